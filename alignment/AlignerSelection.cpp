@@ -0,0 +1,67 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "alignment/AlignerSelection.hh"
+
+#include <algorithm>
+
+using graphtools::Graph;
+using graphtools::NodeId;
+using std::string;
+
+namespace ehunter
+{
+
+GraphComplexity computeGraphComplexity(const Graph& graph)
+{
+    GraphComplexity complexity;
+    complexity.numNodes = graph.numNodes();
+
+    for (NodeId nodeId = 0; nodeId != graph.numNodes(); ++nodeId)
+    {
+        const auto& successors = graph.successors(nodeId);
+        const bool isLoopNode = successors.find(nodeId) != successors.end();
+        const int branchingFactor = successors.size() - (isLoopNode ? 1 : 0);
+
+        complexity.numLoopNodes += isLoopNode ? 1 : 0;
+        complexity.numBranchingNodes += branchingFactor > 1 ? 1 : 0;
+        complexity.maxBranchingFactor = std::max(complexity.maxBranchingFactor, branchingFactor);
+    }
+
+    return complexity;
+}
+
+string selectAligner(const Graph& graph)
+{
+    const GraphComplexity complexity = computeGraphComplexity(graph);
+    if (complexity.numLoopNodes == 0 && complexity.numBranchingNodes == 0)
+    {
+        return "path-aligner";
+    }
+
+    return "dag-aligner";
+}
+
+string resolveAlignerType(const string& alignerType, const Graph& graph)
+{
+    return alignerType == "auto" ? selectAligner(graph) : alignerType;
+}
+
+}
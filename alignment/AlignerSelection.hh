@@ -0,0 +1,60 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <string>
+
+#include "graphcore/Graph.hh"
+
+namespace ehunter
+{
+
+// Graph features that drive the cost of the gapped graph aligners
+struct GraphComplexity
+{
+    int numNodes = 0;
+    // Nodes with an edge to themselves (repeat units)
+    int numLoopNodes = 0;
+    // Nodes with more than one successor other than themselves
+    int numBranchingNodes = 0;
+    // Largest number of successors of a node other than itself
+    int maxBranchingFactor = 0;
+};
+
+GraphComplexity computeGraphComplexity(const graphtools::Graph& graph);
+
+/**
+ * Picks the gapped aligner for the graph of a locus
+ *
+ * The path aligner enumerates every path that a query piece may align to, so its cost grows combinatorially with the
+ * number of repeats and branches, while the dag aligner aligns to all of them at once. The dag aligner was measured
+ * to be faster on graphs of every locus structure benchmarked by AlignerSelectionBenchmark, single repeats included,
+ * so the path aligner is only picked for graphs consisting of a single path
+ *
+ * @param graph: graph of a locus
+ * @return Name of the aligner: path-aligner or dag-aligner
+ */
+std::string selectAligner(const graphtools::Graph& graph);
+
+// Resolves "auto" aligner type into the aligner selected for the graph; other aligner types are returned unchanged
+std::string resolveAlignerType(const std::string& alignerType, const graphtools::Graph& graph);
+
+}
@@ -20,29 +20,19 @@
 
 #include "alignment/AlignmentFilters.hh"
 
-#include <list>
-#include <vector>
-
-#include "graphalign/GaplessAligner.hh"
-#include "graphalign/GraphAlignmentOperations.hh"
-#include "graphalign/LinearAlignmentOperations.hh"
-#include "graphcore/PathOperations.hh"
-
 #include "alignment/GraphAlignmentOperations.hh"
 
 using graphtools::GraphAlignment;
 using graphtools::NodeId;
-using graphtools::Path;
-using std::list;
-using std::string;
-using std::vector;
+using graphtools::Operation;
+using graphtools::OperationType;
 
 namespace ehunter
 {
 
 bool checkIfLocallyPlacedReadPair(
-    boost::optional<GraphAlignment> readAlignment, boost::optional<GraphAlignment> mateAlignment,
-    int kMinNonRepeatAlignmentScore)
+    const boost::optional<CompactGraphAlignment>& readAlignment,
+    const boost::optional<CompactGraphAlignment>& mateAlignment, int kMinNonRepeatAlignmentScore)
 {
     int nonRepeatAlignmentScore = 0;
 
@@ -64,22 +54,57 @@ bool checkIfLocallyPlacedReadPair(
     return true;
 }
 
-bool checkIfUpstreamAlignmentIsGood(NodeId nodeId, GraphAlignment alignment)
+static bool checkIfPassesAlignmentFilters(
+    int queryLength, int frontSoftclipLen, int backSoftclipLen, int referenceLength, int numMatches)
+{
+    const int clippedQueryLength = queryLength - frontSoftclipLen - backSoftclipLen;
+
+    const int percentQueryMatches = (100 * numMatches) / clippedQueryLength;
+    const int percentReferenceMatches = (100 * numMatches) / referenceLength;
+
+    return percentQueryMatches >= 80 && percentReferenceMatches >= 80;
+}
+
+bool checkIfPassesAlignmentFilters(const CompactGraphAlignment& alignment)
+{
+    const PackedOperation firstOperation = alignment.operations().front();
+    const int frontSoftclipLen = firstOperation.type() == OperationType::kSoftclip ? firstOperation.queryLength() : 0;
+
+    const PackedOperation lastOperation = alignment.operations().back();
+    const int backSoftclipLen = lastOperation.type() == OperationType::kSoftclip ? lastOperation.queryLength() : 0;
+
+    return checkIfPassesAlignmentFilters(
+        alignment.queryLength(), frontSoftclipLen, backSoftclipLen, alignment.referenceLength(),
+        alignment.numMatches());
+}
+
+bool checkIfPassesAlignmentFilters(const GraphAlignment& alignment)
+{
+    const Operation& firstOperation = alignment.alignments().front().operations().front();
+    const int frontSoftclipLen = firstOperation.type() == OperationType::kSoftclip ? firstOperation.queryLength() : 0;
+
+    const Operation& lastOperation = alignment.alignments().back().operations().back();
+    const int backSoftclipLen = lastOperation.type() == OperationType::kSoftclip ? lastOperation.queryLength() : 0;
+
+    return checkIfPassesAlignmentFilters(
+        alignment.queryLength(), frontSoftclipLen, backSoftclipLen, alignment.referenceLength(),
+        alignment.numMatches());
+}
+
+bool checkIfUpstreamAlignmentIsGood(NodeId nodeId, const CompactGraphAlignment& alignment)
 {
-    const list<int> repeatNodeIndexes = alignment.getIndexesOfNode(nodeId);
+    const int firstRepeatNodeIndex = alignment.firstIndexOfNode(nodeId);
 
-    if (repeatNodeIndexes.empty())
+    if (firstRepeatNodeIndex == -1)
     {
         return false;
     }
 
-    const int firstRepeatNodeIndex = repeatNodeIndexes.front();
     int score = 0;
     LinearAlignmentParameters parameters;
     for (int nodeIndex = 0; nodeIndex != firstRepeatNodeIndex; ++nodeIndex)
     {
-        score += scoreAlignment(
-            alignment[nodeIndex], parameters.matchScore, parameters.mismatchScore, parameters.gapOpenScore);
+        score += scoreNodeAlignment(alignment, nodeIndex, parameters);
     }
 
     const int kScoreCutoff = parameters.matchScore * 8;
@@ -87,22 +112,20 @@ bool checkIfUpstreamAlignmentIsGood(NodeId nodeId, GraphAlignment alignment)
     return score >= kScoreCutoff;
 }
 
-bool checkIfDownstreamAlignmentIsGood(NodeId nodeId, GraphAlignment alignment)
+bool checkIfDownstreamAlignmentIsGood(NodeId nodeId, const CompactGraphAlignment& alignment)
 {
-    const list<int> repeatNodeIndexes = alignment.getIndexesOfNode(nodeId);
+    const int lastRepeatNodeIndex = alignment.lastIndexOfNode(nodeId);
 
-    if (repeatNodeIndexes.empty())
+    if (lastRepeatNodeIndex == -1)
     {
         return false;
     }
 
-    const int lastRepeatNodeIndex = repeatNodeIndexes.back();
     int score = 0;
     LinearAlignmentParameters parameters;
-    for (int nodeIndex = lastRepeatNodeIndex + 1; nodeIndex != static_cast<int>(alignment.size()); ++nodeIndex)
+    for (int nodeIndex = lastRepeatNodeIndex + 1; nodeIndex != static_cast<int>(alignment.numNodes()); ++nodeIndex)
     {
-        score += scoreAlignment(
-            alignment[nodeIndex], parameters.matchScore, parameters.mismatchScore, parameters.gapOpenScore);
+        score += scoreNodeAlignment(alignment, nodeIndex, parameters);
     }
 
     const int kScoreCutoff = parameters.matchScore * 8;
@@ -26,6 +26,8 @@
 
 #include "graphalign/GraphAlignment.hh"
 
+#include "alignment/CompactGraphAlignment.hh"
+
 namespace ehunter
 {
 
@@ -41,13 +43,24 @@ namespace ehunter
  * @return true if the alignment score to non-repeat nodes exceeds the threshold
  */
 bool checkIfLocallyPlacedReadPair(
-    boost::optional<graphtools::GraphAlignment> readAlignment,
-    boost::optional<graphtools::GraphAlignment> mateAlignment, int kMinNonRepeatAlignmentScore);
+    const boost::optional<CompactGraphAlignment>& readAlignment,
+    const boost::optional<CompactGraphAlignment>& mateAlignment, int kMinNonRepeatAlignmentScore);
+
+/**
+ * Checks if a read alignment is good enough to be used for genotyping
+ *
+ * @param alignment: Alignment of a read
+ * @return true if matches make up at least 80% of both the unclipped query and the reference spanned by the alignment
+ */
+bool checkIfPassesAlignmentFilters(const CompactGraphAlignment& alignment);
+
+// Same filters computed directly on an alignment that is not converted to the compact form
+bool checkIfPassesAlignmentFilters(const graphtools::GraphAlignment& alignment);
 
 // Checks if alignment upstream of a given node is high quality
-bool checkIfUpstreamAlignmentIsGood(graphtools::NodeId nodeId, graphtools::GraphAlignment alignment);
+bool checkIfUpstreamAlignmentIsGood(graphtools::NodeId nodeId, const CompactGraphAlignment& alignment);
 
 // Checks if alignment downstream of a given node is high quality
-bool checkIfDownstreamAlignmentIsGood(graphtools::NodeId nodeId, graphtools::GraphAlignment alignment);
+bool checkIfDownstreamAlignmentIsGood(graphtools::NodeId nodeId, const CompactGraphAlignment& alignment);
 
 }
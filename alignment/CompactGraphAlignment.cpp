@@ -0,0 +1,275 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "alignment/CompactGraphAlignment.hh"
+
+#include <algorithm>
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+using graphtools::Alignment;
+using graphtools::GraphAlignment;
+using graphtools::NodeId;
+using graphtools::Operation;
+using graphtools::OperationType;
+using graphtools::Path;
+using std::list;
+using std::size_t;
+using std::vector;
+
+namespace ehunter
+{
+
+int32_t PackedOperation::referenceLength() const
+{
+    switch (type())
+    {
+    case OperationType::kMatch:
+    case OperationType::kMismatch:
+    case OperationType::kMissingBases:
+    case OperationType::kDeletionFromRef:
+        return length();
+    default:
+        return 0;
+    }
+}
+
+int32_t PackedOperation::queryLength() const
+{
+    switch (type())
+    {
+    case OperationType::kMatch:
+    case OperationType::kMismatch:
+    case OperationType::kMissingBases:
+    case OperationType::kInsertionToRef:
+    case OperationType::kSoftclip:
+        return length();
+    default:
+        return 0;
+    }
+}
+
+CompactGraphAlignment::CompactGraphAlignment(const GraphAlignment& alignment)
+    : graphPtr_(alignment.path().graphRawPtr())
+    , startPosition_(alignment.path().startPosition())
+    , numNodes_(alignment.size())
+    , numOperations_(0)
+{
+    for (const Alignment& nodeAlignment : alignment.alignments())
+    {
+        numOperations_ += nodeAlignment.numOperations();
+    }
+    allocate(numWords());
+
+    uint32_t* nodeIdPtr = words();
+    uint32_t* operationEndPtr = nodeIdPtr + numNodes_;
+    uint32_t* operationPtr = operationEndPtr + numNodes_;
+
+    uint32_t operationIndex = 0;
+    for (size_t nodeIndex = 0; nodeIndex != numNodes_; ++nodeIndex)
+    {
+        nodeIdPtr[nodeIndex] = alignment.path().getNodeIdByIndex(nodeIndex);
+        for (const Operation& operation : alignment[nodeIndex])
+        {
+            if (operation.length() >= (1u << (32 - PackedOperation::kTypeBits)))
+            {
+                throw std::logic_error("Alignment operation is too long to be packed");
+            }
+            const PackedOperation packedOperation(operation.type(), operation.length());
+            operationPtr[operationIndex++] = packedOperation.encoding();
+
+            queryLength_ += packedOperation.queryLength();
+            referenceLength_ += packedOperation.referenceLength();
+            if (packedOperation.type() == OperationType::kMatch)
+            {
+                numMatches_ += packedOperation.length();
+            }
+        }
+        operationEndPtr[nodeIndex] = operationIndex;
+    }
+}
+
+CompactGraphAlignment::CompactGraphAlignment(const CompactGraphAlignment& other)
+    : graphPtr_(other.graphPtr_)
+    , startPosition_(other.startPosition_)
+    , numNodes_(other.numNodes_)
+    , numOperations_(other.numOperations_)
+    , queryLength_(other.queryLength_)
+    , referenceLength_(other.referenceLength_)
+    , numMatches_(other.numMatches_)
+{
+    allocate(numWords());
+    std::copy(other.words(), other.words() + numWords(), words());
+}
+
+CompactGraphAlignment::CompactGraphAlignment(CompactGraphAlignment&& other) noexcept
+    : graphPtr_(other.graphPtr_)
+    , startPosition_(other.startPosition_)
+    , numNodes_(other.numNodes_)
+    , numOperations_(other.numOperations_)
+    , queryLength_(other.queryLength_)
+    , referenceLength_(other.referenceLength_)
+    , numMatches_(other.numMatches_)
+    , heapWords_(std::move(other.heapWords_))
+{
+    if (!heapWords_)
+    {
+        std::copy(other.inlineWords_, other.inlineWords_ + numWords(), inlineWords_);
+    }
+    other.numNodes_ = 0;
+    other.numOperations_ = 0;
+}
+
+CompactGraphAlignment& CompactGraphAlignment::operator=(const CompactGraphAlignment& other)
+{
+    if (this != &other)
+    {
+        CompactGraphAlignment copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+CompactGraphAlignment& CompactGraphAlignment::operator=(CompactGraphAlignment&& other) noexcept
+{
+    if (this != &other)
+    {
+        graphPtr_ = other.graphPtr_;
+        startPosition_ = other.startPosition_;
+        numNodes_ = other.numNodes_;
+        numOperations_ = other.numOperations_;
+        queryLength_ = other.queryLength_;
+        referenceLength_ = other.referenceLength_;
+        numMatches_ = other.numMatches_;
+        heapWords_ = std::move(other.heapWords_);
+        if (!heapWords_)
+        {
+            std::copy(other.inlineWords_, other.inlineWords_ + numWords(), inlineWords_);
+        }
+        other.numNodes_ = 0;
+        other.numOperations_ = 0;
+    }
+    return *this;
+}
+
+void CompactGraphAlignment::allocate(size_t numWords)
+{
+    if (numWords > kInlineCapacity)
+    {
+        heapWords_.reset(new uint32_t[numWords]);
+    }
+}
+
+CompactGraphAlignment::OperationRange CompactGraphAlignment::operations(size_t nodeIndex) const
+{
+    const uint32_t* operationEndPtr = words() + numNodes_;
+    const uint32_t* operationPtr = operationEndPtr + numNodes_;
+    const uint32_t beginIndex = nodeIndex == 0 ? 0 : operationEndPtr[nodeIndex - 1];
+    return OperationRange(operationPtr + beginIndex, operationPtr + operationEndPtr[nodeIndex]);
+}
+
+CompactGraphAlignment::OperationRange CompactGraphAlignment::operations() const
+{
+    const uint32_t* operationPtr = words() + 2 * numNodes_;
+    return OperationRange(operationPtr, operationPtr + numOperations_);
+}
+
+int32_t CompactGraphAlignment::referenceLength(size_t nodeIndex) const
+{
+    int32_t length = 0;
+    for (PackedOperation operation : operations(nodeIndex))
+    {
+        length += operation.referenceLength();
+    }
+    return length;
+}
+
+int32_t CompactGraphAlignment::numMatches(size_t nodeIndex) const
+{
+    int32_t numMatches = 0;
+    for (PackedOperation operation : operations(nodeIndex))
+    {
+        if (operation.type() == OperationType::kMatch)
+        {
+            numMatches += operation.length();
+        }
+    }
+    return numMatches;
+}
+
+bool CompactGraphAlignment::overlapsNode(NodeId nodeId) const { return firstIndexOfNode(nodeId) != -1; }
+
+int CompactGraphAlignment::firstIndexOfNode(NodeId nodeId) const
+{
+    const uint32_t* nodeIdPtr = words();
+    for (size_t nodeIndex = 0; nodeIndex != numNodes_; ++nodeIndex)
+    {
+        if (nodeIdPtr[nodeIndex] == nodeId)
+        {
+            return nodeIndex;
+        }
+    }
+    return -1;
+}
+
+int CompactGraphAlignment::lastIndexOfNode(NodeId nodeId) const
+{
+    const uint32_t* nodeIdPtr = words();
+    for (size_t nodeIndex = numNodes_; nodeIndex != 0; --nodeIndex)
+    {
+        if (nodeIdPtr[nodeIndex - 1] == nodeId)
+        {
+            return nodeIndex - 1;
+        }
+    }
+    return -1;
+}
+
+GraphAlignment CompactGraphAlignment::expand() const
+{
+    vector<NodeId> nodeIds(words(), words() + numNodes_);
+    vector<Alignment> nodeAlignments;
+    nodeAlignments.reserve(numNodes_);
+
+    for (size_t nodeIndex = 0; nodeIndex != numNodes_; ++nodeIndex)
+    {
+        list<Operation> nodeOperations;
+        for (PackedOperation operation : operations(nodeIndex))
+        {
+            nodeOperations.emplace_back(operation.type(), operation.length());
+        }
+        const int32_t referenceStart = nodeIndex == 0 ? startPosition_ : 0;
+        nodeAlignments.emplace_back(referenceStart, std::move(nodeOperations));
+    }
+
+    const Alignment& lastAlignment = nodeAlignments.back();
+    const int32_t endPosition = lastAlignment.referenceStart() + lastAlignment.referenceLength();
+    return GraphAlignment(Path(graphPtr_, startPosition_, nodeIds, endPosition), nodeAlignments);
+}
+
+bool CompactGraphAlignment::operator==(const CompactGraphAlignment& other) const
+{
+    return graphPtr_ == other.graphPtr_ && startPosition_ == other.startPosition_ && numNodes_ == other.numNodes_
+        && numOperations_ == other.numOperations_ && std::equal(words(), words() + numWords(), other.words());
+}
+
+}
@@ -0,0 +1,162 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "graphalign/GraphAlignment.hh"
+#include "graphalign/Operation.hh"
+#include "graphcore/Graph.hh"
+
+namespace ehunter
+{
+
+// Alignment operation packed into a single 32-bit word
+class PackedOperation
+{
+public:
+    static const int kTypeBits = 4;
+
+    explicit PackedOperation(uint32_t encoding)
+        : encoding_(encoding)
+    {
+    }
+    PackedOperation(graphtools::OperationType type, uint32_t length)
+        : encoding_((length << kTypeBits) | static_cast<uint32_t>(type))
+    {
+    }
+
+    graphtools::OperationType type() const
+    {
+        return static_cast<graphtools::OperationType>(encoding_ & ((1u << kTypeBits) - 1));
+    }
+    int32_t length() const { return static_cast<int32_t>(encoding_ >> kTypeBits); }
+    int32_t referenceLength() const;
+    int32_t queryLength() const;
+    uint32_t encoding() const { return encoding_; }
+
+private:
+    uint32_t encoding_;
+};
+
+/**
+ * Read-only graph alignment stored in one contiguous buffer
+ *
+ * The buffer holds the node ids of the path, the end offset of the operations aligned to each node, and the
+ * run-length-encoded operations themselves. Alignments of reads to locus graphs normally fit into the inline
+ * storage, so creating, copying, and moving them does not allocate.
+ */
+class CompactGraphAlignment
+{
+public:
+    static const std::size_t kInlineCapacity = 32;
+
+    class OperationRange
+    {
+    public:
+        class Iterator
+        {
+        public:
+            explicit Iterator(const uint32_t* wordPtr)
+                : wordPtr_(wordPtr)
+            {
+            }
+            PackedOperation operator*() const { return PackedOperation(*wordPtr_); }
+            Iterator& operator++()
+            {
+                ++wordPtr_;
+                return *this;
+            }
+            bool operator!=(const Iterator& other) const { return wordPtr_ != other.wordPtr_; }
+
+        private:
+            const uint32_t* wordPtr_;
+        };
+
+        OperationRange(const uint32_t* beginPtr, const uint32_t* endPtr)
+            : beginPtr_(beginPtr)
+            , endPtr_(endPtr)
+        {
+        }
+        Iterator begin() const { return Iterator(beginPtr_); }
+        Iterator end() const { return Iterator(endPtr_); }
+        std::size_t size() const { return endPtr_ - beginPtr_; }
+        PackedOperation front() const { return PackedOperation(*beginPtr_); }
+        PackedOperation back() const { return PackedOperation(*(endPtr_ - 1)); }
+
+    private:
+        const uint32_t* beginPtr_;
+        const uint32_t* endPtr_;
+    };
+
+    // Explicit because each conversion packs the whole alignment; callers convert once and pass the result on
+    explicit CompactGraphAlignment(const graphtools::GraphAlignment& alignment);
+    CompactGraphAlignment(const CompactGraphAlignment& other);
+    CompactGraphAlignment(CompactGraphAlignment&& other) noexcept;
+    CompactGraphAlignment& operator=(const CompactGraphAlignment& other);
+    CompactGraphAlignment& operator=(CompactGraphAlignment&& other) noexcept;
+
+    const graphtools::Graph& graph() const { return *graphPtr_; }
+    int32_t startPosition() const { return startPosition_; }
+    std::size_t numNodes() const { return numNodes_; }
+    graphtools::NodeId nodeId(std::size_t nodeIndex) const { return words()[nodeIndex]; }
+    OperationRange operations(std::size_t nodeIndex) const;
+    OperationRange operations() const;
+
+    int32_t queryLength() const { return queryLength_; }
+    int32_t referenceLength() const { return referenceLength_; }
+    int32_t numMatches() const { return numMatches_; }
+    int32_t referenceLength(std::size_t nodeIndex) const;
+    int32_t numMatches(std::size_t nodeIndex) const;
+
+    bool overlapsNode(graphtools::NodeId nodeId) const;
+    // Returns -1 if the alignment does not overlap the node
+    int firstIndexOfNode(graphtools::NodeId nodeId) const;
+    int lastIndexOfNode(graphtools::NodeId nodeId) const;
+
+    // Restores the original representation, e.g. for printing
+    graphtools::GraphAlignment expand() const;
+
+    bool operator==(const CompactGraphAlignment& other) const;
+
+private:
+    const uint32_t* words() const { return heapWords_ ? heapWords_.get() : inlineWords_; }
+    uint32_t* words() { return heapWords_ ? heapWords_.get() : inlineWords_; }
+    std::size_t numWords() const { return 2 * numNodes_ + numOperations_; }
+    void allocate(std::size_t numWords);
+
+    const graphtools::Graph* graphPtr_;
+    int32_t startPosition_;
+    uint32_t numNodes_;
+    uint32_t numOperations_;
+    int32_t queryLength_ = 0;
+    int32_t referenceLength_ = 0;
+    int32_t numMatches_ = 0;
+
+    // Node ids, then the end offset of each node's operations, then the operations
+    std::unique_ptr<uint32_t[]> heapWords_;
+    uint32_t inlineWords_[kInlineCapacity];
+};
+
+}
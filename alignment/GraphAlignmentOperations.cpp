@@ -39,6 +39,7 @@ using graphtools::GraphAlignment;
 using graphtools::makeStrGraph;
 using graphtools::mergeAlignments;
 using graphtools::NodeId;
+using graphtools::OperationType;
 using graphtools::Path;
 using std::list;
 using std::string;
@@ -70,74 +71,97 @@ GraphAlignment extendWithSoftclip(const GraphAlignment& graphAlignment, int left
     return GraphAlignment(graphAlignment.path(), sequenceAlignments);
 }
 
-int getNumNonrepeatMatchesUpstream(NodeId nodeId, GraphAlignment alignment)
+int getNumNonrepeatMatchesUpstream(NodeId nodeId, const CompactGraphAlignment& alignment)
 {
-    const list<int> repeatNodeIndexes = alignment.getIndexesOfNode(nodeId);
+    const int firstRepeatNodeIndex = alignment.firstIndexOfNode(nodeId);
 
-    if (repeatNodeIndexes.empty())
+    if (firstRepeatNodeIndex == -1)
     {
         return 0;
     }
 
-    const int firstRepeatNodeIndex = repeatNodeIndexes.front();
     int numMatches = 0;
 
     for (int nodeIndex = 0; nodeIndex != firstRepeatNodeIndex; ++nodeIndex)
     {
-        numMatches += alignment[nodeIndex].numMatched();
+        numMatches += alignment.numMatches(nodeIndex);
     }
 
     return numMatches;
 }
 
-int getNumNonrepeatMatchesDownstream(NodeId nodeId, GraphAlignment alignment)
+int getNumNonrepeatMatchesDownstream(NodeId nodeId, const CompactGraphAlignment& alignment)
 {
-    const list<int> repeatNodeIndexes = alignment.getIndexesOfNode(nodeId);
+    const int lastRepeatNodeIndex = alignment.lastIndexOfNode(nodeId);
 
-    if (repeatNodeIndexes.empty())
+    if (lastRepeatNodeIndex == -1)
     {
         return 0;
     }
 
-    const int lastRepeatNodeIndex = repeatNodeIndexes.back();
     int numMatches = 0;
 
-    for (int nodeIndex = lastRepeatNodeIndex + 1; nodeIndex != static_cast<int>(alignment.size()); ++nodeIndex)
+    for (int nodeIndex = lastRepeatNodeIndex + 1; nodeIndex != static_cast<int>(alignment.numNodes()); ++nodeIndex)
     {
-        numMatches += alignment[nodeIndex].numMatched();
+        numMatches += alignment.numMatches(nodeIndex);
     }
 
     return numMatches;
 }
 
-int scoreAlignmentToNonloopNodes(graphtools::GraphAlignment alignment, LinearAlignmentParameters parameters)
+int scoreNodeAlignment(
+    const CompactGraphAlignment& alignment, std::size_t nodeIndex, LinearAlignmentParameters parameters)
 {
     int score = 0;
-    const Graph& graph = *alignment.path().graphRawPtr();
-    for (int nodeIndex = 0; nodeIndex != (int)alignment.size(); ++nodeIndex)
+    for (PackedOperation operation : alignment.operations(nodeIndex))
     {
-        NodeId nodeId = alignment.path().getNodeIdByIndex(nodeIndex);
-        if (graph.successors(nodeId).find(nodeId) == graph.successors(nodeId).end())
+        switch (operation.type())
         {
-            score += scoreAlignment(
-                alignment[nodeIndex], parameters.matchScore, parameters.mismatchScore, parameters.gapOpenScore);
+        case OperationType::kMatch:
+            score += parameters.matchScore * operation.referenceLength();
+            break;
+        case OperationType::kMismatch:
+            score += parameters.mismatchScore * operation.referenceLength();
+            break;
+        case OperationType::kInsertionToRef:
+            score += parameters.gapOpenScore * operation.queryLength();
+            break;
+        case OperationType::kDeletionFromRef:
+            score += parameters.gapOpenScore * operation.referenceLength();
+            break;
+        default:
+            break;
         }
     }
 
     return score;
 }
 
-int countFullOverlaps(NodeId nodeId, GraphAlignment alignment)
+int scoreAlignmentToNonloopNodes(const CompactGraphAlignment& alignment, LinearAlignmentParameters parameters)
 {
-    const list<int> repeatNodeIndexes = alignment.getIndexesOfNode(nodeId);
+    int score = 0;
+    const Graph& graph = alignment.graph();
+    for (std::size_t nodeIndex = 0; nodeIndex != alignment.numNodes(); ++nodeIndex)
+    {
+        NodeId nodeId = alignment.nodeId(nodeIndex);
+        if (!graph.hasEdge(nodeId, nodeId))
+        {
+            score += scoreNodeAlignment(alignment, nodeIndex, parameters);
+        }
+    }
 
-    const graphtools::Graph& graph = *alignment.path().graphRawPtr();
-    const std::size_t nodeLength = graph.nodeSeq(nodeId).length();
+    return score;
+}
+
+int countFullOverlaps(NodeId nodeId, const CompactGraphAlignment& alignment)
+{
+    const graphtools::Graph& graph = alignment.graph();
+    const int32_t nodeLength = graph.nodeSeq(nodeId).length();
 
     int numFullOverlaps = 0;
-    for (auto nodeIndex : repeatNodeIndexes)
+    for (std::size_t nodeIndex = 0; nodeIndex != alignment.numNodes(); ++nodeIndex)
     {
-        if (alignment[nodeIndex].referenceLength() == nodeLength)
+        if (alignment.nodeId(nodeIndex) == nodeId && alignment.referenceLength(nodeIndex) == nodeLength)
         {
             ++numFullOverlaps;
         }
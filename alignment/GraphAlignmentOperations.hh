@@ -20,9 +20,14 @@
 
 #pragma once
 
+#include <cstddef>
+#include <list>
+
 #include "graphalign/GraphAlignment.hh"
 #include "graphalign/LinearAlignmentParameters.hh"
 
+#include "alignment/CompactGraphAlignment.hh"
+
 namespace ehunter
 {
 
@@ -42,14 +47,21 @@ namespace ehunter
 graphtools::GraphAlignment
 extendWithSoftclip(const graphtools::GraphAlignment& alignment, int leftSoftclipLen, int rightSoftclipLen);
 
-int getNumNonrepeatMatchesUpstream(graphtools::NodeId nodeId, graphtools::GraphAlignment alignment);
+int getNumNonrepeatMatchesUpstream(graphtools::NodeId nodeId, const CompactGraphAlignment& alignment);
+
+int getNumNonrepeatMatchesDownstream(graphtools::NodeId nodeId, const CompactGraphAlignment& alignment);
 
-int getNumNonrepeatMatchesDownstream(graphtools::NodeId nodeId, graphtools::GraphAlignment alignment);
+/**
+ * Scores the piece of the alignment that falls on the node with the given index
+ */
+int scoreNodeAlignment(
+    const CompactGraphAlignment& alignment, std::size_t nodeIndex,
+    LinearAlignmentParameters parameters = LinearAlignmentParameters());
 
 int scoreAlignmentToNonloopNodes(
-    graphtools::GraphAlignment alignment, LinearAlignmentParameters parameters = LinearAlignmentParameters());
+    const CompactGraphAlignment& alignment, LinearAlignmentParameters parameters = LinearAlignmentParameters());
 
-int countFullOverlaps(graphtools::NodeId nodeId, graphtools::GraphAlignment alignment);
+int countFullOverlaps(graphtools::NodeId nodeId, const CompactGraphAlignment& alignment);
 
 graphtools::GraphAlignment computeCanonicalAlignment(const std::list<graphtools::GraphAlignment>& alignments);
 
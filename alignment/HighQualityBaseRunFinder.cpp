@@ -21,61 +21,63 @@
 #include "alignment/HighQualityBaseRunFinder.hh"
 
 #include <cctype>
-#include <limits>
 
 using std::string;
 
 namespace ehunter
 {
 
-template <typename Iter> static int countGoodBases(Iter begin, Iter end)
+static double calculateBaseRunProb(double goodBaseProb, int numGoodBasesInRun, int numBadBasesInRun)
 {
-    int numGoodBases = 0;
-    for (; begin != end; ++begin)
-    {
-        if (isupper(*begin))
-        {
-            ++numGoodBases;
-        }
-    }
-
-    return numGoodBases;
-}
-
-template <typename Iter> static double calculateBaseRunProb(double goodBaseProb, Iter begin, Iter end)
-{
-    const int runLength = end - begin;
-    const int numGoodBasesInRun = countGoodBases(begin, end);
-    const int numBadBasesInRun = runLength - numGoodBasesInRun;
     return numGoodBasesInRun * goodBaseProb + numBadBasesInRun * (1.0 - goodBaseProb);
 }
 
-template <typename Iter>
-static double calculateRunProbability(
-    double probOfGoodBaseInFirstRun, double probOfGoodBaseInSecondRun, Iter start, Iter changePoint, Iter end)
-{
-    const double firstRunProb = calculateBaseRunProb(probOfGoodBaseInFirstRun, start, changePoint);
-    const double secondRunProb = calculateBaseRunProb(probOfGoodBaseInSecondRun, changePoint, end);
-
-    return firstRunProb + secondRunProb;
-}
-
+// Finds the change point maximizing the sum of the probabilities of the runs before and after it in a single scan by
+// moving one base at a time from the second run to the first run
 template <typename Iter>
 static Iter findTopChangePoint(double probOfGoodBaseInFirstRun, double probOfGoodBaseInSecondRun, Iter start, Iter end)
 {
+    int numGoodBasesInFirstRun = 0;
+    int numBadBasesInFirstRun = 0;
+    int numGoodBasesInSecondRun = 0;
+    int numBadBasesInSecondRun = 0;
+    for (auto baseIter = start; baseIter != end; ++baseIter)
+    {
+        if (isupper(*baseIter))
+        {
+            ++numGoodBasesInSecondRun;
+        }
+        else
+        {
+            ++numBadBasesInSecondRun;
+        }
+    }
+
     double topRunProb = 0;
     auto topChangePoint = start;
 
     for (auto changePoint = start; changePoint != end; ++changePoint)
     {
         const double currentRunProb
-            = calculateRunProbability(probOfGoodBaseInFirstRun, probOfGoodBaseInSecondRun, start, changePoint, end);
+            = calculateBaseRunProb(probOfGoodBaseInFirstRun, numGoodBasesInFirstRun, numBadBasesInFirstRun)
+            + calculateBaseRunProb(probOfGoodBaseInSecondRun, numGoodBasesInSecondRun, numBadBasesInSecondRun);
 
         if (topRunProb < currentRunProb)
         {
             topRunProb = currentRunProb;
             topChangePoint = changePoint;
         }
+
+        if (isupper(*changePoint))
+        {
+            ++numGoodBasesInFirstRun;
+            --numGoodBasesInSecondRun;
+        }
+        else
+        {
+            ++numBadBasesInFirstRun;
+            --numBadBasesInSecondRun;
+        }
     }
 
     return topChangePoint;
@@ -20,43 +20,160 @@
 
 #include "alignment/SoftclippingAligner.hh"
 
+#include "alignment/AlignmentFilters.hh"
 #include "alignment/GraphAlignmentOperations.hh"
 #include "alignment/HighQualityBaseRunFinder.hh"
 
 using graphtools::Graph;
 using graphtools::GraphAlignment;
+using graphtools::KmerIndex;
 using std::list;
 using std::string;
+using std::vector;
 
 namespace ehunter
 {
 
 SoftclippingAligner::SoftclippingAligner(
     const Graph* graphPtr, const std::string& alignerName, int kmerLenForAlignment, int paddingLength,
-    int seedAffixTrimLength)
-    : aligner_(graphPtr, kmerLenForAlignment, paddingLength, seedAffixTrimLength, alignerName)
+    int seedAffixTrimLength, int maxGaplessMismatches, bool trimLowQualityBases)
+    : SoftclippingAligner(
+          std::make_shared<KmerIndex>(*graphPtr, kmerLenForAlignment), alignerName, paddingLength, seedAffixTrimLength,
+          maxGaplessMismatches, trimLowQualityBases)
+{
+}
+
+SoftclippingAligner::SoftclippingAligner(
+    std::shared_ptr<const KmerIndex> kmerIndexPtr, const std::string& alignerName, int paddingLength,
+    int seedAffixTrimLength, int maxGaplessMismatches, bool trimLowQualityBases)
+    : gaplessAligner_(kmerIndexPtr)
+    , aligner_(kmerIndexPtr, paddingLength, seedAffixTrimLength, alignerName)
+    , maxGaplessMismatches_(maxGaplessMismatches)
+    , trimLowQualityBases_(trimLowQualityBases)
 {
 }
 
 list<GraphAlignment> SoftclippingAligner::align(const string& query) const
 {
-    /*
-    HighQualityBaseRunFinder goodBaseFinder(6, 2, query.size() / 2);
-    const auto goodBasesRange = goodBaseFinder.find(query);
-    const auto goodBases = string(goodBasesRange.first, goodBasesRange.second);
+    if (!trimLowQualityBases_)
+    {
+        return alignInTiers(query);
+    }
+
+    const auto goodBasesRange = findHighQualityBaseRun(query);
+    const int numBasesTrimmedFromLeft = goodBasesRange.first - query.begin();
+    const int numBasesTrimmedFromRight = query.end() - goodBasesRange.second;
 
-    int numBasesTrimmedFromLeft = goodBasesRange.first - query.begin();
-    int numBasesTrimmedFromRight = query.end() - goodBasesRange.second;
+    if (numBasesTrimmedFromLeft == 0 && numBasesTrimmedFromRight == 0)
+    {
+        return alignInTiers(query);
+    }
 
+    const string goodBases(goodBasesRange.first, goodBasesRange.second);
     list<GraphAlignment> extendedAlignments;
-    for (const auto& alignment : aligner_.align(goodBases))
+    for (const auto& alignment : alignInTiers(goodBases))
+    {
+        extendedAlignments.push_back(extendWithSoftclip(alignment, numBasesTrimmedFromLeft, numBasesTrimmedFromRight));
+    }
+
+    return extendedAlignments;
+}
+
+vector<list<GraphAlignment>> SoftclippingAligner::alignBatch(const vector<string>& queries) const
+{
+    vector<list<GraphAlignment>> alignmentLists(queries.size());
+    vector<std::pair<int, int>> numsBasesTrimmed(queries.size(), std::make_pair(0, 0));
+
+    vector<std::size_t> gappedQueryIndexes;
+    vector<string> gappedQueries;
+    {
+        StageTimer timer(metricsPtr_, AnalysisStage::kGaplessAlignment);
+        for (std::size_t queryIndex = 0; queryIndex != queries.size(); ++queryIndex)
+        {
+            const string& query = queries[queryIndex];
+            string goodBases;
+            if (trimLowQualityBases_)
+            {
+                const auto goodBasesRange = findHighQualityBaseRun(query);
+                numsBasesTrimmed[queryIndex].first = goodBasesRange.first - query.begin();
+                numsBasesTrimmed[queryIndex].second = query.end() - goodBasesRange.second;
+                goodBases.assign(goodBasesRange.first, goodBasesRange.second);
+            }
+            else
+            {
+                goodBases = query;
+            }
+
+            list<GraphAlignment> gaplessAlignments = gaplessAligner_.align(goodBases, maxGaplessMismatches_);
+            if (checkIfGaplessAlignmentsAreGood(gaplessAlignments))
+            {
+                ++tierStats_.numGaplessAlignedReads;
+                alignmentLists[queryIndex] = std::move(gaplessAlignments);
+            }
+            else
+            {
+                gappedQueryIndexes.push_back(queryIndex);
+                gappedQueries.push_back(std::move(goodBases));
+            }
+        }
+    }
+
+    if (!gappedQueries.empty())
+    {
+        StageTimer timer(metricsPtr_, AnalysisStage::kGappedAlignment);
+        tierStats_.numGappedAlignedReads += gappedQueries.size();
+        vector<list<GraphAlignment>> gappedAlignmentLists = aligner_.alignBatch(gappedQueries);
+        for (std::size_t gappedIndex = 0; gappedIndex != gappedQueries.size(); ++gappedIndex)
+        {
+            alignmentLists[gappedQueryIndexes[gappedIndex]] = std::move(gappedAlignmentLists[gappedIndex]);
+        }
+    }
+
+    for (std::size_t queryIndex = 0; queryIndex != queries.size(); ++queryIndex)
+    {
+        const int numBasesTrimmedFromLeft = numsBasesTrimmed[queryIndex].first;
+        const int numBasesTrimmedFromRight = numsBasesTrimmed[queryIndex].second;
+        if (numBasesTrimmedFromLeft == 0 && numBasesTrimmedFromRight == 0)
+        {
+            continue;
+        }
+
+        for (auto& alignment : alignmentLists[queryIndex])
+        {
+            alignment = extendWithSoftclip(alignment, numBasesTrimmedFromLeft, numBasesTrimmedFromRight);
+        }
+    }
+
+    return alignmentLists;
+}
+
+list<GraphAlignment> SoftclippingAligner::alignInTiers(const string& query) const
+{
     {
-        const auto extendedAlignment = extendWithSoftclip(alignment, numBasesTrimmedFromLeft, numBasesTrimmedFromRight);
-        extendedAlignments.push_back(extendedAlignment);
+        StageTimer timer(metricsPtr_, AnalysisStage::kGaplessAlignment);
+        list<GraphAlignment> gaplessAlignments = gaplessAligner_.align(query, maxGaplessMismatches_);
+        if (checkIfGaplessAlignmentsAreGood(gaplessAlignments))
+        {
+            ++tierStats_.numGaplessAlignedReads;
+            return gaplessAlignments;
+        }
     }
-    */
 
+    StageTimer timer(metricsPtr_, AnalysisStage::kGappedAlignment);
+    ++tierStats_.numGappedAlignedReads;
     return aligner_.align(query);
 }
 
+bool SoftclippingAligner::checkIfGaplessAlignmentsAreGood(const list<GraphAlignment>& alignments) const
+{
+    if (alignments.empty())
+    {
+        return false;
+    }
+
+    // All alignments have the same number of mismatches which is within the bound given to the gapless aligner; the
+    // filters are computed on the alignment itself because callers convert the alignment they keep
+    return checkIfPassesAlignmentFilters(alignments.front());
+}
+
 }
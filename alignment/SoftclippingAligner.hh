@@ -21,25 +21,90 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "graphalign/GaplessAligner.hh"
 #include "graphalign/GappedAligner.hh"
 #include "graphalign/GraphAlignment.hh"
+#include "graphalign/KmerIndex.hh"
 #include "graphcore/Graph.hh"
 
+#include "common/PerformanceMetrics.hh"
+
 namespace ehunter
 {
 
+// Numbers of reads resolved by each tier of SoftclippingAligner
+struct AlignmentTierStats
+{
+    int numGaplessAlignedReads = 0;
+    int numGappedAlignedReads = 0;
+
+    int numReads() const { return numGaplessAlignedReads + numGappedAlignedReads; }
+    double percentGaplessAlignedReads() const
+    {
+        return numReads() ? (100.0 * numGaplessAlignedReads) / numReads() : 0.0;
+    }
+
+    AlignmentTierStats& operator+=(const AlignmentTierStats& other)
+    {
+        numGaplessAlignedReads += other.numGaplessAlignedReads;
+        numGappedAlignedReads += other.numGappedAlignedReads;
+        return *this;
+    }
+};
+
+/**
+ * Aligns reads in two tiers: a read is first aligned without gaps from its first unique kmer and the gapped aligner
+ * is only used if that fails or the gapless alignment has too many mismatches or fails the alignment filters
+ *
+ * With the default of no mismatches only perfect gapless alignments are accepted; these are also the top-scoring
+ * gapped alignments, so the results are the same as with the gapped aligner alone
+ *
+ * If trimming is enabled, low-quality (lowercase) bases at the ends of the read are removed before the alignment and
+ * added back to the resulting alignments as softclips
+ */
 class SoftclippingAligner
 {
 public:
     SoftclippingAligner(
         const graphtools::Graph* graphPtr, const std::string& alignerName, int kmerLenForAlignment, int paddingLength,
-        int seedAffixTrimLength);
+        int seedAffixTrimLength, int maxGaplessMismatches = 0, bool trimLowQualityBases = false);
+
+    // Uses a prebuilt kmer index of the graph that may be shared with the aligners of other samples
+    SoftclippingAligner(
+        std::shared_ptr<const graphtools::KmerIndex> kmerIndexPtr, const std::string& alignerName, int paddingLength,
+        int seedAffixTrimLength, int maxGaplessMismatches = 0, bool trimLowQualityBases = false);
     std::list<graphtools::GraphAlignment> align(const std::string& query) const;
 
+    /**
+     * Aligns a batch of reads; the reads that the gapless tier does not resolve are aligned together by the gapped
+     * aligner
+     *
+     * @param queries: Query sequences
+     * @return Lists of alignments, same as align would return for each query
+     */
+    std::vector<std::list<graphtools::GraphAlignment>> alignBatch(const std::vector<std::string>& queries) const;
+
+    const AlignmentTierStats& tierStats() const { return tierStats_; }
+    // Score precision used for the query pieces of batched gapped alignments
+    graphtools::DagScorePrecisionStats scorePrecisionStats() const { return aligner_.scorePrecisionStats(); }
+
+    // Time spent in each tier is added to the given metrics; no time is measured by default
+    void setMetrics(LocusMetrics* metricsPtr) { metricsPtr_ = metricsPtr; }
+
 private:
+    std::list<graphtools::GraphAlignment> alignInTiers(const std::string& query) const;
+    bool checkIfGaplessAlignmentsAreGood(const std::list<graphtools::GraphAlignment>& alignments) const;
+
+    graphtools::GaplessAligner gaplessAligner_;
     graphtools::GappedGraphAligner aligner_;
+    int maxGaplessMismatches_;
+    bool trimLowQualityBases_;
+    mutable AlignmentTierStats tierStats_;
+    LocusMetrics* metricsPtr_ = nullptr;
 };
 
 }
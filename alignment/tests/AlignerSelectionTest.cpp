@@ -0,0 +1,66 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "alignment/AlignerSelection.hh"
+
+#include "gtest/gtest.h"
+
+#include "input/GraphBlueprint.hh"
+#include "input/RegionGraph.hh"
+
+using graphtools::Graph;
+
+using namespace ehunter;
+
+TEST(ComputingGraphComplexity, TwoRepeatGraph_FeaturesCounted)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGA(CAG)*CAACAG(CCG)*ATGTCG"));
+    const GraphComplexity complexity = computeGraphComplexity(graph);
+
+    EXPECT_EQ(5, complexity.numNodes);
+    EXPECT_EQ(2, complexity.numLoopNodes);
+    EXPECT_EQ(2, complexity.numBranchingNodes);
+    EXPECT_EQ(2, complexity.maxBranchingFactor);
+}
+
+TEST(SelectingAligners, SinglePathGraph_PathAlignerSelected)
+{
+    Graph graph(2);
+    graph.setNodeSeq(0, "ATTCGA");
+    graph.setNodeSeq(1, "ATGTCG");
+    graph.addEdge(0, 1);
+
+    EXPECT_EQ("path-aligner", selectAligner(graph));
+}
+
+TEST(SelectingAligners, GraphsWithRepeatsOrSwaps_DagAlignerSelected)
+{
+    EXPECT_EQ("dag-aligner", selectAligner(makeRegionGraph(decodeFeaturesFromRegex("ATTCGA(CGG)*ATGTCG"))));
+    EXPECT_EQ("dag-aligner", selectAligner(makeRegionGraph(decodeFeaturesFromRegex("ATTCGA(C|T)ATGTCG"))));
+    EXPECT_EQ("dag-aligner", selectAligner(makeRegionGraph(decodeFeaturesFromRegex("ATTCGA(CAG)*CAACAG(CCG)*ATGTCG"))));
+}
+
+TEST(ResolvingAlignerTypes, AutoOrExplicitType_AlignerTypeResolved)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGA(CGG)*ATGTCG"));
+
+    EXPECT_EQ("dag-aligner", resolveAlignerType("auto", graph));
+    EXPECT_EQ("path-aligner", resolveAlignerType("path-aligner", graph));
+}
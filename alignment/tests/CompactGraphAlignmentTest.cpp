@@ -0,0 +1,95 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "alignment/CompactGraphAlignment.hh"
+
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "graphalign/GraphAlignmentOperations.hh"
+#include "graphcore/Graph.hh"
+#include "input/RegionGraph.hh"
+
+using graphtools::decodeGraphAlignment;
+using graphtools::Graph;
+using graphtools::GraphAlignment;
+using graphtools::OperationType;
+using std::string;
+
+using namespace ehunter;
+
+TEST(CreatingCompactAlignments, TypicalAlignment_SummaryStatisticsMatchOriginal)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("TAAT(CAG)*CAACAG(CCG)*CCTT"));
+    const GraphAlignment alignment = decodeGraphAlignment(1, "0[3M]1[1M1I2M]1[3M]2[6M]3[3M]3[1X2M]4[2M2S]", &graph);
+
+    CompactGraphAlignment compactAlignment(alignment);
+
+    EXPECT_EQ(1, compactAlignment.startPosition());
+    ASSERT_EQ(alignment.size(), compactAlignment.numNodes());
+    EXPECT_EQ(static_cast<int32_t>(alignment.queryLength()), compactAlignment.queryLength());
+    EXPECT_EQ(static_cast<int32_t>(alignment.referenceLength()), compactAlignment.referenceLength());
+    EXPECT_EQ(static_cast<int32_t>(alignment.numMatches()), compactAlignment.numMatches());
+
+    EXPECT_EQ(3u, compactAlignment.operations(1).size());
+    EXPECT_EQ(OperationType::kInsertionToRef, (*++compactAlignment.operations(1).begin()).type());
+    EXPECT_EQ(3, compactAlignment.referenceLength(1));
+    EXPECT_EQ(2, compactAlignment.numMatches(5));
+    EXPECT_EQ(OperationType::kSoftclip, compactAlignment.operations().back().type());
+
+    EXPECT_EQ(1, compactAlignment.firstIndexOfNode(1));
+    EXPECT_EQ(2, compactAlignment.lastIndexOfNode(1));
+    EXPECT_EQ(-1, compactAlignment.firstIndexOfNode(5));
+    EXPECT_FALSE(compactAlignment.overlapsNode(5));
+}
+
+TEST(ExpandingCompactAlignments, TypicalAlignment_OriginalAlignmentRestored)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("TAAT(CCG)*CCTT"));
+
+    for (const string encoding : { "0[3M]1[3M]", "1[1M1D]1[3M]2[2M]", "1[1M]" })
+    {
+        const GraphAlignment alignment = decodeGraphAlignment(1, encoding, &graph);
+        EXPECT_EQ(alignment, CompactGraphAlignment(alignment).expand());
+    }
+}
+
+TEST(CopyingCompactAlignments, AlignmentsExceedingInlineStorage_CopiedAndMoved)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("TAAT(CCG)*CCTT"));
+    string encoding = "0[3M]";
+    for (int unitIndex = 0; unitIndex != 20; ++unitIndex)
+    {
+        encoding += "1[3M]";
+    }
+    encoding += "2[4M]";
+    const GraphAlignment alignment = decodeGraphAlignment(1, encoding, &graph);
+
+    CompactGraphAlignment compactAlignment(alignment);
+    CompactGraphAlignment copiedAlignment(compactAlignment);
+    EXPECT_EQ(compactAlignment, copiedAlignment);
+
+    CompactGraphAlignment movedAlignment(std::move(copiedAlignment));
+    EXPECT_EQ(compactAlignment, movedAlignment);
+    EXPECT_EQ(alignment, movedAlignment.expand());
+}
@@ -77,7 +77,7 @@ TEST(CalculatingNumberOfNonRepeatMatchesAroundNode, TypicalAlignment_Calculated)
 {
     Graph graph = makeRegionGraph(decodeFeaturesFromRegex("TAAT(CAG)*CAACAG(CCG)*CCTT"));
 
-    const GraphAlignment alignment = decodeGraphAlignment(1, "0[3M]1[1M1I2M]1[3M]2[6M]3[3M]3[3M]4[4M]", &graph);
+    const CompactGraphAlignment alignment(decodeGraphAlignment(1, "0[3M]1[1M1I2M]1[3M]2[6M]3[3M]3[3M]4[4M]", &graph));
 
     EXPECT_EQ(15, getNumNonrepeatMatchesUpstream(3, alignment));
     EXPECT_EQ(0, getNumNonrepeatMatchesUpstream(0, alignment));
@@ -89,7 +89,7 @@ TEST(CalculatingNumberOfNonRepeatMatchesAroundNode, AlignmentNotPassingThroughRe
 {
     Graph graph = makeRegionGraph(decodeFeaturesFromRegex("TAAT(CAG)*CAACAG(CCG)*CCTT"));
 
-    const GraphAlignment alignment = decodeGraphAlignment(1, "0[3M]1[1M1I2M]1[3M]", &graph);
+    const CompactGraphAlignment alignment(decodeGraphAlignment(1, "0[3M]1[1M1I2M]1[3M]", &graph));
 
     EXPECT_EQ(0, getNumNonrepeatMatchesUpstream(3, alignment));
     EXPECT_EQ(0, getNumNonrepeatMatchesDownstream(3, alignment));
@@ -102,27 +102,27 @@ TEST(StrOverlapQuantification, TypicalReads_StrOverlapComputed)
     const NodeId repeatNodeId = 1;
 
     {
-        GraphAlignment alignment = decodeGraphAlignment(0, "0[4M]", &graph);
+        const CompactGraphAlignment alignment(decodeGraphAlignment(0, "0[4M]", &graph));
         ASSERT_EQ(0, countFullOverlaps(repeatNodeId, alignment));
     }
 
     {
-        GraphAlignment alignment = decodeGraphAlignment(2, "0[2M]1[3M]1[3M]2[2M]", &graph);
+        const CompactGraphAlignment alignment(decodeGraphAlignment(2, "0[2M]1[3M]1[3M]2[2M]", &graph));
         ASSERT_EQ(2, countFullOverlaps(repeatNodeId, alignment));
     }
 
     {
-        GraphAlignment alignment = decodeGraphAlignment(2, "0[2M]1[3M]1[3M]1[2M]", &graph);
+        const CompactGraphAlignment alignment(decodeGraphAlignment(2, "0[2M]1[3M]1[3M]1[2M]", &graph));
         ASSERT_EQ(2, countFullOverlaps(repeatNodeId, alignment));
     }
 
     {
-        GraphAlignment alignment = decodeGraphAlignment(0, "1[3M]1[3M]1[3M]1[2M]", &graph);
+        const CompactGraphAlignment alignment(decodeGraphAlignment(0, "1[3M]1[3M]1[3M]1[2M]", &graph));
         ASSERT_EQ(3, countFullOverlaps(repeatNodeId, alignment));
     }
 
     {
-        GraphAlignment alignment = decodeGraphAlignment(1, "1[1S2M]1[1M2D]1[3M]1[2M]", &graph);
+        const CompactGraphAlignment alignment(decodeGraphAlignment(1, "1[1S2M]1[1M2D]1[3M]1[2M]", &graph));
         ASSERT_EQ(2, countFullOverlaps(repeatNodeId, alignment));
     }
 }
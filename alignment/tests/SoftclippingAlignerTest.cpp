@@ -42,23 +42,21 @@ using std::string;
 
 using namespace ehunter;
 
-/*
 class AligningReads : public ::testing::TestWithParam<std::string>
 {
 };
 
-// TODO: Throw an error if there are no valid extensions?
 TEST_P(AligningReads, ReadFlankedByLowQualityBases_Aligned)
 {
-    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATCGATCG", "(CAG)CAACAG(CCG)", "GCTAGCTA"));
-    GraphAlignmentHeuristicsParameters alignmentHeuristicsParams(14, 2, 5);
-    SoftclippingAligner aligner(&graph, GetParam(), alignmentHeuristicsParams);
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATCGATCG(CAG)*CAACAG(CCG)*GCTAGCTA"));
+    const bool trimLowQualityBases = true;
+    SoftclippingAligner aligner(&graph, GetParam(), 14, 2, 5, 0, trimLowQualityBases);
 
     const string query = "gatcgCAgCAGCAACAGCCGCCGCCGCCGgcta";
     const list<GraphAlignment> alignments = aligner.align(query);
 
     const list<GraphAlignment> expectedAlignments
-        = { decodeGraphAlignment(6, "0[3S2M]1[3M]1[3M]2[6M]3[3M]3[3M]3[3M]3[1M6S]", &graph) };
+        = { decodeGraphAlignment(0, "1[5S3M]1[3M]2[6M]3[3M]3[3M]3[3M]3[3M4S]", &graph) };
     ASSERT_EQ(expectedAlignments, alignments);
 }
 
@@ -69,24 +67,87 @@ TEST_P(AligningReads, RealReadEndingInManyLowQualityBases_Aligned)
     const string rightFlank = "CCTCCTCAGCTTCCTCAGCCGCCGCCGCAGGCACAGCCGCTGCTGCCTCAGCCGCAGCCGCCCCCGCCGCCGCCCCCGCCGCCACCCG"
                               "GCCCGGCTGTGGCTGAGGAGCCGCTGCACCGACCGTGAGTTTGGGCC";
 
-    Graph graph = makeRegionGraph(decodeFeaturesFromRegex(leftFlank, "(CAG)CAACAG(CCG)", rightFlank));
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex(leftFlank + "(CAG)*CAACAG(CCG)*" + rightFlank));
 
-    GraphAlignmentHeuristicsParameters alignmentHeuristicsParams(14, 2, 5);
-    SoftclippingAligner aligner(&graph, GetParam(), alignmentHeuristicsParams);
+    const bool trimLowQualityBases = true;
+    SoftclippingAligner aligner(&graph, GetParam(), 14, 2, 5, 0, trimLowQualityBases);
 
     const string query = "CCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAACaGCCGCCACCGCCGCCGCCGCCGCCGCC"
                          "GCCtCCgCAGCCtCCtCaGCCGCCGCCGCCgcCgCaGCCGCcGCcgCCgCcgcCgcc";
 
     const list<GraphAlignment> alignments = aligner.align(query);
 
-    const list<GraphAlignment> expectedAlignments = { decodeGraphAlignment(
-        135,
-        "0[1M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]2[6M]"
-        "3[3M]3[2M1X]3[3M]3[3M]3[3M]3[3M]3[3M]3[3M]3[3M]4[5M1X4M1X17M28S]",
-        &graph) };
+    const string prefixEncoding
+        = "0[1M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]1[3M]2[6M]"
+          "3[3M]3[2M1X]3[3M]3[3M]3[3M]3[3M]3[3M]3[3M]3[3M]3[2M1X]3[3M]3[1M1X1M]3[2M1X]3[2M1X]3[1M1X1M]3[3M]3[3M]3[3M]"
+          "3[3M]3[3M]3[1M1X1M]3[3M]3[3M]3[3M]3[3M]";
+    const list<GraphAlignment> expectedAlignments
+        = { decodeGraphAlignment(135, prefixEncoding + "3[1M7S]", &graph),
+            decodeGraphAlignment(135, prefixEncoding + "4[1M7S]", &graph) };
     ASSERT_EQ(expectedAlignments, alignments);
 }
 
 INSTANTIATE_TEST_CASE_P(
     AlignerTestsInst, AligningReads, ::testing::Values(std::string("path-aligner"), std::string("dag-aligner")), );
-*/
\ No newline at end of file
+
+TEST(AligningReadsInTiers, PerfectlyMatchingRead_AlignedWithoutGaps)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGATTCGCAGGACTA(CAG)*ATGTCGATGTCGTTAC"));
+    SoftclippingAligner aligner(&graph, "dag-aligner", 14, 10, 5);
+    GappedGraphAligner gappedAligner(&graph, 14, 10, 5, "dag-aligner");
+
+    const string query = "GATTCGCAGGACTACAGCAGCAGATGTCGATGTC";
+    EXPECT_EQ(gappedAligner.align(query), aligner.align(query));
+    EXPECT_EQ(1, aligner.tierStats().numGaplessAlignedReads);
+    EXPECT_EQ(0, aligner.tierStats().numGappedAlignedReads);
+}
+
+TEST(AligningReadsInTiers, ReadWithDeletion_AlignedWithGaps)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGATTCGCAGGACTA(CAG)*ATGTCGATGTCGTTAC"));
+    SoftclippingAligner aligner(&graph, "dag-aligner", 14, 10, 5);
+    GappedGraphAligner gappedAligner(&graph, 14, 10, 5, "dag-aligner");
+
+    const string query = "GATTCGCAGGACTACAGCAGCAGATGTCATGTCGTTAC";
+    EXPECT_EQ(gappedAligner.align(query), aligner.align(query));
+    EXPECT_EQ(0, aligner.tierStats().numGaplessAlignedReads);
+    EXPECT_EQ(1, aligner.tierStats().numGappedAlignedReads);
+}
+
+TEST(AligningReadsInTiers, ReadWithMismatch_MismatchesAllowedInGaplessTier)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGATTCGCAGGACTA(CAG)*ATGTCGATGTCGTTAC"));
+    SoftclippingAligner strictAligner(&graph, "dag-aligner", 14, 10, 5);
+    SoftclippingAligner tolerantAligner(&graph, "dag-aligner", 14, 10, 5, 1);
+
+    const string query = "GATTCGCAGGACTACAGCAGCAGATGTCGTTGTCGTTAC";
+    strictAligner.align(query);
+    tolerantAligner.align(query);
+    EXPECT_EQ(0, strictAligner.tierStats().numGaplessAlignedReads);
+    EXPECT_EQ(1, tolerantAligner.tierStats().numGaplessAlignedReads);
+}
+
+TEST(AligningReadsInTiers, BatchOfReads_SameAlignmentsAsSingleReads)
+{
+    Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGATTCGCAGGACTA(CAG)*ATGTCGATGTCGTTAC"));
+    const bool trimLowQualityBases = true;
+    SoftclippingAligner batchAligner(&graph, "dag-aligner", 14, 10, 5, 0, trimLowQualityBases);
+    SoftclippingAligner aligner(&graph, "dag-aligner", 14, 10, 5, 0, trimLowQualityBases);
+
+    const std::vector<string> queries
+        = { "GATTCGCAGGACTACAGCAGCAGATGTCGATGTC", "GATTCGCAGGACTACAGCAGCAGATGTCATGTCGTTAC",
+            "gattCGCAGGACTACAGCAGCAGCAGATGTCGATgtc", "ATTCGCAGGACTACAGCAGCAGCAGCAGATGACGATGTCGTTac",
+            "CCCCCCCCCCCCCCCCCCCCC" };
+    const std::vector<list<GraphAlignment>> batchAlignments = batchAligner.alignBatch(queries);
+
+    ASSERT_EQ(queries.size(), batchAlignments.size());
+    for (std::size_t queryIndex = 0; queryIndex != queries.size(); ++queryIndex)
+    {
+        EXPECT_EQ(aligner.align(queries[queryIndex]), batchAlignments[queryIndex]) << queries[queryIndex];
+    }
+    EXPECT_EQ(aligner.tierStats().numGaplessAlignedReads, batchAligner.tierStats().numGaplessAlignedReads);
+    EXPECT_EQ(aligner.tierStats().numGappedAlignedReads, batchAligner.tierStats().numGappedAlignedReads);
+    // pieces of the read with a deletion are short enough for 8-bit scores
+    EXPECT_LT(0ul, batchAligner.scorePrecisionStats().narrowPieces);
+    EXPECT_EQ(0ul, aligner.scorePrecisionStats().narrowPieces);
+}
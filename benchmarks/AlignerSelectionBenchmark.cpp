@@ -0,0 +1,97 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the alignment of simulated reads to the graphs of typical loci with each gapped aligner. The label of each
+// benchmark shows the aligner picked for the locus by "--aligner auto", so that the choice can be checked against the
+// measured times
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "alignment/AlignerSelection.hh"
+#include "alignment/SoftclippingAligner.hh"
+#include "benchmarks/BenchmarkLoci.hh"
+
+using graphtools::Graph;
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+struct TypicalLocus
+{
+    string name;
+    string structure;
+};
+
+// Locus structures modeled after the catalog entries of these genes
+const vector<TypicalLocus> kLoci = { { "FMR1", "(CGG)*" },
+                                       { "C9ORF72", "(GGCCCC)*" },
+                                       { "HTT", "(CAG)*CAACAG(CCG)*" },
+                                       { "ATXN8OS", "(CTA)*(CTG)*" },
+                                       { "CNBP", "(CAGG)*(CAGA)*(CA)*" },
+                                       { "Swap", "(C|T)" },
+                                       { "TwoSwaps", "(C|T)GATTACA(G|A)" } };
+
+const int kFlankLength = 500;
+const int kReadLength = 150;
+const size_t kNumReads = 100;
+
+void alignReads(benchmark::State& state, const TypicalLocus& locus, const string& alignerName)
+{
+    const Graph graph = makeBenchmarkGraph(locus.structure, kFlankLength);
+    const vector<string> reads = simulateReads(graph, kFlankLength, kReadLength, kNumReads);
+
+    SoftclippingAligner aligner(&graph, alignerName, 14, 10, 5);
+    for (auto _ : state)
+    {
+        for (const string& read : reads)
+        {
+            benchmark::DoNotOptimize(aligner.align(read));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * reads.size());
+    state.SetLabel("auto: " + selectAligner(graph));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    for (const TypicalLocus& locus : kLoci)
+    {
+        for (const string alignerName : { "path-aligner", "dag-aligner" })
+        {
+            benchmark::RegisterBenchmark(
+                ("BM_AlignReads/" + locus.name + "/" + alignerName).c_str(), alignReads, locus, alignerName)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,196 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "benchmarks/BenchmarkLoci.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#include "thirdparty/json/json.hpp"
+
+#include "input/GraphBlueprint.hh"
+#include "input/RegionGraph.hh"
+
+using graphtools::Graph;
+using graphtools::NodeId;
+using Json = nlohmann::json;
+using std::string;
+using std::vector;
+
+namespace ehunter
+{
+
+// Catalog fields hold a single value for loci with one variant and an array otherwise
+static vector<string> decodeStringOrArray(const Json& record)
+{
+    if (record.is_array())
+    {
+        return record.get<vector<string>>();
+    }
+    return { record.get<string>() };
+}
+
+static bool checkIfLoopNode(const Graph& graph, NodeId nodeId)
+{
+    const auto& successors = graph.successors(nodeId);
+    return successors.find(nodeId) != successors.end();
+}
+
+vector<BenchmarkLocus> loadBenchmarkLoci(int flankLength)
+{
+    const char* catalogPathOverride = std::getenv("EH_BENCHMARK_CATALOG");
+    return loadBenchmarkLoci(catalogPathOverride ? catalogPathOverride : BENCHMARK_CATALOG_PATH, flankLength);
+}
+
+vector<BenchmarkLocus> loadBenchmarkLoci(const string& catalogPath, int flankLength)
+{
+    std::ifstream catalogFile(catalogPath);
+    if (!catalogFile.is_open())
+    {
+        throw std::runtime_error("Failed to open catalog " + catalogPath);
+    }
+
+    Json catalogRecords;
+    catalogFile >> catalogRecords;
+
+    vector<BenchmarkLocus> loci;
+    for (const auto& record : catalogRecords)
+    {
+        BenchmarkLocus locus;
+        locus.locusId = record["LocusId"].get<string>();
+        locus.structure = record["LocusStructure"].get<string>();
+        for (const string& encoding : decodeStringOrArray(record["ReferenceRegion"]))
+        {
+            locus.variantRegions.emplace_back(encoding);
+        }
+        for (const string& encoding : decodeStringOrArray(record["VariantType"]))
+        {
+            locus.variantSubtypes.push_back(
+                encoding == "RareRepeat" ? VariantSubtype::kRareRepeat : VariantSubtype::kCommonRepeat);
+        }
+        locus.graph = makeBenchmarkGraph(locus.structure, flankLength);
+        loci.push_back(std::move(locus));
+    }
+
+    return loci;
+}
+
+Graph makeBenchmarkGraph(const string& structure, int flankLength)
+{
+    // Flanks are seeded by the structure so that each locus gets the same graph in every benchmark
+    std::mt19937 generator(std::hash<string>()(structure));
+    const string leftFlank = generateSequence(generator, flankLength);
+    const string rightFlank = generateSequence(generator, flankLength);
+    return makeRegionGraph(decodeFeaturesFromRegex(leftFlank + structure + rightFlank));
+}
+
+LocusSpecification makeLocusSpecification(const BenchmarkLocus& locus, int flankLength)
+{
+    const Region& firstRegion = locus.variantRegions.front();
+    const Region& lastRegion = locus.variantRegions.back();
+    const Region locusRegion(firstRegion.chrom(), firstRegion.start() - flankLength, lastRegion.end() + flankLength);
+    LocusSpecification locusSpec(locus.locusId, { locusRegion }, AlleleCount::kTwo, locus.graph);
+
+    size_t variantIndex = 0;
+    for (NodeId nodeId = 0; nodeId != static_cast<NodeId>(locus.graph.numNodes()); ++nodeId)
+    {
+        if (checkIfLoopNode(locus.graph, nodeId) && variantIndex != locus.variantRegions.size())
+        {
+            const VariantClassification classification(VariantType::kRepeat, locus.variantSubtypes[variantIndex]);
+            locusSpec.addVariantSpecification(
+                locus.locusId + "_" + std::to_string(variantIndex), classification,
+                locus.variantRegions[variantIndex], { nodeId }, boost::none);
+            ++variantIndex;
+        }
+    }
+
+    return locusSpec;
+}
+
+string generateSequence(std::mt19937& generator, int length)
+{
+    const string bases = "ACGT";
+    std::uniform_int_distribution<int> baseDistribution(0, 3);
+    string sequence;
+    for (int index = 0; index != length; ++index)
+    {
+        sequence += bases[baseDistribution(generator)];
+    }
+    return sequence;
+}
+
+string generateHaplotype(std::mt19937& generator, const Graph& graph)
+{
+    std::uniform_int_distribution<int> repeatUnitCount(5, 30);
+    string haplotype;
+    NodeId nodeId = 0;
+    while (true)
+    {
+        for (int count = checkIfLoopNode(graph, nodeId) ? repeatUnitCount(generator) : 1; count; --count)
+        {
+            haplotype += graph.nodeSeq(nodeId);
+        }
+
+        vector<NodeId> nextNodeIds;
+        for (NodeId successor : graph.successors(nodeId))
+        {
+            if (successor != nodeId)
+            {
+                nextNodeIds.push_back(successor);
+            }
+        }
+        if (nextNodeIds.empty())
+        {
+            return haplotype;
+        }
+        std::uniform_int_distribution<size_t> nextNode(0, nextNodeIds.size() - 1);
+        nodeId = nextNodeIds[nextNode(generator)];
+    }
+}
+
+vector<string> simulateReads(const Graph& graph, int flankLength, int readLength, size_t numReads, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    vector<string> reads;
+    while (reads.size() != numReads)
+    {
+        const string haplotype = generateHaplotype(generator, graph);
+        const int firstStart = std::max(flankLength - readLength + 20, 0);
+        const int lastStart = std::max<int>(haplotype.length() - flankLength - 20, firstStart);
+        std::uniform_int_distribution<int> readStart(firstStart, lastStart);
+        string read = haplotype.substr(readStart(generator), readLength);
+
+        std::uniform_int_distribution<int> position(0, 99);
+        for (char& base : read)
+        {
+            if (position(generator) == 0)
+            {
+                base = base == 'A' ? 'C' : 'A';
+            }
+        }
+        reads.push_back(read);
+    }
+
+    return reads;
+}
+
+}
@@ -0,0 +1,68 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Inputs shared by the benchmarks: loci of the variant catalog bundled with the program and reads simulated from them
+
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graphcore/Graph.hh"
+
+#include "common/GenomicRegion.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Catalog locus whose graph has flanks of random sequence in place of the reference sequence
+struct BenchmarkLocus
+{
+    std::string locusId;
+    std::string structure;
+    std::vector<Region> variantRegions;
+    std::vector<VariantSubtype> variantSubtypes;
+    graphtools::Graph graph;
+};
+
+// Loads the loci of the bundled hg38 catalog; the path can be overridden with the EH_BENCHMARK_CATALOG variable
+std::vector<BenchmarkLocus> loadBenchmarkLoci(int flankLength = 500);
+
+// Loads the loci of the given catalog
+std::vector<BenchmarkLocus> loadBenchmarkLoci(const std::string& catalogPath, int flankLength);
+
+// Graph of the given structure with flanks of random sequence
+graphtools::Graph makeBenchmarkGraph(const std::string& structure, int flankLength = 500);
+
+// Specification of a catalog locus with one variant for each repeat of its structure
+LocusSpecification makeLocusSpecification(const BenchmarkLocus& locus, int flankLength = 500);
+
+std::string generateSequence(std::mt19937& generator, int length);
+
+// Spells a random path through the graph from the first to the last node with 5 to 30 iterations of each loop
+std::string generateHaplotype(std::mt19937& generator, const graphtools::Graph& graph);
+
+// Reads overlapping the variant region of a graph built with the given flank length with 1% of bases substituted
+std::vector<std::string>
+simulateReads(const graphtools::Graph& graph, int flankLength, int readLength, size_t numReads, unsigned seed = 42);
+
+}
@@ -0,0 +1,102 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the assignment of read pairs to the loci of the bundled catalog by kmers; nearly all reads screened in practice
+// come from elsewhere in the genome and are rejected by the Bloom filter
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "filtering/CatalogKmerFilter.hh"
+
+#include "benchmarks/BenchmarkLoci.hh"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kFlankLength = 1500;
+const int kReadLength = 150;
+
+RegionCatalog makeBenchmarkCatalog()
+{
+    RegionCatalog catalog;
+    for (const BenchmarkLocus& locus : loadBenchmarkLoci(kFlankLength))
+    {
+        catalog.emplace(locus.locusId, makeLocusSpecification(locus, kFlankLength));
+    }
+    return catalog;
+}
+
+void assignUnrelatedPairs(benchmark::State& state)
+{
+    const CatalogKmerFilter kmerFilter(makeBenchmarkCatalog(), 2 * kReadLength);
+    std::mt19937 generator(42);
+    vector<string> reads;
+    for (int readIndex = 0; readIndex != 1000; ++readIndex)
+    {
+        reads.push_back(generateSequence(generator, kReadLength));
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t readIndex = 0; readIndex + 1 < reads.size(); readIndex += 2)
+        {
+            benchmark::DoNotOptimize(kmerFilter.assignPair(reads[readIndex], reads[readIndex + 1]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+void assignLocusPairs(benchmark::State& state)
+{
+    const RegionCatalog catalog = makeBenchmarkCatalog();
+    const CatalogKmerFilter kmerFilter(catalog, 2 * kReadLength);
+    vector<string> reads;
+    for (const auto& locusIdAndLocusSpec : catalog)
+    {
+        const vector<string> locusReads
+            = simulateReads(locusIdAndLocusSpec.second.regionGraph(), kFlankLength, kReadLength, 20);
+        reads.insert(reads.end(), locusReads.begin(), locusReads.end());
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t readIndex = 0; readIndex + 1 < reads.size(); readIndex += 2)
+        {
+            benchmark::DoNotOptimize(kmerFilter.assignPair(reads[readIndex], reads[readIndex + 1]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+}
+
+BENCHMARK(assignUnrelatedPairs)->Unit(benchmark::kMicrosecond);
+BENCHMARK(assignLocusPairs)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,139 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the decoding of BAM records of reads simulated from the loci of the bundled catalog. The records are built in
+// memory in the layout used by htslib, so no BAM file is needed
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmarks/BenchmarkLoci.hh"
+#include "reads/Read.hh"
+#include "sample_analysis/HtsHelpers.hh"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kFlankLength = 500;
+const int kReadLength = 150;
+const size_t kNumReadsPerLocus = 40;
+
+// Name, single match operation, 4-bit encoded bases, and base qualities of a mapped read
+vector<uint8_t> encodeRecordData(const string& name, const string& bases, std::mt19937& generator)
+{
+    vector<uint8_t> data(name.begin(), name.end());
+    // The name is padded with nulls so that the cigar operations are aligned to 4 bytes
+    data.resize(name.length() + 4 - name.length() % 4, 0);
+
+    const uint32_t cigarOperation = bases.length() << BAM_CIGAR_SHIFT | BAM_CMATCH;
+    const uint8_t* cigarBytes = reinterpret_cast<const uint8_t*>(&cigarOperation);
+    data.insert(data.end(), cigarBytes, cigarBytes + sizeof(cigarOperation));
+
+    for (size_t index = 0; index < bases.length(); index += 2)
+    {
+        const uint8_t firstCode = std::strchr(seq_nt16_str, bases[index]) - seq_nt16_str;
+        const uint8_t secondCode
+            = index + 1 < bases.length() ? std::strchr(seq_nt16_str, bases[index + 1]) - seq_nt16_str : 0;
+        data.push_back(firstCode << 4 | secondCode);
+    }
+
+    // A tenth of the bases have qualities below the cutoff for good base calls
+    std::uniform_int_distribution<int> quality(0, 40);
+    for (size_t index = 0; index != bases.length(); ++index)
+    {
+        data.push_back(quality(generator));
+    }
+
+    return data;
+}
+
+struct BenchmarkRecords
+{
+    vector<vector<uint8_t>> data;
+    vector<bam1_t> records;
+};
+
+BenchmarkRecords makeRecords(const vector<BenchmarkLocus>& loci)
+{
+    std::mt19937 generator(42);
+    BenchmarkRecords records;
+    for (const BenchmarkLocus& locus : loci)
+    {
+        for (const string& bases : simulateReads(locus.graph, kFlankLength, kReadLength, kNumReadsPerLocus))
+        {
+            const string name = locus.locusId + ":read" + std::to_string(records.data.size());
+            records.data.push_back(encodeRecordData(name, bases, generator));
+
+            bam1_t record = bam1_t();
+            record.core.tid = 0;
+            record.core.pos = locus.variantRegions.front().start() - kReadLength / 2;
+            record.core.qual = 60;
+            record.core.l_qname = name.length() + 4 - name.length() % 4;
+            record.core.flag = BAM_FPAIRED | BAM_FPROPER_PAIR | (records.data.size() % 2 ? BAM_FREAD1 : BAM_FREAD2);
+            record.core.n_cigar = 1;
+            record.core.l_qseq = bases.length();
+            record.core.mtid = 0;
+            record.core.mpos = record.core.pos + 200;
+            records.records.push_back(record);
+        }
+    }
+
+    // Data buffers are not moved once all records are created
+    for (size_t index = 0; index != records.records.size(); ++index)
+    {
+        records.records[index].data = records.data[index].data();
+        records.records[index].l_data = records.data[index].size();
+        records.records[index].m_data = records.data[index].size();
+    }
+
+    return records;
+}
+
+void decodeAlignedReads(benchmark::State& state)
+{
+    BenchmarkRecords records = makeRecords(loadBenchmarkLoci(kFlankLength));
+    reads::Read read;
+    reads::LinearAlignmentStats alignmentStats;
+    for (auto _ : state)
+    {
+        for (bam1_t& record : records.records)
+        {
+            htshelpers::DecodeAlignedRead(&record, read, alignmentStats);
+            benchmark::DoNotOptimize(read.sequence.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * records.records.size());
+}
+
+}
+
+BENCHMARK(decodeAlignedReads)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
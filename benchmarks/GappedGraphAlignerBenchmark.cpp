@@ -0,0 +1,77 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the gapped alignment of reads simulated from the loci of the bundled catalog with each aligner. Unlike the
+// aligner selection benchmark, reads are aligned without first trying the gapless aligner
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "graphalign/GappedAligner.hh"
+
+#include "benchmarks/BenchmarkLoci.hh"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kFlankLength = 500;
+const int kReadLength = 150;
+const size_t kNumReads = 100;
+
+void alignReads(benchmark::State& state, const BenchmarkLocus& locus, const string& alignerName)
+{
+    const graphtools::GappedGraphAligner aligner(&locus.graph, 14, 10, 5, alignerName);
+    const vector<string> reads = simulateReads(locus.graph, kFlankLength, kReadLength, kNumReads);
+    for (auto _ : state)
+    {
+        for (const string& read : reads)
+        {
+            benchmark::DoNotOptimize(aligner.align(read));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const vector<BenchmarkLocus> loci = loadBenchmarkLoci(kFlankLength);
+    for (const BenchmarkLocus& locus : loci)
+    {
+        for (const string alignerName : { "path-aligner", "dag-aligner" })
+        {
+            benchmark::RegisterBenchmark(
+                ("BM_GappedAlignment/" + locus.locusId + "/" + alignerName).c_str(), alignReads, locus, alignerName)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
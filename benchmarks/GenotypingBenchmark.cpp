@@ -0,0 +1,132 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times two-allele genotyping of short repeats and length estimation of long repeats at the loci of the bundled
+// catalog. Read counts are simulated for a heterozygous sample with one reference allele and one expanded allele
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmarks/BenchmarkLoci.hh"
+#include "common/CountTable.hh"
+#include "genotyping/RepeatLength.hh"
+#include "genotyping/ShortRepeatGenotyper.hh"
+
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kReadLength = 150;
+const double kHaplotypeDepth = 15.0;
+const double kPropCorrectMolecules = 0.97;
+
+struct RepeatReadCounts
+{
+    int32_t repeatUnitLength;
+    int32_t maxNumUnitsInRead;
+    CountTable countsOfSpanningReads;
+    CountTable countsOfFlankingReads;
+    vector<int32_t> candidateAlleleSizes;
+};
+
+// Counts of spanning and flanking reads for the first repeat of a locus with the reference allele and an allele
+// longer by a third of the read length, with stutter of one unit around each allele
+RepeatReadCounts simulateReadCounts(const BenchmarkLocus& locus, std::mt19937& generator)
+{
+    const Region& repeatRegion = locus.variantRegions.front();
+    const int32_t repeatUnitLength = locus.structure.find(')') - locus.structure.find('(') - 1;
+    const int32_t maxNumUnitsInRead = (kReadLength + repeatUnitLength - 1) / repeatUnitLength;
+    const int32_t refAlleleSize = repeatRegion.length() / repeatUnitLength;
+    const int32_t altAlleleSize = std::min(refAlleleSize + maxNumUnitsInRead / 3, maxNumUnitsInRead);
+
+    std::poisson_distribution<int32_t> readCount(kHaplotypeDepth / 3);
+    std::map<int32_t, int32_t> spanningCounts;
+    std::map<int32_t, int32_t> flankingCounts;
+    for (const int32_t alleleSize : { refAlleleSize, altAlleleSize })
+    {
+        for (int32_t stutter = -1; stutter <= 1; ++stutter)
+        {
+            const int32_t spanningSize = std::min(std::max(alleleSize + stutter, 0), maxNumUnitsInRead);
+            spanningCounts[spanningSize] += readCount(generator) / (stutter ? 4 : 1);
+        }
+        for (int32_t flankingSize = 0; flankingSize <= alleleSize; flankingSize += 2)
+        {
+            flankingCounts[flankingSize] += readCount(generator) / 4;
+        }
+    }
+
+    RepeatReadCounts counts{ repeatUnitLength, maxNumUnitsInRead, CountTable(spanningCounts),
+                             CountTable(flankingCounts), {} };
+    counts.candidateAlleleSizes = counts.countsOfSpanningReads.getElementsWithNonzeroCounts();
+    return counts;
+}
+
+void genotypeShortRepeats(benchmark::State& state)
+{
+    std::mt19937 generator(42);
+    vector<RepeatReadCounts> lociCounts;
+    for (const BenchmarkLocus& locus : loadBenchmarkLoci())
+    {
+        lociCounts.push_back(simulateReadCounts(locus, generator));
+    }
+
+    for (auto _ : state)
+    {
+        for (const RepeatReadCounts& counts : lociCounts)
+        {
+            const ShortRepeatGenotyper genotyper(
+                counts.repeatUnitLength, counts.maxNumUnitsInRead, kPropCorrectMolecules);
+            benchmark::DoNotOptimize(genotyper.genotypeRepeatWithTwoAlleles(
+                counts.countsOfFlankingReads, counts.countsOfSpanningReads, counts.candidateAlleleSizes));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lociCounts.size());
+}
+
+void estimateRepeatLengths(benchmark::State& state)
+{
+    const int32_t numIrrs = state.range(0);
+    for (auto _ : state)
+    {
+        int32_t lengthEstimate = 0;
+        int32_t lowerBound = 0;
+        int32_t upperBound = 0;
+        estimateRepeatLen(numIrrs, kReadLength, kHaplotypeDepth, lengthEstimate, lowerBound, upperBound);
+        benchmark::DoNotOptimize(lengthEstimate);
+        benchmark::DoNotOptimize(lowerBound);
+        benchmark::DoNotOptimize(upperBound);
+    }
+}
+
+}
+
+BENCHMARK(genotypeShortRepeats)->Unit(benchmark::kMicrosecond);
+// Numbers of in-repeat reads of increasingly long expansions
+BENCHMARK(estimateRepeatLengths)->Arg(5)->Arg(50)->Arg(500)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
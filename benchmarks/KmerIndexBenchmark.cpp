@@ -0,0 +1,67 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the construction of the kmer indexes of the graphs of the loci of the bundled catalog; an index of each locus
+// graph is built for alignment and two more by the orientation predictor
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "graphalign/KmerIndex.hh"
+
+#include "benchmarks/BenchmarkLoci.hh"
+
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+// The flanks have the length used by the catalog loader and the kmers have the default length for alignment
+const int kFlankLength = 1500;
+const int kKmerLength = 14;
+
+void buildKmerIndex(benchmark::State& state, const BenchmarkLocus& locus)
+{
+    for (auto _ : state)
+    {
+        graphtools::KmerIndex kmerIndex(locus.graph, kKmerLength);
+        benchmark::DoNotOptimize(kmerIndex);
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const vector<BenchmarkLocus> loci = loadBenchmarkLoci(kFlankLength);
+    for (const BenchmarkLocus& locus : loci)
+    {
+        benchmark::RegisterBenchmark(("BM_BuildKmerIndex/" + locus.locusId).c_str(), buildKmerIndex, locus)
+            ->Unit(benchmark::kMillisecond);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
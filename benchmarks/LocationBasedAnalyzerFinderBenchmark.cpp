@@ -0,0 +1,111 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the lookup of the analyzers of the loci of the bundled catalog by positions of read pairs, as done for every
+// read of a streamed BAM/CRAM file. Most reads of a file are far from any locus, so most queries find nothing
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "benchmarks/BenchmarkLoci.hh"
+#include "output/AlignmentWriter.hh"
+#include "region_analysis/RegionAnalyzer.hh"
+#include "sample_analysis/LocationBasedAnalyzerFinder.hh"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kSearchRadius = 1000;
+const size_t kNumQueries = 10000;
+
+struct ReadPairPosition
+{
+    string readChrom;
+    int32_t readPosition;
+    string mateChrom;
+    int32_t matePosition;
+};
+
+// One read pair in ten is placed near a locus and the rest are placed uniformly on the chromosomes of the catalog
+vector<ReadPairPosition> simulatePositions(const vector<BenchmarkLocus>& loci)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> locusIndex(0, loci.size() - 1);
+    std::uniform_int_distribution<int32_t> offset(-kSearchRadius, kSearchRadius);
+    std::uniform_int_distribution<int32_t> position(0, 150000000);
+    std::uniform_int_distribution<int> pairType(0, 9);
+
+    vector<ReadPairPosition> positions;
+    while (positions.size() != kNumQueries)
+    {
+        const Region& region = loci[locusIndex(generator)].variantRegions.front();
+        const int32_t readPosition
+            = pairType(generator) == 0 ? region.start() + offset(generator) : position(generator);
+        positions.push_back({ region.chrom(), readPosition, region.chrom(), readPosition + 300 });
+    }
+    return positions;
+}
+
+void findAnalyzers(benchmark::State& state)
+{
+    const vector<BenchmarkLocus> loci = loadBenchmarkLoci();
+    vector<LocusSpecification> locusSpecs;
+    for (const BenchmarkLocus& locus : loci)
+    {
+        locusSpecs.push_back(makeLocusSpecification(locus));
+    }
+
+    const SampleParameters sampleParams("sample", Sex::kFemale, 150, 15.0);
+    const HeuristicParameters heuristicParams(false, kSearchRadius, 20, true, "dag-aligner");
+    CompositeAlignmentWriter alignmentWriter;
+    vector<std::unique_ptr<RegionAnalyzer>> analyzers;
+    for (const LocusSpecification& locusSpec : locusSpecs)
+    {
+        analyzers.emplace_back(new RegionAnalyzer(locusSpec, sampleParams, heuristicParams, alignmentWriter));
+    }
+
+    LocationBasedAnalyzerFinder finder(analyzers, kSearchRadius);
+    const vector<ReadPairPosition> positions = simulatePositions(loci);
+    for (auto _ : state)
+    {
+        for (const ReadPairPosition& pair : positions)
+        {
+            benchmark::DoNotOptimize(
+                finder.query(pair.readChrom, pair.readPosition, pair.mateChrom, pair.matePosition));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+}
+
+BENCHMARK(findAnalyzers)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times orientation prediction of reads simulated from the loci of the bundled catalog. A quarter of the reads are
+// reverse-complemented and another quarter are random sequences that do not align to the locus
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "graphutils/SequenceOperations.hh"
+
+#include "benchmarks/BenchmarkLoci.hh"
+#include "filtering/OrientationPredictor.hh"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kFlankLength = 500;
+const int kReadLength = 150;
+const size_t kNumReads = 400;
+
+vector<string> simulateReadsOfEachOrientation(const BenchmarkLocus& locus)
+{
+    vector<string> reads = simulateReads(locus.graph, kFlankLength, kReadLength, kNumReads);
+    std::mt19937 generator(7);
+    for (size_t readIndex = 0; readIndex != reads.size(); ++readIndex)
+    {
+        if (readIndex % 4 == 1)
+        {
+            reads[readIndex] = graphtools::reverseComplement(reads[readIndex]);
+        }
+        else if (readIndex % 4 == 3)
+        {
+            reads[readIndex] = generateSequence(generator, kReadLength);
+        }
+    }
+    return reads;
+}
+
+void predictOrientation(benchmark::State& state, const BenchmarkLocus& locus)
+{
+    const OrientationPredictor predictor(kReadLength, &locus.graph);
+    const vector<string> reads = simulateReadsOfEachOrientation(locus);
+    for (auto _ : state)
+    {
+        for (const string& read : reads)
+        {
+            benchmark::DoNotOptimize(predictor.predict(read));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const vector<BenchmarkLocus> loci = loadBenchmarkLoci(kFlankLength);
+    for (const BenchmarkLocus& locus : loci)
+    {
+        benchmark::RegisterBenchmark(("BM_PredictOrientation/" + locus.locusId).c_str(), predictOrientation, locus)
+            ->Unit(benchmark::kMicrosecond);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
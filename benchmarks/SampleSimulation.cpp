@@ -0,0 +1,395 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "benchmarks/SampleSimulation.hh"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+extern "C"
+{
+#include "htslib/sam.h"
+}
+
+using graphtools::Graph;
+using graphtools::NodeId;
+using Json = nlohmann::json;
+using std::string;
+using std::vector;
+
+namespace ehunter
+{
+
+namespace
+{
+
+const string kOfftargetContigName = "chrOfftarget";
+const int kOfftargetRegionLength = 1000;
+const int kMapq = 60;
+
+// Sequence of a node of the locus graph and the number of its copies in the reference allele
+struct LocusSegment
+{
+    string sequence;
+    int referenceCount;
+    bool isRepeat;
+};
+
+// Coordinates of a locus on the reference and on one of the haplotypes of its contig
+struct LocusPlacement
+{
+    int64_t referenceStart;
+    int64_t referenceEnd;
+    int64_t haplotypeStart;
+    int64_t haplotypeEnd;
+    // Start of the off-target region of a rare repeat or -1 for other loci
+    int64_t offtargetStart;
+};
+
+struct Haplotype
+{
+    int contigIndex;
+    string sequence;
+    vector<LocusPlacement> loci;
+};
+
+bool checkIfLoopNode(const Graph& graph, NodeId nodeId)
+{
+    const auto& successors = graph.successors(nodeId);
+    return successors.find(nodeId) != successors.end();
+}
+
+// Only loci whose graph is a chain of nodes in which edges can skip repeats, the structure of all loci of the bundled
+// catalogs, can be placed on a reference
+vector<LocusSegment> spellLocusSegments(std::mt19937& generator, const BenchmarkLocus& locus)
+{
+    const Graph& graph = locus.graph;
+    for (NodeId nodeId = 0; nodeId != static_cast<NodeId>(graph.numNodes()); ++nodeId)
+    {
+        for (NodeId successor : graph.successors(nodeId))
+        {
+            for (NodeId skippedNodeId = nodeId + 1; skippedNodeId < successor; ++skippedNodeId)
+            {
+                if (!checkIfLoopNode(graph, skippedNodeId))
+                {
+                    throw std::invalid_argument("Simulation of locus " + locus.locusId + " is not supported");
+                }
+            }
+            if (successor < nodeId)
+            {
+                throw std::invalid_argument("Simulation of locus " + locus.locusId + " is not supported");
+            }
+        }
+    }
+
+    vector<LocusSegment> segments;
+    size_t repeatIndex = 0;
+    for (NodeId nodeId = 1; nodeId + 1 < static_cast<NodeId>(graph.numNodes()); ++nodeId)
+    {
+        // Degenerate bases are replaced by one of the sequences that they match
+        const vector<string>& expansions = graph.nodeSeqExpansion(nodeId);
+        std::uniform_int_distribution<size_t> expansionIndex(0, expansions.size() - 1);
+        LocusSegment segment{ expansions[expansionIndex(generator)], 1, false };
+
+        if (checkIfLoopNode(graph, nodeId))
+        {
+            if (repeatIndex == locus.variantRegions.size())
+            {
+                throw std::invalid_argument("Locus " + locus.locusId + " has more repeats than reference regions");
+            }
+            const Region& region = locus.variantRegions[repeatIndex++];
+            segment.referenceCount = (region.end() - region.start()) / segment.sequence.length();
+            segment.isRepeat = true;
+        }
+        segments.push_back(segment);
+    }
+
+    return segments;
+}
+
+string spellAllele(const vector<LocusSegment>& segments, int expandedUnitCount)
+{
+    string allele;
+    bool isFirstRepeat = true;
+    for (const LocusSegment& segment : segments)
+    {
+        int count = segment.referenceCount;
+        if (segment.isRepeat && isFirstRepeat)
+        {
+            count = expandedUnitCount != -1 ? expandedUnitCount : count;
+            isFirstRepeat = false;
+        }
+        for (int index = 0; index != count; ++index)
+        {
+            allele += segment.sequence;
+        }
+    }
+    return allele;
+}
+
+Json encodeStringOrArray(const vector<string>& values)
+{
+    if (values.size() == 1)
+    {
+        return values.front();
+    }
+    return values;
+}
+
+string encodeRegion(const string& contigName, int64_t start, int64_t end)
+{
+    return contigName + ":" + std::to_string(start) + "-" + std::to_string(end);
+}
+
+int64_t mapToReference(const Haplotype& haplotype, int64_t position)
+{
+    const LocusPlacement* precedingLocus = nullptr;
+    for (const LocusPlacement& locus : haplotype.loci)
+    {
+        if (locus.haplotypeStart > position)
+        {
+            break;
+        }
+        precedingLocus = &locus;
+    }
+
+    if (precedingLocus == nullptr)
+    {
+        return position;
+    }
+    if (position < precedingLocus->haplotypeEnd)
+    {
+        // Bases of an expanded allele that are missing from the reference map to its last base
+        const int64_t offset = position - precedingLocus->haplotypeStart;
+        return precedingLocus->referenceStart
+            + std::min(offset, precedingLocus->referenceEnd - precedingLocus->referenceStart - 1);
+    }
+    return position - precedingLocus->haplotypeEnd + precedingLocus->referenceEnd;
+}
+
+void introduceErrors(std::mt19937& generator, double errorRate, string& bases)
+{
+    std::bernoulli_distribution isError(errorRate);
+    std::uniform_int_distribution<int> baseShift(1, 3);
+    const string kBases = "ACGT";
+    for (char& base : bases)
+    {
+        if (isError(generator))
+        {
+            const size_t baseIndex = kBases.find(base) == string::npos ? 0 : kBases.find(base);
+            base = kBases[(baseIndex + baseShift(generator)) % 4];
+        }
+    }
+}
+
+// Sequences fragments from the haplotype; a fragment fully contained in a rare repeat is placed into its off-target
+// region with the given probability, as reads from long expansions are often misaligned by read mappers
+void sequenceHaplotype(
+    std::mt19937& generator, const SimulationParameters& parameters, const Haplotype& haplotype,
+    int offtargetContigIndex, vector<SimulatedRead>& reads)
+{
+    const int readLength = parameters.readLength;
+    const int64_t haplotypeLength = haplotype.sequence.length();
+    const auto numFragments
+        = static_cast<int64_t>(parameters.depth * haplotypeLength / (4.0 * parameters.readLength) + 0.5);
+
+    std::normal_distribution<double> fragmentLengthDistribution(
+        parameters.meanFragmentLength, parameters.meanFragmentLength / 10.0);
+    std::bernoulli_distribution isReverseFragment(0.5);
+    std::bernoulli_distribution isPlacedOfftarget(parameters.offtargetIrrFraction);
+
+    for (int64_t fragmentIndex = 0; fragmentIndex != numFragments; ++fragmentIndex)
+    {
+        const int64_t maxFragmentLength = std::max<int64_t>(haplotypeLength, readLength);
+        const int64_t fragmentLength = std::min(
+            maxFragmentLength, std::max<int64_t>(readLength, std::llround(fragmentLengthDistribution(generator))));
+        std::uniform_int_distribution<int64_t> fragmentStartDistribution(0, haplotypeLength - fragmentLength);
+        const int64_t fragmentStart = fragmentStartDistribution(generator);
+        const int64_t fragmentEnd = fragmentStart + fragmentLength;
+
+        SimulatedRead leftRead;
+        SimulatedRead rightRead;
+        leftRead.name = rightRead.name = "sim" + std::to_string(reads.size() / 2);
+        leftRead.bases = haplotype.sequence.substr(fragmentStart, readLength);
+        rightRead.bases = haplotype.sequence.substr(fragmentEnd - readLength, readLength);
+        introduceErrors(generator, parameters.errorRate, leftRead.bases);
+        introduceErrors(generator, parameters.errorRate, rightRead.bases);
+
+        leftRead.contigIndex = rightRead.contigIndex = haplotype.contigIndex;
+        leftRead.mapq = rightRead.mapq = kMapq;
+        leftRead.position = mapToReference(haplotype, fragmentStart);
+        rightRead.position = mapToReference(haplotype, fragmentEnd - readLength);
+
+        for (const LocusPlacement& locus : haplotype.loci)
+        {
+            const bool isInRepeat = locus.haplotypeStart <= fragmentStart && fragmentEnd <= locus.haplotypeEnd;
+            if (locus.offtargetStart != -1 && isInRepeat && isPlacedOfftarget(generator))
+            {
+                const int64_t offtargetLength = std::max<int64_t>(kOfftargetRegionLength - fragmentLength, 0);
+                std::uniform_int_distribution<int64_t> offsetDistribution(0, offtargetLength);
+                leftRead.contigIndex = rightRead.contigIndex = offtargetContigIndex;
+                leftRead.mapq = rightRead.mapq = 0;
+                leftRead.position = locus.offtargetStart + offsetDistribution(generator);
+                rightRead.position = leftRead.position + fragmentLength - readLength;
+            }
+        }
+
+        const bool isReverse = isReverseFragment(generator);
+        leftRead.flag = BAM_FPAIRED | BAM_FPROPER_PAIR | BAM_FMREVERSE
+            | (isReverse ? BAM_FREAD2 : BAM_FREAD1);
+        rightRead.flag = BAM_FPAIRED | BAM_FPROPER_PAIR | BAM_FREVERSE
+            | (isReverse ? BAM_FREAD1 : BAM_FREAD2);
+        leftRead.matePosition = rightRead.position;
+        rightRead.matePosition = leftRead.position;
+        leftRead.templateLength = rightRead.position + readLength - leftRead.position;
+        rightRead.templateLength = -leftRead.templateLength;
+
+        reads.push_back(std::move(leftRead));
+        reads.push_back(std::move(rightRead));
+    }
+}
+
+}
+
+SimulatedSample simulateSample(const vector<BenchmarkLocus>& loci, const SimulationParameters& parameters)
+{
+    std::mt19937 generator(parameters.seed);
+    SimulatedSample sample;
+
+    // Loci are placed on one contig per chromosome in catalog order
+    vector<vector<const BenchmarkLocus*>> lociByContig;
+    bool hasRareRepeats = false;
+    for (const BenchmarkLocus& locus : loci)
+    {
+        const string& chrom = locus.variantRegions.front().chrom();
+        auto contigIt = std::find_if(
+            sample.contigs.begin(), sample.contigs.end(),
+            [&chrom](const SimulatedContig& contig) { return contig.name == chrom; });
+        if (contigIt == sample.contigs.end())
+        {
+            sample.contigs.push_back({ chrom, "" });
+            lociByContig.emplace_back();
+            contigIt = sample.contigs.end() - 1;
+        }
+        lociByContig[contigIt - sample.contigs.begin()].push_back(&locus);
+        const bool isRareRepeat = locus.variantSubtypes == vector<VariantSubtype>{ VariantSubtype::kRareRepeat };
+        hasRareRepeats = hasRareRepeats || isRareRepeat;
+    }
+
+    const int offtargetContigIndex = hasRareRepeats ? sample.contigs.size() : -1;
+    SimulatedContig offtargetContig{ kOfftargetContigName, generateSequence(generator, parameters.spacerLength) };
+
+    vector<Haplotype> haplotypes;
+    for (size_t contigIndex = 0; contigIndex != lociByContig.size(); ++contigIndex)
+    {
+        string& reference = sample.contigs[contigIndex].sequence;
+        Haplotype firstHaplotype{ static_cast<int>(contigIndex), "", {} };
+        Haplotype secondHaplotype{ static_cast<int>(contigIndex), "", {} };
+        for (const BenchmarkLocus* locusPtr : lociByContig[contigIndex])
+        {
+            const string spacer = generateSequence(generator, parameters.spacerLength);
+            reference += spacer;
+            firstHaplotype.sequence += spacer;
+            secondHaplotype.sequence += spacer;
+
+            const vector<LocusSegment> segments = spellLocusSegments(generator, *locusPtr);
+            const auto expansionIt = parameters.expansions.find(locusPtr->locusId);
+            const int expandedUnitCount = expansionIt != parameters.expansions.end() ? expansionIt->second : -1;
+            const string referenceAllele = spellAllele(segments, -1);
+            const string expandedAllele = spellAllele(segments, expandedUnitCount);
+
+            Json record;
+            record["LocusId"] = locusPtr->locusId;
+            record["LocusStructure"] = locusPtr->structure;
+            vector<string> referenceRegions;
+            int64_t segmentStart = reference.length();
+            for (const LocusSegment& segment : segments)
+            {
+                const int64_t segmentEnd = segmentStart + segment.sequence.length() * segment.referenceCount;
+                if (segment.isRepeat)
+                {
+                    const string& contigName = sample.contigs[contigIndex].name;
+                    referenceRegions.push_back(encodeRegion(contigName, segmentStart, segmentEnd));
+                }
+                segmentStart = segmentEnd;
+            }
+            record["ReferenceRegion"] = encodeStringOrArray(referenceRegions);
+            vector<string> variantTypes;
+            for (VariantSubtype subtype : locusPtr->variantSubtypes)
+            {
+                variantTypes.push_back(subtype == VariantSubtype::kRareRepeat ? "RareRepeat" : "Repeat");
+            }
+            record["VariantType"] = encodeStringOrArray(variantTypes);
+
+            LocusPlacement placement{ static_cast<int64_t>(reference.length()),
+                                      static_cast<int64_t>(reference.length() + referenceAllele.length()),
+                                      static_cast<int64_t>(firstHaplotype.sequence.length()),
+                                      static_cast<int64_t>(firstHaplotype.sequence.length() + referenceAllele.length()),
+                                      -1 };
+            if (variantTypes == vector<string>{ "RareRepeat" })
+            {
+                const int64_t offtargetStart = offtargetContig.sequence.length();
+                const int64_t offtargetEnd = offtargetStart + kOfftargetRegionLength;
+                placement.offtargetStart = offtargetStart;
+                offtargetContig.sequence += generateSequence(generator, kOfftargetRegionLength);
+                record["OfftargetRegions"] = { encodeRegion(kOfftargetContigName, offtargetStart, offtargetEnd) };
+                offtargetContig.sequence += generateSequence(generator, parameters.spacerLength);
+            }
+            sample.catalog.push_back(record);
+
+            reference += referenceAllele;
+            firstHaplotype.sequence += referenceAllele;
+            firstHaplotype.loci.push_back(placement);
+            placement.haplotypeStart = secondHaplotype.sequence.length();
+            placement.haplotypeEnd = placement.haplotypeStart + expandedAllele.length();
+            secondHaplotype.sequence += expandedAllele;
+            secondHaplotype.loci.push_back(placement);
+        }
+
+        const string spacer = generateSequence(generator, parameters.spacerLength);
+        reference += spacer;
+        firstHaplotype.sequence += spacer;
+        secondHaplotype.sequence += spacer;
+        haplotypes.push_back(std::move(firstHaplotype));
+        haplotypes.push_back(std::move(secondHaplotype));
+    }
+
+    if (hasRareRepeats)
+    {
+        haplotypes.push_back({ offtargetContigIndex, offtargetContig.sequence, {} });
+        haplotypes.push_back({ offtargetContigIndex, offtargetContig.sequence, {} });
+        sample.contigs.push_back(std::move(offtargetContig));
+    }
+
+    for (const Haplotype& haplotype : haplotypes)
+    {
+        sequenceHaplotype(generator, parameters, haplotype, offtargetContigIndex, sample.reads);
+    }
+
+    std::stable_sort(
+        sample.reads.begin(), sample.reads.end(), [](const SimulatedRead& read, const SimulatedRead& other) {
+            return std::make_pair(read.contigIndex, read.position) < std::make_pair(other.contigIndex, other.position);
+        });
+
+    return sample;
+}
+
+}
@@ -0,0 +1,82 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Simulation of a sample with the loci of a variant catalog: a synthetic reference in which the loci are separated by
+// random sequence, a catalog with the coordinates of the loci in that reference, and read pairs sequenced from it
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "thirdparty/json/json.hpp"
+
+#include "benchmarks/BenchmarkLoci.hh"
+
+namespace ehunter
+{
+
+struct SimulationParameters
+{
+    // Read depth on diploid chromosomes
+    double depth = 30;
+    int readLength = 150;
+    int meanFragmentLength = 400;
+    double errorRate = 0.001;
+    // Length of random sequence placed around each locus
+    int spacerLength = 5000;
+    // Fraction of read pairs fully contained in a rare repeat that are placed into its off-target region
+    double offtargetIrrFraction = 0.5;
+    unsigned seed = 42;
+    // Number of units of the first repeat of the given loci on the second haplotype
+    std::map<std::string, int> expansions;
+};
+
+struct SimulatedContig
+{
+    std::string name;
+    std::string sequence;
+};
+
+struct SimulatedRead
+{
+    std::string name;
+    int flag;
+    int contigIndex;
+    int64_t position;
+    int mapq;
+    int64_t matePosition;
+    int64_t templateLength;
+    std::string bases;
+};
+
+struct SimulatedSample
+{
+    std::vector<SimulatedContig> contigs;
+    nlohmann::json catalog;
+    // Sorted by coordinate
+    std::vector<SimulatedRead> reads;
+};
+
+SimulatedSample simulateSample(const std::vector<BenchmarkLocus>& loci, const SimulationParameters& parameters);
+
+}
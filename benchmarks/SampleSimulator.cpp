@@ -0,0 +1,192 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Simulates a sample with the loci of a variant catalog and writes its reference (<prefix>.fa), catalog
+// (<prefix>_catalog.json), and coordinate-sorted indexed reads (<prefix>.bam) for end-to-end benchmarks
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+extern "C"
+{
+#include "htslib/faidx.h"
+#include "htslib/sam.h"
+}
+
+#include "benchmarks/SampleSimulation.hh"
+
+namespace po = boost::program_options;
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+// Bases are assigned quality 30
+const char kBaseQualityCode = '?';
+
+void writeReference(const vector<SimulatedContig>& contigs, const string& referencePath)
+{
+    std::ofstream referenceFile(referencePath);
+    if (!referenceFile.is_open())
+    {
+        throw std::runtime_error("Failed to open " + referencePath + " for writing");
+    }
+
+    const size_t kLineWidth = 60;
+    for (const SimulatedContig& contig : contigs)
+    {
+        referenceFile << ">" << contig.name << "\n";
+        for (size_t lineStart = 0; lineStart < contig.sequence.length(); lineStart += kLineWidth)
+        {
+            referenceFile << contig.sequence.substr(lineStart, kLineWidth) << "\n";
+        }
+    }
+    referenceFile.close();
+
+    if (fai_build(referencePath.c_str()) != 0)
+    {
+        throw std::runtime_error("Failed to index " + referencePath);
+    }
+}
+
+// Records are parsed from SAM text so that htslib takes care of the encoding of the reads
+void writeReads(const SimulatedSample& sample, int readLength, const string& bamPath)
+{
+    string headerText = "@HD\tVN:1.4\tSO:coordinate\n";
+    for (const SimulatedContig& contig : sample.contigs)
+    {
+        headerText += "@SQ\tSN:" + contig.name + "\tLN:" + std::to_string(contig.sequence.length()) + "\n";
+    }
+    bam_hdr_t* headerPtr = sam_hdr_parse(headerText.length(), headerText.c_str());
+    headerPtr->l_text = headerText.length();
+    headerPtr->text = strdup(headerText.c_str());
+
+    samFile* bamFilePtr = sam_open(bamPath.c_str(), "wb");
+    if (bamFilePtr == nullptr || sam_hdr_write(bamFilePtr, headerPtr) != 0)
+    {
+        throw std::runtime_error("Failed to write header of " + bamPath);
+    }
+
+    const string cigar = std::to_string(readLength) + "M";
+    const string qualities(readLength, kBaseQualityCode);
+    bam1_t* recordPtr = bam_init1();
+    for (const SimulatedRead& read : sample.reads)
+    {
+        string line = read.name + "\t" + std::to_string(read.flag) + "\t" + sample.contigs[read.contigIndex].name
+            + "\t" + std::to_string(read.position + 1) + "\t" + std::to_string(read.mapq) + "\t" + cigar + "\t=\t"
+            + std::to_string(read.matePosition + 1) + "\t" + std::to_string(read.templateLength) + "\t" + read.bases
+            + "\t" + qualities;
+        kstring_t lineString = { line.length(), line.length() + 1, &line[0] };
+        if (sam_parse1(&lineString, headerPtr, recordPtr) < 0 || sam_write1(bamFilePtr, headerPtr, recordPtr) < 0)
+        {
+            throw std::runtime_error("Failed to write read " + read.name + " to " + bamPath);
+        }
+    }
+    bam_destroy1(recordPtr);
+    bam_hdr_destroy(headerPtr);
+
+    if (sam_close(bamFilePtr) != 0 || sam_index_build(bamPath.c_str(), 0) != 0)
+    {
+        throw std::runtime_error("Failed to index " + bamPath);
+    }
+}
+
+void addExpansions(const vector<string>& encodings, SimulationParameters& parameters)
+{
+    for (const string& encoding : encodings)
+    {
+        const size_t separatorPosition = encoding.find('=');
+        if (separatorPosition == string::npos)
+        {
+            throw std::invalid_argument("Expansion " + encoding + " must be specified as LOCUS_ID=UNIT_COUNT");
+        }
+        const string locusId = encoding.substr(0, separatorPosition);
+        parameters.expansions[locusId] = std::stoi(encoding.substr(separatorPosition + 1));
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    SimulationParameters parameters;
+    string catalogPath;
+    string outputPrefix;
+    vector<string> expansionEncodings;
+
+    // clang-format off
+    po::options_description usage("Allowed options");
+    usage.add_options()
+      ("help", "Print help message")
+      ("variant-catalog", po::value<string>(&catalogPath)->required(), "JSON file with the loci to simulate")
+      ("output-prefix", po::value<string>(&outputPrefix)->required(), "Prefix for the output files")
+      ("depth", po::value<double>(&parameters.depth)->default_value(parameters.depth), "Read depth on diploid chromosomes")
+      ("read-length", po::value<int>(&parameters.readLength)->default_value(parameters.readLength), "Read length")
+      ("fragment-length", po::value<int>(&parameters.meanFragmentLength)->default_value(parameters.meanFragmentLength), "Mean fragment length")
+      ("error-rate", po::value<double>(&parameters.errorRate)->default_value(parameters.errorRate), "Fraction of substituted bases")
+      ("spacer-length", po::value<int>(&parameters.spacerLength)->default_value(parameters.spacerLength), "Length of random sequence between loci")
+      ("offtarget-irr-fraction", po::value<double>(&parameters.offtargetIrrFraction)->default_value(parameters.offtargetIrrFraction), "Fraction of in-repeat read pairs of rare repeats placed into their off-target regions")
+      ("expansion", po::value<vector<string>>(&expansionEncodings), "Number of units of the first repeat of a locus on one haplotype as LOCUS_ID=UNIT_COUNT; can be repeated")
+      ("seed", po::value<unsigned>(&parameters.seed)->default_value(parameters.seed), "Seed of the random number generator");
+    // clang-format on
+
+    try
+    {
+        po::variables_map argumentMap;
+        po::store(po::command_line_parser(argc, argv).options(usage).run(), argumentMap);
+        if (argc == 1 || argumentMap.count("help"))
+        {
+            std::cerr << usage << std::endl;
+            return argc == 1 ? 1 : 0;
+        }
+        po::notify(argumentMap);
+        addExpansions(expansionEncodings, parameters);
+        if (parameters.spacerLength < parameters.meanFragmentLength)
+        {
+            throw std::invalid_argument("Spacer length must be at least the fragment length");
+        }
+
+        const SimulatedSample sample = simulateSample(loadBenchmarkLoci(catalogPath, 500), parameters);
+        writeReference(sample.contigs, outputPrefix + ".fa");
+        std::ofstream catalogFile(outputPrefix + "_catalog.json");
+        catalogFile << sample.catalog.dump(4) << std::endl;
+        writeReads(sample, parameters.readLength, outputPrefix + ".bam");
+
+        std::cout << "Loci\t" << sample.catalog.size() << "\n";
+        std::cout << "Reads\t" << sample.reads.size() << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Compares the single-pass scoring of all repeat unit permutations in WeightedPurityCalculator with scoring each
+// permutation separately, on in-repeat reads and on reads that are not in the repeat
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "stats/WeightedPurityCalculator.hh"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+namespace
+{
+
+const int kReadLength = 150;
+const int kNumReads = 1000;
+const double kMinPurity = 0.90;
+
+vector<string> simulateRepeatReads(const string& repeatUnit, double errorRate)
+{
+    std::mt19937 randomEngine(42);
+    std::uniform_real_distribution<double> errorDistribution(0.0, 1.0);
+    std::uniform_int_distribution<int> baseDistribution(0, 3);
+    const string bases = "ACGT";
+
+    vector<string> reads;
+    for (int readIndex = 0; readIndex != kNumReads; ++readIndex)
+    {
+        string read;
+        for (int position = 0; position != kReadLength; ++position)
+        {
+            const bool isError = errorDistribution(randomEngine) < errorRate;
+            read += isError ? bases[baseDistribution(randomEngine)] : repeatUnit[position % repeatUnit.length()];
+        }
+        reads.push_back(read);
+    }
+
+    return reads;
+}
+
+void scoreReadsScalar(benchmark::State& state, const string& repeatUnit, double errorRate)
+{
+    WeightedPurityCalculator calculator(repeatUnit);
+    const vector<string> reads = simulateRepeatReads(repeatUnit, errorRate);
+    for (auto _ : state)
+    {
+        int numInRepeatReads = 0;
+        for (const auto& read : reads)
+        {
+            numInRepeatReads += calculator.scoreEachPermutationSeparately(read) >= kMinPurity;
+        }
+        benchmark::DoNotOptimize(numInRepeatReads);
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+void scoreReadsInOnePass(benchmark::State& state, const string& repeatUnit, double errorRate)
+{
+    WeightedPurityCalculator calculator(repeatUnit);
+    const vector<string> reads = simulateRepeatReads(repeatUnit, errorRate);
+    for (auto _ : state)
+    {
+        int numInRepeatReads = 0;
+        for (const auto& read : reads)
+        {
+            numInRepeatReads += calculator.score(read) >= kMinPurity;
+        }
+        benchmark::DoNotOptimize(numInRepeatReads);
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+void checkReadsWithEarlyTermination(benchmark::State& state, const string& repeatUnit, double errorRate)
+{
+    WeightedPurityCalculator calculator(repeatUnit);
+    const vector<string> reads = simulateRepeatReads(repeatUnit, errorRate);
+    for (auto _ : state)
+    {
+        int numInRepeatReads = 0;
+        for (const auto& read : reads)
+        {
+            numInRepeatReads += calculator.checkIfReachesScore(read, kMinPurity);
+        }
+        benchmark::DoNotOptimize(numInRepeatReads);
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+}
+
+}
+
+// Error rate of 0.75 gives reads that are unrelated to the repeat
+BENCHMARK_CAPTURE(scoreReadsScalar, CGG_InRepeat, string("CGG"), 0.02);
+BENCHMARK_CAPTURE(scoreReadsInOnePass, CGG_InRepeat, string("CGG"), 0.02);
+BENCHMARK_CAPTURE(checkReadsWithEarlyTermination, CGG_InRepeat, string("CGG"), 0.02);
+BENCHMARK_CAPTURE(scoreReadsScalar, GGCCCC_InRepeat, string("GGCCCC"), 0.02);
+BENCHMARK_CAPTURE(scoreReadsInOnePass, GGCCCC_InRepeat, string("GGCCCC"), 0.02);
+BENCHMARK_CAPTURE(checkReadsWithEarlyTermination, GGCCCC_InRepeat, string("GGCCCC"), 0.02);
+BENCHMARK_CAPTURE(scoreReadsScalar, GGCCCC_NotInRepeat, string("GGCCCC"), 0.75);
+BENCHMARK_CAPTURE(scoreReadsInOnePass, GGCCCC_NotInRepeat, string("GGCCCC"), 0.75);
+BENCHMARK_CAPTURE(checkReadsWithEarlyTermination, GGCCCC_NotInRepeat, string("GGCCCC"), 0.75);
+
+BENCHMARK_MAIN();
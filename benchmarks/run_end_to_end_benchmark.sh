@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+#
+# Expansion Hunter
+# Copyright (c) 2018 Illumina, Inc.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Simulates a sample with the loci of the bundled catalog, analyzes it in seeking and streaming modes, and prints a
+# tab-separated table with wall time, reads and loci analyzed per second, and peak memory of each run.
+#
+# Usage: run_end_to_end_benchmark.sh <build directory> <working directory> [SampleSimulator options]
+#
+# Read depth and length are taken from the DEPTH (30 by default) and READ_LENGTH (150 by default) variables. Peak
+# memory is measured with GNU time, which is expected at /usr/bin/time unless its path is given in GNU_TIME.
+
+set -euo pipefail
+
+if [[ $# -lt 2 ]]; then
+    sed -n '/^# Usage/,/^$/p' "$0" >&2
+    exit 1
+fi
+
+readonly build_dir=$1
+readonly work_dir=$2
+shift 2
+
+readonly source_dir=$(cd "$(dirname "$0")/.." && pwd)
+readonly depth=${DEPTH:-30}
+readonly read_length=${READ_LENGTH:-150}
+readonly gnu_time=${GNU_TIME:-/usr/bin/time}
+readonly prefix=$work_dir/simulated
+
+mkdir -p "$work_dir"
+simulation_summary=$("$build_dir/benchmarks/SampleSimulator" \
+    --variant-catalog "$source_dir/variant_catalog/variant_catalog_hg38.json" \
+    --output-prefix "$prefix" --depth "$depth" --read-length "$read_length" "$@")
+readonly num_loci=$(awk -F '\t' '$1 == "Loci" { print $2 }' <<< "$simulation_summary")
+readonly num_reads=$(awk -F '\t' '$1 == "Reads" { print $2 }' <<< "$simulation_summary")
+
+# Files without the .bam extension are streamed, so the same reads are analyzed in streaming mode through a link
+ln -sf "$(basename "$prefix").bam" "$prefix.stream"
+
+printf "Mode\tWallTimeSeconds\tReadsPerSecond\tLociPerSecond\tPeakRssMegabytes\n"
+for mode in seeking streaming; do
+    reads=$prefix.bam
+    [[ $mode == streaming ]] && reads=$prefix.stream
+
+    start_time=$(date +%s.%N)
+    "$gnu_time" -v -o "$work_dir/$mode.time" "$build_dir/ExpansionHunter" \
+        --reads "$reads" --reference "$prefix.fa" --variant-catalog "${prefix}_catalog.json" \
+        --output-prefix "$work_dir/$mode" --genome-coverage "$depth" --read-length "$read_length" \
+        > "$work_dir/$mode.stdout" 2>&1
+    end_time=$(date +%s.%N)
+
+    peak_rss_kb=$(awk -F ': ' '/Maximum resident set size/ { print $2 }' "$work_dir/$mode.time")
+    awk -v mode="$mode" -v start="$start_time" -v end="$end_time" -v reads="$num_reads" -v loci="$num_loci" \
+        -v rss="$peak_rss_kb" 'BEGIN {
+            seconds = end - start
+            printf "%s\t%.3f\t%.0f\t%.2f\t%.1f\n", mode, seconds, reads / seconds, loci / seconds, rss / 1024
+        }'
+done
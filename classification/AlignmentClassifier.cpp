@@ -78,7 +78,7 @@ GraphAlignment RepeatAlignmentClassifier::GetCanonicalAlignment(const list<Graph
     const GraphAlignment* canonical_alignment_ptr = nullptr;
     for (const GraphAlignment& alignment : Alignments)
     {
-        AlignmentType alignment_type = Classify(alignment);
+        AlignmentType alignment_type = Classify(CompactGraphAlignment(alignment));
         if (!canonical_alignment_ptr)
         {
             canonical_alignment_ptr = &alignment;
@@ -96,13 +96,14 @@ GraphAlignment RepeatAlignmentClassifier::GetCanonicalAlignment(const list<Graph
     return *canonical_alignment_ptr;
 }
 
-AlignmentType RepeatAlignmentClassifier::Classify(const GraphAlignment& alignment) const
+AlignmentType RepeatAlignmentClassifier::Classify(const CompactGraphAlignment& alignment) const
 {
     bool overlaps_left_flank = false;
     bool overlaps_right_flank = false;
 
-    for (auto node_id : alignment.path().nodeIds())
+    for (std::size_t node_index = 0; node_index != alignment.numNodes(); ++node_index)
     {
+        const NodeId node_id = alignment.nodeId(node_index);
         if (left_flank_node_ids_.find(node_id) != left_flank_node_ids_.end())
         {
             overlaps_left_flank = true;
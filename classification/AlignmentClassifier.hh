@@ -28,6 +28,8 @@
 
 #include "graphalign/GraphAlignment.hh"
 
+#include "alignment/CompactGraphAlignment.hh"
+
 using graphtools::GraphAlignment;
 
 namespace ehunter
@@ -49,7 +51,7 @@ class RepeatAlignmentClassifier
 {
 public:
     RepeatAlignmentClassifier(const graphtools::Graph& graph, int32_t repeat_node_id);
-    AlignmentType Classify(const GraphAlignment& alignment) const;
+    AlignmentType Classify(const CompactGraphAlignment& alignment) const;
     GraphAlignment GetCanonicalAlignment(const std::list<GraphAlignment>& alignments) const;
     const std::set<graphtools::NodeId>& leftFlankNodeIds() const { return left_flank_node_ids_; }
     const std::set<graphtools::NodeId>& rightFlankNodeIds() const { return right_flank_node_ids_; }
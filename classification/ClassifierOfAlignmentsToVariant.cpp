@@ -67,15 +67,16 @@ ClassifierOfAlignmentsToVariant::ClassifierOfAlignmentsToVariant(vector<NodeId>
     lastBundleNode_ = targetNodes_.back();
 }
 
-void ClassifierOfAlignmentsToVariant::classify(const graphtools::GraphAlignment& graphAlignment)
+void ClassifierOfAlignmentsToVariant::classify(const CompactGraphAlignment& graphAlignment)
 {
     bool pathStartsUpstream = false;
     bool pathEndsDownstream = false;
     bool pathOverlapsTargetNode = false;
     NodeId targetNodeOverlapped = kInvalidNodeId;
 
-    for (auto pathNode : graphAlignment.path().nodeIds())
+    for (std::size_t nodeIndex = 0; nodeIndex != graphAlignment.numNodes(); ++nodeIndex)
     {
+        const NodeId pathNode = graphAlignment.nodeId(nodeIndex);
         if (pathNode < firstBundleNode_)
         {
             pathStartsUpstream = true;
@@ -26,6 +26,7 @@
 #include "graphalign/GraphAlignment.hh"
 #include "graphcore/Graph.hh"
 
+#include "alignment/CompactGraphAlignment.hh"
 #include "common/CountTable.hh"
 
 namespace ehunter {
@@ -38,7 +39,7 @@ public:
 
     ClassifierOfAlignmentsToVariant(std::vector<graphtools::NodeId> targetNodes);
 
-    void classify(const graphtools::GraphAlignment& graphAlignment);
+    void classify(const CompactGraphAlignment& graphAlignment);
 
     const CountTable& countsOfReadsFlankingUpstream() const { return countsOfReadsFlankingUpstream_; }
     const CountTable& countsOfReadsFlankingDownstream() const { return countsOfReadsFlankingDownstream_; }
@@ -60,7 +60,7 @@ TEST(AlignmentClassificaton, SpanningAlignment_Classified)
         const string read = "CCCCGCCGAT";
         GraphAlignment alignment = decodeGraphAlignment(4, "0[2M]1[3M]1[3M]2[2M]", &graph);
 
-        EXPECT_EQ(AlignmentType::kSpansRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kSpansRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 
     { //                  FFFF
@@ -68,7 +68,7 @@ TEST(AlignmentClassificaton, SpanningAlignment_Classified)
         GraphAlignment alignment = decodeGraphAlignment(4, "0[2M]2[2M]", &graph);
 
         RepeatAlignmentClassifier alignment_classifier(graph, 1);
-        EXPECT_EQ(AlignmentType::kSpansRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kSpansRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 }
 
@@ -81,7 +81,7 @@ TEST(AlignmentClassificaton, FlankingAlignment_Classified)
         const string read = "AACCCCG";
         GraphAlignment alignment = decodeGraphAlignment(2, "0[4M]1[3M]", &graph);
 
-        EXPECT_EQ(AlignmentType::kFlanksRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kFlanksRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 
     { //                  RRRFFF
@@ -89,7 +89,7 @@ TEST(AlignmentClassificaton, FlankingAlignment_Classified)
         GraphAlignment alignment = decodeGraphAlignment(0, "1[3M]2[3M]", &graph);
 
         RepeatAlignmentClassifier alignment_classifier(graph, 1);
-        EXPECT_EQ(AlignmentType::kFlanksRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kFlanksRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 }
 
@@ -102,7 +102,7 @@ TEST(AlignmentClassificaton, RepeatAlignment_Classified)
         const string read = "CCGCCGCC";
         GraphAlignment alignment = decodeGraphAlignment(0, "1[3M]1[3M]1[2M]", &graph);
 
-        EXPECT_EQ(AlignmentType::kInsideRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kInsideRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 
     { //                  RRRRRRRR
@@ -110,7 +110,7 @@ TEST(AlignmentClassificaton, RepeatAlignment_Classified)
         GraphAlignment alignment = decodeGraphAlignment(1, "1[2M]1[3M]1[3M]", &graph);
 
         RepeatAlignmentClassifier alignment_classifier(graph, 1);
-        EXPECT_EQ(AlignmentType::kInsideRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kInsideRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 }
 
@@ -123,7 +123,7 @@ TEST(AlignmentClassificaton, OutsideRepeatAlignment_Classified)
         const string read = "AAAAC";
         GraphAlignment alignment = decodeGraphAlignment(0, "0[5M]", &graph);
 
-        EXPECT_EQ(AlignmentType::kOutsideRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kOutsideRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 
     { //                  FFF
@@ -131,7 +131,7 @@ TEST(AlignmentClassificaton, OutsideRepeatAlignment_Classified)
         GraphAlignment alignment = decodeGraphAlignment(1, "2[3M]", &graph);
 
         RepeatAlignmentClassifier alignment_classifier(graph, 1);
-        EXPECT_EQ(AlignmentType::kOutsideRepeat, alignment_classifier.Classify(alignment));
+        EXPECT_EQ(AlignmentType::kOutsideRepeat, alignment_classifier.Classify(CompactGraphAlignment(alignment)));
     }
 }
 
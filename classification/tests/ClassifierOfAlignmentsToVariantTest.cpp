@@ -69,12 +69,12 @@ TEST(ClassifyingAlignmentsOverIndel, DownstreamAndUpstreamAlignments_Classified)
     GraphAlignment downstreamFlankingAlignment = decodeGraphAlignment(0, "4[2M]5[3M]", &graph);
     ASSERT_TRUE(checkConsistency(downstreamFlankingAlignment, "CATGT"));
 
-    classifier.classify(upstreamAlignment);
-    classifier.classify(downstreamAlignment);
-    classifier.classify(spanningAlignment);
-    classifier.classify(bypassingAlignment);
-    classifier.classify(upstreamFlankingAlignment);
-    classifier.classify(downstreamFlankingAlignment);
+    classifier.classify(CompactGraphAlignment(upstreamAlignment));
+    classifier.classify(CompactGraphAlignment(downstreamAlignment));
+    classifier.classify(CompactGraphAlignment(spanningAlignment));
+    classifier.classify(CompactGraphAlignment(bypassingAlignment));
+    classifier.classify(CompactGraphAlignment(upstreamFlankingAlignment));
+    classifier.classify(CompactGraphAlignment(downstreamFlankingAlignment));
 
     EXPECT_EQ(CountTable(map<int32_t, int32_t>({ { 4, 1 } })), classifier.countsOfReadsFlankingUpstream());
     EXPECT_EQ(CountTable(map<int32_t, int32_t>({ { 4, 1 } })), classifier.countsOfReadsFlankingDownstream());
@@ -0,0 +1,55 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "common/BufferedFileSink.hh"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using std::string;
+
+namespace ehunter
+{
+
+BufferedFileSink::BufferedFileSink(string path, std::size_t bufferSize)
+    : path_(std::move(path))
+    , buffer_(bufferSize)
+{
+    // The buffer must be installed before the file is opened for it to take effect
+    stream_.rdbuf()->pubsetbuf(buffer_.data(), buffer_.size());
+    stream_.open(path_.c_str());
+    if (!stream_.is_open())
+    {
+        throw std::runtime_error("Failed to open " + path_ + " for writing: " + strerror(errno));
+    }
+}
+
+void BufferedFileSink::close()
+{
+    stream_.close();
+    if (stream_.fail())
+    {
+        throw std::runtime_error("Failed to write " + path_);
+    }
+}
+
+}
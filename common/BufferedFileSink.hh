@@ -0,0 +1,52 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ehunter
+{
+
+// Output file with a large user-space buffer; records written one at a time reach the disk in a few large writes
+class BufferedFileSink
+{
+public:
+    static const std::size_t kDefaultBufferSize = 1 << 20;
+
+    explicit BufferedFileSink(std::string path, std::size_t bufferSize = kDefaultBufferSize);
+    BufferedFileSink(const BufferedFileSink&) = delete;
+    BufferedFileSink& operator=(const BufferedFileSink&) = delete;
+
+    const std::string& path() const { return path_; }
+    std::ostream& stream() { return stream_; }
+    void close();
+
+private:
+    std::string path_;
+    std::vector<char> buffer_;
+    std::ofstream stream_;
+};
+
+}
@@ -40,25 +40,9 @@ namespace ehunter {
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
-Outputs::Outputs(const string& vcfPath, const string& jsonPath, const string& logPath)
+Outputs::Outputs(const string& jsonPath)
+    : json_(jsonPath)
 {
-    vcf_.open(vcfPath.c_str());
-    if (!vcf_.is_open())
-    {
-        throw std::runtime_error("Failed to open " + vcfPath + " for writing: " + strerror(errno));
-    }
-
-    json_.open(jsonPath.c_str());
-    if (!json_.is_open())
-    {
-        throw std::runtime_error("Failed to open " + jsonPath + " for writing: " + strerror(errno));
-    }
-
-    log_.open(logPath.c_str());
-    if (!log_.is_open())
-    {
-        throw std::runtime_error("Failed to open " + logPath + " for writing: " + strerror(errno));
-    }
 }
 
 
@@ -21,13 +21,16 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <boost/optional.hpp>
 
+#include "common/BufferedFileSink.hh"
 #include "common/Common.hh"
 #include "common/GenomicRegion.hh"
 
@@ -37,15 +40,11 @@ namespace ehunter
 class Outputs
 {
 public:
-    Outputs(const std::string& vcfPath, const std::string& jsonPath, const std::string& logPath);
-    std::ostream& vcf() { return vcf_; }
-    std::ostream& json() { return json_; }
-    std::ostream& log() { return log_; }
+    explicit Outputs(const std::string& jsonPath);
+    std::ostream& json() { return json_.stream(); }
 
 private:
-    std::ofstream vcf_;
-    std::ofstream json_;
-    std::ofstream log_;
+    BufferedFileSink json_;
 };
 
 class InputPaths
@@ -71,21 +70,89 @@ private:
 class OutputPaths
 {
 public:
-    OutputPaths(std::string vcf, std::string json, std::string log)
+    OutputPaths(
+        std::string vcf, std::string json, std::string log, std::string bam, std::string checkpoint,
+        std::string metrics, std::string readCounts)
         : vcf_(vcf)
         , json_(json)
         , log_(log)
+        , bam_(bam)
+        , checkpoint_(checkpoint)
+        , metrics_(metrics)
+        , readCounts_(readCounts)
     {
     }
 
     const std::string& vcf() const { return vcf_; }
     const std::string& json() const { return json_; }
     const std::string& log() const { return log_; }
+    const std::string& bam() const { return bam_; }
+    const std::string& checkpoint() const { return checkpoint_; }
+    const std::string& metrics() const { return metrics_; }
+    const std::string& readCounts() const { return readCounts_; }
 
 private:
     std::string vcf_;
     std::string json_;
     std::string log_;
+    std::string bam_;
+    std::string checkpoint_;
+    std::string metrics_;
+    std::string readCounts_;
+};
+
+enum class VcfIndexFormat
+{
+    kNone,
+    kTbi,
+    kCsi
+};
+
+class OutputParameters
+{
+public:
+    OutputParameters(
+        bool compressVcf = false, VcfIndexFormat vcfIndexFormat = VcfIndexFormat::kNone, int numCompressionThreads = 1,
+        bool writeAlignmentLog = false, bool writeRealignedBam = false, bool resumeFromCheckpoint = false,
+        bool writeMetrics = false, bool writeReadCounts = false)
+        : compressVcf_(compressVcf)
+        , vcfIndexFormat_(vcfIndexFormat)
+        , numCompressionThreads_(numCompressionThreads)
+        , writeAlignmentLog_(writeAlignmentLog)
+        , writeRealignedBam_(writeRealignedBam)
+        , resumeFromCheckpoint_(resumeFromCheckpoint)
+        , writeMetrics_(writeMetrics)
+        , writeReadCounts_(writeReadCounts)
+    {
+    }
+
+    // VCF is written bgzip-compressed and can then be indexed
+    bool compressVcf() const { return compressVcf_; }
+    VcfIndexFormat vcfIndexFormat() const { return vcfIndexFormat_; }
+    int numCompressionThreads() const { return numCompressionThreads_; }
+
+    // Realigned reads are written to the YAML log and/or to a BAM file only on request
+    bool writeAlignmentLog() const { return writeAlignmentLog_; }
+    bool writeRealignedBam() const { return writeRealignedBam_; }
+
+    // Loci saved to the checkpoint of an interrupted run are not analyzed again
+    bool resumeFromCheckpoint() const { return resumeFromCheckpoint_; }
+
+    // Time spent on each stage of the analysis is only measured on request
+    bool writeMetrics() const { return writeMetrics_; }
+
+    // Read counts of each locus are saved on request so that the sample can be genotyped again without realignment
+    bool writeReadCounts() const { return writeReadCounts_; }
+
+private:
+    bool compressVcf_;
+    VcfIndexFormat vcfIndexFormat_;
+    int numCompressionThreads_;
+    bool writeAlignmentLog_;
+    bool writeRealignedBam_;
+    bool resumeFromCheckpoint_;
+    bool writeMetrics_;
+    bool writeReadCounts_;
 };
 
 class SampleParameters
@@ -130,7 +197,8 @@ public:
     HeuristicParameters(
         bool verboseLogging, int regionExtensionLength, int qualityCutoffForGoodBaseCall, bool skipUnaligned,
         const std::string& alignerType, int kmerLenForAlignment = 14, int paddingLength = 10,
-        int seedAffixTrimLength = 5)
+        int seedAffixTrimLength = 5, bool trimLowQualityBases = false, bool useKmerPrefilter = false,
+        int maxGaplessMismatches = 0)
         : verboseLogging_(verboseLogging)
         , regionExtensionLength_(regionExtensionLength)
         , qualityCutoffForGoodBaseCall_(qualityCutoffForGoodBaseCall)
@@ -139,7 +207,9 @@ public:
         , kmerLenForAlignment_(kmerLenForAlignment)
         , paddingLength_(paddingLength)
         , seedAffixTrimLength_(seedAffixTrimLength)
-
+        , trimLowQualityBases_(trimLowQualityBases)
+        , useKmerPrefilter_(useKmerPrefilter)
+        , maxGaplessMismatches_(maxGaplessMismatches)
     {
     }
 
@@ -151,6 +221,10 @@ public:
     int kmerLenForAlignment() const { return kmerLenForAlignment_; }
     int paddingLength() const { return paddingLength_; }
     int seedAffixTrimLength() const { return seedAffixTrimLength_; }
+    bool trimLowQualityBases() const { return trimLowQualityBases_; }
+    bool useKmerPrefilter() const { return useKmerPrefilter_; }
+    // Gapless alignments with more mismatches are realigned with the gapped aligner
+    int maxGaplessMismatches() const { return maxGaplessMismatches_; }
 
 private:
     bool verboseLogging_;
@@ -161,30 +235,176 @@ private:
     int kmerLenForAlignment_;
     int paddingLength_;
     int seedAffixTrimLength_;
+    bool trimLowQualityBases_;
+    bool useKmerPrefilter_;
+    int maxGaplessMismatches_;
 };
 
-class ProgramParameters
+// Reads, output files, and parameters of one of the samples analyzed by a run
+class SampleTask
 {
 public:
-    ProgramParameters(
-        InputPaths inputPaths, OutputPaths outputPaths, SampleParameters sample, HeuristicParameters heuristics)
+    SampleTask(InputPaths inputPaths, OutputPaths outputPaths, SampleParameters sample)
         : inputPaths_(std::move(inputPaths))
         , outputPaths_(std::move(outputPaths))
         , sample_(std::move(sample))
-        , heuristics_(std::move(heuristics))
     {
     }
 
     const InputPaths& inputPaths() const { return inputPaths_; }
     const OutputPaths& outputPaths() const { return outputPaths_; }
-    SampleParameters& sample() { return sample_; }
-    const HeuristicParameters& heuristics() const { return heuristics_; }
+    const SampleParameters& sample() const { return sample_; }
 
 private:
     InputPaths inputPaths_;
     OutputPaths outputPaths_;
     SampleParameters sample_;
+};
+
+// Decodes a job submitted to a running service into the task of analyzing one sample
+using ServiceJobDecoder = std::function<SampleTask(const std::string& jobEncoding)>;
+
+// In service mode, catalogs are loaded once and samples are analyzed as jobs are submitted
+class ServiceParameters
+{
+public:
+    ServiceParameters(std::string reference, std::string catalog, ServiceJobDecoder jobDecoder)
+        : reference_(std::move(reference))
+        , catalog_(std::move(catalog))
+        , jobDecoder_(std::move(jobDecoder))
+    {
+    }
+
+    const std::string& reference() const { return reference_; }
+    const std::string& catalog() const { return catalog_; }
+    SampleTask decodeJob(const std::string& jobEncoding) const { return jobDecoder_(jobEncoding); }
+
+private:
+    std::string reference_;
+    std::string catalog_;
+    ServiceJobDecoder jobDecoder_;
+};
+
+// Part of the catalog analyzed by a run when loci are split between several runs; whole catalog by default
+class CatalogShard
+{
+public:
+    CatalogShard(int index = 0, int numShards = 1)
+        : index_(index)
+        , numShards_(numShards)
+    {
+    }
+
+    int index() const { return index_; }
+    int numShards() const { return numShards_; }
+    bool isWholeCatalog() const { return numShards_ == 1; }
+
+private:
+    int index_;
+    int numShards_;
+};
+
+// Samples are analyzed one after another unless multiple threads are requested in batch or service mode
+class ProgramParameters
+{
+public:
+    ProgramParameters(
+        std::vector<SampleTask> sampleTasks, OutputParameters outputParameters, HeuristicParameters heuristics,
+        int numThreads = 1, boost::optional<ServiceParameters> optionalServiceParameters = boost::none,
+        CatalogShard catalogShard = CatalogShard())
+        : sampleTasks_(std::move(sampleTasks))
+        , outputParameters_(std::move(outputParameters))
+        , heuristics_(std::move(heuristics))
+        , numThreads_(numThreads)
+        , optionalServiceParameters_(std::move(optionalServiceParameters))
+        , catalogShard_(catalogShard)
+    {
+    }
+
+    const std::vector<SampleTask>& sampleTasks() const { return sampleTasks_; }
+    const OutputParameters& outputParameters() const { return outputParameters_; }
+    const HeuristicParameters& heuristics() const { return heuristics_; }
+    int numThreads() const { return numThreads_; }
+    const CatalogShard& catalogShard() const { return catalogShard_; }
+
+    bool isServiceMode() const { return optionalServiceParameters_.is_initialized(); }
+    const ServiceParameters& serviceParameters() const
+    {
+        if (!optionalServiceParameters_)
+        {
+            throw std::logic_error("Attempting to access service parameters outside of service mode");
+        }
+        return *optionalServiceParameters_;
+    }
+
+private:
+    std::vector<SampleTask> sampleTasks_;
+    OutputParameters outputParameters_;
     HeuristicParameters heuristics_;
+    int numThreads_;
+    boost::optional<ServiceParameters> optionalServiceParameters_;
+    CatalogShard catalogShard_;
+};
+
+// Parameters of the merge command that combines the outputs of runs that analyzed different shards of a catalog
+class MergeParameters
+{
+public:
+    MergeParameters(
+        std::vector<std::string> shardOutputPrefixes, std::string outputPrefix, OutputParameters outputParameters)
+        : shardOutputPrefixes_(std::move(shardOutputPrefixes))
+        , outputPrefix_(std::move(outputPrefix))
+        , outputParameters_(std::move(outputParameters))
+    {
+    }
+
+    // Output prefixes of the shard runs in the order of shard indexes
+    const std::vector<std::string>& shardOutputPrefixes() const { return shardOutputPrefixes_; }
+    const std::string& outputPrefix() const { return outputPrefix_; }
+    const OutputParameters& outputParameters() const { return outputParameters_; }
+
+private:
+    std::vector<std::string> shardOutputPrefixes_;
+    std::string outputPrefix_;
+    OutputParameters outputParameters_;
+};
+
+// Parameters of the regenotype command that genotypes a sample from read counts saved by an earlier run
+class RegenotypeParameters
+{
+public:
+    RegenotypeParameters(
+        std::string readCountsPath, std::string reference, std::string catalog, std::string outputPrefix,
+        boost::optional<Sex> optionalSex, boost::optional<double> optionalHaplotypeDepth,
+        OutputParameters outputParameters)
+        : readCountsPath_(std::move(readCountsPath))
+        , reference_(std::move(reference))
+        , catalog_(std::move(catalog))
+        , outputPrefix_(std::move(outputPrefix))
+        , optionalSex_(optionalSex)
+        , optionalHaplotypeDepth_(optionalHaplotypeDepth)
+        , outputParameters_(std::move(outputParameters))
+    {
+    }
+
+    const std::string& readCountsPath() const { return readCountsPath_; }
+    const std::string& reference() const { return reference_; }
+    const std::string& catalog() const { return catalog_; }
+    const std::string& outputPrefix() const { return outputPrefix_; }
+    const OutputParameters& outputParameters() const { return outputParameters_; }
+
+    // Sex and depth of the sample override those saved with the read counts if set
+    const boost::optional<Sex>& optionalSex() const { return optionalSex_; }
+    const boost::optional<double>& optionalHaplotypeDepth() const { return optionalHaplotypeDepth_; }
+
+private:
+    std::string readCountsPath_;
+    std::string reference_;
+    std::string catalog_;
+    std::string outputPrefix_;
+    boost::optional<Sex> optionalSex_;
+    boost::optional<double> optionalHaplotypeDepth_;
+    OutputParameters outputParameters_;
 };
 
 }
@@ -0,0 +1,87 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "common/PerformanceMetrics.hh"
+
+#include <stdexcept>
+
+using std::string;
+
+namespace ehunter
+{
+
+string getStageName(AnalysisStage stage)
+{
+    switch (stage)
+    {
+    case AnalysisStage::kReadDecoding:
+        return "ReadDecoding";
+    case AnalysisStage::kMateRecovery:
+        return "MateRecovery";
+    case AnalysisStage::kOrientationPrediction:
+        return "OrientationPrediction";
+    case AnalysisStage::kGaplessAlignment:
+        return "GaplessAlignment";
+    case AnalysisStage::kGappedAlignment:
+        return "GappedAlignment";
+    case AnalysisStage::kGenotyping:
+        return "Genotyping";
+    case AnalysisStage::kOutput:
+        return "Output";
+    }
+
+    throw std::logic_error("Encountered unknown analysis stage");
+}
+
+LocusMetrics& LocusMetrics::operator+=(const LocusMetrics& other)
+{
+    for (int stageIndex = 0; stageIndex != kNumAnalysisStages; ++stageIndex)
+    {
+        stageSeconds[stageIndex] += other.stageSeconds[stageIndex];
+    }
+    numReadsDecoded += other.numReadsDecoded;
+    numMateSeeks += other.numMateSeeks;
+    numReadsAligned += other.numReadsAligned;
+    numReadsRejected += other.numReadsRejected;
+    numGaplessTierReads += other.numGaplessTierReads;
+    numGappedTierReads += other.numGappedTierReads;
+    numIndexCacheHits += other.numIndexCacheHits;
+    numNarrowScorePieces += other.numNarrowScorePieces;
+    numNarrowScoreOverflows += other.numNarrowScoreOverflows;
+    return *this;
+}
+
+LocusMetrics& SampleMetrics::addLocus(const string& locusId)
+{
+    loci_.emplace_back(locusId, LocusMetrics());
+    return loci_.back().second;
+}
+
+LocusMetrics SampleMetrics::total() const
+{
+    LocusMetrics totalMetrics = sampleWideMetrics_;
+    for (const auto& locusIdAndMetrics : loci_)
+    {
+        totalMetrics += locusIdAndMetrics.second;
+    }
+    return totalMetrics;
+}
+
+}
@@ -0,0 +1,125 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <utility>
+
+namespace ehunter
+{
+
+// Stages of the analysis of a locus whose wall time is measured when performance metrics are requested
+enum class AnalysisStage
+{
+    kReadDecoding,
+    kMateRecovery,
+    kOrientationPrediction,
+    kGaplessAlignment,
+    kGappedAlignment,
+    kGenotyping,
+    kOutput
+};
+
+const int kNumAnalysisStages = 7;
+
+std::string getStageName(AnalysisStage stage);
+
+// Time spent in each stage and numbers of reads handled by the analysis of a locus or of a whole sample
+struct LocusMetrics
+{
+    std::array<double, kNumAnalysisStages> stageSeconds = std::array<double, kNumAnalysisStages>();
+    int numReadsDecoded = 0;
+    int numMateSeeks = 0;
+    int numReadsAligned = 0;
+    int numReadsRejected = 0;
+    int numGaplessTierReads = 0;
+    int numGappedTierReads = 0;
+    int numIndexCacheHits = 0;
+    // Query pieces aligned in batches with 8-bit scores and those of them realigned after the scores saturated
+    int numNarrowScorePieces = 0;
+    int numNarrowScoreOverflows = 0;
+
+    double& seconds(AnalysisStage stage) { return stageSeconds[static_cast<int>(stage)]; }
+    double seconds(AnalysisStage stage) const { return stageSeconds[static_cast<int>(stage)]; }
+
+    LocusMetrics& operator+=(const LocusMetrics& other);
+};
+
+/**
+ * Metrics of the loci of a sample in the order in which they were analyzed
+ *
+ * A sample is analyzed by a single thread, so the metrics are not synchronized. Work that is shared by all loci, such
+ * as decoding the reads of a streamed file, is recorded in the sample-wide metrics.
+ */
+class SampleMetrics
+{
+public:
+    // References to the metrics of a locus remain valid as other loci are added
+    LocusMetrics& addLocus(const std::string& locusId);
+    LocusMetrics& sampleWideMetrics() { return sampleWideMetrics_; }
+
+    const std::deque<std::pair<std::string, LocusMetrics>>& loci() const { return loci_; }
+    const LocusMetrics& sampleWideMetrics() const { return sampleWideMetrics_; }
+
+    // Sum of the sample-wide metrics and the metrics of all loci
+    LocusMetrics total() const;
+
+private:
+    std::deque<std::pair<std::string, LocusMetrics>> loci_;
+    LocusMetrics sampleWideMetrics_;
+};
+
+// Adds the wall time of its scope to the given stage; the clock is not read at all if no metrics are given
+class StageTimer
+{
+public:
+    StageTimer(LocusMetrics* metricsPtr, AnalysisStage stage)
+        : metricsPtr_(metricsPtr)
+        , stage_(stage)
+    {
+        if (metricsPtr_)
+        {
+            startTime_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StageTimer()
+    {
+        if (metricsPtr_)
+        {
+            const std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime_;
+            metricsPtr_->seconds(stage_) += elapsedTime.count();
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    LocusMetrics* metricsPtr_;
+    AnalysisStage stage_;
+    std::chrono::steady_clock::time_point startTime_;
+};
+
+}
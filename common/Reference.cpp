@@ -25,8 +25,10 @@
 #include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 using std::string;
+using std::vector;
 
 namespace ehunter
 {
@@ -59,4 +61,17 @@ string FastaReference::getSequence(const string& chrom, pos_t start, pos_t end)
     return sequence;
 }
 
+vector<std::pair<string, int64_t>> FastaReference::contigs() const
+{
+    vector<std::pair<string, int64_t>> contigNamesAndLengths;
+    const int numContigs = faidx_nseq(fai_ptr_);
+    for (int contigIndex = 0; contigIndex != numContigs; ++contigIndex)
+    {
+        const char* contigName = faidx_iseq(fai_ptr_, contigIndex);
+        contigNamesAndLengths.emplace_back(contigName, faidx_seq_len(fai_ptr_, contigName));
+    }
+
+    return contigNamesAndLengths;
+}
+
 }
@@ -22,8 +22,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Include the fai class from samtools
 #include "htslib/faidx.h"
@@ -45,6 +48,9 @@ public:
      * @return Reference sequence in upper case
      */
     virtual std::string getSequence(const std::string& chrom, pos_t start, pos_t end) const = 0;
+
+    // Names and lengths of all contigs in the order of the reference
+    virtual std::vector<std::pair<std::string, int64_t>> contigs() const = 0;
 };
 
 /**
@@ -58,6 +64,9 @@ public:
 
     std::string getSequence(const std::string& chrom, pos_t start, pos_t end) const override;
 
+    // Names and lengths of all contigs in the order in which they appear in the fasta index
+    std::vector<std::pair<std::string, int64_t>> contigs() const override;
+
 private:
     std::string genome_path_;
     faidx_t* fai_ptr_;
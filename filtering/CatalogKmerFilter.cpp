@@ -0,0 +1,328 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "filtering/CatalogKmerFilter.hh"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "graphutils/SequenceOperations.hh"
+
+using graphtools::Graph;
+using std::string;
+using std::vector;
+
+namespace ehunter
+{
+
+namespace
+{
+
+const uint32_t kRepeatGroupBit = 1u << 31;
+const int kBloomFilterBitsPerKmer = 16;
+// A read anchored by at least 30bp of sequence can be assigned to the flank of a locus
+const int kMinFlankKmerMatches = 10;
+const int kMaxCandidateLoci = 4;
+
+int encodeBase(char base)
+{
+    switch (base)
+    {
+    case 'A':
+    case 'a':
+        return 0;
+    case 'C':
+    case 'c':
+        return 1;
+    case 'G':
+    case 'g':
+        return 2;
+    case 'T':
+    case 't':
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+uint64_t mixBits(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+// Repeats of units that are rotations or reverse complements of one another, or repeats of a shorter unit, consist of
+// the same kmers
+string getCanonicalUnit(const string& unit)
+{
+    string shortestUnit = unit;
+    for (size_t unitLength = 1; unitLength < unit.length(); ++unitLength)
+    {
+        string spelledUnit;
+        while (spelledUnit.length() < unit.length())
+        {
+            spelledUnit += unit.substr(0, unitLength);
+        }
+        if (spelledUnit == unit)
+        {
+            shortestUnit = unit.substr(0, unitLength);
+            break;
+        }
+    }
+
+    string canonicalUnit = shortestUnit;
+    for (const string& strandUnit : { shortestUnit, graphtools::reverseComplement(shortestUnit) })
+    {
+        for (size_t rotation = 0; rotation != strandUnit.length(); ++rotation)
+        {
+            canonicalUnit
+                = std::min(canonicalUnit, strandUnit.substr(rotation) + strandUnit.substr(0, rotation));
+        }
+    }
+    return canonicalUnit;
+}
+
+}
+
+template <typename Callback> void CatalogKmerFilter::forEachKmer(const string& sequence, Callback callback) const
+{
+    // Kmers are counted on both strands, so each is represented by the smaller of its encodings on the two strands
+    const uint64_t kmerMask = kmerLength_ == 32 ? ~0ULL : (1ULL << (2 * kmerLength_)) - 1;
+    const int reverseKmerShift = 2 * (kmerLength_ - 1);
+    uint64_t forwardKmer = 0;
+    uint64_t reverseKmer = 0;
+    int numValidBases = 0;
+    for (char base : sequence)
+    {
+        const int baseCode = encodeBase(base);
+        if (baseCode == -1)
+        {
+            numValidBases = 0;
+            continue;
+        }
+        forwardKmer = ((forwardKmer << 2) | baseCode) & kmerMask;
+        reverseKmer = (reverseKmer >> 2) | (static_cast<uint64_t>(3 - baseCode) << reverseKmerShift);
+        if (++numValidBases >= kmerLength_)
+        {
+            callback(std::min(forwardKmer, reverseKmer));
+        }
+    }
+}
+
+CatalogKmerFilter::CatalogKmerFilter(const RegionCatalog& regionCatalog, int flankLength, int kmerLength)
+    : kmerLength_(kmerLength)
+{
+    if (kmerLength_ < 1 || kmerLength_ > 32)
+    {
+        throw std::invalid_argument("Kmer length " + std::to_string(kmerLength_) + " is not supported");
+    }
+
+    vector<std::pair<uint64_t, uint32_t>> kmerEntries;
+    auto addKmers = [&](const string& sequence, uint32_t value) {
+        forEachKmer(sequence, [&](uint64_t kmer) { kmerEntries.emplace_back(kmer, value); });
+    };
+
+    std::unordered_map<string, uint32_t> repeatGroupIndexes;
+    int locusIndex = 0;
+    for (const auto& locusIdAndLocusSpec : regionCatalog)
+    {
+        const LocusSpecification& locusSpec = locusIdAndLocusSpec.second;
+        const Graph& graph = locusSpec.regionGraph();
+        const string& leftFlank = graph.nodeSeq(0);
+        const string& rightFlank = graph.nodeSeq(graph.numNodes() - 1);
+        const size_t leftFlankLength = std::min<size_t>(flankLength, leftFlank.length());
+        addKmers(leftFlank.substr(leftFlank.length() - leftFlankLength), locusIndex);
+        addKmers(rightFlank.substr(0, flankLength), locusIndex);
+
+        for (const auto& variantSpec : locusSpec.variantSpecs())
+        {
+            const VariantClassification& classification = variantSpec.classification();
+            if (classification.type != VariantType::kRepeat || classification.subtype != VariantSubtype::kRareRepeat)
+            {
+                continue;
+            }
+
+            const auto repeatNodeId = variantSpec.nodes().front();
+            const string canonicalUnit = getCanonicalUnit(graph.nodeSeq(repeatNodeId));
+            const auto groupIndexIt = repeatGroupIndexes.emplace(canonicalUnit, repeatGroups_.size()).first;
+            if (groupIndexIt->second == repeatGroups_.size())
+            {
+                repeatGroups_.emplace_back();
+            }
+            repeatGroups_[groupIndexIt->second].push_back(locusIndex);
+
+            for (const string& unit : graph.nodeSeqExpansion(repeatNodeId))
+            {
+                string repeat;
+                while (repeat.length() < kmerLength_ + unit.length())
+                {
+                    repeat += unit;
+                }
+                addKmers(repeat, kRepeatGroupBit | groupIndexIt->second);
+            }
+        }
+        ++locusIndex;
+    }
+
+    // Kmers of repeats take precedence over those of flanks, which often contain a few units of the repeat; kmers
+    // shared by the flanks of several loci or by different repeats cannot be used to assign reads. Values of the
+    // repeats are sorted after values of the flanks
+    std::sort(kmerEntries.begin(), kmerEntries.end());
+    for (auto entryIt = kmerEntries.begin(); entryIt != kmerEntries.end();)
+    {
+        auto nextEntryIt = entryIt;
+        while (nextEntryIt != kmerEntries.end() && nextEntryIt->first == entryIt->first)
+        {
+            ++nextEntryIt;
+        }
+        const uint32_t value = std::prev(nextEntryIt)->second;
+        const bool isUnique = std::all_of(entryIt, nextEntryIt, [value](const std::pair<uint64_t, uint32_t>& entry) {
+            return entry.second == value || (entry.second & kRepeatGroupBit) != (value & kRepeatGroupBit);
+        });
+        if (isUnique)
+        {
+            kmers_.push_back(entryIt->first);
+            kmerValues_.push_back(value);
+        }
+        entryIt = nextEntryIt;
+    }
+
+    size_t numBloomFilterWords = 1;
+    while (numBloomFilterWords * 64 < kmers_.size() * kBloomFilterBitsPerKmer)
+    {
+        numBloomFilterWords *= 2;
+    }
+    bloomFilterWords_.resize(numBloomFilterWords, 0);
+    for (uint64_t kmer : kmers_)
+    {
+        size_t wordIndex;
+        const uint64_t bits = getBloomFilterBits(kmer, wordIndex);
+        bloomFilterWords_[wordIndex] |= bits;
+    }
+}
+
+// Both bits of a kmer are set in the same word, so that each kmer is checked with a single memory access
+uint64_t CatalogKmerFilter::getBloomFilterBits(uint64_t kmer, size_t& wordIndex) const
+{
+    const uint64_t hash = mixBits(kmer);
+    wordIndex = (hash >> 32) & (bloomFilterWords_.size() - 1);
+    return (1ULL << (hash & 63)) | (1ULL << ((hash >> 6) & 63));
+}
+
+CatalogKmerFilter::ReadMatch CatalogKmerFilter::matchRead(const string& sequence) const
+{
+    int numKmers = 0;
+    int numRepeatKmers = 0;
+    int repeatGroupVotes = 0;
+    int candidateRepeatGroup = -1;
+    int candidateLoci[kMaxCandidateLoci];
+    int candidateLocusMatches[kMaxCandidateLoci];
+    int numCandidateLoci = 0;
+
+    forEachKmer(sequence, [&](uint64_t kmer) {
+        ++numKmers;
+        size_t wordIndex;
+        const uint64_t bits = getBloomFilterBits(kmer, wordIndex);
+        if ((bloomFilterWords_[wordIndex] & bits) != bits)
+        {
+            return;
+        }
+        const auto kmerIt = std::lower_bound(kmers_.begin(), kmers_.end(), kmer);
+        if (kmerIt == kmers_.end() || *kmerIt != kmer)
+        {
+            return;
+        }
+
+        const uint32_t value = kmerValues_[kmerIt - kmers_.begin()];
+        if (value & kRepeatGroupBit)
+        {
+            // Majority vote among the repeats matched by the kmers
+            const int repeatGroup = value & ~kRepeatGroupBit;
+            ++numRepeatKmers;
+            if (repeatGroupVotes == 0)
+            {
+                candidateRepeatGroup = repeatGroup;
+            }
+            repeatGroupVotes += repeatGroup == candidateRepeatGroup ? 1 : -1;
+            return;
+        }
+
+        const int locusIndex = value;
+        int candidateIndex = 0;
+        while (candidateIndex != numCandidateLoci && candidateLoci[candidateIndex] != locusIndex)
+        {
+            ++candidateIndex;
+        }
+        if (candidateIndex != numCandidateLoci)
+        {
+            ++candidateLocusMatches[candidateIndex];
+        }
+        else if (numCandidateLoci != kMaxCandidateLoci)
+        {
+            candidateLoci[numCandidateLoci] = locusIndex;
+            candidateLocusMatches[numCandidateLoci++] = 1;
+        }
+    });
+
+    ReadMatch match;
+    int maxLocusMatches = kMinFlankKmerMatches - 1;
+    for (int candidateIndex = 0; candidateIndex != numCandidateLoci; ++candidateIndex)
+    {
+        if (candidateLocusMatches[candidateIndex] > maxLocusMatches)
+        {
+            maxLocusMatches = candidateLocusMatches[candidateIndex];
+            match.flankLocusIndex = candidateLoci[candidateIndex];
+        }
+    }
+
+    // Purity of the reads is checked by the locus analyzer, so only most of the kmers need to match the repeat
+    if (numKmers != 0 && 2 * numRepeatKmers >= numKmers)
+    {
+        match.repeatGroupIndex = candidateRepeatGroup;
+    }
+
+    return match;
+}
+
+ReadPairAssignment CatalogKmerFilter::assignPair(const string& read, const string& mate) const
+{
+    const ReadMatch readMatch = matchRead(read);
+    const ReadMatch mateMatch = matchRead(mate);
+
+    ReadPairAssignment assignment;
+    assignment.targetLocusIndex
+        = readMatch.flankLocusIndex != -1 ? readMatch.flankLocusIndex : mateMatch.flankLocusIndex;
+    if (assignment.targetLocusIndex == -1 && readMatch.repeatGroupIndex != -1
+        && readMatch.repeatGroupIndex == mateMatch.repeatGroupIndex)
+    {
+        assignment.offtargetLocusIndexes = repeatGroups_[readMatch.repeatGroupIndex];
+    }
+
+    return assignment;
+}
+
+}
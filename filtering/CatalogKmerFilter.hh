@@ -0,0 +1,73 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Loci, given by their position in the catalog, that a read pair is assigned to
+struct ReadPairAssignment
+{
+    // Locus whose flanks are matched by one of the reads or -1
+    int targetLocusIndex = -1;
+    // Rare repeats whose unit makes up both reads; only set if the pair is not assigned to a target locus
+    std::vector<int> offtargetLocusIndexes;
+};
+
+// Assigns reads that cannot be placed by their alignment to loci of a catalog by kmers of the flanks next to the
+// repeats of each locus and of the units of rare repeats. A Bloom filter over all kmers rejects most reads from the
+// rest of the genome before the sorted table of kmers is searched
+class CatalogKmerFilter
+{
+public:
+    // Kmers are taken from the given length of each flank next to the repeats
+    CatalogKmerFilter(const RegionCatalog& regionCatalog, int flankLength, int kmerLength = 20);
+
+    ReadPairAssignment assignPair(const std::string& read, const std::string& mate) const;
+    size_t numKmers() const { return kmers_.size(); }
+
+private:
+    struct ReadMatch
+    {
+        int flankLocusIndex = -1;
+        int repeatGroupIndex = -1;
+    };
+
+    ReadMatch matchRead(const std::string& sequence) const;
+    template <typename Callback> void forEachKmer(const std::string& sequence, Callback callback) const;
+    uint64_t getBloomFilterBits(uint64_t kmer, size_t& wordIndex) const;
+
+    int kmerLength_;
+    // Sorted kmers and either the index of the locus or, with the top bit set, of the group of rare repeats
+    std::vector<uint64_t> kmers_;
+    std::vector<uint32_t> kmerValues_;
+    std::vector<uint64_t> bloomFilterWords_;
+    // Rare repeats grouped by unit
+    std::vector<std::vector<int>> repeatGroups_;
+};
+
+}
@@ -0,0 +1,122 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "filtering/CatalogKmerFilter.hh"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "graphcore/GraphBuilders.hh"
+#include "graphutils/SequenceOperations.hh"
+
+using graphtools::reverseComplement;
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+static string generateFlank(unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> baseIndex(0, 3);
+    string flank;
+    for (int position = 0; position != 300; ++position)
+    {
+        flank += "ACGT"[baseIndex(generator)];
+    }
+    return flank;
+}
+
+static string repeatUnit(const string& unit, int numUnits)
+{
+    string repeat;
+    for (int unitIndex = 0; unitIndex != numUnits; ++unitIndex)
+    {
+        repeat += unit;
+    }
+    return repeat;
+}
+
+class AssigningReadPairsByKmers : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        addLocus("common_locus", generateFlank(1), "CAG", generateFlank(2), VariantSubtype::kCommonRepeat);
+        addLocus("rare_locus", generateFlank(3), "CGG", generateFlank(4), VariantSubtype::kRareRepeat);
+    }
+
+    void addLocus(
+        const string& locusId, const string& leftFlank, const string& unit, const string& rightFlank,
+        VariantSubtype subtype)
+    {
+        LocusSpecification locusSpec(
+            locusId, { Region("chr1:1-2") }, AlleleCount::kTwo,
+            graphtools::makeStrGraph(leftFlank, unit, rightFlank));
+        locusSpec.addVariantSpecification(
+            locusId, VariantClassification(VariantType::kRepeat, subtype), Region("chr1:1-2"), { 1 }, 1);
+        catalog.emplace(locusId, locusSpec);
+    }
+
+    RegionCatalog catalog;
+};
+
+TEST_F(AssigningReadPairsByKmers, ReadsAnchoredInFlanks_AssignedToTheirLocus)
+{
+    CatalogKmerFilter kmerFilter(catalog, 150);
+    const string commonRead = generateFlank(1).substr(250) + repeatUnit("CAG", 30);
+    const string rareRead = repeatUnit("CGG", 30) + generateFlank(4).substr(0, 60);
+    const string irr = repeatUnit("CGG", 50);
+
+    EXPECT_EQ(0, kmerFilter.assignPair(commonRead, irr).targetLocusIndex);
+    EXPECT_EQ(1, kmerFilter.assignPair(irr, reverseComplement(rareRead)).targetLocusIndex);
+    EXPECT_TRUE(kmerFilter.assignPair(irr, rareRead).offtargetLocusIndexes.empty());
+}
+
+TEST_F(AssigningReadPairsByKmers, InRepeatReadsOfRareRepeat_AssignedToItsOfftargetRegions)
+{
+    CatalogKmerFilter kmerFilter(catalog, 150);
+    const string irr = repeatUnit("CGG", 50);
+    const string mate = reverseComplement(repeatUnit("GCG", 50));
+
+    const ReadPairAssignment assignment = kmerFilter.assignPair(irr, mate);
+    EXPECT_EQ(-1, assignment.targetLocusIndex);
+    EXPECT_EQ(vector<int>({ 1 }), assignment.offtargetLocusIndexes);
+
+    // Both reads must consist of the repeat
+    EXPECT_TRUE(kmerFilter.assignPair(irr, generateFlank(5).substr(0, 150)).offtargetLocusIndexes.empty());
+}
+
+TEST_F(AssigningReadPairsByKmers, UnrelatedReads_NotAssigned)
+{
+    CatalogKmerFilter kmerFilter(catalog, 150);
+    const string read = generateFlank(5).substr(0, 150);
+    const string mate = generateFlank(6).substr(0, 150);
+    const string commonIrr = repeatUnit("CAG", 50);
+
+    const ReadPairAssignment assignment = kmerFilter.assignPair(read, mate);
+    EXPECT_EQ(-1, assignment.targetLocusIndex);
+    EXPECT_TRUE(assignment.offtargetLocusIndexes.empty());
+    EXPECT_EQ(-1, kmerFilter.assignPair(commonIrr, commonIrr).targetLocusIndex);
+    EXPECT_TRUE(kmerFilter.assignPair(commonIrr, commonIrr).offtargetLocusIndexes.empty());
+}
@@ -0,0 +1,93 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "input/CatalogSharding.hh"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using std::string;
+using std::to_string;
+
+namespace ehunter
+{
+
+int64_t estimateLocusAnalysisCost(const LocusSpecification& locusSpec)
+{
+    // Reads are collected from a window of about 2kb around each target and offtarget region
+    const int64_t kCostPerReadRegion = 2000;
+    // Repeats are genotyped by evaluating every allele size supported by the reads
+    const int64_t kCostPerRepeat = 1000;
+
+    const graphtools::Graph& graph = locusSpec.regionGraph();
+    int64_t cost = 0;
+    for (graphtools::NodeId nodeId = 0; nodeId != static_cast<graphtools::NodeId>(graph.numNodes()); ++nodeId)
+    {
+        cost += graph.nodeSeq(nodeId).length();
+    }
+
+    const auto numReadRegions = locusSpec.referenceLoci().size() + locusSpec.offtargetLoci().size();
+    cost += kCostPerReadRegion * static_cast<int64_t>(numReadRegions);
+
+    for (const auto& variantSpec : locusSpec.variantSpecs())
+    {
+        if (variantSpec.classification().type == VariantType::kRepeat)
+        {
+            cost += kCostPerRepeat;
+        }
+    }
+
+    return cost;
+}
+
+RegionCatalog selectCatalogShard(const RegionCatalog& catalog, int shardIndex, int numShards)
+{
+    if (numShards < 1 || shardIndex < 0 || shardIndex >= numShards)
+    {
+        throw std::invalid_argument(
+            "Shard index " + to_string(shardIndex) + " is invalid for " + to_string(numShards) + " shards");
+    }
+
+    int64_t totalCost = 0;
+    for (const auto& locusIdAndLocusSpec : catalog)
+    {
+        totalCost += estimateLocusAnalysisCost(locusIdAndLocusSpec.second);
+    }
+
+    // A locus goes to the shard that covers the midpoint of its cost interval, so shards are contiguous in catalog
+    // order and the split depends only on the catalog
+    RegionCatalog shard;
+    int64_t precedingCost = 0;
+    for (const auto& locusIdAndLocusSpec : catalog)
+    {
+        const int64_t cost = estimateLocusAnalysisCost(locusIdAndLocusSpec.second);
+        const int64_t locusShardIndex = (2 * precedingCost + cost) * numShards / (2 * totalCost);
+        if (std::min<int64_t>(locusShardIndex, numShards - 1) == shardIndex)
+        {
+            shard.emplace(locusIdAndLocusSpec);
+        }
+        precedingCost += cost;
+    }
+
+    return shard;
+}
+
+}
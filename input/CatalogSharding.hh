@@ -0,0 +1,47 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Rough cost of analyzing a locus in arbitrary units; it grows with the size of the locus graph, the number of regions
+// that reads are collected from, and the number of repeats to genotype
+int64_t estimateLocusAnalysisCost(const LocusSpecification& locusSpec);
+
+/**
+ * Selects the loci analyzed by one of several runs that split a catalog between them
+ *
+ * The catalog is split into consecutive runs of loci with approximately equal total cost, so the outputs of the shards
+ * concatenated in the order of their indexes contain the records of an unsplit run in the same order.
+ *
+ * @param catalog: Full catalog
+ * @param shardIndex: 0-based index of the shard
+ * @param numShards: Number of shards the catalog is split into
+ * @return Loci of the shard
+ */
+RegionCatalog selectCatalogShard(const RegionCatalog& catalog, int shardIndex, int numShards);
+
+}
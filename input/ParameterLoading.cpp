@@ -21,12 +21,15 @@
 #include "input/ParameterLoading.hh"
 
 #include <iostream>
+#include <set>
+#include <sstream>
 #include <vector>
 
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
 #include <boost/program_options.hpp>
 
+#include "input/SampleManifest.hh"
 #include "input/SampleStats.hh"
 #include "src/Version.hh"
 
@@ -45,12 +48,23 @@ struct UserParameters
 {
     // Input file paths
     string htsFilePath;
+    string manifestPath;
     string referencePath;
     string catalogPath;
 
     // Output prefix
     string outputPrefix;
 
+    // Output parameters
+    bool compressVcf;
+    string vcfIndexFormatEncoding;
+    int numCompressionThreads;
+    bool writeAlignmentLog;
+    bool writeRealignedBam;
+    bool resumeFromCheckpoint;
+    bool writeMetrics;
+    bool writeReadCounts;
+
     // Sample parameters
     optional<int> optionalReadLength;
     optional<double> optionalGenomeCoverage;
@@ -59,9 +73,18 @@ struct UserParameters
     // Heuristic parameters
     bool verboseLogging;
     string alignerType;
+    bool trimLowQualityBases;
+    bool useKmerPrefilter;
     int regionExtensionLength;
     int qualityCutoffForGoodBaseCall;
     bool skipUnaligned;
+
+    // Batch and service parameters
+    int numThreads;
+    bool serveJobs;
+
+    // Catalog shard encoded as i/N
+    string catalogShardEncoding;
 };
 
 boost::optional<UserParameters> tryParsingUserParameters(int argc, char** argv)
@@ -73,15 +96,29 @@ boost::optional<UserParameters> tryParsingUserParameters(int argc, char** argv)
     usage.add_options()
       ("help", "Print help message")
       ("version", "Print version number")
-      ("reads", po::value<string>(&params.htsFilePath)->required(), "BAM/CRAM file with aligned reads")
+      ("reads", po::value<string>(&params.htsFilePath), "BAM/CRAM file with aligned reads")
+      ("manifest", po::value<string>(&params.manifestPath), "Tab-separated file listing BAM/CRAM files, sexes, read lengths, and coverages of samples to analyze in batch mode")
       ("reference", po::value<string>(&params.referencePath)->required(), "FASTA file with reference genome")
       ("variant-catalog", po::value<string>(&params.catalogPath)->required(), "JSON file with variants to genotype")
-      ("output-prefix", po::value<string>(&params.outputPrefix)->required(), "Prefix for the output files")
+      ("output-prefix", po::value<string>(&params.outputPrefix), "Prefix for the output files")
+      ("bgzip-vcf", po::bool_switch(&params.compressVcf)->default_value(false), "Write bgzip-compressed VCF (.vcf.gz)")
+      ("vcf-index", po::value<string>(&params.vcfIndexFormatEncoding)->default_value("tbi"), "Index of bgzip-compressed VCF; must be tbi, csi, or none")
+      ("compression-threads", po::value<int>(&params.numCompressionThreads)->default_value(1), "Number of threads used to compress the output")
+      ("alignment-log", po::bool_switch(&params.writeAlignmentLog)->default_value(false), "Write alignments of informative reads to a YAML log (.log)")
+      ("realigned-bam", po::bool_switch(&params.writeRealignedBam)->default_value(false), "Write informative reads with their graph alignments to a BAM file (_realigned.bam)")
+      ("resume", po::bool_switch(&params.resumeFromCheckpoint)->default_value(false), "Skip loci saved to the checkpoint (.checkpoint) of an interrupted run")
+      ("metrics", po::bool_switch(&params.writeMetrics)->default_value(false), "Write time spent on each stage of the analysis of every locus to a JSON file (.metrics.json)")
+      ("save-read-counts", po::bool_switch(&params.writeReadCounts)->default_value(false), "Save read counts of every locus to a binary file (.counts) for the regenotype command")
       ("region-extension-length", po::value<int>(&params.regionExtensionLength)->default_value(1000), "How far from on/off-target regions to search for informative reads")
       ("read-length", po::value<int>(), "Read length")
       ("genome-coverage", po::value<double>(), "Read depth on diploid chromosomes")
       ("sex", po::value<string>(&params.sampleSexEncoding)->default_value("female"), "Sex of the sample; must be either male or female")
-      ("aligner", po::value<string>(&params.alignerType)->default_value("dag-aligner"), "dag-aligner or path-aligner")
+      ("aligner", po::value<string>(&params.alignerType)->default_value("dag-aligner"), "dag-aligner, path-aligner, or auto")
+      ("trim-low-quality-bases", po::bool_switch(&params.trimLowQualityBases)->default_value(false), "Softclip low-quality bases at read ends before alignment")
+      ("kmer-prefilter", po::bool_switch(&params.useKmerPrefilter)->default_value(false), "Assign unmapped reads and reads aligned away from all loci by kmers of the loci")
+      ("threads", po::value<int>(&params.numThreads)->default_value(1), "Number of samples analyzed concurrently in batch or service mode")
+      ("shard", po::value<string>(&params.catalogShardEncoding), "Analyze only the i-th of N parts of the catalog specified as i/N")
+      ("serve", po::bool_switch(&params.serveJobs)->default_value(false), "Keep the catalog loaded and analyze jobs read from standard input")
       ("verbose-logging", po::bool_switch(&params.verboseLogging)->default_value(false), "Enable verbose logging");
     // clang-format on
 
@@ -121,6 +158,27 @@ boost::optional<UserParameters> tryParsingUserParameters(int argc, char** argv)
     return params;
 }
 
+static CatalogShard decodeCatalogShard(const string& encoding)
+{
+    if (encoding.empty())
+    {
+        return CatalogShard();
+    }
+
+    std::istringstream encodingStream(encoding);
+    int shardNumber = 0;
+    int numShards = 0;
+    char separator = 0;
+    encodingStream >> shardNumber >> separator >> numShards;
+    if (!encodingStream || !encodingStream.eof() || separator != '/' || numShards < 1 || shardNumber < 1
+        || shardNumber > numShards)
+    {
+        throw std::invalid_argument(encoding + " is not a valid shard; expected i/N with i between 1 and N");
+    }
+
+    return CatalogShard(shardNumber - 1, numShards);
+}
+
 static void assertWritablePath(const string& pathEncoding)
 {
     const fs::path path(pathEncoding);
@@ -161,16 +219,27 @@ static void assertIndexExists(const string& htsFilePath)
     throw std::invalid_argument("Could not find index of " + htsFilePath);
 }
 
-void assertValidity(const UserParameters& userParameters)
+static void assertOutputParameterValidity(const UserParameters& userParameters)
 {
-    // Validate input file paths
+    const auto& indexFormatEncoding = userParameters.vcfIndexFormatEncoding;
+    if (indexFormatEncoding != "tbi" && indexFormatEncoding != "csi" && indexFormatEncoding != "none")
+    {
+        throw std::invalid_argument(indexFormatEncoding + " is not a valid VCF index format");
+    }
+
+    const int kMaxCompressionThreads = 64;
+    if (userParameters.numCompressionThreads < 1 || userParameters.numCompressionThreads > kMaxCompressionThreads)
+    {
+        throw std::invalid_argument(
+            "Number of compression threads must be between 1 and " + to_string(kMaxCompressionThreads));
+    }
+}
+
+static void assertSampleValidity(const UserParameters& userParameters)
+{
+    // Validate reads
     assertPathToExistingFile(userParameters.htsFilePath);
     assertIndexExists(userParameters.htsFilePath);
-    assertPathToExistingFile(userParameters.referencePath);
-    assertPathToExistingFile(userParameters.catalogPath);
-
-    // Validate output prefix
-    assertWritablePath(userParameters.outputPrefix);
 
     // Validate sample parameters
     if (userParameters.optionalReadLength)
@@ -194,9 +263,62 @@ void assertValidity(const UserParameters& userParameters)
     {
         throw std::invalid_argument(userParameters.sampleSexEncoding + " is not a valid sex encoding");
     }
+}
+
+void assertValidity(const UserParameters& userParameters)
+{
+    // Validate input file paths
+    const bool isBatchMode = !userParameters.manifestPath.empty();
+    if (userParameters.serveJobs)
+    {
+        // Jobs specify their own reads and output prefixes
+        if (!userParameters.htsFilePath.empty() || isBatchMode || !userParameters.outputPrefix.empty())
+        {
+            throw std::invalid_argument("--reads, --manifest, and --output-prefix cannot be used with --serve");
+        }
+        // Standard output is reserved for job reports
+        if (userParameters.verboseLogging)
+        {
+            throw std::invalid_argument("--verbose-logging cannot be used with --serve");
+        }
+    }
+    else if (userParameters.htsFilePath.empty() == !isBatchMode)
+    {
+        throw std::invalid_argument("Either --reads or --manifest must be specified but not both");
+    }
+    else if (isBatchMode)
+    {
+        assertPathToExistingFile(userParameters.manifestPath);
+    }
+    else
+    {
+        assertSampleValidity(userParameters);
+    }
+    assertPathToExistingFile(userParameters.referencePath);
+    assertPathToExistingFile(userParameters.catalogPath);
+
+    // Validate output prefix
+    if (!userParameters.serveJobs)
+    {
+        if (userParameters.outputPrefix.empty())
+        {
+            throw std::invalid_argument("--output-prefix must be specified");
+        }
+        assertWritablePath(userParameters.outputPrefix);
+    }
+
+    // Validate output parameters
+    assertOutputParameterValidity(userParameters);
+
+    // Read counts of the loci saved to a checkpoint are not kept
+    if (userParameters.writeReadCounts && userParameters.resumeFromCheckpoint)
+    {
+        throw std::invalid_argument("--save-read-counts cannot be used with --resume");
+    }
 
     // Heuristic parameters
-    if (userParameters.alignerType != "dag-aligner" && userParameters.alignerType != "path-aligner")
+    if (userParameters.alignerType != "dag-aligner" && userParameters.alignerType != "path-aligner"
+        && userParameters.alignerType != "auto")
     {
         throw std::invalid_argument(userParameters.alignerType + " is not a valid aligner type");
     }
@@ -222,6 +344,14 @@ void assertValidity(const UserParameters& userParameters)
             + to_string(kMinQualityCutoffForGoodBaseCall) + " and " + to_string(kMaxQualityCutoffForGoodBaseCall);
         throw std::invalid_argument(message);
     }
+
+    decodeCatalogShard(userParameters.catalogShardEncoding);
+
+    const int kMaxThreads = 256;
+    if (userParameters.numThreads < 1 || userParameters.numThreads > kMaxThreads)
+    {
+        throw std::invalid_argument("Number of threads must be between 1 and " + to_string(kMaxThreads));
+    }
 }
 
 SampleParameters decodeSampleParameters(const UserParameters& userParams)
@@ -245,6 +375,59 @@ SampleParameters decodeSampleParameters(const UserParameters& userParams)
     }
 }
 
+OutputParameters decodeOutputParameters(const UserParameters& userParams)
+{
+    VcfIndexFormat vcfIndexFormat = VcfIndexFormat::kNone;
+    if (userParams.compressVcf && userParams.vcfIndexFormatEncoding == "tbi")
+    {
+        vcfIndexFormat = VcfIndexFormat::kTbi;
+    }
+    else if (userParams.compressVcf && userParams.vcfIndexFormatEncoding == "csi")
+    {
+        vcfIndexFormat = VcfIndexFormat::kCsi;
+    }
+
+    return OutputParameters(
+        userParams.compressVcf, vcfIndexFormat, userParams.numCompressionThreads, userParams.writeAlignmentLog,
+        userParams.writeRealignedBam, userParams.resumeFromCheckpoint, userParams.writeMetrics,
+        userParams.writeReadCounts);
+}
+
+static SampleTask decodeSampleTask(const UserParameters& userParams, const string& outputPrefix)
+{
+    InputPaths inputPaths(userParams.htsFilePath, userParams.referencePath, userParams.catalogPath);
+    const string vcfPath = outputPrefix + (userParams.compressVcf ? ".vcf.gz" : ".vcf");
+    const string jsonPath = outputPrefix + ".json";
+    const string logPath = outputPrefix + ".log";
+    const string bamPath = outputPrefix + "_realigned.bam";
+    const string checkpointPath = outputPrefix + ".checkpoint";
+    const string metricsPath = outputPrefix + ".metrics.json";
+    const string readCountsPath = outputPrefix + ".counts";
+    OutputPaths outputPaths(vcfPath, jsonPath, logPath, bamPath, checkpointPath, metricsPath, readCountsPath);
+
+    return SampleTask(inputPaths, outputPaths, decodeSampleParameters(userParams));
+}
+
+// Fields missing from a manifest line or a job take their values from the command line
+static UserParameters applyManifestEntry(const UserParameters& userParams, const SampleManifestEntry& manifestEntry)
+{
+    UserParameters sampleUserParams = userParams;
+    sampleUserParams.htsFilePath = manifestEntry.htsFilePath;
+    if (manifestEntry.optionalSexEncoding)
+    {
+        sampleUserParams.sampleSexEncoding = *manifestEntry.optionalSexEncoding;
+    }
+    if (manifestEntry.optionalReadLength)
+    {
+        sampleUserParams.optionalReadLength = manifestEntry.optionalReadLength;
+    }
+    if (manifestEntry.optionalGenomeCoverage)
+    {
+        sampleUserParams.optionalGenomeCoverage = manifestEntry.optionalGenomeCoverage;
+    }
+    return sampleUserParams;
+}
+
 boost::optional<ProgramParameters> tryLoadingProgramParameters(int argc, char** argv)
 {
     auto optionalUserParameters = tryParsingUserParameters(argc, argv);
@@ -256,17 +439,180 @@ boost::optional<ProgramParameters> tryLoadingProgramParameters(int argc, char**
     const auto& userParams = *optionalUserParameters;
     assertValidity(userParams);
 
-    InputPaths inputPaths(userParams.htsFilePath, userParams.referencePath, userParams.catalogPath);
-    const string vcfPath = userParams.outputPrefix + ".vcf";
-    const string jsonPath = userParams.outputPrefix + ".json";
-    const string logPath = userParams.outputPrefix + ".log";
-    OutputPaths outputPaths(vcfPath, jsonPath, logPath);
-    SampleParameters sampleParameters = decodeSampleParameters(userParams);
+    vector<SampleTask> sampleTasks;
+    optional<ServiceParameters> optionalServiceParameters;
+    if (userParams.serveJobs)
+    {
+        auto jobDecoder = [userParams](const string& jobEncoding) {
+            const ServiceJob job = decodeServiceJob(jobEncoding);
+            assertWritablePath(job.outputPrefix);
+            const UserParameters sampleUserParams = applyManifestEntry(userParams, job.sample);
+            assertSampleValidity(sampleUserParams);
+            return decodeSampleTask(sampleUserParams, job.outputPrefix);
+        };
+        optionalServiceParameters = ServiceParameters(userParams.referencePath, userParams.catalogPath, jobDecoder);
+    }
+    else if (userParams.manifestPath.empty())
+    {
+        sampleTasks.push_back(decodeSampleTask(userParams, userParams.outputPrefix));
+    }
+    else
+    {
+        std::set<string> sampleIds;
+        for (const auto& manifestEntry : loadSampleManifestFromDisk(userParams.manifestPath))
+        {
+            const UserParameters sampleUserParams = applyManifestEntry(userParams, manifestEntry);
+            assertSampleValidity(sampleUserParams);
+
+            const string sampleId = fs::path(sampleUserParams.htsFilePath).stem().string();
+            if (!sampleIds.insert(sampleId).second)
+            {
+                throw std::invalid_argument("Manifest lists more than one sample with id " + sampleId);
+            }
+            sampleTasks.push_back(decodeSampleTask(sampleUserParams, userParams.outputPrefix + "_" + sampleId));
+        }
+    }
+
+    OutputParameters outputParameters = decodeOutputParameters(userParams);
+    const int kKmerLenForAlignment = 14;
+    const int kPaddingLength = 10;
+    const int kSeedAffixTrimLength = 5;
     HeuristicParameters heuristicParameters(
         userParams.verboseLogging, userParams.regionExtensionLength, userParams.qualityCutoffForGoodBaseCall,
-        userParams.skipUnaligned, userParams.alignerType);
+        userParams.skipUnaligned, userParams.alignerType, kKmerLenForAlignment, kPaddingLength, kSeedAffixTrimLength,
+        userParams.trimLowQualityBases, userParams.useKmerPrefilter);
+
+    return ProgramParameters(
+        sampleTasks, outputParameters, heuristicParameters, userParams.numThreads, optionalServiceParameters,
+        decodeCatalogShard(userParams.catalogShardEncoding));
+}
+
+boost::optional<MergeParameters> tryLoadingMergeParameters(int argc, char** argv)
+{
+    UserParameters params;
+    vector<string> shardOutputPrefixes;
+
+    // clang-format off
+    po::options_description usage("Usage: ExpansionHunter merge [options] <output prefixes of shards 1..N>\nAllowed options");
+    usage.add_options()
+      ("help", "Print help message")
+      ("output-prefix", po::value<string>(&params.outputPrefix)->required(), "Prefix for the merged output files")
+      ("bgzip-vcf", po::bool_switch(&params.compressVcf)->default_value(false), "Write bgzip-compressed VCF (.vcf.gz)")
+      ("vcf-index", po::value<string>(&params.vcfIndexFormatEncoding)->default_value("tbi"), "Index of bgzip-compressed VCF; must be tbi, csi, or none")
+      ("compression-threads", po::value<int>(&params.numCompressionThreads)->default_value(1), "Number of threads used to compress the output");
+    // clang-format on
+
+    po::options_description hiddenOptions;
+    hiddenOptions.add_options()("shard-prefix", po::value<vector<string>>(&shardOutputPrefixes));
+    po::positional_options_description positionalOptions;
+    positionalOptions.add("shard-prefix", -1);
+
+    po::options_description allOptions;
+    allOptions.add(usage).add(hiddenOptions);
+
+    if (argc == 1)
+    {
+        std::cerr << usage << std::endl;
+        return boost::optional<MergeParameters>();
+    }
+
+    po::variables_map argumentMap;
+    po::store(
+        po::command_line_parser(argc, argv).options(allOptions).positional(positionalOptions).run(), argumentMap);
+
+    if (argumentMap.count("help"))
+    {
+        std::cerr << usage << std::endl;
+        return boost::optional<MergeParameters>();
+    }
+
+    po::notify(argumentMap);
+
+    if (shardOutputPrefixes.empty())
+    {
+        throw std::invalid_argument("Output prefixes of the shards to merge must be specified");
+    }
+    assertWritablePath(params.outputPrefix);
+
+    assertOutputParameterValidity(params);
+
+    params.writeAlignmentLog = false;
+    params.writeRealignedBam = false;
+    params.resumeFromCheckpoint = false;
+    params.writeMetrics = false;
+    params.writeReadCounts = false;
+    return MergeParameters(shardOutputPrefixes, params.outputPrefix, decodeOutputParameters(params));
+}
+
+boost::optional<RegenotypeParameters> tryLoadingRegenotypeParameters(int argc, char** argv)
+{
+    UserParameters params;
+    string readCountsPath;
+
+    // clang-format off
+    po::options_description usage("Usage: ExpansionHunter regenotype [options]\nAllowed options");
+    usage.add_options()
+      ("help", "Print help message")
+      ("read-counts", po::value<string>(&readCountsPath)->required(), "Read counts saved with --save-read-counts (.counts)")
+      ("reference", po::value<string>(&params.referencePath)->required(), "FASTA file with reference genome")
+      ("variant-catalog", po::value<string>(&params.catalogPath)->required(), "JSON file with variants to genotype")
+      ("output-prefix", po::value<string>(&params.outputPrefix)->required(), "Prefix for the output files")
+      ("bgzip-vcf", po::bool_switch(&params.compressVcf)->default_value(false), "Write bgzip-compressed VCF (.vcf.gz)")
+      ("vcf-index", po::value<string>(&params.vcfIndexFormatEncoding)->default_value("tbi"), "Index of bgzip-compressed VCF; must be tbi, csi, or none")
+      ("compression-threads", po::value<int>(&params.numCompressionThreads)->default_value(1), "Number of threads used to compress the output")
+      ("genome-coverage", po::value<double>(), "Read depth on diploid chromosomes; overrides the depth saved with the read counts")
+      ("sex", po::value<string>(&params.sampleSexEncoding), "Sex of the sample; overrides the sex saved with the read counts");
+    // clang-format on
+
+    if (argc == 1)
+    {
+        std::cerr << usage << std::endl;
+        return boost::optional<RegenotypeParameters>();
+    }
+
+    po::variables_map argumentMap;
+    po::store(po::command_line_parser(argc, argv).options(usage).run(), argumentMap);
+
+    if (argumentMap.count("help"))
+    {
+        std::cerr << usage << std::endl;
+        return boost::optional<RegenotypeParameters>();
+    }
+
+    po::notify(argumentMap);
+
+    assertPathToExistingFile(readCountsPath);
+    assertPathToExistingFile(params.referencePath);
+    assertPathToExistingFile(params.catalogPath);
+    assertWritablePath(params.outputPrefix);
+    assertOutputParameterValidity(params);
+
+    optional<Sex> optionalSex;
+    if (argumentMap.count("sex"))
+    {
+        optionalSex = decodeSampleSex(params.sampleSexEncoding);
+    }
+
+    optional<double> optionalHaplotypeDepth;
+    if (argumentMap.count("genome-coverage"))
+    {
+        const double genomeCoverage = argumentMap["genome-coverage"].as<double>();
+        const double kMinDepthAllowed = 10.0;
+        if (genomeCoverage < kMinDepthAllowed)
+        {
+            throw std::invalid_argument("Read depth must be at least " + std::to_string(kMinDepthAllowed));
+        }
+        optionalHaplotypeDepth = genomeCoverage / 2;
+    }
 
-    return ProgramParameters(inputPaths, outputPaths, sampleParameters, heuristicParameters);
+    params.writeAlignmentLog = false;
+    params.writeRealignedBam = false;
+    params.resumeFromCheckpoint = false;
+    params.writeMetrics = false;
+    params.writeReadCounts = false;
+    return RegenotypeParameters(
+        readCountsPath, params.referencePath, params.catalogPath, params.outputPrefix, optionalSex,
+        optionalHaplotypeDepth, decodeOutputParameters(params));
 }
 
 }
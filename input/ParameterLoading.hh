@@ -29,4 +29,10 @@ namespace ehunter
 
 boost::optional<ProgramParameters> tryLoadingProgramParameters(int argc, char** argv);
 
+// Parses arguments of the merge command; argv[0] is the name of the command
+boost::optional<MergeParameters> tryLoadingMergeParameters(int argc, char** argv);
+
+// Parses arguments of the regenotype command; argv[0] is the name of the command
+boost::optional<RegenotypeParameters> tryLoadingRegenotypeParameters(int argc, char** argv);
+
 }
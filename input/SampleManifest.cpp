@@ -0,0 +1,138 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "input/SampleManifest.hh"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+using boost::optional;
+using std::string;
+using std::to_string;
+using std::vector;
+
+namespace ehunter
+{
+
+static optional<string> decodeOptionalField(const vector<string>& fields, size_t index)
+{
+    if (index >= fields.size() || fields[index] == ".")
+    {
+        return optional<string>();
+    }
+    return fields[index];
+}
+
+template <typename T>
+static optional<T> decodeOptionalNumber(const vector<string>& fields, size_t index, const string& lineDescription)
+{
+    const optional<string> optionalField = decodeOptionalField(fields, index);
+    if (!optionalField)
+    {
+        return optional<T>();
+    }
+
+    std::istringstream fieldStream(*optionalField);
+    T number;
+    if (!(fieldStream >> number) || !fieldStream.eof())
+    {
+        throw std::invalid_argument(lineDescription + " contains invalid numeric field " + *optionalField);
+    }
+
+    return number;
+}
+
+// Decodes sample fields that start at the given position of a manifest line or a job
+static SampleManifestEntry
+decodeSampleFields(const vector<string>& fields, size_t firstIndex, const string& lineDescription)
+{
+    const size_t kMaxNumSampleFields = 4;
+    if (fields.size() <= firstIndex || fields.size() > firstIndex + kMaxNumSampleFields || fields[firstIndex].empty())
+    {
+        throw std::invalid_argument(lineDescription + " is malformed");
+    }
+
+    SampleManifestEntry entry;
+    entry.htsFilePath = fields[firstIndex];
+    entry.optionalSexEncoding = decodeOptionalField(fields, firstIndex + 1);
+    entry.optionalReadLength = decodeOptionalNumber<int>(fields, firstIndex + 2, lineDescription);
+    entry.optionalGenomeCoverage = decodeOptionalNumber<double>(fields, firstIndex + 3, lineDescription);
+    return entry;
+}
+
+vector<SampleManifestEntry> decodeSampleManifest(std::istream& manifestStream)
+{
+    vector<SampleManifestEntry> entries;
+    string line;
+    int lineNum = 0;
+    while (std::getline(manifestStream, line))
+    {
+        ++lineNum;
+        boost::trim_right(line);
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+
+        vector<string> fields;
+        boost::split(fields, line, boost::is_any_of("\t"));
+        entries.push_back(decodeSampleFields(fields, 0, "Manifest line " + to_string(lineNum)));
+    }
+
+    if (entries.empty())
+    {
+        throw std::invalid_argument("Manifest does not list any samples");
+    }
+
+    return entries;
+}
+
+ServiceJob decodeServiceJob(const string& jobEncoding)
+{
+    const string trimmedEncoding = boost::trim_right_copy(jobEncoding);
+    vector<string> fields;
+    boost::split(fields, trimmedEncoding, boost::is_any_of("\t"));
+    if (fields.front().empty())
+    {
+        throw std::invalid_argument("Job " + trimmedEncoding + " does not specify output prefix");
+    }
+
+    ServiceJob job;
+    job.outputPrefix = fields.front();
+    job.sample = decodeSampleFields(fields, 1, "Job " + trimmedEncoding);
+    return job;
+}
+
+vector<SampleManifestEntry> loadSampleManifestFromDisk(const string& manifestPath)
+{
+    std::ifstream manifestStream(manifestPath.c_str());
+
+    if (!manifestStream.is_open())
+    {
+        throw std::runtime_error("Failed to open manifest file " + manifestPath);
+    }
+
+    return decodeSampleManifest(manifestStream);
+}
+
+}
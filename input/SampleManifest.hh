@@ -0,0 +1,72 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace ehunter
+{
+
+// Sample listed in a batch manifest; unset fields default to the values given on the command line
+struct SampleManifestEntry
+{
+    std::string htsFilePath;
+    boost::optional<std::string> optionalSexEncoding;
+    boost::optional<int> optionalReadLength;
+    boost::optional<double> optionalGenomeCoverage;
+};
+
+/**
+ * Decodes a manifest of samples to analyze in batch mode
+ *
+ * Each line lists tab-separated path to a BAM/CRAM file, sex, read length, and genome coverage of a sample. Only the
+ * path is required; trailing fields can be omitted and any field other than the path can be set to "." to leave it
+ * unset. Empty lines and lines starting with "#" are skipped.
+ *
+ * @param manifestStream: Stream with manifest lines
+ * @return Manifest entries in the order of the lines
+ */
+std::vector<SampleManifestEntry> decodeSampleManifest(std::istream& manifestStream);
+
+std::vector<SampleManifestEntry> loadSampleManifestFromDisk(const std::string& manifestPath);
+
+// Analysis job submitted to a running service
+struct ServiceJob
+{
+    std::string outputPrefix;
+    SampleManifestEntry sample;
+};
+
+/**
+ * Decodes a job submitted to a running service
+ *
+ * A job consists of tab-separated output prefix followed by the fields of a manifest line describing the sample.
+ *
+ * @param jobEncoding: Single line encoding the job
+ * @return Decoded job
+ */
+ServiceJob decodeServiceJob(const std::string& jobEncoding);
+
+}
@@ -0,0 +1,90 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "input/CatalogSharding.hh"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "input/GraphBlueprint.hh"
+#include "input/RegionGraph.hh"
+
+using graphtools::Graph;
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+static RegionCatalog makeCatalog(const vector<string>& locusStructures)
+{
+    RegionCatalog catalog;
+    for (size_t locusIndex = 0; locusIndex != locusStructures.size(); ++locusIndex)
+    {
+        const string locusId = "locus" + std::to_string(locusIndex);
+        Graph graph = makeRegionGraph(decodeFeaturesFromRegex(locusStructures[locusIndex]));
+        LocusSpecification locusSpec(locusId, { Region("chr1:1-2") }, AlleleCount::kTwo, graph);
+        catalog.emplace(locusId, std::move(locusSpec));
+    }
+    return catalog;
+}
+
+TEST(ShardingCatalogs, TypicalCatalog_SplitIntoConsecutiveLoci)
+{
+    const string longFlank(3000, 'A');
+    const string shortLocus = "ATTCGA(C)*ATGTCG";
+    const RegionCatalog catalog = makeCatalog(
+        { shortLocus, longFlank + "(CAG)*" + longFlank, shortLocus, shortLocus, shortLocus, shortLocus });
+
+    const int numShards = 3;
+    vector<string> shardedLocusIds;
+    for (int shardIndex = 0; shardIndex != numShards; ++shardIndex)
+    {
+        const RegionCatalog shard = selectCatalogShard(catalog, shardIndex, numShards);
+        EXPECT_FALSE(shard.empty());
+        for (const auto& locusIdAndLocusSpec : shard)
+        {
+            shardedLocusIds.push_back(locusIdAndLocusSpec.first);
+        }
+    }
+
+    // Each locus is in exactly one shard, and shards follow catalog order
+    const vector<string> expectedLocusIds = { "locus0", "locus1", "locus2", "locus3", "locus4", "locus5" };
+    EXPECT_EQ(expectedLocusIds, shardedLocusIds);
+
+    // The costly locus is not grouped with most of the others
+    EXPECT_GE(3u, selectCatalogShard(catalog, 0, numShards).size());
+}
+
+TEST(ShardingCatalogs, MoreShardsThanLoci_EachLocusSelectedOnce)
+{
+    const RegionCatalog catalog = makeCatalog({ "ATTCGA(C)*ATGTCG", "ATTCGA(C)*ATGTCG" });
+
+    size_t numSelectedLoci = 0;
+    for (int shardIndex = 0; shardIndex != 5; ++shardIndex)
+    {
+        numSelectedLoci += selectCatalogShard(catalog, shardIndex, 5).size();
+    }
+    EXPECT_EQ(2u, numSelectedLoci);
+
+    EXPECT_THROW(selectCatalogShard(catalog, 5, 5), std::invalid_argument);
+}
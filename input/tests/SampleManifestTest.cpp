@@ -0,0 +1,82 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "input/SampleManifest.hh"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+TEST(DecodingSampleManifests, TypicalManifest_Decoded)
+{
+    std::istringstream manifestStream("# reads\tsex\tread_length\tgenome_coverage\n"
+                                      "/data/sample1.bam\tmale\t150\t30.5\n"
+                                      "\n"
+                                      "/data/sample2.cram\t.\t.\t40\n"
+                                      "/data/sample3.bam\n");
+
+    const vector<SampleManifestEntry> entries = decodeSampleManifest(manifestStream);
+
+    ASSERT_EQ(3ul, entries.size());
+    EXPECT_EQ("/data/sample1.bam", entries[0].htsFilePath);
+    EXPECT_EQ(string("male"), *entries[0].optionalSexEncoding);
+    EXPECT_EQ(150, *entries[0].optionalReadLength);
+    EXPECT_DOUBLE_EQ(30.5, *entries[0].optionalGenomeCoverage);
+
+    EXPECT_EQ("/data/sample2.cram", entries[1].htsFilePath);
+    EXPECT_FALSE(entries[1].optionalSexEncoding);
+    EXPECT_FALSE(entries[1].optionalReadLength);
+    EXPECT_DOUBLE_EQ(40.0, *entries[1].optionalGenomeCoverage);
+
+    EXPECT_EQ("/data/sample3.bam", entries[2].htsFilePath);
+    EXPECT_FALSE(entries[2].optionalSexEncoding);
+    EXPECT_FALSE(entries[2].optionalGenomeCoverage);
+}
+
+TEST(DecodingSampleManifests, MalformedManifests_ExceptionThrown)
+{
+    std::istringstream emptyManifest("# reads\tsex\n");
+    EXPECT_THROW(decodeSampleManifest(emptyManifest), std::invalid_argument);
+
+    std::istringstream manifestWithInvalidReadLength("/data/sample1.bam\tmale\t150bp\n");
+    EXPECT_THROW(decodeSampleManifest(manifestWithInvalidReadLength), std::invalid_argument);
+
+    std::istringstream manifestWithExtraFields("/data/sample1.bam\tmale\t150\t30\tNA12878\n");
+    EXPECT_THROW(decodeSampleManifest(manifestWithExtraFields), std::invalid_argument);
+}
+
+TEST(DecodingServiceJobs, TypicalJobs_Decoded)
+{
+    const ServiceJob job = decodeServiceJob("/out/sample1\t/data/sample1.bam\tmale\t.\t30\n");
+    EXPECT_EQ("/out/sample1", job.outputPrefix);
+    EXPECT_EQ("/data/sample1.bam", job.sample.htsFilePath);
+    EXPECT_EQ(string("male"), *job.sample.optionalSexEncoding);
+    EXPECT_FALSE(job.sample.optionalReadLength);
+    EXPECT_DOUBLE_EQ(30.0, *job.sample.optionalGenomeCoverage);
+
+    EXPECT_THROW(decodeServiceJob("/out/sample1"), std::invalid_argument);
+    EXPECT_THROW(decodeServiceJob("\t/data/sample1.bam"), std::invalid_argument);
+    EXPECT_THROW(decodeServiceJob("/out/sample1\t/data/sample1.bam\tmale\t150\t30\tNA12878"), std::invalid_argument);
+}
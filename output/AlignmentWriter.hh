@@ -0,0 +1,75 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "graphalign/GraphAlignment.hh"
+
+#include "reads/Read.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Receives reads realigned to locus graphs; the read sequence is given in the orientation it was aligned in
+class AlignmentWriter
+{
+public:
+    virtual ~AlignmentWriter() = default;
+
+    virtual void write(
+        const LocusSpecification& locusSpec, const reads::Read& read, const graphtools::GraphAlignment& alignment)
+        = 0;
+    virtual void close() = 0;
+};
+
+// Passes alignments on to each of the added writers; discards them if no writers were added
+class CompositeAlignmentWriter : public AlignmentWriter
+{
+public:
+    void add(std::unique_ptr<AlignmentWriter> writerPtr) { writerPtrs_.push_back(std::move(writerPtr)); }
+
+    void write(
+        const LocusSpecification& locusSpec, const reads::Read& read,
+        const graphtools::GraphAlignment& alignment) override
+    {
+        for (auto& writerPtr : writerPtrs_)
+        {
+            writerPtr->write(locusSpec, read, alignment);
+        }
+    }
+
+    void close() override
+    {
+        for (auto& writerPtr : writerPtrs_)
+        {
+            writerPtr->close();
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<AlignmentWriter>> writerPtrs_;
+};
+
+}
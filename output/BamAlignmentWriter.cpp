@@ -0,0 +1,208 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/BamAlignmentWriter.hh"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "graphIO/BamWriter.hh"
+#include "graphcore/GraphReferenceMapping.hh"
+
+namespace ehunter
+{
+
+using graphtools::GraphAlignment;
+using graphtools::GraphReferenceMapping;
+using graphtools::ReferenceInterval;
+using std::string;
+using std::unique_ptr;
+
+static graphIO::ReferenceContigs convertContigInfo(const BamAlignmentWriter::ContigInfo& contigs)
+{
+    graphIO::ReferenceContigs bamContigs;
+    for (const auto& contig : contigs)
+    {
+        if (contig.second < 0 || contig.second > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("Contig " + contig.first + " is too long to be written to a BAM header");
+        }
+        bamContigs.emplace_back(contig.first, static_cast<uint32_t>(contig.second));
+    }
+
+    return bamContigs;
+}
+
+// Maps the flanks of a locus graph to the reference so that records can be placed next to their locus
+struct BamAlignmentWriter::LocusPlacement
+{
+    explicit LocusPlacement(const LocusSpecification& locusSpec)
+        : graphPtr(&locusSpec.regionGraph())
+        , contig(locusSpec.referenceLoci().front().chrom())
+        , locusStart(locusSpec.referenceLoci().front().start())
+        , referenceMapping(graphPtr)
+    {
+        int64_t locusEnd = locusSpec.referenceLoci().front().end();
+        for (const auto& referenceLocus : locusSpec.referenceLoci())
+        {
+            locusStart = std::min(locusStart, referenceLocus.start());
+            locusEnd = std::max(locusEnd, referenceLocus.end());
+        }
+
+        const auto& graph = locusSpec.regionGraph();
+        const graphtools::NodeId leftFlankNode = 0;
+        const graphtools::NodeId rightFlankNode = graph.numNodes() - 1;
+        const int64_t leftFlankLength = graph.nodeSeq(leftFlankNode).length();
+        const int64_t rightFlankLength = graph.nodeSeq(rightFlankNode).length();
+        referenceMapping.addMapping(leftFlankNode, ReferenceInterval(contig, locusStart - leftFlankLength, locusStart));
+        referenceMapping.addMapping(rightFlankNode, ReferenceInterval(contig, locusEnd, locusEnd + rightFlankLength));
+    }
+
+    // Places the record at the first position of the alignment that falls on either flank; reads confined to the
+    // variant nodes are placed at the start of the locus
+    void place(const GraphAlignment& alignment, graphIO::BamAlignment& bamAlignment) const
+    {
+        auto optionalPosition = referenceMapping.map(alignment.path());
+        bamAlignment.chromName = contig;
+        bamAlignment.pos = optionalPosition ? optionalPosition->start : locusStart;
+    }
+
+    const graphtools::Graph* graphPtr;
+    string contig;
+    int64_t locusStart;
+    GraphReferenceMapping referenceMapping;
+};
+
+BamAlignmentWriter::BamAlignmentWriter(const string& bamPath, const ContigInfo& contigs, std::size_t maxQueueSize)
+    : maxQueueSize_(std::max<std::size_t>(maxQueueSize, 1))
+{
+    graphIO::ReferenceContigs bamContigs = convertContigInfo(contigs);
+    bamWriterPtr_.reset(new graphIO::BamWriter(bamPath, bamContigs));
+    writerThread_ = std::thread(&BamAlignmentWriter::writeQueuedAlignments, this);
+}
+
+BamAlignmentWriter::~BamAlignmentWriter() { stopWriterThread(); }
+
+const BamAlignmentWriter::LocusPlacement& BamAlignmentWriter::getPlacement(const LocusSpecification& locusSpec)
+{
+    // Analyzers own copies of the locus specifications, so the mapping is rebuilt if the locus graph is not the one
+    // the mapping refers to
+    std::unique_ptr<LocusPlacement>& placementPtr = locusPlacements_[locusSpec.regionId()];
+    if (!placementPtr || placementPtr->graphPtr != &locusSpec.regionGraph())
+    {
+        placementPtr.reset(new LocusPlacement(locusSpec));
+    }
+    return *placementPtr;
+}
+
+void BamAlignmentWriter::write(
+    const LocusSpecification& locusSpec, const reads::Read& read, const GraphAlignment& alignment)
+{
+    unique_ptr<graphIO::BamAlignment> bamAlignmentPtr(new graphIO::BamAlignment());
+    bamAlignmentPtr->fragmentName = read.fragmentId();
+    bamAlignmentPtr->sequence = read.sequence;
+    bamAlignmentPtr->isPaired = true;
+    bamAlignmentPtr->isMate1 = read.is_first_mate;
+    bamAlignmentPtr->graphCigar = alignment.generateCigar();
+    bamAlignmentPtr->graphName = locusSpec.regionId();
+    getPlacement(locusSpec).place(alignment, *bamAlignmentPtr);
+
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    queueNotFull_.wait(lock, [this] { return queue_.size() < maxQueueSize_ || writeError_ || isClosing_; });
+    if (writeError_)
+    {
+        std::rethrow_exception(writeError_);
+    }
+    if (isClosing_)
+    {
+        throw std::logic_error("Cannot write alignments after the BAM file is closed");
+    }
+
+    queue_.push_back(std::move(bamAlignmentPtr));
+    lock.unlock();
+    queueNotEmpty_.notify_one();
+}
+
+void BamAlignmentWriter::writeQueuedAlignments()
+{
+    std::deque<unique_ptr<graphIO::BamAlignment>> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueNotEmpty_.wait(lock, [this] { return !queue_.empty() || isClosing_; });
+            if (queue_.empty())
+            {
+                return;
+            }
+            batch.swap(queue_);
+        }
+        queueNotFull_.notify_all();
+
+        try
+        {
+            for (auto& bamAlignmentPtr : batch)
+            {
+                bamWriterPtr_->writeAlignment(*bamAlignmentPtr);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            writeError_ = std::current_exception();
+            queue_.clear();
+            isClosing_ = true;
+        }
+        batch.clear();
+        queueNotFull_.notify_all();
+    }
+}
+
+void BamAlignmentWriter::stopWriterThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        isClosing_ = true;
+    }
+    queueNotEmpty_.notify_all();
+    queueNotFull_.notify_all();
+
+    if (writerThread_.joinable())
+    {
+        writerThread_.join();
+    }
+
+    // Closing the writer flushes the last BGZF block and writes the end-of-file marker
+    bamWriterPtr_.reset();
+}
+
+void BamAlignmentWriter::close()
+{
+    stopWriterThread();
+    if (writeError_)
+    {
+        std::rethrow_exception(writeError_);
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "output/AlignmentWriter.hh"
+
+namespace graphIO
+{
+class BamWriter;
+struct BamAlignment;
+}
+
+namespace ehunter
+{
+
+// Writes realigned reads to a BAM file as placed but unmapped records carrying their graph CIGARs in the XG tag and
+// the ids of the loci whose graphs the CIGARs refer to in the XL tag. Records are encoded by the calling thread and
+// compressed and written by a dedicated writer thread.
+class BamAlignmentWriter : public AlignmentWriter
+{
+public:
+    using ContigInfo = std::vector<std::pair<std::string, int64_t>>;
+    static const std::size_t kDefaultMaxQueueSize = 10000;
+
+    BamAlignmentWriter(
+        const std::string& bamPath, const ContigInfo& contigs, std::size_t maxQueueSize = kDefaultMaxQueueSize);
+    ~BamAlignmentWriter() override;
+    BamAlignmentWriter(const BamAlignmentWriter&) = delete;
+    BamAlignmentWriter& operator=(const BamAlignmentWriter&) = delete;
+
+    void write(
+        const LocusSpecification& locusSpec, const reads::Read& read,
+        const graphtools::GraphAlignment& alignment) override;
+    void close() override;
+
+private:
+    struct LocusPlacement;
+
+    const LocusPlacement& getPlacement(const LocusSpecification& locusSpec);
+    void writeQueuedAlignments();
+    void stopWriterThread();
+
+    std::unique_ptr<graphIO::BamWriter> bamWriterPtr_;
+    std::size_t maxQueueSize_;
+    // Reference mappings of the flanks of the loci written so far
+    std::unordered_map<std::string, std::unique_ptr<LocusPlacement>> locusPlacements_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueNotEmpty_;
+    std::condition_variable queueNotFull_;
+    std::deque<std::unique_ptr<graphIO::BamAlignment>> queue_;
+    bool isClosing_ = false;
+    std::exception_ptr writeError_;
+    std::thread writerThread_;
+};
+
+}
@@ -0,0 +1,115 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/BgzfFileSink.hh"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using std::string;
+
+namespace ehunter
+{
+
+static BGZF* openBgzfFile(const string& path)
+{
+    BGZF* filePtr = bgzf_open(path.c_str(), "w");
+    if (!filePtr)
+    {
+        throw std::runtime_error("Failed to open " + path + " for writing: " + strerror(errno));
+    }
+    return filePtr;
+}
+
+BgzfStreamBuffer::BgzfStreamBuffer(BGZF* filePtr, std::size_t bufferSize)
+    : filePtr_(filePtr)
+    , buffer_(bufferSize)
+{
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+bool BgzfStreamBuffer::writeBufferedData()
+{
+    const std::ptrdiff_t numBytes = pptr() - pbase();
+    if (numBytes > 0 && bgzf_write(filePtr_, pbase(), numBytes) != numBytes)
+    {
+        return false;
+    }
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return true;
+}
+
+BgzfStreamBuffer::int_type BgzfStreamBuffer::overflow(int_type symbol)
+{
+    if (!writeBufferedData())
+    {
+        return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(symbol, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(symbol);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(symbol);
+}
+
+// Only hands the data over to BGZF; blocks are compressed and written as they fill up
+int BgzfStreamBuffer::sync() { return writeBufferedData() ? 0 : -1; }
+
+BgzfFileSink::BgzfFileSink(string path, int numThreads, std::size_t bufferSize)
+    : path_(std::move(path))
+    , filePtr_(openBgzfFile(path_))
+    , streamBuffer_(filePtr_, bufferSize)
+    , stream_(&streamBuffer_)
+{
+    if (numThreads > 1)
+    {
+        const int kNumBlocksPerThread = 64;
+        bgzf_mt(filePtr_, numThreads, kNumBlocksPerThread);
+    }
+}
+
+BgzfFileSink::~BgzfFileSink()
+{
+    if (filePtr_)
+    {
+        stream_.flush();
+        bgzf_close(filePtr_);
+    }
+}
+
+void BgzfFileSink::close()
+{
+    stream_.flush();
+    const bool isStreamGood = stream_.good();
+    const int closeStatus = bgzf_close(filePtr_);
+    filePtr_ = nullptr;
+
+    if (!isStreamGood || closeStatus != 0)
+    {
+        throw std::runtime_error("Failed to write " + path_);
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "htslib/bgzf.h"
+
+namespace ehunter
+{
+
+// Stream buffer that compresses everything written to it into a BGZF file
+class BgzfStreamBuffer : public std::streambuf
+{
+public:
+    BgzfStreamBuffer(BGZF* filePtr, std::size_t bufferSize);
+
+protected:
+    int_type overflow(int_type symbol) override;
+    int sync() override;
+
+private:
+    bool writeBufferedData();
+
+    BGZF* filePtr_;
+    std::vector<char> buffer_;
+};
+
+// Output file compressed with bgzip; compression of consecutive blocks is spread over the given number of threads
+class BgzfFileSink
+{
+public:
+    static const std::size_t kDefaultBufferSize = 1 << 20;
+
+    BgzfFileSink(std::string path, int numThreads, std::size_t bufferSize = kDefaultBufferSize);
+    ~BgzfFileSink();
+    BgzfFileSink(const BgzfFileSink&) = delete;
+    BgzfFileSink& operator=(const BgzfFileSink&) = delete;
+
+    const std::string& path() const { return path_; }
+    std::ostream& stream() { return stream_; }
+    void close();
+
+private:
+    std::string path_;
+    BGZF* filePtr_ = nullptr;
+    BgzfStreamBuffer streamBuffer_;
+    std::ostream stream_;
+};
+
+}
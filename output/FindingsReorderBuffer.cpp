@@ -0,0 +1,78 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/FindingsReorderBuffer.hh"
+
+#include <stdexcept>
+
+namespace ehunter
+{
+
+FindingsReorderBuffer::FindingsReorderBuffer(const RegionCatalog& regionCatalog, FindingsConsumer consumer)
+    : regionCatalog_(regionCatalog)
+    , consumer_(std::move(consumer))
+    , nextLocusIter_(regionCatalog_.begin())
+{
+}
+
+void FindingsReorderBuffer::add(const RegionId& locusId, RegionFindings locusFindings)
+{
+    const auto locusIter = regionCatalog_.find(locusId);
+    if (locusIter == regionCatalog_.end())
+    {
+        throw std::logic_error("Received findings for locus " + locusId + " that is not in the catalog");
+    }
+
+    const bool isAlreadyPassedOn = isComplete() || regionCatalog_.key_comp()(locusIter->first, nextLocusIter_->first);
+    if (isAlreadyPassedOn || pendingFindings_.find(locusId) != pendingFindings_.end())
+    {
+        throw std::logic_error("Received findings for locus " + locusId + " more than once");
+    }
+
+    if (locusIter == nextLocusIter_)
+    {
+        consumer_(locusIter->second, locusFindings);
+        ++nextLocusIter_;
+        passOnReadyLoci();
+    }
+    else
+    {
+        pendingFindings_.emplace(locusId, std::move(locusFindings));
+    }
+}
+
+void FindingsReorderBuffer::passOnReadyLoci()
+{
+    while (!isComplete())
+    {
+        auto pendingIter = pendingFindings_.find(nextLocusIter_->first);
+        if (pendingIter == pendingFindings_.end())
+        {
+            return;
+        }
+
+        consumer_(nextLocusIter_->second, pendingIter->second);
+        pendingFindings_.erase(pendingIter);
+        ++nextLocusIter_;
+    }
+}
+
+}
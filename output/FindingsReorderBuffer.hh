@@ -0,0 +1,56 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+#include "region_analysis/VariantFindings.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Restores catalog order of locus findings that may be reported in any order. Each locus is passed on as soon as
+// all loci preceding it in the catalog have been passed on, so only out-of-order findings are ever held in memory.
+class FindingsReorderBuffer
+{
+public:
+    using FindingsConsumer = std::function<void(const LocusSpecification& locusSpec, const RegionFindings& findings)>;
+
+    FindingsReorderBuffer(const RegionCatalog& regionCatalog, FindingsConsumer consumer);
+
+    void add(const RegionId& locusId, RegionFindings locusFindings);
+    std::size_t numPendingLoci() const { return pendingFindings_.size(); }
+    bool isComplete() const { return nextLocusIter_ == regionCatalog_.end(); }
+
+private:
+    void passOnReadyLoci();
+
+    const RegionCatalog& regionCatalog_;
+    FindingsConsumer consumer_;
+    RegionCatalog::const_iterator nextLocusIter_;
+    std::unordered_map<RegionId, RegionFindings> pendingFindings_;
+};
+
+}
@@ -38,43 +38,64 @@ using boost::optional;
 using std::to_string;
 using std::vector;
 
-std::ostream& operator<<(std::ostream& out, JsonWriter& jsonWriter)
-{
-    jsonWriter.write(out);
-    return out;
-}
-
-JsonWriter::JsonWriter(
-    const string& sampleName, int readLength, const RegionCatalog& regionCatalog, const SampleFindings& sampleFindings)
+JsonWriter::JsonWriter(const string& sampleName, int readLength, std::ostream& out)
     : sampleName_(sampleName)
     , readLength_(readLength)
-    , regionCatalog_(regionCatalog)
-    , sampleFindings_(sampleFindings)
+    , out_(out)
 {
 }
 
-void JsonWriter::write(std::ostream& out)
+void JsonWriter::write(const LocusSpecification& locusSpec, const RegionFindings& locusFindings)
 {
-    Json array = Json::array();
-
-    for (const auto& regionIdAndFindings : sampleFindings_)
+    for (const auto& record : formatRecords(locusSpec, locusFindings))
     {
-        const string& regionId = regionIdAndFindings.first;
-        const LocusSpecification& regionSpec = regionCatalog_.at(regionId);
-        const RegionFindings& regionFindings = regionIdAndFindings.second;
+        writeRecord(record);
+    }
+}
 
-        for (const auto& variantIdAndFindings : regionFindings)
+vector<Json> JsonWriter::formatRecords(const LocusSpecification& locusSpec, const RegionFindings& locusFindings) const
+{
+    vector<Json> records;
+    for (const auto& variantSpec : locusSpec.variantSpecs())
+    {
+        const auto variantFindingsIter = locusFindings.find(variantSpec.id());
+        if (variantFindingsIter == locusFindings.end())
         {
-            const string& variantId = variantIdAndFindings.first;
-            const VariantSpecification& variantSpec = regionSpec.getVariantSpecById(variantId);
+            continue;
+        }
+
+        VariantJsonWriter variantWriter(locusSpec, variantSpec, readLength_);
+        variantFindingsIter->second->accept(&variantWriter);
+        records.push_back(variantWriter.record());
+    }
+    return records;
+}
 
-            VariantJsonWriter variantWriter(regionSpec, variantSpec, readLength_);
-            variantIdAndFindings.second->accept(&variantWriter);
-            array.push_back(variantWriter.record());
+// Produces the same layout as serializing the whole array with an indentation of 4
+void JsonWriter::writeRecord(const Json& record)
+{
+    out_ << (isEmpty_ ? "[\n" : ",\n");
+    isEmpty_ = false;
+
+    const string encoding = record.dump(4);
+    string indentedEncoding = "    ";
+    indentedEncoding.reserve(encoding.size() + encoding.size() / 4);
+    for (const char symbol : encoding)
+    {
+        indentedEncoding += symbol;
+        if (symbol == '\n')
+        {
+            indentedEncoding += "    ";
         }
-    };
+    }
 
-    out << std::setw(4) << array << std::endl;
+    out_ << indentedEncoding;
+}
+
+void JsonWriter::close()
+{
+    out_ << (isEmpty_ ? "[]\n" : "\n]\n");
+    out_.flush();
 }
 
 template <typename T> static string streamToString(const T& streamableObject)
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "region_analysis/VariantFindings.hh"
 #include "region_spec/LocusSpecification.hh"
 
@@ -50,22 +52,27 @@ private:
     nlohmann::json record_;
 };
 
+// Writes the JSON array of variant records incrementally, one locus at a time; only the record currently being
+// written is held in memory
 class JsonWriter
 {
 public:
-    JsonWriter(
-        const std::string& sampleName, int readLength, const RegionCatalog& regionCatalog,
-        const SampleFindings& sampleFindings);
+    JsonWriter(const std::string& sampleName, int readLength, std::ostream& out);
+
+    void write(const LocusSpecification& locusSpec, const RegionFindings& locusFindings);
+    void close();
 
-    void write(std::ostream& out);
+    // Records of the variants of a locus in the order in which write() adds them to the array
+    std::vector<nlohmann::json>
+    formatRecords(const LocusSpecification& locusSpec, const RegionFindings& locusFindings) const;
+    void writeRecord(const nlohmann::json& record);
 
 private:
+
     const std::string sampleName_;
     const int readLength_;
-    const RegionCatalog& regionCatalog_;
-    const SampleFindings& sampleFindings_;
+    std::ostream& out_;
+    bool isEmpty_ = true;
 };
 
-std::ostream& operator<<(std::ostream& out, JsonWriter& jsonWriter);
-
 }
@@ -0,0 +1,73 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/MetricsWriter.hh"
+
+using Json = nlohmann::json;
+using std::string;
+
+namespace ehunter
+{
+
+Json encodeLocusMetrics(const LocusMetrics& metrics)
+{
+    Json stageSeconds;
+    for (int stageIndex = 0; stageIndex != kNumAnalysisStages; ++stageIndex)
+    {
+        const AnalysisStage stage = static_cast<AnalysisStage>(stageIndex);
+        stageSeconds[getStageName(stage)] = metrics.seconds(stage);
+    }
+
+    Json record;
+    record["StageSeconds"] = stageSeconds;
+    record["ReadsDecoded"] = metrics.numReadsDecoded;
+    record["MateSeeks"] = metrics.numMateSeeks;
+    record["ReadsAligned"] = metrics.numReadsAligned;
+    record["ReadsRejected"] = metrics.numReadsRejected;
+    record["ReadsResolvedByGaplessTier"] = metrics.numGaplessTierReads;
+    record["ReadsResolvedByGappedTier"] = metrics.numGappedTierReads;
+    record["IndexCacheHits"] = metrics.numIndexCacheHits;
+    record["PiecesAlignedWith8BitScores"] = metrics.numNarrowScorePieces;
+    record["PiecesRealignedWith16BitScores"] = metrics.numNarrowScoreOverflows;
+    return record;
+}
+
+void writeSampleMetrics(
+    const string& sampleId, double wallTimeSeconds, const SampleMetrics& sampleMetrics, std::ostream& out)
+{
+    Json lociRecords = Json::array();
+    for (const auto& locusIdAndMetrics : sampleMetrics.loci())
+    {
+        Json locusRecord = encodeLocusMetrics(locusIdAndMetrics.second);
+        locusRecord["LocusId"] = locusIdAndMetrics.first;
+        lociRecords.push_back(locusRecord);
+    }
+
+    Json record;
+    record["SampleId"] = sampleId;
+    record["WallTimeSeconds"] = wallTimeSeconds;
+    record["Total"] = encodeLocusMetrics(sampleMetrics.total());
+    record["SampleWide"] = encodeLocusMetrics(sampleMetrics.sampleWideMetrics());
+    record["Loci"] = lociRecords;
+
+    out << record.dump(4) << std::endl;
+}
+
+}
@@ -0,0 +1,45 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "thirdparty/json/json.hpp"
+
+#include "common/PerformanceMetrics.hh"
+
+namespace ehunter
+{
+
+// Encodes the time spent in each stage and the read counts of one locus or of a whole sample
+nlohmann::json encodeLocusMetrics(const LocusMetrics& metrics);
+
+/**
+ * Writes the performance metrics of a sample as a JSON object
+ *
+ * The object holds the total wall time of the analysis, the aggregate metrics of all loci ("Total"), the metrics of
+ * work shared by all loci ("SampleWide"), and the metrics of each locus in the order of analysis ("Loci")
+ */
+void writeSampleMetrics(
+    const std::string& sampleId, double wallTimeSeconds, const SampleMetrics& sampleMetrics, std::ostream& out);
+
+}
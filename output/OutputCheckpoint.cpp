@@ -0,0 +1,248 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/OutputCheckpoint.hh"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+using Json = nlohmann::json;
+using std::string;
+using std::vector;
+
+namespace ehunter
+{
+
+// 64-bit FNV-1a digest of the file contents
+static string computeFileDigest(const string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    uint64_t digest = 14695981039346656037ull;
+    char buffer[1 << 16];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() != 0)
+    {
+        for (std::streamsize index = 0; index != file.gcount(); ++index)
+        {
+            digest ^= static_cast<unsigned char>(buffer[index]);
+            digest *= 1099511628211ull;
+        }
+    }
+
+    std::ostringstream encoding;
+    encoding << std::hex << std::setw(16) << std::setfill('0') << digest;
+    return encoding.str();
+}
+
+Json encodeCheckpointSettings(
+    const InputPaths& inputPaths, const SampleParameters& sampleParams, const HeuristicParameters& heuristicParams,
+    const CatalogShard& catalogShard)
+{
+    Json settings;
+    settings["Reads"] = fs::absolute(inputPaths.htsFile()).string();
+    settings["Catalog"] = fs::absolute(inputPaths.catalog()).string();
+    settings["CatalogDigest"] = computeFileDigest(inputPaths.catalog());
+    settings["ShardIndex"] = catalogShard.index();
+    settings["NumShards"] = catalogShard.numShards();
+    settings["Reference"] = fs::absolute(inputPaths.reference()).string();
+    settings["Sex"] = sampleParams.sex() == Sex::kMale ? "male" : "female";
+    settings["ReadLength"] = sampleParams.readLength();
+    if (sampleParams.isHaplotypeDepthSet())
+    {
+        settings["HaplotypeDepth"] = sampleParams.haplotypeDepth();
+    }
+    settings["Aligner"] = heuristicParams.alignerType();
+    settings["RegionExtensionLength"] = heuristicParams.regionExtensionLength();
+    settings["QualityCutoffForGoodBaseCall"] = heuristicParams.qualityCutoffForGoodBaseCall();
+    settings["SkipUnaligned"] = heuristicParams.skipUnaligned();
+    settings["KmerLenForAlignment"] = heuristicParams.kmerLenForAlignment();
+    settings["PaddingLength"] = heuristicParams.paddingLength();
+    settings["SeedAffixTrimLength"] = heuristicParams.seedAffixTrimLength();
+    settings["TrimLowQualityBases"] = heuristicParams.trimLowQualityBases();
+    settings["UseKmerPrefilter"] = heuristicParams.useKmerPrefilter();
+    return settings;
+}
+
+static Json encodeCheckpointHeader(const string& sampleId, const Json& settings)
+{
+    Json header;
+    header["SampleId"] = sampleId;
+    header["Settings"] = settings;
+    return header;
+}
+
+CheckpointWriter::CheckpointWriter(string path, const string& sampleId, const Json& settings, uint64_t validSize)
+    : path_(std::move(path))
+{
+    if (validSize != 0)
+    {
+        fs::resize_file(path_, validSize);
+        out_.open(path_, std::ios::app);
+    }
+    else
+    {
+        out_.open(path_, std::ios::trunc);
+        out_ << encodeCheckpointHeader(sampleId, settings).dump() << "\n";
+    }
+
+    if (!out_)
+    {
+        throw std::runtime_error("Failed to open checkpoint " + path_);
+    }
+}
+
+void CheckpointWriter::write(const RegionId& locusId, const LocusOutputRecords& records)
+{
+    Json encoding;
+    encoding["LocusId"] = locusId;
+    encoding["Json"] = records.jsonRecords;
+    encoding["Vcf"] = records.vcfRecords;
+
+    vector<string> fieldDescriptionEncodings;
+    for (const auto& idAndFieldDescription : records.vcfFieldDescriptions)
+    {
+        std::ostringstream fieldDescriptionEncoding;
+        fieldDescriptionEncoding << idAndFieldDescription.second;
+        fieldDescriptionEncodings.push_back(fieldDescriptionEncoding.str());
+    }
+    encoding["VcfHeader"] = fieldDescriptionEncodings;
+
+    // JSON encoding escapes line breaks, so each locus occupies a single line. Flushing once per locus costs little
+    // next to the analysis of the locus and leaves at most one locus to redo after an interruption
+    out_ << encoding.dump() << "\n";
+    out_.flush();
+
+    if (!out_)
+    {
+        throw std::runtime_error("Failed to write checkpoint " + path_);
+    }
+}
+
+void CheckpointWriter::close()
+{
+    out_.close();
+    if (out_.fail())
+    {
+        throw std::runtime_error("Failed to write checkpoint " + path_);
+    }
+}
+
+static bool tryDecodingHeader(const string& line, string& sampleId, Json& settings)
+{
+    try
+    {
+        const Json header = Json::parse(line);
+        sampleId = header.at("SampleId").get<string>();
+        // Checkpoints of earlier versions have no settings and are never resumed
+        settings = header.count("Settings") != 0 ? header.at("Settings") : Json();
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+static bool tryDecodingLocus(const string& line, RegionId& locusId, LocusOutputRecords& records)
+{
+    try
+    {
+        const Json encoding = Json::parse(line);
+        locusId = encoding.at("LocusId").get<string>();
+        for (const auto& jsonRecord : encoding.at("Json"))
+        {
+            records.jsonRecords.push_back(jsonRecord);
+        }
+        records.vcfRecords = encoding.at("Vcf").get<vector<string>>();
+        for (const string& fieldDescriptionEncoding : encoding.at("VcfHeader").get<vector<string>>())
+        {
+            FieldDescription fieldDescription = decodeFieldDescription(fieldDescriptionEncoding);
+            const auto key = std::make_pair(fieldDescription.fieldType, fieldDescription.id);
+            records.vcfFieldDescriptions.emplace(key, std::move(fieldDescription));
+        }
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+OutputCheckpoint loadOutputCheckpoint(const string& path, const string& sampleId, const Json& settings)
+{
+    OutputCheckpoint checkpoint;
+    std::ifstream checkpointFile(path);
+    if (!checkpointFile.is_open())
+    {
+        return checkpoint;
+    }
+
+    bool isHeaderRead = false;
+    uint64_t numBytesRead = 0;
+    string line;
+    // The last line is incomplete if it is not terminated by a line break
+    while (std::getline(checkpointFile, line) && !checkpointFile.eof())
+    {
+        numBytesRead += line.length() + 1;
+        if (!isHeaderRead)
+        {
+            string checkpointSampleId;
+            Json checkpointSettings;
+            if (!tryDecodingHeader(line, checkpointSampleId, checkpointSettings))
+            {
+                break;
+            }
+            if (checkpointSampleId != sampleId)
+            {
+                throw std::invalid_argument("Checkpoint " + path + " was created for sample " + checkpointSampleId);
+            }
+            if (checkpointSettings != settings)
+            {
+                throw std::invalid_argument(
+                    "Checkpoint " + path + " was created with a different catalog or analysis parameters: "
+                    + checkpointSettings.dump());
+            }
+            isHeaderRead = true;
+        }
+        else
+        {
+            RegionId locusId;
+            LocusOutputRecords records;
+            if (!tryDecodingLocus(line, locusId, records))
+            {
+                break;
+            }
+            checkpoint.completedLoci[locusId] = std::move(records);
+        }
+        checkpoint.validSize = numBytesRead;
+    }
+
+    return checkpoint;
+}
+
+}
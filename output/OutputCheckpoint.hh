@@ -0,0 +1,100 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "thirdparty/json/json.hpp"
+
+#include "common/Parameters.hh"
+#include "output/VcfHeader.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Records of a locus in the form they are written to the JSON and VCF files
+struct LocusOutputRecords
+{
+    std::vector<nlohmann::json> jsonRecords;
+    std::vector<std::string> vcfRecords;
+    FieldDescriptionCatalog vcfFieldDescriptions;
+};
+
+// Loci whose records were saved to a checkpoint
+struct OutputCheckpoint
+{
+    std::unordered_map<RegionId, LocusOutputRecords> completedLoci;
+    // Number of bytes taken by complete records at the start of the checkpoint file
+    uint64_t validSize = 0;
+};
+
+/**
+ * Summarizes the inputs and parameters that the records of a checkpoint depend on
+ *
+ * The summary includes a digest of the catalog contents, so a catalog edited in place is told apart from the original.
+ * Reads are identified by the absolute path of their file because the sample id only derives from its name.
+ */
+nlohmann::json encodeCheckpointSettings(
+    const InputPaths& inputPaths, const SampleParameters& sampleParams, const HeuristicParameters& heuristicParams,
+    const CatalogShard& catalogShard);
+
+/**
+ * Append-only checkpoint of the loci analyzed so far
+ *
+ * The first line identifies the sample and the settings of the analysis and every following line holds the records of
+ * one locus, so a line cut short by an interrupted run can be recognized and dropped. The records of each locus are
+ * flushed to disk as soon as they are written.
+ */
+class CheckpointWriter
+{
+public:
+    // Truncates the checkpoint to the given number of bytes of valid records and appends after them
+    CheckpointWriter(
+        std::string path, const std::string& sampleId, const nlohmann::json& settings, uint64_t validSize);
+
+    void write(const RegionId& locusId, const LocusOutputRecords& records);
+    void close();
+
+private:
+    std::string path_;
+    std::ofstream out_;
+};
+
+/**
+ * Loads the records of the loci saved to a checkpoint
+ *
+ * Reading stops at the first incomplete or malformed line, so the records of the locus being saved when a run was
+ * interrupted are discarded.
+ *
+ * @param path: Path to the checkpoint; a missing checkpoint is treated as empty
+ * @param sampleId: Sample that the checkpoint must have been created for
+ * @param settings: Settings that the checkpoint must have been created with (see encodeCheckpointSettings)
+ * @return Loci of the checkpoint
+ */
+OutputCheckpoint loadOutputCheckpoint(
+    const std::string& path, const std::string& sampleId, const nlohmann::json& settings);
+
+}
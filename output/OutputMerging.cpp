@@ -0,0 +1,227 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/OutputMerging.hh"
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "htslib/bgzf.h"
+#include "htslib/kstring.h"
+#include "thirdparty/json/json.hpp"
+
+#include "common/BufferedFileSink.hh"
+#include "output/VcfHeader.hh"
+#include "output/VcfWriter.hh"
+
+using std::string;
+using std::vector;
+
+namespace ehunter
+{
+
+// Reads lines of a plain-text or a bgzip-compressed (.gz) file
+class VcfLineReader
+{
+public:
+    explicit VcfLineReader(const string& path)
+        : path_(path)
+    {
+        if (boost::algorithm::ends_with(path, ".gz"))
+        {
+            bgzfFilePtr_ = bgzf_open(path.c_str(), "r");
+            if (!bgzfFilePtr_)
+            {
+                throw std::runtime_error("Failed to open " + path);
+            }
+        }
+        else
+        {
+            plainFile_.open(path);
+            if (!plainFile_.is_open())
+            {
+                throw std::runtime_error("Failed to open " + path);
+            }
+        }
+    }
+
+    ~VcfLineReader()
+    {
+        if (bgzfFilePtr_)
+        {
+            bgzf_close(bgzfFilePtr_);
+        }
+        free(lineBuffer_.s);
+    }
+
+    VcfLineReader(const VcfLineReader&) = delete;
+    VcfLineReader& operator=(const VcfLineReader&) = delete;
+
+    bool getLine(string& line)
+    {
+        if (!bgzfFilePtr_)
+        {
+            return static_cast<bool>(std::getline(plainFile_, line));
+        }
+
+        const int status = bgzf_getline(bgzfFilePtr_, '\n', &lineBuffer_);
+        if (status < -1)
+        {
+            throw std::runtime_error("Failed to read " + path_);
+        }
+        if (status == -1)
+        {
+            return false;
+        }
+        line.assign(lineBuffer_.s, lineBuffer_.l);
+        return true;
+    }
+
+private:
+    string path_;
+    std::ifstream plainFile_;
+    BGZF* bgzfFilePtr_ = nullptr;
+    kstring_t lineBuffer_ = { 0, 0, nullptr };
+};
+
+void mergeShardJsonOutputs(const vector<string>& shardJsonPaths, std::ostream& out)
+{
+    nlohmann::json records = nlohmann::json::array();
+    for (const string& shardJsonPath : shardJsonPaths)
+    {
+        std::ifstream shardJsonFile(shardJsonPath);
+        if (!shardJsonFile.is_open())
+        {
+            throw std::runtime_error("Failed to open " + shardJsonPath);
+        }
+
+        nlohmann::json shardRecords;
+        shardJsonFile >> shardRecords;
+        if (!shardRecords.is_array())
+        {
+            throw std::runtime_error(shardJsonPath + " does not contain an array of variant records");
+        }
+        for (auto& record : shardRecords)
+        {
+            records.push_back(std::move(record));
+        }
+    }
+
+    // Same layout as the records written one at a time by JsonWriter
+    out << records.dump(4) << "\n";
+}
+
+static string extractVcfSampleName(const string& shardVcfPath)
+{
+    VcfLineReader reader(shardVcfPath);
+    string line;
+    while (reader.getLine(line) && boost::algorithm::starts_with(line, "#"))
+    {
+        if (boost::algorithm::starts_with(line, "#CHROM"))
+        {
+            return line.substr(line.rfind('\t') + 1);
+        }
+    }
+
+    throw std::runtime_error(shardVcfPath + " does not contain a VCF header");
+}
+
+void mergeShardVcfOutputs(
+    const vector<string>& shardVcfPaths, const string& vcfPath, const OutputParameters& outputParameters)
+{
+    if (shardVcfPaths.empty())
+    {
+        throw std::invalid_argument("No VCF files to merge");
+    }
+
+    const string sampleName = extractVcfSampleName(shardVcfPaths.front());
+    VcfWriter vcfWriter(sampleName, vcfPath, outputParameters);
+
+    // Records of each shard are sorted by position and come from consecutive loci of the catalog, so the stable sort of
+    // the concatenated records by the writer restores the order of a single run within each contig; without a
+    // reference, contigs follow the order in which the shards first list them
+    for (const string& shardVcfPath : shardVcfPaths)
+    {
+        if (extractVcfSampleName(shardVcfPath) != sampleName)
+        {
+            throw std::invalid_argument("Sample of " + shardVcfPath + " differs from " + sampleName);
+        }
+
+        VcfLineReader reader(shardVcfPath);
+        string line;
+        while (reader.getLine(line))
+        {
+            if (boost::algorithm::starts_with(line, "##fileformat=") || boost::algorithm::starts_with(line, "#CHROM"))
+            {
+                continue;
+            }
+            else if (boost::algorithm::starts_with(line, "##"))
+            {
+                vcfWriter.addFieldDescription(decodeFieldDescription(line));
+            }
+            else if (!line.empty())
+            {
+                vcfWriter.addRecord(line + "\n");
+            }
+        }
+    }
+
+    vcfWriter.close();
+}
+
+static string findShardVcf(const string& shardOutputPrefix)
+{
+    for (const string& extension : { ".vcf.gz", ".vcf" })
+    {
+        const string vcfPath = shardOutputPrefix + extension;
+        if (std::ifstream(vcfPath).good())
+        {
+            return vcfPath;
+        }
+    }
+
+    throw std::invalid_argument("Could not find VCF file with prefix " + shardOutputPrefix);
+}
+
+void mergeShardOutputs(const MergeParameters& mergeParameters)
+{
+    vector<string> shardJsonPaths;
+    vector<string> shardVcfPaths;
+    for (const string& shardOutputPrefix : mergeParameters.shardOutputPrefixes())
+    {
+        shardJsonPaths.push_back(shardOutputPrefix + ".json");
+        shardVcfPaths.push_back(findShardVcf(shardOutputPrefix));
+    }
+
+    const string& outputPrefix = mergeParameters.outputPrefix();
+    const OutputParameters& outputParameters = mergeParameters.outputParameters();
+
+    BufferedFileSink jsonFile(outputPrefix + ".json");
+    mergeShardJsonOutputs(shardJsonPaths, jsonFile.stream());
+    jsonFile.close();
+
+    const string vcfPath = outputPrefix + (outputParameters.compressVcf() ? ".vcf.gz" : ".vcf");
+    mergeShardVcfOutputs(shardVcfPaths, vcfPath, outputParameters);
+}
+
+}
@@ -0,0 +1,47 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/Parameters.hh"
+
+namespace ehunter
+{
+
+// The functions below combine the outputs of runs that analyzed consecutive shards of a catalog (see
+// selectCatalogShard) into the outputs that a single run over the whole catalog would produce. The shard outputs must
+// be listed in the order of shard indexes
+
+// Concatenates the JSON arrays of variant records
+void mergeShardJsonOutputs(const std::vector<std::string>& shardJsonPaths, std::ostream& out);
+
+// Combines the VCF headers and sorts the records of all shards by position; shard VCFs can be bgzip-compressed
+void mergeShardVcfOutputs(
+    const std::vector<std::string>& shardVcfPaths, const std::string& vcfPath,
+    const OutputParameters& outputParameters);
+
+// Merges the JSON and VCF files written with each of the shard output prefixes
+void mergeShardOutputs(const MergeParameters& mergeParameters);
+
+}
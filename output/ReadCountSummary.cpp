@@ -0,0 +1,337 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/ReadCountSummary.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+using std::string;
+
+namespace ehunter
+{
+
+static const char kFileTag[] = "EHCOUNTS";
+static const uint64_t kFormatVersion = 1;
+
+enum class RecordType : uint8_t
+{
+    kLocus = 1,
+    kSample = 2
+};
+
+static void writeByte(std::ostream& out, uint8_t byte) { out.put(static_cast<char>(byte)); }
+
+static void writeUnsigned(std::ostream& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        writeByte(out, static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    writeByte(out, static_cast<uint8_t>(value));
+}
+
+// Signed integers are zigzag-encoded so that small negative values also take few bytes
+static void writeSigned(std::ostream& out, int64_t value)
+{
+    writeUnsigned(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static void writeString(std::ostream& out, const string& value)
+{
+    writeUnsigned(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+static void writeDouble(std::ostream& out, double value)
+{
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int byteIndex = 0; byteIndex != 8; ++byteIndex)
+    {
+        writeByte(out, static_cast<uint8_t>(bits >> (8 * byteIndex)));
+    }
+}
+
+static void writeCountTable(std::ostream& out, const CountTable& countTable)
+{
+    writeUnsigned(out, std::distance(countTable.begin(), countTable.end()));
+    for (const auto& elementAndCount : countTable)
+    {
+        writeSigned(out, elementAndCount.first);
+        writeSigned(out, elementAndCount.second);
+    }
+}
+
+// Reads fields of a summary and reports a summary that ends early as incomplete
+class SummaryReader
+{
+public:
+    SummaryReader(const string& path, std::istream& in)
+        : path_(path)
+        , in_(in)
+    {
+    }
+
+    uint8_t readByte()
+    {
+        const int byte = in_.get();
+        if (byte == std::char_traits<char>::eof())
+        {
+            throw std::invalid_argument("Read count summary " + path_ + " is incomplete");
+        }
+        return static_cast<uint8_t>(byte);
+    }
+
+    uint64_t readUnsigned()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const uint8_t byte = readByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+        throw std::invalid_argument("Read count summary " + path_ + " is malformed");
+    }
+
+    int64_t readSigned()
+    {
+        const uint64_t encoding = readUnsigned();
+        return static_cast<int64_t>(encoding >> 1) ^ -static_cast<int64_t>(encoding & 1);
+    }
+
+    int32_t readInt32()
+    {
+        const int64_t value = readSigned();
+        if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max())
+        {
+            throw std::invalid_argument("Read count summary " + path_ + " is malformed");
+        }
+        return static_cast<int32_t>(value);
+    }
+
+    string readString()
+    {
+        const uint64_t length = readUnsigned();
+        string value;
+        for (uint64_t charIndex = 0; charIndex != length; ++charIndex)
+        {
+            value.push_back(static_cast<char>(readByte()));
+        }
+        return value;
+    }
+
+    double readDouble()
+    {
+        uint64_t bits = 0;
+        for (int byteIndex = 0; byteIndex != 8; ++byteIndex)
+        {
+            bits |= static_cast<uint64_t>(readByte()) << (8 * byteIndex);
+        }
+        double value = 0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    CountTable readCountTable()
+    {
+        CountTable countTable;
+        const uint64_t numElements = readUnsigned();
+        for (uint64_t elementIndex = 0; elementIndex != numElements; ++elementIndex)
+        {
+            const int32_t element = readInt32();
+            countTable.setCountOf(element, readInt32());
+        }
+        return countTable;
+    }
+
+private:
+    const string& path_;
+    std::istream& in_;
+};
+
+// Collects the read counts that the findings for a variant were computed from
+class ReadCountExtractor : public VariantFindingsVisitor
+{
+public:
+    void visit(const RepeatFindings* findingsPtr) override
+    {
+        readCounts_.variantType = VariantType::kRepeat;
+        readCounts_.countsOfSpanningReads = findingsPtr->countsOfSpanningReads();
+        readCounts_.countsOfFlankingReads = findingsPtr->countsOfFlankingReads();
+        readCounts_.countsOfInrepeatReads = findingsPtr->countsOfInrepeatReads();
+    }
+
+    void visit(const SmallVariantFindings* findingsPtr) override
+    {
+        readCounts_.variantType = VariantType::kSmallVariant;
+        readCounts_.numRefReads = findingsPtr->numRefReads();
+        readCounts_.numAltReads = findingsPtr->numAltReads();
+    }
+
+    const VariantReadCounts& readCounts() const { return readCounts_; }
+
+private:
+    VariantReadCounts readCounts_;
+};
+
+ReadCountSummaryWriter::ReadCountSummaryWriter(string path)
+    : path_(std::move(path))
+    , out_(path_, std::ios::binary | std::ios::trunc)
+{
+    if (!out_)
+    {
+        throw std::runtime_error("Failed to open read count summary " + path_ + " for writing");
+    }
+    out_.write(kFileTag, std::strlen(kFileTag));
+    writeUnsigned(out_, kFormatVersion);
+}
+
+void ReadCountSummaryWriter::write(const RegionId& locusId, const RegionFindings& locusFindings)
+{
+    writeByte(out_, static_cast<uint8_t>(RecordType::kLocus));
+    writeString(out_, locusId);
+    writeUnsigned(out_, locusFindings.size());
+    for (const auto& variantIdAndFindings : locusFindings)
+    {
+        ReadCountExtractor extractor;
+        variantIdAndFindings.second->accept(&extractor);
+        const VariantReadCounts& readCounts = extractor.readCounts();
+
+        writeString(out_, variantIdAndFindings.first);
+        if (readCounts.variantType == VariantType::kRepeat)
+        {
+            writeByte(out_, static_cast<uint8_t>(VariantType::kRepeat));
+            writeCountTable(out_, readCounts.countsOfSpanningReads);
+            writeCountTable(out_, readCounts.countsOfFlankingReads);
+            writeCountTable(out_, readCounts.countsOfInrepeatReads);
+        }
+        else
+        {
+            writeByte(out_, static_cast<uint8_t>(VariantType::kSmallVariant));
+            writeSigned(out_, readCounts.numRefReads);
+            writeSigned(out_, readCounts.numAltReads);
+        }
+    }
+
+    if (!out_)
+    {
+        throw std::runtime_error("Failed to write read count summary " + path_);
+    }
+}
+
+void ReadCountSummaryWriter::close(const SampleParameters& sampleParams)
+{
+    writeByte(out_, static_cast<uint8_t>(RecordType::kSample));
+    writeString(out_, sampleParams.id());
+    writeByte(out_, sampleParams.sex() == Sex::kMale ? 0 : 1);
+    writeSigned(out_, sampleParams.readLength());
+    writeDouble(out_, sampleParams.haplotypeDepth());
+
+    out_.close();
+    if (out_.fail())
+    {
+        throw std::runtime_error("Failed to write read count summary " + path_);
+    }
+}
+
+static VariantReadCounts readVariantReadCounts(SummaryReader& reader, const string& path)
+{
+    VariantReadCounts readCounts;
+    const uint8_t variantType = reader.readByte();
+    if (variantType == static_cast<uint8_t>(VariantType::kRepeat))
+    {
+        readCounts.variantType = VariantType::kRepeat;
+        readCounts.countsOfSpanningReads = reader.readCountTable();
+        readCounts.countsOfFlankingReads = reader.readCountTable();
+        readCounts.countsOfInrepeatReads = reader.readCountTable();
+    }
+    else if (variantType == static_cast<uint8_t>(VariantType::kSmallVariant))
+    {
+        readCounts.variantType = VariantType::kSmallVariant;
+        readCounts.numRefReads = reader.readInt32();
+        readCounts.numAltReads = reader.readInt32();
+    }
+    else
+    {
+        throw std::invalid_argument("Read count summary " + path + " is malformed");
+    }
+    return readCounts;
+}
+
+ReadCountSummary loadReadCountSummary(const string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+    {
+        throw std::invalid_argument("Failed to open read count summary " + path);
+    }
+
+    string fileTag(std::strlen(kFileTag), '\0');
+    in.read(&fileTag[0], fileTag.size());
+    if (!in || fileTag != kFileTag)
+    {
+        throw std::invalid_argument(path + " is not a read count summary");
+    }
+
+    SummaryReader reader(path, in);
+    const uint64_t formatVersion = reader.readUnsigned();
+    if (formatVersion != kFormatVersion)
+    {
+        throw std::invalid_argument(
+            "Read count summary " + path + " has unsupported format version " + std::to_string(formatVersion));
+    }
+
+    ReadCountSummary summary;
+    for (uint8_t recordType = reader.readByte(); recordType != static_cast<uint8_t>(RecordType::kSample);
+         recordType = reader.readByte())
+    {
+        if (recordType != static_cast<uint8_t>(RecordType::kLocus))
+        {
+            throw std::invalid_argument("Read count summary " + path + " is malformed");
+        }
+
+        const RegionId locusId = reader.readString();
+        LocusReadCounts& locusReadCounts = summary.loci[locusId];
+        const uint64_t numVariants = reader.readUnsigned();
+        for (uint64_t variantIndex = 0; variantIndex != numVariants; ++variantIndex)
+        {
+            const string variantId = reader.readString();
+            locusReadCounts[variantId] = readVariantReadCounts(reader, path);
+        }
+    }
+
+    summary.sampleId = reader.readString();
+    summary.sex = reader.readByte() == 0 ? Sex::kMale : Sex::kFemale;
+    summary.readLength = reader.readInt32();
+    summary.haplotypeDepth = reader.readDouble();
+
+    return summary;
+}
+
+}
@@ -0,0 +1,75 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include "common/Common.hh"
+#include "common/Parameters.hh"
+#include "region_analysis/VariantFindings.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Read counts of the loci of a sample along with the parameters of the sample that they were collected with
+struct ReadCountSummary
+{
+    std::string sampleId;
+    Sex sex = Sex::kFemale;
+    int readLength = 0;
+    double haplotypeDepth = 0;
+    std::unordered_map<RegionId, LocusReadCounts> loci;
+};
+
+/**
+ * Saves the read counts of each analyzed locus to a compact binary file
+ *
+ * The file starts with a tag and a format version followed by one record per locus holding the read counts of all of
+ * its variants; integers are stored as variable-length integers. Sample parameters are written by close() after the
+ * last locus because the depth of a sample may be estimated by the analysis, so a summary left incomplete by an
+ * interrupted run is rejected when it is loaded.
+ */
+class ReadCountSummaryWriter
+{
+public:
+    explicit ReadCountSummaryWriter(std::string path);
+
+    void write(const RegionId& locusId, const RegionFindings& locusFindings);
+    // The haplotype depth of the sample must be set
+    void close(const SampleParameters& sampleParams);
+
+private:
+    std::string path_;
+    std::ofstream out_;
+};
+
+/**
+ * Loads read counts saved by ReadCountSummaryWriter
+ *
+ * @param path: Path to the summary
+ * @return Read counts of the loci of the summary and parameters of the sample
+ */
+ReadCountSummary loadReadCountSummary(const std::string& path);
+
+}
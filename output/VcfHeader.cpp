@@ -21,9 +21,14 @@
 #include "output/VcfHeader.hh"
 
 #include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
 
 using std::ostream;
 using std::string;
+using std::vector;
 
 namespace ehunter
 {
@@ -125,34 +130,84 @@ FieldDescription::FieldDescription(
 {
 }
 
-void outputVcfHeader(const RegionCatalog& regionCatalog, const SampleFindings& sampleFindings, ostream& out)
+void outputVcfHeader(const FieldDescriptionCatalog& fieldDescriptionCatalog, ostream& out)
 {
     out << "##fileformat=VCFv4.1\n";
 
-    FieldDescriptionCatalog fieldDescriptionCatalog;
+    for (const auto& fieldIdAndDescription : fieldDescriptionCatalog)
+    {
+        const auto& description = fieldIdAndDescription.second;
+        out << description << "\n";
+    }
+}
 
-    for (const auto& regionIdAndFindings : sampleFindings)
+static FieldType decodeFieldType(const string& encoding)
+{
+    if (encoding == "INFO")
     {
-        const string& regionId = regionIdAndFindings.first;
-        const LocusSpecification& regionSpec = regionCatalog.at(regionId);
-        const RegionFindings& regionFindings = regionIdAndFindings.second;
+        return FieldType::kInfo;
+    }
+    else if (encoding == "FILTER")
+    {
+        return FieldType::kFilter;
+    }
+    else if (encoding == "FORMAT")
+    {
+        return FieldType::kFormat;
+    }
+    else if (encoding == "ALT")
+    {
+        return FieldType::kAlt;
+    }
 
-        for (const auto& variantIdAndFindings : regionFindings)
-        {
-            const string& variantId = variantIdAndFindings.first;
-            const VariantSpecification& variantSpec = regionSpec.getVariantSpecById(variantId);
+    throw std::invalid_argument("Unknown VCF field type " + encoding);
+}
 
-            FieldDescriptionWriter descriptionWriter(regionSpec, variantSpec);
-            variantIdAndFindings.second->accept(&descriptionWriter);
-            descriptionWriter.dumpTo(fieldDescriptionCatalog);
-        }
+FieldDescription decodeFieldDescription(const string& encoding)
+{
+    const string kDescriptionStart = ",Description=\"";
+    const string kDescriptionEnd = "\">";
+    const size_t typeEnd = encoding.find("=<");
+    const size_t descriptionStart = encoding.find(kDescriptionStart);
+    if (encoding.compare(0, 2, "##") != 0 || typeEnd == string::npos || descriptionStart == string::npos
+        || !boost::algorithm::ends_with(encoding, kDescriptionEnd))
+    {
+        throw std::invalid_argument("Malformed VCF field description " + encoding);
     }
 
-    for (const auto& fieldIdAndDescription : fieldDescriptionCatalog)
+    const FieldType fieldType = decodeFieldType(encoding.substr(2, typeEnd - 2));
+    const size_t descriptionLength = encoding.length() - kDescriptionEnd.length() - descriptionStart
+        - kDescriptionStart.length();
+    const string description = encoding.substr(descriptionStart + kDescriptionStart.length(), descriptionLength);
+
+    // Fields preceding the description are ID and, for INFO and FORMAT fields, Number and Type
+    vector<string> fields;
+    const string fieldsEncoding = encoding.substr(typeEnd + 2, descriptionStart - typeEnd - 2);
+    boost::algorithm::split(fields, fieldsEncoding, boost::is_any_of(","));
+    string id;
+    string number;
+    string contentType;
+    for (const string& field : fields)
     {
-        const auto& description = fieldIdAndDescription.second;
-        out << description << "\n";
+        if (boost::algorithm::starts_with(field, "ID="))
+        {
+            id = field.substr(3);
+        }
+        else if (boost::algorithm::starts_with(field, "Number="))
+        {
+            number = field.substr(7);
+        }
+        else if (boost::algorithm::starts_with(field, "Type="))
+        {
+            contentType = field.substr(5);
+        }
+        else
+        {
+            throw std::invalid_argument("Malformed VCF field description " + encoding);
+        }
     }
+
+    return FieldDescription(fieldType, id, number, contentType, description);
 }
 
 std::ostream& operator<<(std::ostream& out, FieldType fieldType)
@@ -79,7 +79,10 @@ private:
     FieldDescriptionCatalog fieldDescriptions_;
 };
 
-void outputVcfHeader(const RegionCatalog& regionCatalog, const SampleFindings& sampleFindings, std::ostream& out);
+void outputVcfHeader(const FieldDescriptionCatalog& fieldDescriptionCatalog, std::ostream& out);
+
+// Decodes a header line written for a field description, such as ##INFO=<ID=END,...>
+FieldDescription decodeFieldDescription(const std::string& encoding);
 
 std::ostream& operator<<(std::ostream& out, FieldType fieldType);
 std::ostream& operator<<(std::ostream& out, const FieldDescription& fieldDescription);
@@ -0,0 +1,233 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/VcfIndexBuilder.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "htslib/hts.h"
+#include "htslib/tbx.h"
+
+namespace fs = boost::filesystem;
+using std::string;
+using std::vector;
+
+namespace ehunter
+{
+
+static uint32_t decodeLittleEndian(const unsigned char* bytes, int numBytes)
+{
+    uint32_t value = 0;
+    for (int byteIndex = numBytes - 1; byteIndex >= 0; --byteIndex)
+    {
+        value = (value << 8) | bytes[byteIndex];
+    }
+    return value;
+}
+
+static void encodeLittleEndian(uint32_t value, vector<uint8_t>& bytes)
+{
+    for (int byteIndex = 0; byteIndex != 4; ++byteIndex)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> (8 * byteIndex)));
+    }
+}
+
+// Returns the total size of the block as recorded in the BC subfield of the gzip header
+static uint32_t extractBlockSize(std::istream& bgzfStream)
+{
+    const int kFixedHeaderLength = 12;
+    unsigned char header[kFixedHeaderLength];
+    bgzfStream.read(reinterpret_cast<char*>(header), kFixedHeaderLength);
+    const bool isGzipHeaderWithExtraField = header[0] == 31 && header[1] == 139 && header[2] == 8 && (header[3] & 4);
+    if (!bgzfStream || !isGzipHeaderWithExtraField)
+    {
+        throw std::runtime_error("Encountered a malformed BGZF block header");
+    }
+
+    const uint32_t extraFieldLength = decodeLittleEndian(header + 10, 2);
+    vector<unsigned char> extraField(extraFieldLength);
+    bgzfStream.read(reinterpret_cast<char*>(extraField.data()), extraFieldLength);
+
+    uint32_t subfieldStart = 0;
+    while (bgzfStream && subfieldStart + 4 <= extraFieldLength)
+    {
+        const uint32_t subfieldLength = decodeLittleEndian(&extraField[subfieldStart + 2], 2);
+        const bool isBlockSizeSubfield
+            = extraField[subfieldStart] == 'B' && extraField[subfieldStart + 1] == 'C' && subfieldLength == 2;
+        if (isBlockSizeSubfield && subfieldStart + 6 <= extraFieldLength)
+        {
+            return decodeLittleEndian(&extraField[subfieldStart + 4], 2) + 1;
+        }
+        subfieldStart += 4 + subfieldLength;
+    }
+
+    throw std::runtime_error("BGZF block header is missing the block size");
+}
+
+BgzfBlockLayout::BgzfBlockLayout(std::istream& bgzfStream)
+{
+    while (bgzfStream.peek() != std::istream::traits_type::eof())
+    {
+        const uint32_t blockSize = extractBlockSize(bgzfStream);
+
+        // The last four bytes of each block store the size of its uncompressed data
+        const int kSizeFieldLength = 4;
+        unsigned char sizeField[kSizeFieldLength];
+        bgzfStream.seekg(compressedSize_ + blockSize - kSizeFieldLength);
+        bgzfStream.read(reinterpret_cast<char*>(sizeField), kSizeFieldLength);
+        if (!bgzfStream)
+        {
+            throw std::runtime_error("Encountered a truncated BGZF block");
+        }
+        const uint32_t blockUncompressedSize = decodeLittleEndian(sizeField, kSizeFieldLength);
+
+        blocks_.push_back({ compressedSize_, uncompressedSize_, blockUncompressedSize });
+        compressedSize_ += blockSize;
+        uncompressedSize_ += blockUncompressedSize;
+    }
+}
+
+uint64_t BgzfBlockLayout::getVirtualOffset(uint64_t uncompressedOffset)
+{
+    for (; currentBlockIndex_ != blocks_.size(); ++currentBlockIndex_)
+    {
+        const Block& block = blocks_[currentBlockIndex_];
+        const bool isOffsetInBlock = uncompressedOffset < block.uncompressedStart + block.uncompressedSize;
+        // Empty blocks mark the end of file
+        if (isOffsetInBlock || uncompressedOffset == block.uncompressedStart)
+        {
+            return (block.compressedStart << 16) | (uncompressedOffset - block.uncompressedStart);
+        }
+    }
+
+    if (uncompressedOffset == uncompressedSize_)
+    {
+        return compressedSize_ << 16;
+    }
+
+    throw std::logic_error("Offset " + std::to_string(uncompressedOffset) + " is past the end of BGZF data");
+}
+
+VcfIndexBuilder::VcfIndexBuilder(VcfIndexFormat indexFormat)
+    : indexFormat_(indexFormat)
+{
+    if (indexFormat_ == VcfIndexFormat::kNone)
+    {
+        throw std::logic_error("Index format must be specified to build an index");
+    }
+}
+
+void VcfIndexBuilder::addRecord(const string& contig, int64_t start, int64_t end, uint64_t uncompressedEndOffset)
+{
+    if (contigNames_.empty() || contigNames_.back() != contig)
+    {
+        if (std::find(contigNames_.begin(), contigNames_.end(), contig) != contigNames_.end())
+        {
+            throw std::logic_error("Records on " + contig + " must be contiguous to be indexed");
+        }
+        contigNames_.push_back(contig);
+    }
+
+    const int32_t contigIndex = static_cast<int32_t>(contigNames_.size()) - 1;
+    recordIntervals_.push_back({ contigIndex, start, end, uncompressedEndOffset });
+}
+
+// Index metadata in the layout written by tabix: configuration of the VCF preset followed by contig names
+static vector<uint8_t> encodeIndexMetadata(const vector<string>& contigNames)
+{
+    vector<uint8_t> metadata;
+    encodeLittleEndian(tbx_conf_vcf.preset, metadata);
+    encodeLittleEndian(tbx_conf_vcf.sc, metadata);
+    encodeLittleEndian(tbx_conf_vcf.bc, metadata);
+    encodeLittleEndian(tbx_conf_vcf.ec, metadata);
+    encodeLittleEndian(tbx_conf_vcf.meta_char, metadata);
+    encodeLittleEndian(tbx_conf_vcf.line_skip, metadata);
+
+    uint32_t namesLength = 0;
+    for (const auto& contigName : contigNames)
+    {
+        namesLength += contigName.length() + 1;
+    }
+    encodeLittleEndian(namesLength, metadata);
+
+    for (const auto& contigName : contigNames)
+    {
+        metadata.insert(metadata.end(), contigName.begin(), contigName.end());
+        metadata.push_back('\0');
+    }
+
+    return metadata;
+}
+
+void VcfIndexBuilder::build(const string& vcfPath, uint64_t uncompressedSize)
+{
+    std::ifstream bgzfStream(vcfPath, std::ios::binary);
+    if (!bgzfStream.is_open())
+    {
+        throw std::runtime_error("Failed to open " + vcfPath + " for indexing");
+    }
+    BgzfBlockLayout blockLayout(bgzfStream);
+
+    const bool isCsi = indexFormat_ == VcfIndexFormat::kCsi;
+    const int indexFormatCode = isCsi ? HTS_FMT_CSI : HTS_FMT_TBI;
+    // Same binning scheme as tabix uses by default
+    const int kMinShift = 14;
+    const int kMaxShift = 31;
+    const int numLevels = isCsi ? (kMaxShift - kMinShift + 2) / 3 : 5;
+
+    const uint64_t recordsStart = blockLayout.getVirtualOffset(recordsStartOffset_);
+    std::unique_ptr<hts_idx_t, void (*)(hts_idx_t*)> indexPtr(
+        hts_idx_init(0, indexFormatCode, recordsStart, kMinShift, numLevels), hts_idx_destroy);
+
+    for (const auto& interval : recordIntervals_)
+    {
+        const uint64_t recordEnd = blockLayout.getVirtualOffset(interval.uncompressedEndOffset);
+        const int status
+            = hts_idx_push(indexPtr.get(), interval.contigIndex, interval.start, interval.end, recordEnd, 1);
+        if (status < 0)
+        {
+            throw std::runtime_error("Failed to index " + vcfPath + "; records must be sorted by position");
+        }
+    }
+
+    hts_idx_finish(indexPtr.get(), blockLayout.getVirtualOffset(uncompressedSize));
+
+    vector<uint8_t> metadata = encodeIndexMetadata(contigNames_);
+    hts_idx_set_meta(indexPtr.get(), metadata.size(), metadata.data(), 1);
+
+    // hts_idx_save does not report errors in htslib 1.3.1, so a failure is detected by the missing index file
+    const string indexPath = vcfPath + (isCsi ? ".csi" : ".tbi");
+    fs::remove(indexPath);
+    hts_idx_save(indexPtr.get(), vcfPath.c_str(), indexFormatCode);
+    boost::system::error_code errorCode;
+    if (fs::file_size(indexPath, errorCode) == 0 || errorCode)
+    {
+        throw std::runtime_error("Failed to write index of " + vcfPath);
+    }
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "common/Parameters.hh"
+
+namespace ehunter
+{
+
+// Positions of the blocks of a BGZF file; translates offsets in the uncompressed data to BGZF virtual offsets
+class BgzfBlockLayout
+{
+public:
+    explicit BgzfBlockLayout(std::istream& bgzfStream);
+
+    // Offsets must be requested in non-decreasing order
+    uint64_t getVirtualOffset(uint64_t uncompressedOffset);
+
+private:
+    struct Block
+    {
+        uint64_t compressedStart;
+        uint64_t uncompressedStart;
+        uint32_t uncompressedSize;
+    };
+
+    std::vector<Block> blocks_;
+    uint64_t compressedSize_ = 0;
+    uint64_t uncompressedSize_ = 0;
+    std::size_t currentBlockIndex_ = 0;
+};
+
+// Collects the intervals covered by the records of a VCF while it is written and saves a tabix or CSI index for it
+// once the compressed file is complete. Records are located by their offsets in the uncompressed data, so the index
+// can be built for files compressed by several threads without decompressing them.
+class VcfIndexBuilder
+{
+public:
+    explicit VcfIndexBuilder(VcfIndexFormat indexFormat);
+
+    // Start and end of the records are 0-based and the end is exclusive
+    void setRecordsStartOffset(uint64_t uncompressedOffset) { recordsStartOffset_ = uncompressedOffset; }
+    void addRecord(const std::string& contig, int64_t start, int64_t end, uint64_t uncompressedEndOffset);
+
+    void build(const std::string& vcfPath, uint64_t uncompressedSize);
+
+private:
+    struct RecordInterval
+    {
+        int32_t contigIndex;
+        int64_t start;
+        int64_t end;
+        uint64_t uncompressedEndOffset;
+    };
+
+    VcfIndexFormat indexFormat_;
+    uint64_t recordsStartOffset_ = 0;
+    std::vector<std::string> contigNames_;
+    std::vector<RecordInterval> recordIntervals_;
+};
+
+}
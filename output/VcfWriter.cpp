@@ -20,14 +20,19 @@
 
 #include "output/VcfWriter.hh"
 
+#include <algorithm>
+#include <cstdio>
 #include <deque>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/join.hpp>
 
-#include "output/VcfHeader.hh"
+#include "output/BgzfFileSink.hh"
 #include "output/VcfWriterHelpers.hh"
 #include "stats/ReadSupportCalculator.hh"
 
@@ -55,42 +60,203 @@ void writeBodyHeader(const string& sampleName, ostream& out)
     out << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t" << sampleName << "\n";
 }
 
-std::ostream& operator<<(std::ostream& out, VcfWriter& vcfWriter)
+VcfWriter::VcfWriter(
+    const string& sampleName, int readLength, Reference& reference, string vcfPath,
+    const OutputParameters& outputParameters)
+    : sampleName_(sampleName)
+    , readLength_(readLength)
+    , referencePtr_(&reference)
+    , vcfPath_(std::move(vcfPath))
+    , outputParameters_(outputParameters)
+    , bodySpool_(vcfPath_ + ".body")
 {
-    outputVcfHeader(vcfWriter.regionCatalog_, vcfWriter.sampleFindings_, out);
-    writeBodyHeader(vcfWriter.sampleName_, out);
-    vcfWriter.writeBody(out);
-    return out;
+    for (const auto& contigNameAndLength : reference.contigs())
+    {
+        contigIndexes_.emplace(contigNameAndLength.first, static_cast<int32_t>(contigNames_.size()));
+        contigNames_.push_back(contigNameAndLength.first);
+    }
 }
 
-VcfWriter::VcfWriter(
-    const string& sampleName, int readLength, const RegionCatalog& regionCatalog, const SampleFindings& sampleFindings,
-    Reference& reference)
+VcfWriter::VcfWriter(const string& sampleName, string vcfPath, const OutputParameters& outputParameters)
     : sampleName_(sampleName)
-    , readLength_(readLength)
-    , regionCatalog_(regionCatalog)
-    , sampleFindings_(sampleFindings)
-    , reference_(reference)
+    , readLength_(0)
+    , referencePtr_(nullptr)
+    , vcfPath_(std::move(vcfPath))
+    , outputParameters_(outputParameters)
+    , bodySpool_(vcfPath_ + ".body")
+{
+}
+
+void VcfWriter::write(const LocusSpecification& locusSpec, const RegionFindings& locusFindings)
 {
+    vector<string> records;
+    formatRecords(locusSpec, locusFindings, records, fieldDescriptionCatalog_);
+    for (const auto& record : records)
+    {
+        addRecord(record);
+    }
 }
 
-void VcfWriter::writeBody(ostream& out)
+void VcfWriter::formatRecords(
+    const LocusSpecification& locusSpec, const RegionFindings& locusFindings, vector<string>& records,
+    FieldDescriptionCatalog& fieldDescriptions) const
 {
-    for (const auto& regionIdAndFindings : sampleFindings_)
+    if (!referencePtr_)
     {
-        const string& regionId = regionIdAndFindings.first;
-        const LocusSpecification& regionSpec = regionCatalog_.at(regionId);
-        const RegionFindings& regionFindings = regionIdAndFindings.second;
+        throw std::logic_error("Writing variant findings requires a reference");
+    }
+
+    for (const auto& variantSpec : locusSpec.variantSpecs())
+    {
+        const auto variantFindingsIter = locusFindings.find(variantSpec.id());
+        if (variantFindingsIter == locusFindings.end())
+        {
+            continue;
+        }
+
+        FieldDescriptionWriter descriptionWriter(locusSpec, variantSpec);
+        variantFindingsIter->second->accept(&descriptionWriter);
+        descriptionWriter.dumpTo(fieldDescriptions);
 
-        for (const auto& variantIdAndFindings : regionFindings)
+        std::ostringstream recordStream;
+        VariantVcfWriter variantWriter(locusSpec, variantSpec, readLength_, *referencePtr_, recordStream);
+        variantFindingsIter->second->accept(&variantWriter);
+        if (!recordStream.str().empty())
         {
-            const string& variantId = variantIdAndFindings.first;
-            const VariantSpecification& variantSpec = regionSpec.getVariantSpecById(variantId);
+            records.push_back(recordStream.str());
+        }
+    }
+}
 
-            VariantVcfWriter variantWriter(regionSpec, variantSpec, readLength_, reference_, out);
-            variantIdAndFindings.second->accept(&variantWriter);
+static string extractInfoValue(const string& infoFields, const string& key)
+{
+    vector<string> fields;
+    boost::algorithm::split(fields, infoFields, boost::is_any_of(";"));
+    for (const auto& field : fields)
+    {
+        if (field.compare(0, key.length() + 1, key + "=") == 0)
+        {
+            return field.substr(key.length() + 1);
         }
     }
+    return "";
+}
+
+void VcfWriter::addRecord(const string& record)
+{
+    if (record.empty())
+    {
+        return;
+    }
+
+    vector<string> fields;
+    boost::algorithm::split(fields, record, boost::is_any_of("\t"));
+    const string& contig = fields[0];
+    const int64_t position = std::stoll(fields[1]);
+    const string& refSequence = fields[3];
+    const string endEncoding = extractInfoValue(fields[7], "END");
+
+    // 0-based half-open interval covered by the record as defined by tabix
+    const int64_t start = position - 1;
+    const int64_t end = endEncoding.empty() ? start + refSequence.length() : std::stoll(endEncoding);
+
+    auto contigIter = contigIndexes_.find(contig);
+    if (contigIter == contigIndexes_.end())
+    {
+        contigIter = contigIndexes_.emplace(contig, static_cast<int32_t>(contigNames_.size())).first;
+        contigNames_.push_back(contig);
+    }
+
+    recordLocations_.push_back(
+        { contigIter->second, start, end, bodySpoolSize_, static_cast<uint32_t>(record.length()) });
+    bodySpool_.stream() << record;
+    bodySpoolSize_ += record.length();
+}
+
+void VcfWriter::addFieldDescription(const FieldDescription& fieldDescription)
+{
+    const auto key = std::make_pair(fieldDescription.fieldType, fieldDescription.id);
+    fieldDescriptionCatalog_.emplace(key, fieldDescription);
+}
+
+uint64_t VcfWriter::writeSortedRecords(ostream& out, VcfIndexBuilder* indexBuilderPtr)
+{
+    std::ostringstream headerStream;
+    outputVcfHeader(fieldDescriptionCatalog_, headerStream);
+    writeBodyHeader(sampleName_, headerStream);
+    const string header = headerStream.str();
+    out << header;
+
+    uint64_t uncompressedSize = header.length();
+    if (indexBuilderPtr)
+    {
+        indexBuilderPtr->setRecordsStartOffset(uncompressedSize);
+    }
+
+    std::ifstream body(bodySpool_.path(), std::ios::binary);
+    if (!body.is_open())
+    {
+        throw std::runtime_error("Failed to read back VCF records from " + bodySpool_.path());
+    }
+
+    string record;
+    for (const auto& location : recordLocations_)
+    {
+        record.resize(location.length);
+        body.seekg(location.spoolOffset);
+        body.read(&record[0], location.length);
+        if (!body)
+        {
+            throw std::runtime_error("Failed to read back VCF records from " + bodySpool_.path());
+        }
+
+        out << record;
+        uncompressedSize += location.length;
+        if (indexBuilderPtr)
+        {
+            const string& contig = contigNames_[location.contigIndex];
+            indexBuilderPtr->addRecord(contig, location.start, location.end, uncompressedSize);
+        }
+    }
+
+    return uncompressedSize;
+}
+
+void VcfWriter::close()
+{
+    bodySpool_.close();
+
+    auto comparePositions = [](const RecordLocation& location, const RecordLocation& otherLocation) {
+        if (location.contigIndex != otherLocation.contigIndex)
+        {
+            return location.contigIndex < otherLocation.contigIndex;
+        }
+        return location.start < otherLocation.start;
+    };
+    std::stable_sort(recordLocations_.begin(), recordLocations_.end(), comparePositions);
+
+    if (!outputParameters_.compressVcf())
+    {
+        BufferedFileSink vcfFile(vcfPath_);
+        writeSortedRecords(vcfFile.stream(), nullptr);
+        vcfFile.close();
+    }
+    else if (outputParameters_.vcfIndexFormat() == VcfIndexFormat::kNone)
+    {
+        BgzfFileSink vcfFile(vcfPath_, outputParameters_.numCompressionThreads());
+        writeSortedRecords(vcfFile.stream(), nullptr);
+        vcfFile.close();
+    }
+    else
+    {
+        VcfIndexBuilder indexBuilder(outputParameters_.vcfIndexFormat());
+        BgzfFileSink vcfFile(vcfPath_, outputParameters_.numCompressionThreads());
+        const uint64_t uncompressedSize = writeSortedRecords(vcfFile.stream(), &indexBuilder);
+        vcfFile.close();
+        indexBuilder.build(vcfPath_, uncompressedSize);
+    }
+
+    std::remove(bodySpool_.path().c_str());
 }
 
 static string createRepeatAlleleSymbol(int repeatSize) { return "<STR" + std::to_string(repeatSize) + ">"; }
@@ -226,7 +392,7 @@ void VariantVcfWriter::visit(const RepeatFindings* repeatFindingsPtr)
                                          "GT:SO:REPCN:REPCI:ADSP:ADFL:ADIR",
                                          sampleFields };
 
-    out_ << boost::algorithm::join(vcfRecordElements, "\t") << std::endl;
+    out_ << boost::algorithm::join(vcfRecordElements, "\t") << "\n";
 }
 
 void VariantVcfWriter::visit(const SmallVariantFindings* smallVariantFindingsPtr)
@@ -324,7 +490,7 @@ void VariantVcfWriter::visit(const SmallVariantFindings* smallVariantFindingsPtr
                          infoFields,
                          sampleField,
                          sampleValue };
-    out_ << boost::algorithm::join(line, "\t") << std::endl;
+    out_ << boost::algorithm::join(line, "\t") << "\n";
 }
 
 }
@@ -20,12 +20,18 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
+#include "common/BufferedFileSink.hh"
+#include "common/Parameters.hh"
 #include "common/Reference.hh"
+#include "output/VcfHeader.hh"
+#include "output/VcfIndexBuilder.hh"
 #include "region_analysis/VariantFindings.hh"
 #include "region_spec/LocusSpecification.hh"
 
@@ -59,26 +65,55 @@ private:
 };
 
 // TODO: Document the code after multi-unit repeat format is finalized (GT-598)
+//
+// The header depends on the calls made, so records are spooled to <vcf>.body as each locus is written; close() then
+// writes the header followed by the spooled records sorted by position and removes the spool. Contigs are sorted in
+// the order of the reference or, without one, in the order in which they first appear. A compressed VCF is indexed as
+// it is written.
 class VcfWriter
 {
 public:
     VcfWriter(
-        const std::string& sampleName, int readLength, const RegionCatalog& regionCatalog,
-        const SampleFindings& sampleFindings, Reference& reference);
+        const std::string& sampleName, int readLength, Reference& reference, std::string vcfPath,
+        const OutputParameters& outputParameters);
+
+    // Writer of records that were already formatted, for example by the runs that analyzed shards of a catalog
+    VcfWriter(const std::string& sampleName, std::string vcfPath, const OutputParameters& outputParameters);
+
+    void write(const LocusSpecification& locusSpec, const RegionFindings& locusFindings);
+
+    // Appends the records of the variants of a locus and the descriptions of the fields they use without writing them
+    void formatRecords(
+        const LocusSpecification& locusSpec, const RegionFindings& locusFindings, std::vector<std::string>& records,
+        FieldDescriptionCatalog& fieldDescriptions) const;
 
-    friend std::ostream& operator<<(std::ostream& out, VcfWriter& vcfWriter);
+    void addRecord(const std::string& record);
+    void addFieldDescription(const FieldDescription& fieldDescription);
+    void close();
 
 private:
-    void writeHeader(std::ostream& out);
-    void writeBody(std::ostream& out);
+    struct RecordLocation
+    {
+        int32_t contigIndex;
+        int64_t start;
+        int64_t end;
+        uint64_t spoolOffset;
+        uint32_t length;
+    };
+
+    uint64_t writeSortedRecords(std::ostream& out, VcfIndexBuilder* indexBuilderPtr);
 
     const std::string sampleName_;
     const int readLength_;
-    const RegionCatalog& regionCatalog_;
-    const SampleFindings& sampleFindings_;
-    Reference& reference_;
+    Reference* referencePtr_;
+    const std::string vcfPath_;
+    const OutputParameters outputParameters_;
+    BufferedFileSink bodySpool_;
+    uint64_t bodySpoolSize_ = 0;
+    FieldDescriptionCatalog fieldDescriptionCatalog_;
+    std::map<std::string, int32_t> contigIndexes_;
+    std::vector<std::string> contigNames_;
+    std::vector<RecordLocation> recordLocations_;
 };
 
-std::ostream& operator<<(std::ostream& out, VcfWriter& vcfWriter);
-
 }
@@ -0,0 +1,81 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/YamlAlignmentWriter.hh"
+
+#include <ostream>
+#include <vector>
+
+#include "graphalign/GraphAlignmentOperations.hh"
+#include "graphutils/SequenceOperations.hh"
+
+namespace ehunter
+{
+
+using graphtools::GraphAlignment;
+using graphtools::splitStringByDelimiter;
+using std::string;
+using std::vector;
+
+static string indentMultilineString(const string str, int32_t indentation_len)
+{
+    string indented_str;
+    const vector<string> lines = splitStringByDelimiter(str, '\n');
+    for (auto& line : lines)
+    {
+        if (!indented_str.empty())
+        {
+            indented_str += '\n';
+        }
+        indented_str += string(indentation_len, ' ') + line;
+    }
+
+    return indented_str;
+}
+
+YamlAlignmentWriter::YamlAlignmentWriter(const string& logPath)
+    : logFile_(logPath)
+{
+}
+
+void YamlAlignmentWriter::write(
+    const LocusSpecification& locusSpec, const reads::Read& read, const GraphAlignment& alignment)
+{
+    std::ostream& out = logFile_.stream();
+    if (locusSpec.regionId() != currentLocusId_)
+    {
+        currentLocusId_ = locusSpec.regionId();
+        out << currentLocusId_ << ":\n";
+    }
+
+    const int32_t indentationSize = 2;
+    const string spacer(indentationSize, ' ');
+    out << spacer << "- name: " << read.read_id << "\n";
+    out << spacer << "  path: " << alignment.path() << "\n";
+    out << spacer << "  graph_cigar: " << alignment.generateCigar() << "\n";
+    out << spacer << "  alignment: |\n";
+    const string alignmentEncoding = prettyPrint(alignment, read.sequence);
+    out << indentMultilineString(alignmentEncoding, 3 * indentationSize) << "\n";
+}
+
+void YamlAlignmentWriter::close() { logFile_.close(); }
+
+}
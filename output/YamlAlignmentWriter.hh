@@ -0,0 +1,48 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <string>
+
+#include "common/BufferedFileSink.hh"
+#include "output/AlignmentWriter.hh"
+
+namespace ehunter
+{
+
+// Writes human-readable alignments grouped by locus in YAML format
+class YamlAlignmentWriter : public AlignmentWriter
+{
+public:
+    explicit YamlAlignmentWriter(const std::string& logPath);
+
+    void write(
+        const LocusSpecification& locusSpec, const reads::Read& read,
+        const graphtools::GraphAlignment& alignment) override;
+    void close() override;
+
+private:
+    BufferedFileSink logFile_;
+    std::string currentLocusId_;
+};
+
+}
@@ -0,0 +1,94 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/FindingsReorderBuffer.hh"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "input/GraphBlueprint.hh"
+#include "input/RegionGraph.hh"
+
+using graphtools::Graph;
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+static RegionCatalog makeCatalog(const vector<string>& locusIds)
+{
+    RegionCatalog catalog;
+    for (const auto& locusId : locusIds)
+    {
+        Graph graph = makeRegionGraph(decodeFeaturesFromRegex("ATTCGA(C)*ATGTCG"));
+        LocusSpecification locusSpec(locusId, { Region("chr1:1-2") }, AlleleCount::kTwo, graph);
+        catalog.emplace(locusId, std::move(locusSpec));
+    }
+    return catalog;
+}
+
+TEST(ReorderingLocusFindings, FindingsInCatalogOrder_PassedOnImmediately)
+{
+    const RegionCatalog catalog = makeCatalog({ "locus1", "locus2" });
+    vector<string> passedOnLoci;
+    FindingsReorderBuffer buffer(catalog, [&](const LocusSpecification& locusSpec, const RegionFindings&) {
+        passedOnLoci.push_back(locusSpec.regionId());
+    });
+
+    buffer.add("locus1", RegionFindings());
+    EXPECT_EQ(vector<string>({ "locus1" }), passedOnLoci);
+    buffer.add("locus2", RegionFindings());
+    EXPECT_EQ(vector<string>({ "locus1", "locus2" }), passedOnLoci);
+    EXPECT_TRUE(buffer.isComplete());
+}
+
+TEST(ReorderingLocusFindings, FindingsOutOfCatalogOrder_HeldUntilPrecedingLociArrive)
+{
+    const RegionCatalog catalog = makeCatalog({ "locus1", "locus2", "locus3" });
+    vector<string> passedOnLoci;
+    FindingsReorderBuffer buffer(catalog, [&](const LocusSpecification& locusSpec, const RegionFindings&) {
+        passedOnLoci.push_back(locusSpec.regionId());
+    });
+
+    buffer.add("locus3", RegionFindings());
+    buffer.add("locus2", RegionFindings());
+    EXPECT_TRUE(passedOnLoci.empty());
+    EXPECT_EQ(2u, buffer.numPendingLoci());
+
+    buffer.add("locus1", RegionFindings());
+    EXPECT_EQ(vector<string>({ "locus1", "locus2", "locus3" }), passedOnLoci);
+    EXPECT_EQ(0u, buffer.numPendingLoci());
+    EXPECT_TRUE(buffer.isComplete());
+}
+
+TEST(ReorderingLocusFindings, UnexpectedFindings_ExceptionThrown)
+{
+    const RegionCatalog catalog = makeCatalog({ "locus1", "locus2" });
+    FindingsReorderBuffer buffer(catalog, [](const LocusSpecification&, const RegionFindings&) {});
+
+    EXPECT_THROW(buffer.add("locus3", RegionFindings()), std::logic_error);
+
+    buffer.add("locus1", RegionFindings());
+    EXPECT_THROW(buffer.add("locus1", RegionFindings()), std::logic_error);
+}
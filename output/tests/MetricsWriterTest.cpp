@@ -0,0 +1,91 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/MetricsWriter.hh"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+using Json = nlohmann::json;
+
+using namespace ehunter;
+
+TEST(AggregatingMetrics, MetricsOfLociAndSampleWideWork_Summed)
+{
+    SampleMetrics sampleMetrics;
+    sampleMetrics.sampleWideMetrics().numReadsDecoded = 100;
+    sampleMetrics.sampleWideMetrics().seconds(AnalysisStage::kReadDecoding) = 2.0;
+
+    LocusMetrics& locus1Metrics = sampleMetrics.addLocus("locus1");
+    LocusMetrics& locus2Metrics = sampleMetrics.addLocus("locus2");
+    locus1Metrics.numReadsAligned = 3;
+    locus1Metrics.numReadsRejected = 1;
+    locus1Metrics.seconds(AnalysisStage::kGenotyping) = 0.5;
+    locus2Metrics.numReadsAligned = 4;
+    locus2Metrics.numMateSeeks = 2;
+    locus2Metrics.seconds(AnalysisStage::kGenotyping) = 0.25;
+
+    const LocusMetrics totalMetrics = sampleMetrics.total();
+    EXPECT_EQ(100, totalMetrics.numReadsDecoded);
+    EXPECT_EQ(7, totalMetrics.numReadsAligned);
+    EXPECT_EQ(1, totalMetrics.numReadsRejected);
+    EXPECT_EQ(2, totalMetrics.numMateSeeks);
+    EXPECT_DOUBLE_EQ(2.0, totalMetrics.seconds(AnalysisStage::kReadDecoding));
+    EXPECT_DOUBLE_EQ(0.75, totalMetrics.seconds(AnalysisStage::kGenotyping));
+}
+
+TEST(TimingStages, MissingMetrics_NothingMeasured)
+{
+    LocusMetrics metrics;
+    {
+        StageTimer timer(&metrics, AnalysisStage::kOutput);
+        StageTimer idleTimer(nullptr, AnalysisStage::kOutput);
+    }
+
+    EXPECT_GE(metrics.seconds(AnalysisStage::kOutput), 0.0);
+    EXPECT_EQ(0.0, metrics.seconds(AnalysisStage::kGenotyping));
+}
+
+TEST(WritingMetrics, TypicalSampleMetrics_LociWrittenInOrderOfAnalysis)
+{
+    SampleMetrics sampleMetrics;
+    sampleMetrics.addLocus("locus2").numIndexCacheHits = 2;
+    LocusMetrics& locus1Metrics = sampleMetrics.addLocus("locus1");
+    locus1Metrics.numGappedTierReads = 5;
+    locus1Metrics.numNarrowScorePieces = 8;
+    locus1Metrics.numNarrowScoreOverflows = 3;
+
+    std::ostringstream out;
+    writeSampleMetrics("sample", 1.5, sampleMetrics, out);
+    const Json record = Json::parse(out.str());
+
+    EXPECT_EQ("sample", record["SampleId"]);
+    EXPECT_DOUBLE_EQ(1.5, record["WallTimeSeconds"].get<double>());
+    ASSERT_EQ(2u, record["Loci"].size());
+    EXPECT_EQ("locus2", record["Loci"][0]["LocusId"]);
+    EXPECT_EQ(2, record["Loci"][0]["IndexCacheHits"]);
+    EXPECT_EQ("locus1", record["Loci"][1]["LocusId"]);
+    EXPECT_EQ(5, record["Loci"][1]["ReadsResolvedByGappedTier"]);
+    EXPECT_EQ(5, record["Total"]["ReadsResolvedByGappedTier"]);
+    EXPECT_EQ(8, record["Loci"][1]["PiecesAlignedWith8BitScores"]);
+    EXPECT_EQ(3, record["Total"]["PiecesRealignedWith16BitScores"]);
+    EXPECT_EQ(0.0, record["Total"]["StageSeconds"]["MateRecovery"].get<double>());
+}
@@ -0,0 +1,161 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/OutputCheckpoint.hh"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+namespace fs = boost::filesystem;
+using std::string;
+
+using namespace ehunter;
+
+class CheckpointingLoci : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory_ = fs::temp_directory_path() / fs::unique_path();
+        fs::create_directories(directory_);
+        path_ = (directory_ / "sample.checkpoint").string();
+
+        records_.jsonRecords.push_back(nlohmann::json({ { "VariantId", "locus1" }, { "Genotype", "5/7" } }));
+        records_.vcfRecords.push_back("chr1\t100\t.\tA\t<STR7>\t.\tPASS\tEND=110;REPID=locus1\tGT\t0/1\n");
+        FieldDescription description(FieldType::kInfo, "END", "1", "Integer", "End position of the variant");
+        records_.vcfFieldDescriptions.emplace(std::make_pair(FieldType::kInfo, string("END")), description);
+
+        settings_ = nlohmann::json({ { "Catalog", "catalog.json" }, { "Aligner", "dag-aligner" } });
+    }
+
+    void TearDown() override { fs::remove_all(directory_); }
+
+    fs::path directory_;
+    string path_;
+    LocusOutputRecords records_;
+    nlohmann::json settings_;
+};
+
+TEST_F(CheckpointingLoci, SavedLoci_Loaded)
+{
+    CheckpointWriter writer(path_, "sample", settings_, 0);
+    writer.write("locus1", records_);
+    writer.write("locus2", LocusOutputRecords());
+    writer.close();
+
+    const OutputCheckpoint checkpoint = loadOutputCheckpoint(path_, "sample", settings_);
+    ASSERT_EQ(2u, checkpoint.completedLoci.size());
+    EXPECT_EQ(fs::file_size(path_), checkpoint.validSize);
+
+    const LocusOutputRecords& loadedRecords = checkpoint.completedLoci.at("locus1");
+    EXPECT_EQ(records_.jsonRecords, loadedRecords.jsonRecords);
+    EXPECT_EQ(records_.vcfRecords, loadedRecords.vcfRecords);
+    ASSERT_EQ(1u, loadedRecords.vcfFieldDescriptions.size());
+    EXPECT_EQ("End position of the variant", loadedRecords.vcfFieldDescriptions.begin()->second.description);
+
+    EXPECT_THROW(loadOutputCheckpoint(path_, "otherSample", settings_), std::invalid_argument);
+}
+
+TEST_F(CheckpointingLoci, TruncatedLastRecord_DroppedAndOverwritten)
+{
+    CheckpointWriter writer(path_, "sample", settings_, 0);
+    writer.write("locus1", records_);
+    writer.write("locus2", records_);
+    writer.close();
+    fs::resize_file(path_, fs::file_size(path_) - 10);
+
+    const OutputCheckpoint checkpoint = loadOutputCheckpoint(path_, "sample", settings_);
+    EXPECT_EQ(1u, checkpoint.completedLoci.count("locus1"));
+    EXPECT_EQ(0u, checkpoint.completedLoci.count("locus2"));
+
+    CheckpointWriter resumedWriter(path_, "sample", settings_, checkpoint.validSize);
+    resumedWriter.write("locus2", records_);
+    resumedWriter.close();
+
+    EXPECT_EQ(2u, loadOutputCheckpoint(path_, "sample", settings_).completedLoci.size());
+}
+
+TEST_F(CheckpointingLoci, MissingCheckpoint_Empty)
+{
+    const OutputCheckpoint checkpoint = loadOutputCheckpoint(path_, "sample", settings_);
+    EXPECT_TRUE(checkpoint.completedLoci.empty());
+    EXPECT_EQ(0u, checkpoint.validSize);
+}
+
+TEST_F(CheckpointingLoci, WrittenLocus_FlushedBeforeClose)
+{
+    CheckpointWriter writer(path_, "sample", settings_, 0);
+    writer.write("locus1", records_);
+
+    EXPECT_EQ(1u, loadOutputCheckpoint(path_, "sample", settings_).completedLoci.count("locus1"));
+    writer.close();
+}
+
+TEST_F(CheckpointingLoci, DifferentSettings_Rejected)
+{
+    CheckpointWriter writer(path_, "sample", settings_, 0);
+    writer.write("locus1", records_);
+    writer.close();
+
+    nlohmann::json otherSettings = settings_;
+    otherSettings["Aligner"] = "path-aligner";
+    EXPECT_THROW(loadOutputCheckpoint(path_, "sample", otherSettings), std::invalid_argument);
+}
+
+TEST_F(CheckpointingLoci, EditedCatalog_ChangesSettings)
+{
+    const string catalogPath = (directory_ / "catalog.json").string();
+    std::ofstream(catalogPath) << "[{\"LocusId\": \"locus1\"}]";
+    const InputPaths inputPaths("sample.bam", "reference.fa", catalogPath);
+    const SampleParameters sampleParams("sample", Sex::kFemale, 150);
+    const HeuristicParameters heuristicParams(false, 1000, 20, true, "dag-aligner");
+    const nlohmann::json settings = encodeCheckpointSettings(inputPaths, sampleParams, heuristicParams, CatalogShard());
+    EXPECT_EQ(settings, encodeCheckpointSettings(inputPaths, sampleParams, heuristicParams, CatalogShard()));
+
+    std::ofstream(catalogPath) << "[{\"LocusId\": \"locus2\"}]";
+    EXPECT_NE(settings, encodeCheckpointSettings(inputPaths, sampleParams, heuristicParams, CatalogShard()));
+}
+
+
+TEST_F(CheckpointingLoci, OtherReadsOrShard_ChangesSettings)
+{
+    const string catalogPath = (directory_ / "catalog.json").string();
+    std::ofstream(catalogPath) << "[{\"LocusId\": \"locus1\"}]";
+    const SampleParameters sampleParams("sample", Sex::kFemale, 150);
+    const HeuristicParameters heuristicParams(false, 1000, 20, true, "dag-aligner");
+    const nlohmann::json settings = encodeCheckpointSettings(
+        InputPaths("run1/sample.bam", "reference.fa", catalogPath), sampleParams, heuristicParams, CatalogShard(0, 2));
+
+    EXPECT_NE(
+        settings,
+        encodeCheckpointSettings(
+            InputPaths("run2/sample.bam", "reference.fa", catalogPath), sampleParams, heuristicParams,
+            CatalogShard(0, 2)));
+    EXPECT_NE(
+        settings,
+        encodeCheckpointSettings(
+            InputPaths("run1/sample.bam", "reference.fa", catalogPath), sampleParams, heuristicParams,
+            CatalogShard(1, 2)));
+}
@@ -0,0 +1,144 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/OutputMerging.hh"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "output/VcfHeader.hh"
+#include "output/VcfWriter.hh"
+
+namespace fs = boost::filesystem;
+using std::string;
+using std::vector;
+
+using namespace ehunter;
+
+static string readFile(const string& path)
+{
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static void writeFile(const string& path, const string& contents)
+{
+    std::ofstream file(path);
+    file << contents;
+}
+
+class MergingShardOutputs : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory_ = fs::temp_directory_path() / fs::unique_path();
+        fs::create_directories(directory_);
+    }
+
+    void TearDown() override { fs::remove_all(directory_); }
+
+    string path(const string& filename) const { return (directory_ / filename).string(); }
+
+    // Writes the records with a VCF writer, which sorts them, as the run analyzing the loci of the records would
+    void writeVcf(const string& vcfPath, const vector<string>& records) const
+    {
+        VcfWriter vcfWriter("sample", vcfPath, OutputParameters());
+        vcfWriter.addFieldDescription(FieldDescription(FieldType::kFilter, "PASS", "", "", "All filters passed"));
+        for (const auto& record : records)
+        {
+            vcfWriter.addRecord(record);
+            if (record.find("REPID") != string::npos)
+            {
+                vcfWriter.addFieldDescription(
+                    FieldDescription(FieldType::kInfo, "REPID", "1", "String", "Repeat identifier"));
+            }
+        }
+        vcfWriter.close();
+    }
+
+    fs::path directory_;
+};
+
+TEST_F(MergingShardOutputs, VcfsOfConsecutiveShards_MergedIntoVcfOfSingleRun)
+{
+    // Records in catalog order; the second and the third record start at the same position
+    const vector<string> records
+        = { "chr2\t100\t.\tA\t<STR5>\t.\tPASS\tEND=110;REPID=locus1\tGT\t0/1\n",
+            "chr1\t500\t.\tC\tT\t.\tPASS\t.\tGT\t0/1\n",
+            "chr1\t500\t.\tC\t<STR7>\t.\tPASS\tEND=530;REPID=locus3\tGT\t1/1\n",
+            "chr1\t200\t.\tG\tA\t.\tPASS\t.\tGT\t0/1\n",
+            "chr2\t50\t.\tT\t<STR9>\t.\tPASS\tEND=80;REPID=locus5\tGT\t0/1\n" };
+
+    writeVcf(path("single.vcf"), records);
+    writeVcf(path("shard1.vcf"), vector<string>(records.begin(), records.begin() + 2));
+    writeVcf(path("shard2.vcf"), vector<string>(records.begin() + 2, records.end()));
+
+    mergeShardVcfOutputs({ path("shard1.vcf"), path("shard2.vcf") }, path("merged.vcf"), OutputParameters());
+
+    EXPECT_EQ(readFile(path("single.vcf")), readFile(path("merged.vcf")));
+}
+
+TEST_F(MergingShardOutputs, JsonOutputsOfShards_Concatenated)
+{
+    writeFile(path("shard1.json"), "[\n    {\n        \"VariantId\": \"locus1\"\n    }\n]\n");
+    writeFile(path("shard2.json"), "[]\n");
+    writeFile(
+        path("shard3.json"),
+        "[\n    {\n        \"VariantId\": \"locus2\"\n    },\n    {\n        \"VariantId\": \"locus3\"\n    }\n]\n");
+
+    std::ostringstream mergedJson;
+    mergeShardJsonOutputs({ path("shard1.json"), path("shard2.json"), path("shard3.json") }, mergedJson);
+
+    const string expectedJson = "[\n    {\n        \"VariantId\": \"locus1\"\n    },\n    {\n        \"VariantId\": "
+                                "\"locus2\"\n    },\n    {\n        \"VariantId\": \"locus3\"\n    }\n]\n";
+    EXPECT_EQ(expectedJson, mergedJson.str());
+}
+
+TEST(DecodingVcfFieldDescriptions, EncodedDescriptions_Decoded)
+{
+    const vector<FieldDescription> descriptions
+        = { FieldDescription(FieldType::kInfo, "END", "1", "Integer", "End position of the variant"),
+            FieldDescription(FieldType::kFormat, "SO", "1", "String", "Type of reads; can be SPANNING, or FLANKING"),
+            FieldDescription(FieldType::kAlt, "STR5", "", "", "Allele comprised of 5 repeat units") };
+
+    for (const auto& description : descriptions)
+    {
+        std::ostringstream encoding;
+        encoding << description;
+        const FieldDescription decodedDescription = decodeFieldDescription(encoding.str());
+
+        EXPECT_EQ(description.fieldType, decodedDescription.fieldType);
+        EXPECT_EQ(description.id, decodedDescription.id);
+        EXPECT_EQ(description.number, decodedDescription.number);
+        EXPECT_EQ(description.contentType, decodedDescription.contentType);
+        EXPECT_EQ(description.description, decodedDescription.description);
+    }
+
+    EXPECT_THROW(decodeFieldDescription("##INFO=<ID=END,Number=1>"), std::invalid_argument);
+}
@@ -0,0 +1,108 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/ReadCountSummary.hh"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+namespace fs = boost::filesystem;
+using std::string;
+
+using namespace ehunter;
+
+class SummarizingReadCounts : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory_ = fs::temp_directory_path() / fs::unique_path();
+        fs::create_directories(directory_);
+        path_ = (directory_ / "sample.counts").string();
+    }
+
+    void TearDown() override { fs::remove_all(directory_); }
+
+    fs::path directory_;
+    string path_;
+};
+
+TEST_F(SummarizingReadCounts, SavedCounts_Loaded)
+{
+    const CountTable spanningCounts(std::map<int32_t, int32_t>({ { 5, 10 }, { 7, 8 } }));
+    const CountTable flankingCounts(std::map<int32_t, int32_t>({ { 3, 2 } }));
+    const CountTable inrepeatCounts(std::map<int32_t, int32_t>({ { 150, 1 } }));
+
+    RegionFindings locusFindings;
+    locusFindings.emplace(
+        "repeat", std::unique_ptr<VariantFindings>(new RepeatFindings(
+                      spanningCounts, flankingCounts, inrepeatCounts, boost::optional<RepeatGenotype>())));
+    locusFindings.emplace(
+        "indel", std::unique_ptr<VariantFindings>(new SmallVariantFindings(
+                     12, 0, AllelePresenceStatus::kPresent, AllelePresenceStatus::kAbsent,
+                     boost::optional<SmallVariantGenotype>())));
+
+    ReadCountSummaryWriter writer(path_);
+    writer.write("locus1", locusFindings);
+    writer.write("locus2", RegionFindings());
+    writer.close(SampleParameters("sample", Sex::kMale, 150, 15.5));
+
+    const ReadCountSummary summary = loadReadCountSummary(path_);
+    EXPECT_EQ("sample", summary.sampleId);
+    EXPECT_EQ(Sex::kMale, summary.sex);
+    EXPECT_EQ(150, summary.readLength);
+    EXPECT_DOUBLE_EQ(15.5, summary.haplotypeDepth);
+    ASSERT_EQ(2u, summary.loci.size());
+    EXPECT_TRUE(summary.loci.at("locus2").empty());
+
+    const LocusReadCounts& locusReadCounts = summary.loci.at("locus1");
+    ASSERT_EQ(2u, locusReadCounts.size());
+    const VariantReadCounts& repeatCounts = locusReadCounts.at("repeat");
+    EXPECT_EQ(VariantType::kRepeat, repeatCounts.variantType);
+    EXPECT_EQ(spanningCounts, repeatCounts.countsOfSpanningReads);
+    EXPECT_EQ(flankingCounts, repeatCounts.countsOfFlankingReads);
+    EXPECT_EQ(inrepeatCounts, repeatCounts.countsOfInrepeatReads);
+    const VariantReadCounts& indelCounts = locusReadCounts.at("indel");
+    EXPECT_EQ(VariantType::kSmallVariant, indelCounts.variantType);
+    EXPECT_EQ(12, indelCounts.numRefReads);
+    EXPECT_EQ(0, indelCounts.numAltReads);
+}
+
+TEST_F(SummarizingReadCounts, SummaryOfInterruptedRun_Rejected)
+{
+    {
+        ReadCountSummaryWriter writer(path_);
+        writer.write("locus1", RegionFindings());
+    }
+    EXPECT_THROW(loadReadCountSummary(path_), std::invalid_argument);
+}
+
+TEST_F(SummarizingReadCounts, FileOfOtherFormat_Rejected)
+{
+    std::ofstream(path_) << "{\"SampleId\": \"sample\"}\n";
+    EXPECT_THROW(loadReadCountSummary(path_), std::invalid_argument);
+}
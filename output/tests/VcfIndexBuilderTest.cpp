@@ -0,0 +1,80 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>,
+// Concept: Michael Eberle <meberle@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "output/VcfIndexBuilder.hh"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using std::string;
+
+using namespace ehunter;
+
+// Block with a valid BGZF header whose payload is not real compressed data
+static string makeBgzfBlock(int payloadSize, uint32_t uncompressedSize)
+{
+    const int blockSize = 18 + payloadSize + 8;
+    string block = { 31, static_cast<char>(139), 8, 4, 0, 0, 0, 0, 0, static_cast<char>(255), 6, 0, 'B', 'C', 2, 0 };
+    block += static_cast<char>((blockSize - 1) & 0xff);
+    block += static_cast<char>((blockSize - 1) >> 8);
+    block += string(payloadSize + 4, 'x');
+    for (int byteIndex = 0; byteIndex != 4; ++byteIndex)
+    {
+        block += static_cast<char>((uncompressedSize >> (8 * byteIndex)) & 0xff);
+    }
+    return block;
+}
+
+TEST(TranslatingUncompressedOffsets, OffsetsWithinBlocks_VirtualOffsetsComputed)
+{
+    const string firstBlock = makeBgzfBlock(10, 100);
+    const string secondBlock = makeBgzfBlock(20, 50);
+    const string eofBlock = makeBgzfBlock(2, 0);
+    std::istringstream bgzfStream(firstBlock + secondBlock + eofBlock);
+
+    BgzfBlockLayout blockLayout(bgzfStream);
+
+    const uint64_t secondBlockStart = firstBlock.size();
+    const uint64_t eofBlockStart = firstBlock.size() + secondBlock.size();
+    EXPECT_EQ(0u, blockLayout.getVirtualOffset(0));
+    EXPECT_EQ(99u, blockLayout.getVirtualOffset(99));
+    EXPECT_EQ(secondBlockStart << 16, blockLayout.getVirtualOffset(100));
+    EXPECT_EQ((secondBlockStart << 16) | 49, blockLayout.getVirtualOffset(149));
+    EXPECT_EQ(eofBlockStart << 16, blockLayout.getVirtualOffset(150));
+}
+
+TEST(TranslatingUncompressedOffsets, OffsetPastEndOfData_ExceptionThrown)
+{
+    std::istringstream bgzfStream(makeBgzfBlock(10, 100));
+    BgzfBlockLayout blockLayout(bgzfStream);
+
+    EXPECT_EQ(uint64_t(36) << 16, blockLayout.getVirtualOffset(100));
+    EXPECT_THROW(blockLayout.getVirtualOffset(101), std::logic_error);
+}
+
+TEST(TranslatingUncompressedOffsets, MalformedBlockHeader_ExceptionThrown)
+{
+    std::istringstream bgzfStream("not a bgzf file");
+    EXPECT_THROW(BgzfBlockLayout blockLayout(bgzfStream), std::runtime_error);
+}
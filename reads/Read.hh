@@ -83,21 +83,16 @@ namespace reads
     class RepeatAlignmentStats
     {
     public:
-        RepeatAlignmentStats(
-            const GraphAlignment& canonical_alignment, AlignmentType canonical_alignment_type,
-            int32_t num_repeat_units_spanned)
-            : canonical_alignment_(canonical_alignment)
-            , canonical_alignment_type_(canonical_alignment_type)
+        RepeatAlignmentStats(AlignmentType canonical_alignment_type, int32_t num_repeat_units_spanned)
+            : canonical_alignment_type_(canonical_alignment_type)
             , num_repeat_units_spanned_(num_repeat_units_spanned)
         {
         }
 
-        const GraphAlignment& canonicalAlignment() const { return canonical_alignment_; }
         AlignmentType canonicalAlignmentType() const { return canonical_alignment_type_; }
         int32_t numRepeatUnitsSpanned() const { return num_repeat_units_spanned_; }
 
     private:
-        GraphAlignment canonical_alignment_;
         AlignmentType canonical_alignment_type_;
         int32_t num_repeat_units_spanned_;
     };
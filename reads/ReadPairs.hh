@@ -64,6 +64,7 @@ namespace reads
         void AddMateToExistingRead(const Read& mate);
 
         const ReadPair& operator[](const std::string& fragment_id) const;
+        bool Contains(const std::string& fragment_id) const { return read_pairs_.count(fragment_id) != 0; }
 
         int32_t NumReads() const { return num_reads_; }
         int32_t NumCompletePairs() const;
@@ -28,6 +28,7 @@
 #include "graphalign/GraphAlignmentOperations.hh"
 #include "graphutils/SequenceOperations.hh"
 
+#include "alignment/AlignerSelection.hh"
 #include "alignment/AlignmentFilters.hh"
 #include "alignment/AlignmentTweakers.hh"
 #include "alignment/GraphAlignmentOperations.hh"
@@ -38,61 +39,79 @@ namespace ehunter
 {
 
 using boost::optional;
-using graphtools::Operation;
-using graphtools::OperationType;
-using graphtools::splitStringByDelimiter;
 using reads::LinearAlignmentStats;
 using reads::Read;
 using std::list;
 using std::string;
 using std::vector;
 
-static const string encodeReadPair(const Read& read, const Read& mate)
+// Cached indexes are built from the catalog's specification of the region and the others from the analyzer's copy
+static std::shared_ptr<const OrientationPredictor> getOrientationPredictor(
+    const LocusSpecification& catalogRegionSpec, const LocusSpecification& regionSpec,
+    const SampleParameters& sampleParams, RegionIndexCache* indexCachePtr, LocusMetrics* metricsPtr)
 {
-    return read.read_id + ": " + read.sequence + "\n" + mate.read_id + ": " + read.sequence;
+    if (indexCachePtr)
+    {
+        bool isCacheHit = false;
+        auto predictorPtr
+            = indexCachePtr->getOrientationPredictor(catalogRegionSpec, sampleParams.readLength(), &isCacheHit);
+        if (metricsPtr && isCacheHit)
+        {
+            ++metricsPtr->numIndexCacheHits;
+        }
+        return predictorPtr;
+    }
+    return std::make_shared<OrientationPredictor>(sampleParams.readLength(), &regionSpec.regionGraph());
 }
 
-static string indentMultilineString(const string str, int32_t indentation_len)
+static std::shared_ptr<const graphtools::KmerIndex> getAlignmentIndex(
+    const LocusSpecification& catalogRegionSpec, const LocusSpecification& regionSpec,
+    const HeuristicParameters& heuristicParams, RegionIndexCache* indexCachePtr, LocusMetrics* metricsPtr)
 {
-    string indented_str;
-    const vector<string> lines = splitStringByDelimiter(str, '\n');
-    for (auto& line : lines)
+    if (indexCachePtr)
     {
-        if (!indented_str.empty())
+        bool isCacheHit = false;
+        auto indexPtr = indexCachePtr->getAlignmentIndex(catalogRegionSpec, &isCacheHit);
+        if (metricsPtr && isCacheHit)
         {
-            indented_str += '\n';
+            ++metricsPtr->numIndexCacheHits;
         }
-        indented_str += string(indentation_len, ' ') + line;
+        return indexPtr;
     }
+    return std::make_shared<graphtools::KmerIndex>(regionSpec.regionGraph(), heuristicParams.kmerLenForAlignment());
+}
+
+// Bounds the reads held by each analyzer; in streaming mode every locus of the catalog keeps its pending pairs
+static const std::size_t kMaxNumPendingMates = 32;
 
-    return indented_str;
+static int computeMaxNumUnitsInRead(int readLength, int repeatUnitLength)
+{
+    return std::ceil(readLength / static_cast<double>(repeatUnitLength));
 }
 
-static void outputAlignedRead(const Read& read, GraphAlignment alignment, std::ostream& out)
+static const string encodeReadPair(const Read& read, const Read& mate)
 {
-    const int32_t indentationSize = 2;
-    const string spacer(indentationSize, ' ');
-    out << spacer << "- name: " << read.read_id << std::endl;
-    out << spacer << "  path: " << alignment.path() << std::endl;
-    out << spacer << "  graph_cigar: " << alignment.generateCigar() << std::endl;
-    out << spacer << "  alignment: |" << std::endl;
-    const string alignmentEncoding = prettyPrint(alignment, read.sequence);
-    out << indentMultilineString(alignmentEncoding, 3 * indentationSize) << std::endl;
+    return read.read_id + ": " + read.sequence + "\n" + mate.read_id + ": " + read.sequence;
 }
 
 RegionAnalyzer::RegionAnalyzer(
     const LocusSpecification& regionSpec, SampleParameters sampleParams, HeuristicParameters heuristicParams,
-    std::ostream& alignmentStream)
+    AlignmentWriter& alignmentWriter, RegionIndexCache* indexCachePtr, LocusMetrics* metricsPtr)
     : regionSpec_(regionSpec)
     , sampleParams_(sampleParams)
     , heuristicParams_(heuristicParams)
-    , alignmentStream_(alignmentStream)
-    , orientationPredictor_(sampleParams.readLength(), &regionSpec_.regionGraph())
+    , alignmentWriter_(alignmentWriter)
+    , orientationPredictorPtr_(
+          getOrientationPredictor(regionSpec, regionSpec_, sampleParams_, indexCachePtr, metricsPtr))
     , graphAligner_(
-          &regionSpec_.regionGraph(), heuristicParams.alignerType(), heuristicParams_.kmerLenForAlignment(),
-          heuristicParams_.paddingLength(), heuristicParams_.seedAffixTrimLength())
+          getAlignmentIndex(regionSpec, regionSpec_, heuristicParams_, indexCachePtr, metricsPtr),
+          resolveAlignerType(heuristicParams.alignerType(), regionSpec_.regionGraph()),
+          heuristicParams_.paddingLength(), heuristicParams_.seedAffixTrimLength(),
+          heuristicParams_.maxGaplessMismatches(), heuristicParams_.trimLowQualityBases())
+    , metricsPtr_(metricsPtr)
 {
     verboseLogger_ = spdlog::get("verbose");
+    graphAligner_.setMetrics(metricsPtr_);
 
     for (const auto& variantSpec : regionSpec_.variantSpecs())
     {
@@ -102,7 +121,7 @@ RegionAnalyzer::RegionAnalyzer(
             const int repeatNodeId = variantSpec.nodes().front();
             const string& repeatUnit = graph.nodeSeq(repeatNodeId);
             const int repeatUnitLength = repeatUnit.length();
-            const int maxNumUnitsInRead = std::ceil(sampleParams_.readLength() / static_cast<double>(repeatUnitLength));
+            const int maxNumUnitsInRead = computeMaxNumUnitsInRead(sampleParams_.readLength(), repeatUnitLength);
 
             weightedPurityCalculators.emplace(std::make_pair(repeatUnit, WeightedPurityCalculator(repeatUnit)));
 
@@ -139,12 +158,71 @@ RegionAnalyzer::RegionAnalyzer(
 
 void RegionAnalyzer::processMates(reads::Read read, reads::Read mate)
 {
-    optional<GraphAlignment> readAlignment = alignRead(read);
-    optional<GraphAlignment> mateAlignment = alignRead(mate);
+    pendingMates_.emplace_back(std::move(read), std::move(mate));
+    if (pendingMates_.size() == kMaxNumPendingMates)
+    {
+        processPendingMates();
+    }
+}
+
+void RegionAnalyzer::processPendingMates()
+{
+    if (pendingMates_.empty())
+    {
+        return;
+    }
+
+    // Reads that are expected to align are aligned in one batch; each read gets the index of its query or -1
+    vector<int> queryIndexes;
+    vector<string> queries;
+    for (auto& readAndMate : pendingMates_)
+    {
+        for (Read* readPtr : { &readAndMate.first, &readAndMate.second })
+        {
+            if (orientRead(*readPtr))
+            {
+                queryIndexes.push_back(queries.size());
+                queries.push_back(readPtr->sequence);
+            }
+            else
+            {
+                queryIndexes.push_back(-1);
+            }
+        }
+    }
+
+    const vector<list<GraphAlignment>> alignmentLists = graphAligner_.alignBatch(queries);
+    const list<GraphAlignment> noAlignments;
+    auto getAlignments = [&](std::size_t readIndex) -> const list<GraphAlignment>& {
+        return queryIndexes[readIndex] == -1 ? noAlignments : alignmentLists[queryIndexes[readIndex]];
+    };
+
+    for (std::size_t pairIndex = 0; pairIndex != pendingMates_.size(); ++pairIndex)
+    {
+        // Downstream analysis works on the compact representation which avoids copying the alignment node by node
+        optional<CompactGraphAlignment> compactReadAlignment;
+        optional<CompactGraphAlignment> compactMateAlignment;
+        optional<GraphAlignment> readAlignment
+            = selectCanonicalAlignment(getAlignments(2 * pairIndex), compactReadAlignment);
+        optional<GraphAlignment> mateAlignment
+            = selectCanonicalAlignment(getAlignments(2 * pairIndex + 1), compactMateAlignment);
+
+        const Read& read = pendingMates_[pairIndex].first;
+        const Read& mate = pendingMates_[pairIndex].second;
+        processAlignedMates(read, readAlignment, compactReadAlignment, mate, mateAlignment, compactMateAlignment);
+    }
 
+    pendingMates_.clear();
+}
+
+void RegionAnalyzer::processAlignedMates(
+    const Read& read, const optional<GraphAlignment>& readAlignment,
+    const optional<CompactGraphAlignment>& compactReadAlignment, const Read& mate,
+    const optional<GraphAlignment>& mateAlignment, const optional<CompactGraphAlignment>& compactMateAlignment)
+{
     int kMinNonRepeatAlignmentScore = sampleParams_.readLength() / 7.5;
     kMinNonRepeatAlignmentScore = std::max(kMinNonRepeatAlignmentScore, 3);
-    if (!checkIfLocallyPlacedReadPair(readAlignment, mateAlignment, kMinNonRepeatAlignmentScore))
+    if (!checkIfLocallyPlacedReadPair(compactReadAlignment, compactMateAlignment, kMinNonRepeatAlignmentScore))
     {
         if (verboseLogger_)
         {
@@ -156,12 +234,12 @@ void RegionAnalyzer::processMates(reads::Read read, reads::Read mate)
 
     if (readAlignment && mateAlignment)
     {
-        outputAlignedRead(read, *readAlignment, alignmentStream_);
-        outputAlignedRead(mate, *mateAlignment, alignmentStream_);
+        alignmentWriter_.write(regionSpec_, read, *readAlignment);
+        alignmentWriter_.write(regionSpec_, mate, *mateAlignment);
 
         for (auto& variantAnalyzerPtr : variantAnalyzerPtrs_)
         {
-            variantAnalyzerPtr->processMates(read, *readAlignment, mate, *mateAlignment);
+            variantAnalyzerPtr->processMates(read, *compactReadAlignment, mate, *compactMateAlignment);
         }
     }
     else if (verboseLogger_)
@@ -173,7 +251,7 @@ void RegionAnalyzer::processMates(reads::Read read, reads::Read mate)
     }
 }
 
-void RegionAnalyzer::processOfftargetMates(reads::Read read1, reads::Read read2)
+const string& RegionAnalyzer::unitOfRareRepeat() const
 {
     if (!optionalUnitOfRareRepeat_)
     {
@@ -182,81 +260,107 @@ void RegionAnalyzer::processOfftargetMates(reads::Read read1, reads::Read read2)
         throw std::logic_error(errorMessage);
     }
 
-    const string& repeatUnit = *optionalUnitOfRareRepeat_;
+    return *optionalUnitOfRareRepeat_;
+}
+
+void RegionAnalyzer::processOfftargetMates(reads::Read read1, reads::Read read2)
+{
+    const string& repeatUnit = unitOfRareRepeat();
 
     const auto& weightedPurityCalculator = weightedPurityCalculators.at(repeatUnit);
-    const bool isFirstReadInrepeat = weightedPurityCalculator.score(read1.sequence) >= 0.90;
-    const bool isSecondReadInrepeat = weightedPurityCalculator.score(read2.sequence) >= 0.90;
+    const bool isFirstReadInrepeat = weightedPurityCalculator.checkIfReachesScore(read1.sequence, 0.90);
+    // The mate only needs to be scored if the first read is in the repeat
+    const bool isSecondReadInrepeat
+        = isFirstReadInrepeat && weightedPurityCalculator.checkIfReachesScore(read2.sequence, 0.90);
 
     if (isFirstReadInrepeat && isSecondReadInrepeat)
     {
-        std::cerr << "Found IRR pair " << read1.fragmentId() << std::endl;
-        processMates(std::move(read1), std::move(read2));
+        processPrescreenedOfftargetMates(std::move(read1), std::move(read2));
     }
 }
 
-boost::optional<GraphAlignment> RegionAnalyzer::alignRead(Read& read) const
+void RegionAnalyzer::processPrescreenedOfftargetMates(reads::Read read1, reads::Read read2)
 {
-    OrientationPrediction predictedOrientation = orientationPredictor_.predict(read.sequence);
+    unitOfRareRepeat();
 
-    if (predictedOrientation == OrientationPrediction::kAlignsInReverseComplementOrientation)
+    std::cerr << "Found IRR pair " << read1.fragmentId() << std::endl;
+    processMates(std::move(read1), std::move(read2));
+}
+
+bool RegionAnalyzer::orientRead(Read& read) const
+{
+    OrientationPrediction predictedOrientation;
     {
-        read.sequence = graphtools::reverseComplement(read.sequence);
+        StageTimer timer(metricsPtr_, AnalysisStage::kOrientationPrediction);
+        predictedOrientation = orientationPredictorPtr_->predict(read.sequence);
     }
-    else if (predictedOrientation == OrientationPrediction::kDoesNotAlign)
+
+    if (predictedOrientation == OrientationPrediction::kAlignsInReverseComplementOrientation)
     {
-        return boost::optional<GraphAlignment>();
+        read.sequence = graphtools::reverseComplement(read.sequence);
     }
 
-    const list<GraphAlignment> alignments = graphAligner_.align(read.sequence);
+    return predictedOrientation != OrientationPrediction::kDoesNotAlign;
+}
 
-    if (alignments.empty())
+optional<GraphAlignment> RegionAnalyzer::selectCanonicalAlignment(
+    const list<GraphAlignment>& alignments, optional<CompactGraphAlignment>& compactAlignment) const
+{
+    optional<GraphAlignment> optionalAlignment;
+    if (!alignments.empty())
     {
-        return boost::optional<GraphAlignment>();
-    }
+        GraphAlignment canonicalAlignment = computeCanonicalAlignment(alignments);
+        CompactGraphAlignment compactCanonicalAlignment(canonicalAlignment);
 
-    GraphAlignment canonicalAlignment = computeCanonicalAlignment(alignments);
+        if (checkIfPassesAlignmentFilters(compactCanonicalAlignment))
+        {
+            // const int kShrinkLength = 10;
+            // shrinkUncertainPrefix(kShrinkLength, read.sequence, canonicalAlignment);
+            // shrinkUncertainSuffix(kShrinkLength, read.sequence, canonicalAlignment);
 
-    if (checkIfPassesAlignmentFilters(canonicalAlignment))
-    {
-        // const int kShrinkLength = 10;
-        // shrinkUncertainPrefix(kShrinkLength, read.sequence, canonicalAlignment);
-        // shrinkUncertainSuffix(kShrinkLength, read.sequence, canonicalAlignment);
+            optionalAlignment = std::move(canonicalAlignment);
+            compactAlignment = std::move(compactCanonicalAlignment);
+        }
+    }
 
-        return canonicalAlignment;
+    if (metricsPtr_ && optionalAlignment)
+    {
+        ++metricsPtr_->numReadsAligned;
     }
-    else
+    else if (metricsPtr_)
     {
-        return boost::optional<GraphAlignment>();
+        ++metricsPtr_->numReadsRejected;
     }
+    return optionalAlignment;
 }
 
-bool RegionAnalyzer::checkIfPassesAlignmentFilters(const GraphAlignment& alignment) const
+bool RegionAnalyzer::checkIfPassesAlignmentFilters(const CompactGraphAlignment& alignment) const
 {
-    const Operation& firstOperation = alignment.alignments().front().operations().front();
-    const int frontSoftclipLen = firstOperation.type() == OperationType::kSoftclip ? firstOperation.queryLength() : 0;
-
-    const Operation& lastOperation = alignment.alignments().back().operations().back();
-    const int backSoftclipLen = lastOperation.type() == OperationType::kSoftclip ? lastOperation.queryLength() : 0;
-
-    const int clippedQueryLength = alignment.queryLength() - frontSoftclipLen - backSoftclipLen;
-    const int referenceLength = alignment.referenceLength();
+    return ehunter::checkIfPassesAlignmentFilters(alignment);
+}
 
-    const int percentQueryMatches = (100 * alignment.numMatches()) / clippedQueryLength;
-    const int percentReferenceMatches = (100 * alignment.numMatches()) / referenceLength;
+RegionFindings RegionAnalyzer::genotype()
+{
+    processPendingMates();
 
-    if (percentQueryMatches >= 80 && percentReferenceMatches >= 80)
+    StageTimer timer(metricsPtr_, AnalysisStage::kGenotyping);
+    if (metricsPtr_)
     {
-        return true;
+        metricsPtr_->numGaplessTierReads = graphAligner_.tierStats().numGaplessAlignedReads;
+        metricsPtr_->numGappedTierReads = graphAligner_.tierStats().numGappedAlignedReads;
+        const graphtools::DagScorePrecisionStats precisionStats = graphAligner_.scorePrecisionStats();
+        metricsPtr_->numNarrowScorePieces = static_cast<int>(precisionStats.narrowPieces);
+        metricsPtr_->numNarrowScoreOverflows = static_cast<int>(precisionStats.narrowOverflows);
     }
-    else
+
+    if (verboseLogger_)
     {
-        return false;
+        const AlignmentTierStats& tierStats = graphAligner_.tierStats();
+        verboseLogger_->info(
+            "Aligned {} of {} reads from {} without gaps", tierStats.numGaplessAlignedReads, tierStats.numReads(),
+            regionSpec_.regionId());
     }
-}
 
-RegionFindings RegionAnalyzer::genotype()
-{
     RegionFindings regionResults;
 
     for (auto& variantAnalyzerPtr : variantAnalyzerPtrs_)
@@ -270,19 +374,59 @@ RegionFindings RegionAnalyzer::genotype()
 
 vector<std::unique_ptr<RegionAnalyzer>> initializeRegionAnalyzers(
     const RegionCatalog& RegionCatalog, const SampleParameters& sampleParams,
-    const HeuristicParameters& heuristicParams, std::ostream& alignmentStream)
+    const HeuristicParameters& heuristicParams, AlignmentWriter& alignmentWriter, RegionIndexCache* indexCachePtr,
+    SampleMetrics* metricsPtr)
 {
     vector<std::unique_ptr<RegionAnalyzer>> regionAnalyzers;
 
     for (const auto& regionIdAndRegionSpec : RegionCatalog)
     {
         const LocusSpecification& regionSpec = regionIdAndRegionSpec.second;
-
-        // alignmentStream << regionSpec.regionId() << ":" << std::endl;
-        regionAnalyzers.emplace_back(new RegionAnalyzer(regionSpec, sampleParams, heuristicParams, alignmentStream));
+        LocusMetrics* locusMetricsPtr = metricsPtr ? &metricsPtr->addLocus(regionSpec.regionId()) : nullptr;
+        regionAnalyzers.emplace_back(new RegionAnalyzer(
+            regionSpec, sampleParams, heuristicParams, alignmentWriter, indexCachePtr, locusMetricsPtr));
     }
 
     return regionAnalyzers;
 }
 
+RegionFindings genotypeLocusFromReadCounts(
+    const LocusSpecification& locusSpec, const LocusReadCounts& locusReadCounts, const SampleParameters& sampleParams)
+{
+    RegionFindings locusFindings;
+    for (const auto& variantSpec : locusSpec.variantSpecs())
+    {
+        const auto readCountsIter = locusReadCounts.find(variantSpec.id());
+        if (readCountsIter == locusReadCounts.end())
+        {
+            throw std::invalid_argument("Read counts of variant " + variantSpec.id() + " are missing");
+        }
+        const VariantReadCounts& readCounts = readCountsIter->second;
+        if (readCounts.variantType != variantSpec.classification().type)
+        {
+            throw std::invalid_argument(
+                "Read counts of variant " + variantSpec.id() + " belong to a variant of another type");
+        }
+
+        std::unique_ptr<VariantFindings> variantFindingsPtr;
+        if (variantSpec.classification().type == VariantType::kRepeat)
+        {
+            const int repeatUnitLength = locusSpec.regionGraph().nodeSeq(variantSpec.nodes().front()).length();
+            variantFindingsPtr = genotypeRepeatFromCounts(
+                readCounts.countsOfSpanningReads, readCounts.countsOfFlankingReads, readCounts.countsOfInrepeatReads,
+                locusSpec.expectedAlleleCount(), repeatUnitLength,
+                computeMaxNumUnitsInRead(sampleParams.readLength(), repeatUnitLength), sampleParams.haplotypeDepth());
+        }
+        else
+        {
+            variantFindingsPtr = genotypeSmallVariantFromCounts(
+                readCounts.numRefReads, readCounts.numAltReads, locusSpec.expectedAlleleCount(),
+                sampleParams.haplotypeDepth());
+        }
+        locusFindings.emplace(variantSpec.id(), std::move(variantFindingsPtr));
+    }
+
+    return locusFindings;
+}
+
 }
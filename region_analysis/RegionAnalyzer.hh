@@ -19,9 +19,12 @@
 //
 
 #include <cassert>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 
@@ -31,10 +34,14 @@
 #include "graphalign/GappedAligner.hh"
 #include "graphalign/KmerIndex.hh"
 
+#include "alignment/CompactGraphAlignment.hh"
 #include "alignment/SoftclippingAligner.hh"
 #include "common/Parameters.hh"
+#include "common/PerformanceMetrics.hh"
 #include "filtering/OrientationPredictor.hh"
+#include "output/AlignmentWriter.hh"
 #include "reads/Read.hh"
+#include "region_analysis/RegionIndexCache.hh"
 #include "region_analysis/VariantAnalyzer.hh"
 #include "region_analysis/VariantFindings.hh"
 #include "region_spec/LocusSpecification.hh"
@@ -45,12 +52,16 @@
 namespace ehunter
 {
 
+// Kmer indexes are taken from the index cache if one is given and are built for this analyzer otherwise; in the former
+// case the indexes refer to the given region specification, which must then outlive the analyzer. If metrics are given,
+// the time spent on each stage and the numbers of aligned and rejected reads are added to them
 class RegionAnalyzer
 {
 public:
     RegionAnalyzer(
         const LocusSpecification& regionSpec, SampleParameters sampleParams, HeuristicParameters heuristicParams,
-        std::ostream& alignmentStream);
+        AlignmentWriter& alignmentWriter, RegionIndexCache* indexCachePtr = nullptr,
+        LocusMetrics* metricsPtr = nullptr);
 
     RegionAnalyzer(const RegionAnalyzer&) = delete;
     RegionAnalyzer& operator=(const RegionAnalyzer&) = delete;
@@ -60,26 +71,47 @@ public:
     const std::string& regionId() const { return regionSpec_.regionId(); }
     const LocusSpecification& regionSpec() const { return regionSpec_; }
 
+    // Pairs are buffered and aligned in batches; genotype() processes the remaining ones
     void processMates(reads::Read read, reads::Read mate);
     void processOfftargetMates(reads::Read read1, reads::Read read2);
+    // Same for pairs already known to have both reads in the rare repeat, e.g. pairs served by OfftargetReadCache
+    void processPrescreenedOfftargetMates(reads::Read read1, reads::Read read2);
     bool checkIfPassesSequenceFilters(const std::string& sequence) const;
-    bool checkIfPassesAlignmentFilters(const graphtools::GraphAlignment& alignment) const;
+    bool checkIfPassesAlignmentFilters(const CompactGraphAlignment& alignment) const;
     bool checkIfPassesAlignmentFilters() const; // Public for unit testing
 
     RegionFindings genotype();
 
+    // Numbers of reads aligned without gaps and with the gapped aligner; complete once genotype() was called
+    const AlignmentTierStats& alignmentTierStats() const { return graphAligner_.tierStats(); }
+    LocusMetrics* metricsPtr() const { return metricsPtr_; }
+
     bool operator==(const RegionAnalyzer& other) const;
 
 private:
-    boost::optional<GraphAlignment> alignRead(reads::Read& read) const;
+    const std::string& unitOfRareRepeat() const;
+    void processPendingMates();
+    void processAlignedMates(
+        const reads::Read& read, const boost::optional<GraphAlignment>& readAlignment,
+        const boost::optional<CompactGraphAlignment>& compactReadAlignment, const reads::Read& mate,
+        const boost::optional<GraphAlignment>& mateAlignment,
+        const boost::optional<CompactGraphAlignment>& compactMateAlignment);
+    // Reverse-complements the read if needed; returns false if the read is not expected to align to the region
+    bool orientRead(reads::Read& read) const;
+    // Returns the canonical alignment of a read if it passes the alignment filters; its compact form, which the
+    // filters are computed on, is stored in compactAlignment
+    boost::optional<GraphAlignment> selectCanonicalAlignment(
+        const std::list<GraphAlignment>& alignments, boost::optional<CompactGraphAlignment>& compactAlignment) const;
 
     LocusSpecification regionSpec_;
     SampleParameters sampleParams_;
     HeuristicParameters heuristicParams_;
 
-    std::ostream& alignmentStream_;
-    OrientationPredictor orientationPredictor_;
+    AlignmentWriter& alignmentWriter_;
+    std::shared_ptr<const OrientationPredictor> orientationPredictorPtr_;
     SoftclippingAligner graphAligner_;
+    // Pairs are aligned in batches that share the targets of the gapped aligner
+    std::vector<std::pair<reads::Read, reads::Read>> pendingMates_;
 
     std::unordered_map<std::string, WeightedPurityCalculator> weightedPurityCalculators;
 
@@ -87,10 +119,23 @@ private:
     boost::optional<std::string> optionalUnitOfRareRepeat_;
 
     std::shared_ptr<spdlog::logger> verboseLogger_;
+    LocusMetrics* metricsPtr_;
 };
 
 std::vector<std::unique_ptr<RegionAnalyzer>> initializeRegionAnalyzers(
     const RegionCatalog& RegionCatalog, const SampleParameters& sampleParams,
-    const HeuristicParameters& heuristicParams, std::ostream& alignmentStream);
+    const HeuristicParameters& heuristicParams, AlignmentWriter& alignmentWriter,
+    RegionIndexCache* indexCachePtr = nullptr, SampleMetrics* metricsPtr = nullptr);
+
+/**
+ * Genotypes the variants of a locus from read counts saved by an earlier analysis without aligning any reads
+ *
+ * @param locusSpec: Locus whose variants are genotyped
+ * @param locusReadCounts: Read counts of every variant of the locus
+ * @param sampleParams: Parameters of the sample; the haplotype depth must be set
+ * @return Findings for the variants of the locus
+ */
+RegionFindings genotypeLocusFromReadCounts(
+    const LocusSpecification& locusSpec, const LocusReadCounts& locusReadCounts, const SampleParameters& sampleParams);
 
 }
@@ -0,0 +1,71 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "region_analysis/RegionIndexCache.hh"
+
+using graphtools::KmerIndex;
+using std::shared_ptr;
+
+namespace ehunter
+{
+
+RegionIndexCache::RegionIndexCache(int kmerLenForAlignment)
+    : kmerLenForAlignment_(kmerLenForAlignment)
+{
+}
+
+shared_ptr<const KmerIndex>
+RegionIndexCache::getAlignmentIndex(const LocusSpecification& regionSpec, bool* isCacheHitPtr)
+{
+    // Indexes are built under the lock so that samples reaching a locus at the same time build its index only once
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& indexPtr = alignmentIndexes_[regionSpec.regionId()];
+    if (isCacheHitPtr)
+    {
+        *isCacheHitPtr = indexPtr != nullptr;
+    }
+    if (!indexPtr)
+    {
+        indexPtr = std::make_shared<KmerIndex>(regionSpec.regionGraph(), kmerLenForAlignment_);
+    }
+
+    return indexPtr;
+}
+
+shared_ptr<const OrientationPredictor>
+RegionIndexCache::getOrientationPredictor(const LocusSpecification& regionSpec, int readLength, bool* isCacheHitPtr)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& predictorPtr = orientationPredictors_[std::make_pair(regionSpec.regionId(), readLength)];
+    if (isCacheHitPtr)
+    {
+        *isCacheHitPtr = predictorPtr != nullptr;
+    }
+    if (!predictorPtr)
+    {
+        predictorPtr = std::make_shared<OrientationPredictor>(readLength, &regionSpec.regionGraph());
+    }
+
+    return predictorPtr;
+}
+
+}
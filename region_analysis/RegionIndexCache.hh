@@ -0,0 +1,62 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "graphalign/KmerIndex.hh"
+
+#include "filtering/OrientationPredictor.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+/**
+ * Thread-safe cache of the kmer indexes of the locus graphs of a catalog
+ *
+ * Each index is built the first time it is requested and is then shared by the analyzers of all samples genotyped
+ * against the catalog. The indexes refer to the graphs of the catalog, so the catalog must outlive the cache.
+ */
+class RegionIndexCache
+{
+public:
+    explicit RegionIndexCache(int kmerLenForAlignment);
+
+    // If given, the flag is set to whether the index was already built before the request
+    std::shared_ptr<const graphtools::KmerIndex>
+    getAlignmentIndex(const LocusSpecification& regionSpec, bool* isCacheHitPtr = nullptr);
+    std::shared_ptr<const OrientationPredictor>
+    getOrientationPredictor(const LocusSpecification& regionSpec, int readLength, bool* isCacheHitPtr = nullptr);
+
+private:
+    int kmerLenForAlignment_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const graphtools::KmerIndex>> alignmentIndexes_;
+    std::map<std::pair<std::string, int>, std::shared_ptr<const OrientationPredictor>> orientationPredictors_;
+};
+
+}
@@ -33,7 +33,6 @@ namespace ehunter
 {
 
 using boost::optional;
-using graphtools::GraphAlignment;
 using graphtools::NodeId;
 using graphtools::prettyPrint;
 using graphtools::splitStringByDelimiter;
@@ -44,7 +43,7 @@ using std::string;
 using std::vector;
 
 static bool checkIfAlignmentIsConfident(
-    NodeId repeatNodeId, const GraphAlignment& alignment, const RepeatAlignmentStats& alignmentStats)
+    NodeId repeatNodeId, const CompactGraphAlignment& alignment, const RepeatAlignmentStats& alignmentStats)
 {
     const bool doesReadAlignWellOverLeftFlank = checkIfUpstreamAlignmentIsGood(repeatNodeId, alignment);
     const bool doesReadAlignWellOverRightFlank = checkIfDownstreamAlignmentIsGood(repeatNodeId, alignment);
@@ -69,7 +68,8 @@ static bool checkIfAlignmentIsConfident(
 }
 
 void RepeatAnalyzer::processMates(
-    const Read& read, const GraphAlignment& readAlignment, const Read& mate, const GraphAlignment& mateAlignment)
+    const Read& read, const CompactGraphAlignment& readAlignment, const Read& mate,
+    const CompactGraphAlignment& mateAlignment)
 {
     RepeatAlignmentStats readAlignmentStats = classifyReadAlignment(readAlignment);
     RepeatAlignmentStats mateAlignmentStats = classifyReadAlignment(mateAlignment);
@@ -88,10 +88,10 @@ void RepeatAnalyzer::processMates(
     else if (verboseLogger_)
     {
         std::cerr << read.readId() << " could not be confidently aligned " << std::endl;
-        std::cerr << prettyPrint(readAlignment, read.sequence) << std::endl;
+        std::cerr << prettyPrint(readAlignment.expand(), read.sequence) << std::endl;
         verboseLogger_->info(
             "Not a confident alignment for repeat node {}\n{}", repeatNodeId(),
-            prettyPrint(readAlignment, read.sequence));
+            prettyPrint(readAlignment.expand(), read.sequence));
     }
 
     if (isMateAlignmentConfident)
@@ -103,20 +103,20 @@ void RepeatAnalyzer::processMates(
     else if (verboseLogger_)
     {
         std::cerr << mate.readId() << " could not be confidently aligned " << std::endl;
-        std::cerr << prettyPrint(mateAlignment, mate.sequence) << std::endl;
+        std::cerr << prettyPrint(mateAlignment.expand(), mate.sequence) << std::endl;
         verboseLogger_->info(
             "Not a confident alignment for repeat node {}\n{}", repeatNodeId(),
-            prettyPrint(mateAlignment, mate.sequence));
+            prettyPrint(mateAlignment.expand(), mate.sequence));
     }
 }
 
-RepeatAlignmentStats RepeatAnalyzer::classifyReadAlignment(const graphtools::GraphAlignment& alignment)
+RepeatAlignmentStats RepeatAnalyzer::classifyReadAlignment(const CompactGraphAlignment& alignment)
 {
     AlignmentType alignmentType = alignmentClassifier_.Classify(alignment);
     int32_t numRepeatUnitsOverlapped = countFullOverlaps(repeatNodeId(), alignment);
     numRepeatUnitsOverlapped = std::min(numRepeatUnitsOverlapped, maxNumUnitsInRead_);
 
-    return RepeatAlignmentStats(alignment, alignmentType, numRepeatUnitsOverlapped);
+    return RepeatAlignmentStats(alignmentType, numRepeatUnitsOverlapped);
 }
 
 void RepeatAnalyzer::summarizeAlignmentsToReadCounts(const RepeatAlignmentStats& repeatAlignmentStats)
@@ -139,27 +139,26 @@ void RepeatAnalyzer::summarizeAlignmentsToReadCounts(const RepeatAlignmentStats&
 
 std::unique_ptr<VariantFindings> RepeatAnalyzer::analyze() const
 {
-    const vector<int32_t> candidateAlleleSizes = generateCandidateAlleleSizes();
-    optional<RepeatGenotype> repeatGenotype = genotypeCommonRepeat(candidateAlleleSizes);
-
-    std::unique_ptr<VariantFindings> variantFiningsPtr(
-        new RepeatFindings(countsOfSpanningReads_, countsOfFlankingReads_, countsOfInrepeatReads_, repeatGenotype));
-    return variantFiningsPtr;
+    return genotypeRepeatFromCounts(
+        countsOfSpanningReads_, countsOfFlankingReads_, countsOfInrepeatReads_, expectedAlleleCount_,
+        repeatUnit_.length(), maxNumUnitsInRead_, haplotypeDepth_);
 }
 
-vector<int32_t> RepeatAnalyzer::generateCandidateAlleleSizes() const
+static vector<int32_t> generateCandidateAlleleSizes(
+    const CountTable& countsOfSpanningReads, const CountTable& countsOfFlankingReads,
+    const CountTable& countsOfInrepeatReads)
 {
-    vector<int32_t> candidateAlleleSizes = countsOfSpanningReads_.getElementsWithNonzeroCounts();
+    vector<int32_t> candidateAlleleSizes = countsOfSpanningReads.getElementsWithNonzeroCounts();
     const int32_t longestSpanning = candidateAlleleSizes.empty()
         ? 0
         : *std::max_element(candidateAlleleSizes.begin(), candidateAlleleSizes.end());
 
-    const vector<int32_t> repeatSizesInFlankingReads = countsOfFlankingReads_.getElementsWithNonzeroCounts();
+    const vector<int32_t> repeatSizesInFlankingReads = countsOfFlankingReads.getElementsWithNonzeroCounts();
     const int32_t longestFlanking = repeatSizesInFlankingReads.empty()
         ? 0
         : *std::max_element(repeatSizesInFlankingReads.begin(), repeatSizesInFlankingReads.end());
 
-    const vector<int32_t> repeatSizesInInrepeatReads = countsOfInrepeatReads_.getElementsWithNonzeroCounts();
+    const vector<int32_t> repeatSizesInInrepeatReads = countsOfInrepeatReads.getElementsWithNonzeroCounts();
     const int32_t longestInrepeat = repeatSizesInInrepeatReads.empty()
         ? 0
         : *std::max_element(repeatSizesInInrepeatReads.begin(), repeatSizesInInrepeatReads.end());
@@ -174,16 +173,23 @@ vector<int32_t> RepeatAnalyzer::generateCandidateAlleleSizes() const
     return candidateAlleleSizes;
 }
 
-optional<RepeatGenotype> RepeatAnalyzer::genotypeCommonRepeat(const vector<int32_t>& candidateAlleleSizes) const
+std::unique_ptr<VariantFindings> genotypeRepeatFromCounts(
+    const CountTable& countsOfSpanningReads, const CountTable& countsOfFlankingReads,
+    const CountTable& countsOfInrepeatReads, AlleleCount expectedAlleleCount, int32_t repeatUnitLength,
+    int32_t maxNumUnitsInRead, double haplotypeDepth)
 {
-    const int32_t repeatUnitLen = repeatUnit_.length();
-    const double propCorrectMolecules = 0.97;
+    const vector<int32_t> candidateAlleleSizes
+        = generateCandidateAlleleSizes(countsOfSpanningReads, countsOfFlankingReads, countsOfInrepeatReads);
 
+    const double propCorrectMolecules = 0.97;
     RepeatGenotyper repeatGenotyper(
-        haplotypeDepth_, expectedAlleleCount_, repeatUnitLen, maxNumUnitsInRead_, propCorrectMolecules,
-        countsOfSpanningReads_, countsOfFlankingReads_, countsOfInrepeatReads_);
+        haplotypeDepth, expectedAlleleCount, repeatUnitLength, maxNumUnitsInRead, propCorrectMolecules,
+        countsOfSpanningReads, countsOfFlankingReads, countsOfInrepeatReads);
+    optional<RepeatGenotype> repeatGenotype = repeatGenotyper.genotypeRepeat(candidateAlleleSizes);
 
-    return repeatGenotyper.genotypeRepeat(candidateAlleleSizes);
+    std::unique_ptr<VariantFindings> variantFiningsPtr(
+        new RepeatFindings(countsOfSpanningReads, countsOfFlankingReads, countsOfInrepeatReads, repeatGenotype));
+    return variantFiningsPtr;
 }
 
 }
@@ -58,17 +58,15 @@ public:
     ~RepeatAnalyzer() = default;
 
     void processMates(
-        const reads::Read& read, const graphtools::GraphAlignment& readAlignment, const reads::Read& mate,
-        const graphtools::GraphAlignment& mateAlignment) override;
+        const reads::Read& read, const CompactGraphAlignment& readAlignment, const reads::Read& mate,
+        const CompactGraphAlignment& mateAlignment) override;
 
     std::unique_ptr<VariantFindings> analyze() const override;
 
 private:
     graphtools::NodeId repeatNodeId() const { return nodeIds_.front(); }
-    boost::optional<RepeatGenotype> genotypeCommonRepeat(const std::vector<int32_t>& candidateAlleleSizes) const;
-    reads::RepeatAlignmentStats classifyReadAlignment(const graphtools::GraphAlignment& alignment);
+    reads::RepeatAlignmentStats classifyReadAlignment(const CompactGraphAlignment& alignment);
     void summarizeAlignmentsToReadCounts(const reads::RepeatAlignmentStats& repeatAlignmentStats);
-    std::vector<int32_t> generateCandidateAlleleSizes() const;
 
     const int32_t maxNumUnitsInRead_;
     const double haplotypeDepth_;
@@ -83,4 +81,10 @@ private:
     std::shared_ptr<spdlog::logger> verboseLogger_;
 };
 
+// Genotypes a repeat from the numbers of repeat units in spanning, flanking, and in-repeat reads
+std::unique_ptr<VariantFindings> genotypeRepeatFromCounts(
+    const CountTable& countsOfSpanningReads, const CountTable& countsOfFlankingReads,
+    const CountTable& countsOfInrepeatReads, AlleleCount expectedAlleleCount, int32_t repeatUnitLength,
+    int32_t maxNumUnitsInRead, double haplotypeDepth);
+
 }
@@ -33,8 +33,8 @@ namespace ehunter
 {
 
 void SmallVariantAnalyzer::processMates(
-    const reads::Read& /*read*/, const graphtools::GraphAlignment& readAlignment, const reads::Read& /*mate*/,
-    const graphtools::GraphAlignment& mateAlignment)
+    const reads::Read& /*read*/, const CompactGraphAlignment& readAlignment, const reads::Read& /*mate*/,
+    const CompactGraphAlignment& mateAlignment)
 {
     alignmentClassifier_.classify(readAlignment);
     alignmentClassifier_.classify(mateAlignment);
@@ -88,13 +88,21 @@ std::unique_ptr<VariantFindings> SmallVariantAnalyzer::analyze() const
     const int refNodeSupport = countReadsSupportingNode(refNode);
     const int altNodeSupport = countReadsSupportingNode(altNode);
 
-    auto genotype = smallVariantGenotyper_.genotype(refNodeSupport, altNodeSupport);
+    return genotypeSmallVariantFromCounts(refNodeSupport, altNodeSupport, expectedAlleleCount_, haplotypeDepth_);
+}
+
+std::unique_ptr<VariantFindings> genotypeSmallVariantFromCounts(
+    int numRefReads, int numAltReads, AlleleCount expectedAlleleCount, double haplotypeDepth)
+{
+    SmallVariantGenotyper smallVariantGenotyper(haplotypeDepth, expectedAlleleCount);
+    auto genotype = smallVariantGenotyper.genotype(numRefReads, numAltReads);
 
-    AllelePresenceStatus refAlleleStatus = allelePresenceChecker_.check(refNodeSupport, altNodeSupport);
-    AllelePresenceStatus altAlleleStatus = allelePresenceChecker_.check(altNodeSupport, refNodeSupport);
+    AllelePresenceChecker allelePresenceChecker(haplotypeDepth);
+    AllelePresenceStatus refAlleleStatus = allelePresenceChecker.check(numRefReads, numAltReads);
+    AllelePresenceStatus altAlleleStatus = allelePresenceChecker.check(numAltReads, numRefReads);
 
     return std::unique_ptr<VariantFindings>(
-        new SmallVariantFindings(refNodeSupport, altNodeSupport, refAlleleStatus, altAlleleStatus, genotype));
+        new SmallVariantFindings(numRefReads, numAltReads, refAlleleStatus, altAlleleStatus, genotype));
 }
 
 }
@@ -45,8 +45,6 @@ public:
         , haplotypeDepth_(haplotypeDepth)
         , optionalRefNode_(optionalRefNode)
         , alignmentClassifier_(nodeIds_)
-        , smallVariantGenotyper_(haplotypeDepth_, expectedAlleleCount_)
-        , allelePresenceChecker_(haplotypeDepth_)
     {
         verboseLogger_ = spdlog::get("verbose");
         // Only indels are allowed
@@ -58,8 +56,8 @@ public:
     std::unique_ptr<VariantFindings> analyze() const override;
 
     void processMates(
-        const reads::Read& read, const graphtools::GraphAlignment& readAlignment, const reads::Read& mate,
-        const graphtools::GraphAlignment& mateAlignment) override;
+        const reads::Read& read, const CompactGraphAlignment& readAlignment, const reads::Read& mate,
+        const CompactGraphAlignment& mateAlignment) override;
 
     double haplotypeDepth() const { return haplotypeDepth_; }
 
@@ -71,10 +69,12 @@ protected:
     boost::optional<graphtools::NodeId> optionalRefNode_;
 
     ClassifierOfAlignmentsToVariant alignmentClassifier_;
-    SmallVariantGenotyper smallVariantGenotyper_;
-    AllelePresenceChecker allelePresenceChecker_;
 
     std::shared_ptr<spdlog::logger> verboseLogger_;
 };
 
+// Genotypes a small variant from the numbers of reads supporting its reference and alternative alleles
+std::unique_ptr<VariantFindings> genotypeSmallVariantFromCounts(
+    int numRefReads, int numAltReads, AlleleCount expectedAlleleCount, double haplotypeDepth);
+
 }
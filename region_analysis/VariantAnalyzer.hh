@@ -27,6 +27,7 @@
 #include "graphalign/GraphAlignment.hh"
 #include "graphcore/Graph.hh"
 
+#include "alignment/CompactGraphAlignment.hh"
 #include "common/Common.hh"
 #include "reads/Read.hh"
 #include "region_analysis/VariantFindings.hh"
@@ -49,8 +50,8 @@ public:
     virtual ~VariantAnalyzer() = default;
 
     virtual void processMates(
-        const reads::Read& read, const graphtools::GraphAlignment& readAlignment, const reads::Read& mate,
-        const graphtools::GraphAlignment& mateAlignment)
+        const reads::Read& read, const CompactGraphAlignment& readAlignment, const reads::Read& mate,
+        const CompactGraphAlignment& mateAlignment)
         = 0;
 
     virtual std::unique_ptr<VariantFindings> analyze() const = 0;
@@ -20,7 +20,9 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 #include <boost/optional.hpp>
@@ -29,6 +31,7 @@
 #include "genotyping/AllelePresenceChecker.hh"
 #include "genotyping/RepeatGenotype.hh"
 #include "genotyping/SmallVariantGenotype.hh"
+#include "region_spec/VariantSpecification.hh"
 
 namespace ehunter
 {
@@ -53,6 +56,9 @@ public:
 using RegionFindings = std::unordered_map<std::string, std::unique_ptr<VariantFindings>>;
 using SampleFindings = std::unordered_map<std::string, RegionFindings>;
 
+// Receives the findings for each locus as soon as the analysis of that locus is complete
+using LocusFindingsHandler = std::function<void(const std::string& locusId, RegionFindings locusFindings)>;
+
 class RepeatFindings : public VariantFindings
 {
 public:
@@ -121,6 +127,25 @@ private:
     boost::optional<SmallVariantGenotype> optionalGenotype_;
 };
 
+// Read counts that the genotype of a variant is computed from; these can be saved so that the variant can be genotyped
+// again without realigning the reads
+struct VariantReadCounts
+{
+    VariantType variantType = VariantType::kRepeat;
+
+    // Numbers of repeat units in spanning, flanking, and in-repeat reads of a repeat
+    CountTable countsOfSpanningReads;
+    CountTable countsOfFlankingReads;
+    CountTable countsOfInrepeatReads;
+
+    // Numbers of reads supporting the reference and alternative alleles of a small variant
+    int numRefReads = 0;
+    int numAltReads = 0;
+};
+
+// Read counts of the variants of a locus by variant id
+using LocusReadCounts = std::unordered_map<std::string, VariantReadCounts>;
+
 std::ostream& operator<<(std::ostream& out, const RepeatFindings& repeatFindings);
 
 }
@@ -24,6 +24,7 @@
 
 #include "input/GraphBlueprint.hh"
 #include "input/RegionGraph.hh"
+#include "output/AlignmentWriter.hh"
 #include "region_spec/LocusSpecification.hh"
 
 using namespace ehunter;
@@ -50,7 +51,8 @@ TEST_P(AlignerTests, RegionAnalysis_ShortSingleUnitRepeat_Genotyped)
     SampleParameters sampleParams("dummy_sample", Sex::kFemale, 10, 5.0);
     HeuristicParameters heuristicParams(false, 1000, 20, true, GetParam(), 4, 1, 5);
 
-    RegionAnalyzer regionAnalyzer(regionSpec, sampleParams, heuristicParams, std::cerr);
+    CompositeAlignmentWriter alignmentWriter;
+    RegionAnalyzer regionAnalyzer(regionSpec, sampleParams, heuristicParams, alignmentWriter);
 
     regionAnalyzer.processMates(Read("read1/1", "CGACCCATGT"), Read("read1/2", "GACCCATGTC"));
     regionAnalyzer.processMates(Read("read2/1", "CGACATGT"), Read("read2/2", "GACATGTC"));
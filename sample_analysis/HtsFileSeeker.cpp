@@ -125,6 +125,20 @@ namespace htshelpers
         status_ = Status::kStreamingReads;
     }
 
+    void HtsFileSeeker::setUnmappedRegion()
+    {
+        closeRegion();
+
+        htsRegionPtr_ = sam_itr_queryi(htsIndexPtr_, HTS_IDX_NOCOOR, 0, 0);
+
+        if (htsRegionPtr_ == nullptr)
+        {
+            throw std::runtime_error("Failed to extract unmapped reads from " + htsFilePath_);
+        }
+
+        status_ = Status::kStreamingReads;
+    }
+
     bool HtsFileSeeker::trySeekingToNextPrimaryAlignment()
     {
         if (status_ != Status::kStreamingReads)
@@ -44,6 +44,8 @@ namespace htshelpers
         HtsFileSeeker(const std::string& htsFilePath);
         ~HtsFileSeeker();
         void setRegion(const Region& region);
+        // Unmapped reads without a mapped mate are stored at the end of the file
+        void setUnmappedRegion();
         bool trySeekingToNextPrimaryAlignment();
 
         int32_t currentReadChromIndex() const;
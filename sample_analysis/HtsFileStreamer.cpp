@@ -89,12 +89,21 @@ namespace htshelpers
         return false;
     }
 
+    // Unmapped reads are placed on a contig with an empty name
+    static const string kUnmappedChrom;
+
     int32_t HtsFileStreamer::currentReadChromIndex() const { return htsAlignmentPtr_->core.tid; }
-    const std::string& HtsFileStreamer::currentReadChrom() const { return chromNames_[currentReadChromIndex()]; }
+    const std::string& HtsFileStreamer::currentReadChrom() const
+    {
+        return currentReadChromIndex() != -1 ? chromNames_[currentReadChromIndex()] : kUnmappedChrom;
+    }
     int32_t HtsFileStreamer::currentReadPosition() const { return htsAlignmentPtr_->core.pos; }
 
     int32_t HtsFileStreamer::currentMateChromIndex() const { return htsAlignmentPtr_->core.mtid; }
-    const std::string& HtsFileStreamer::currentMateChrom() const { return chromNames_[currentMateChromIndex()]; }
+    const std::string& HtsFileStreamer::currentMateChrom() const
+    {
+        return currentMateChromIndex() != -1 ? chromNames_[currentMateChromIndex()] : kUnmappedChrom;
+    }
     int32_t HtsFileStreamer::currentMatePosition() const { return htsAlignmentPtr_->core.mpos; }
 
     bool HtsFileStreamer::isStreamingAlignedReads() const
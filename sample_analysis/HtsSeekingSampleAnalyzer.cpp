@@ -29,11 +29,13 @@
 
 #include "thirdparty/spdlog/spdlog.h"
 
+#include "filtering/CatalogKmerFilter.hh"
 #include "reads/ReadPairs.hh"
 #include "region_analysis/RegionAnalyzer.hh"
 #include "sample_analysis/HtsFileSeeker.hh"
 #include "sample_analysis/IndexBasedDepthEstimate.hh"
 #include "sample_analysis/MateExtractor.hh"
+#include "sample_analysis/OfftargetReadCache.hh"
 
 namespace ehunter
 {
@@ -43,31 +45,37 @@ using htshelpers::HtsFileSeeker;
 using reads::LinearAlignmentStats;
 using reads::Read;
 using reads::ReadPairs;
-using std::ostream;
 using std::string;
 using std::unordered_map;
 using std::vector;
 
 using AlignmentStatsCatalog = unordered_map<string, LinearAlignmentStats>;
 
-static ReadPairs
-collectReads(const vector<Region>& regions, AlignmentStatsCatalog& alignmentStatsCatalog, HtsFileSeeker& fileHopper)
+static ReadPairs collectReads(
+    const vector<Region>& regions, AlignmentStatsCatalog& alignmentStatsCatalog, HtsFileSeeker& fileHopper,
+    LocusMetrics* metricsPtr)
 {
+    StageTimer timer(metricsPtr, AnalysisStage::kReadDecoding);
     ReadPairs readPairs;
     auto console = spdlog::get("console") ? spdlog::get("console") : spdlog::stderr_color_mt("console");
-    int preReads = 0;
     for (const auto& region : regions)
     {
+        // Reads are counted as decoded even if an overlapping region already contributed them
+        int numReadsDecoded = 0;
         fileHopper.setRegion(region);
         while (fileHopper.trySeekingToNextPrimaryAlignment())
         {
             LinearAlignmentStats alignmentStats;
             Read read = fileHopper.decodeRead(alignmentStats);
+            ++numReadsDecoded;
             alignmentStatsCatalog.emplace(std::make_pair(read.readId(), alignmentStats));
             readPairs.Add(std::move(read));
         }
-        console->info("Collected {} reads from {}", readPairs.NumReads() - preReads, region);
-        preReads += readPairs.NumReads();
+        console->info("Collected {} reads from {}", numReadsDecoded, region);
+        if (metricsPtr)
+        {
+            metricsPtr->numReadsDecoded += numReadsDecoded;
+        }
     }
     return readPairs;
 }
@@ -83,10 +91,11 @@ bool checkIfMatesWereMappedNearby(const LinearAlignmentStats& alignmentStats)
     return false;
 }
 
-void recoverMates(const string& htsFilePath, const AlignmentStatsCatalog& alignmentStatsCatalog, ReadPairs& readPairs)
+void recoverMates(
+    htshelpers::MateExtractor& mateExtractor, const AlignmentStatsCatalog& alignmentStatsCatalog,
+    ReadPairs& readPairs, LocusMetrics* metricsPtr)
 {
-    htshelpers::MateExtractor mateExtractor(htsFilePath);
-
+    StageTimer timer(metricsPtr, AnalysisStage::kMateRecovery);
     for (auto& fragmentIdAndReadPair : readPairs)
     {
         reads::ReadPair& readPair = fragmentIdAndReadPair.second;
@@ -108,6 +117,10 @@ void recoverMates(const string& htsFilePath, const AlignmentStatsCatalog& alignm
 
         if (!checkIfMatesWereMappedNearby(alignmentStats))
         {
+            if (metricsPtr)
+            {
+                ++metricsPtr->numMateSeeks;
+            }
             Read mate = mateExtractor.extractMate(read, alignmentStats);
             if (mate.isSet())
             {
@@ -122,12 +135,96 @@ void recoverMates(const string& htsFilePath, const AlignmentStatsCatalog& alignm
     }
 }
 
+// Assigns pairs of unmapped reads to loci by kmers; the pairs are returned for each locus in the order of the catalog
+static void assignUnmappedReadPairs(
+    const RegionCatalog& regionCatalog, int readLength, HtsFileSeeker& htsFileSeeker,
+    vector<ReadPairs>& targetReadPairs, vector<ReadPairs>& offtargetReadPairs, LocusMetrics* metricsPtr)
+{
+    // Kmers are taken from the flanks within a fragment length of the repeats
+    const CatalogKmerFilter kmerFilter(regionCatalog, 2 * readLength);
+    targetReadPairs.resize(regionCatalog.size());
+    offtargetReadPairs.resize(regionCatalog.size());
+
+    StageTimer timer(metricsPtr, AnalysisStage::kReadDecoding);
+    unordered_map<string, Read> unpairedReads;
+    int numAssignedPairs = 0;
+    htsFileSeeker.setUnmappedRegion();
+    while (htsFileSeeker.trySeekingToNextPrimaryAlignment())
+    {
+        LinearAlignmentStats alignmentStats;
+        Read read = htsFileSeeker.decodeRead(alignmentStats);
+        if (metricsPtr)
+        {
+            ++metricsPtr->numReadsDecoded;
+        }
+
+        const auto mateIterator = unpairedReads.find(read.fragmentId());
+        if (mateIterator == unpairedReads.end())
+        {
+            unpairedReads.emplace(read.fragmentId(), std::move(read));
+            continue;
+        }
+        Read mate = std::move(mateIterator->second);
+        unpairedReads.erase(mateIterator);
+
+        const ReadPairAssignment assignment = kmerFilter.assignPair(read.sequence, mate.sequence);
+        if (assignment.targetLocusIndex != -1)
+        {
+            targetReadPairs[assignment.targetLocusIndex].Add(read);
+            targetReadPairs[assignment.targetLocusIndex].Add(mate);
+        }
+        for (int locusIndex : assignment.offtargetLocusIndexes)
+        {
+            offtargetReadPairs[locusIndex].Add(read);
+            offtargetReadPairs[locusIndex].Add(mate);
+        }
+        if (assignment.targetLocusIndex != -1 || !assignment.offtargetLocusIndexes.empty())
+        {
+            ++numAssignedPairs;
+        }
+    }
+
+    auto console = spdlog::get("console") ? spdlog::get("console") : spdlog::stderr_color_mt("console");
+    console->info("Assigned {} unmapped read pairs to loci by kmers", numAssignedPairs);
+}
+
+// Pairs of the fragments in excludedReadPairs are skipped
+static void addReadPairs(
+    const ReadPairs& sourceReadPairs, ReadPairs& readPairs, const ReadPairs* excludedReadPairsPtr = nullptr)
+{
+    for (const auto& fragmentIdAndReadPair : sourceReadPairs)
+    {
+        if (excludedReadPairsPtr && excludedReadPairsPtr->Contains(fragmentIdAndReadPair.first))
+        {
+            continue;
+        }
+        readPairs.Add(fragmentIdAndReadPair.second.first_mate);
+        readPairs.Add(fragmentIdAndReadPair.second.second_mate);
+    }
+}
+
+// Off-target reads are only used by loci with a rare repeat
+static optional<string> getUnitOfRareRepeat(const LocusSpecification& regionSpec)
+{
+    for (const auto& variantSpec : regionSpec.variantSpecs())
+    {
+        if (variantSpec.classification().subtype == VariantSubtype::kRareRepeat)
+        {
+            return regionSpec.regionGraph().nodeSeq(variantSpec.nodes().front());
+        }
+    }
+    return optional<string>();
+}
+
+// Off-target pairs from the cache have both reads in the rare repeat; the others still need to be screened
 static RegionFindings analyzeRegion(
-    const ReadPairs& readPairs, const ReadPairs& offtargetReadPairs, const LocusSpecification& regionSpec,
-    const SampleParameters& sampleParams, const HeuristicParameters& heuristicParams, ostream& alignmentStream)
+    const ReadPairs& readPairs, const ReadPairs& prescreenedOfftargetReadPairs, const ReadPairs& offtargetReadPairs,
+    const LocusSpecification& regionSpec, const SampleParameters& sampleParams,
+    const HeuristicParameters& heuristicParams, AlignmentWriter& alignmentWriter, RegionIndexCache* indexCachePtr,
+    LocusMetrics* metricsPtr)
 {
-    alignmentStream << regionSpec.regionId() << ":" << std::endl;
-    RegionAnalyzer regionAnalyzer(regionSpec, sampleParams, heuristicParams, alignmentStream);
+    RegionAnalyzer regionAnalyzer(
+        regionSpec, sampleParams, heuristicParams, alignmentWriter, indexCachePtr, metricsPtr);
 
     for (const auto fragmentIdAndReads : readPairs)
     {
@@ -138,6 +235,15 @@ static RegionFindings analyzeRegion(
         }
     }
 
+    for (const auto fragmentIdAndReads : prescreenedOfftargetReadPairs)
+    {
+        const auto& readPair = fragmentIdAndReads.second;
+        if (readPair.first_mate.isSet() && readPair.second_mate.isSet())
+        {
+            regionAnalyzer.processPrescreenedOfftargetMates(readPair.first_mate, readPair.second_mate);
+        }
+    }
+
     for (const auto fragmentIdAndReads : offtargetReadPairs)
     {
         const auto& readPair = fragmentIdAndReads.second;
@@ -147,12 +253,20 @@ static RegionFindings analyzeRegion(
         }
     }
 
-    return regionAnalyzer.genotype();
+    RegionFindings regionFindings = regionAnalyzer.genotype();
+
+    auto console = spdlog::get("console") ? spdlog::get("console") : spdlog::stderr_color_mt("console");
+    const AlignmentTierStats& tierStats = regionAnalyzer.alignmentTierStats();
+    console->info(
+        "Aligned {:.1f}% of {} reads without gaps", tierStats.percentGaplessAlignedReads(), tierStats.numReads());
+
+    return regionFindings;
 }
 
-SampleFindings htsSeekingSampleAnalysis(
+void htsSeekingSampleAnalysis(
     const InputPaths& inputPaths, SampleParameters& sampleParams, const HeuristicParameters& heuristicParams,
-    const RegionCatalog& regionCatalog, std::ostream& alignmentStream)
+    const RegionCatalog& regionCatalog, AlignmentWriter& alignmentWriter, const LocusFindingsHandler& locusFindingsHandler,
+    RegionIndexCache* indexCachePtr, SampleMetrics* metricsPtr)
 {
     auto console = spdlog::get("console") ? spdlog::get("console") : spdlog::stderr_color_mt("console");
 
@@ -172,32 +286,64 @@ SampleFindings htsSeekingSampleAnalysis(
 
     HtsFileSeeker htsFileSeeker(inputPaths.htsFile());
 
-    SampleFindings sampleFindings;
+    vector<ReadPairs> kmerTargetReadPairs;
+    vector<ReadPairs> kmerOfftargetReadPairs;
+    if (heuristicParams.useKmerPrefilter())
+    {
+        assignUnmappedReadPairs(
+            regionCatalog, sampleParams.readLength(), htsFileSeeker, kmerTargetReadPairs, kmerOfftargetReadPairs,
+            metricsPtr ? &metricsPtr->sampleWideMetrics() : nullptr);
+    }
+
+    // Reads of an off-target region shared by several loci are accounted for in the metrics of the first of them
+    htshelpers::MateExtractor mateExtractor(inputPaths.htsFile());
+    LocusMetrics* locusMetricsPtr = nullptr;
+    auto loadOfftargetReadPairs = [&](const Region& region) {
+        AlignmentStatsCatalog alignmentStatsCatalog;
+        ReadPairs readPairs = collectReads({ region }, alignmentStatsCatalog, htsFileSeeker, locusMetricsPtr);
+        recoverMates(mateExtractor, alignmentStatsCatalog, readPairs, locusMetricsPtr);
+        return readPairs;
+    };
+    OfftargetReadCache offtargetReadCache(regionCatalog, loadOfftargetReadPairs);
+
+    int locusIndex = 0;
     for (const auto& regionIdAndRegionSpec : regionCatalog)
     {
         const string& regionId = regionIdAndRegionSpec.first;
         const LocusSpecification& regionSpec = regionIdAndRegionSpec.second;
+        locusMetricsPtr = metricsPtr ? &metricsPtr->addLocus(regionId) : nullptr;
         vector<Region> targetRegions;
         const auto& referenceLoci = regionSpec.referenceLoci();
         auto extendRegion = [=](Region region) { return region.extend(heuristicParams.regionExtensionLength()); };
         std::transform(referenceLoci.begin(), referenceLoci.end(), std::back_inserter(targetRegions), extendRegion);
         AlignmentStatsCatalog readAlignmentStats;
-        ReadPairs targetReadPairs = collectReads(targetRegions, readAlignmentStats, htsFileSeeker);
-        recoverMates(inputPaths.htsFile(), readAlignmentStats, targetReadPairs);
+        ReadPairs targetReadPairs = collectReads(targetRegions, readAlignmentStats, htsFileSeeker, locusMetricsPtr);
+        recoverMates(mateExtractor, readAlignmentStats, targetReadPairs, locusMetricsPtr);
         console->info("Collected {} read pairs from target regions", targetReadPairs.NumCompletePairs());
 
-        AlignmentStatsCatalog offtargetReadAlignmentStatsCatalog;
-        ReadPairs offtargetReadPairs
-            = collectReads(regionSpec.offtargetLoci(), offtargetReadAlignmentStatsCatalog, htsFileSeeker);
-        recoverMates(inputPaths.htsFile(), offtargetReadAlignmentStatsCatalog, offtargetReadPairs);
-        console->info("Collected {} read pairs from offtarget regions", offtargetReadPairs.NumCompletePairs());
+        const ReadPairs prescreenedOfftargetReadPairs
+            = offtargetReadCache.getReadPairs(regionSpec, getUnitOfRareRepeat(regionSpec));
+        console->info(
+            "Collected {} read pairs from offtarget regions", prescreenedOfftargetReadPairs.NumCompletePairs());
+
+        ReadPairs offtargetReadPairs;
+        if (heuristicParams.useKmerPrefilter())
+        {
+            addReadPairs(kmerTargetReadPairs[locusIndex], targetReadPairs);
+            addReadPairs(kmerOfftargetReadPairs[locusIndex], offtargetReadPairs, &prescreenedOfftargetReadPairs);
+            kmerTargetReadPairs[locusIndex].Clear();
+            kmerOfftargetReadPairs[locusIndex].Clear();
+        }
+        ++locusIndex;
 
         auto regionFindings = analyzeRegion(
-            targetReadPairs, offtargetReadPairs, regionSpec, sampleParams, heuristicParams, alignmentStream);
-        sampleFindings.emplace(std::make_pair(regionId, std::move(regionFindings)));
+            targetReadPairs, prescreenedOfftargetReadPairs, offtargetReadPairs, regionSpec, sampleParams,
+            heuristicParams, alignmentWriter, indexCachePtr, locusMetricsPtr);
+        StageTimer outputTimer(locusMetricsPtr, AnalysisStage::kOutput);
+        locusFindingsHandler(regionId, std::move(regionFindings));
     }
 
-    return sampleFindings;
+    console->info("Read {} distinct offtarget regions", offtargetReadCache.numRegionsLoaded());
 }
 
 }
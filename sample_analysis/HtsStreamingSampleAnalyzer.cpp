@@ -23,6 +23,9 @@
 #include <memory>
 #include <unordered_map>
 
+#include "thirdparty/spdlog/spdlog.h"
+
+#include "filtering/CatalogKmerFilter.hh"
 #include "region_analysis/RegionAnalyzer.hh"
 #include "sample_analysis/HtsFileStreamer.hh"
 #include "sample_analysis/HtsHelpers.hh"
@@ -37,30 +40,67 @@ using std::unordered_map;
 namespace ehunter
 {
 
-SampleFindings htslibStreamingSampleAnalyzer(
+void htslibStreamingSampleAnalyzer(
     const InputPaths& inputPaths, const SampleParameters& sampleParams, const HeuristicParameters& heuristicParams,
-    const RegionCatalog& regionCatalog, std::ostream& alignmentStream)
+    const RegionCatalog& regionCatalog, AlignmentWriter& alignmentWriter, const LocusFindingsHandler& locusFindingsHandler,
+    RegionIndexCache* indexCachePtr, SampleMetrics* metricsPtr)
 {
-    vector<std::unique_ptr<RegionAnalyzer>> locusAnalyzers
-        = initializeRegionAnalyzers(regionCatalog, sampleParams, heuristicParams, alignmentStream);
-    LocationBasedDispatcher locationBasedDispatcher(locusAnalyzers, heuristicParams.regionExtensionLength());
+    vector<std::unique_ptr<RegionAnalyzer>> locusAnalyzers = initializeRegionAnalyzers(
+        regionCatalog, sampleParams, heuristicParams, alignmentWriter, indexCachePtr, metricsPtr);
+    // Kmers are taken from the flanks within a fragment length of the repeats
+    std::unique_ptr<CatalogKmerFilter> kmerFilterPtr;
+    if (heuristicParams.useKmerPrefilter())
+    {
+        kmerFilterPtr.reset(new CatalogKmerFilter(regionCatalog, 2 * sampleParams.readLength()));
+    }
+    LocationBasedDispatcher locationBasedDispatcher(
+        locusAnalyzers, heuristicParams.regionExtensionLength(), kmerFilterPtr.get());
 
+    // Reads are decoded once for all loci, so decoding is only accounted for in the sample-wide metrics
+    LocusMetrics* sampleWideMetricsPtr = metricsPtr ? &metricsPtr->sampleWideMetrics() : nullptr;
     htshelpers::HtsFileStreamer readStreamer(inputPaths.htsFile());
-    while (readStreamer.trySeekingToNextPrimaryAlignment() && readStreamer.isStreamingAlignedReads())
+    auto tryDecodingNextRead = [&](reads::Read& read) {
+        StageTimer timer(sampleWideMetricsPtr, AnalysisStage::kReadDecoding);
+        // Unmapped reads at the end of the file are only of use to the kmer filter
+        if (!readStreamer.trySeekingToNextPrimaryAlignment()
+            || (!readStreamer.isStreamingAlignedReads() && !kmerFilterPtr))
+        {
+            return false;
+        }
+        read = readStreamer.decodeRead();
+        if (sampleWideMetricsPtr)
+        {
+            ++sampleWideMetricsPtr->numReadsDecoded;
+        }
+        return true;
+    };
+
+    reads::Read read;
+    while (tryDecodingNextRead(read))
     {
         locationBasedDispatcher.dispatch(
             readStreamer.currentReadChrom(), readStreamer.currentReadPosition(), readStreamer.currentMateChrom(),
-            readStreamer.currentMatePosition(), readStreamer.decodeRead());
+            readStreamer.currentMatePosition(), std::move(read));
     }
 
-    SampleFindings sampleFindings;
+    AlignmentTierStats alignmentTierStats;
     for (auto& locusAnalyzer : locusAnalyzers)
     {
         auto locusFindings = locusAnalyzer->genotype();
-        sampleFindings.emplace(std::make_pair(locusAnalyzer->regionId(), std::move(locusFindings)));
+        alignmentTierStats += locusAnalyzer->alignmentTierStats();
+        StageTimer outputTimer(locusAnalyzer->metricsPtr(), AnalysisStage::kOutput);
+        locusFindingsHandler(locusAnalyzer->regionId(), std::move(locusFindings));
+        locusAnalyzer.reset();
     }
 
-    return sampleFindings;
+    auto console = spdlog::get("console") ? spdlog::get("console") : spdlog::stderr_color_mt("console");
+    if (kmerFilterPtr)
+    {
+        console->info("Assigned {} read pairs to loci by kmers", locationBasedDispatcher.numPairsAssignedByKmers());
+    }
+    console->info(
+        "Aligned {:.1f}% of {} reads without gaps", alignmentTierStats.percentGaplessAlignedReads(),
+        alignmentTierStats.numReads());
 }
 
 }
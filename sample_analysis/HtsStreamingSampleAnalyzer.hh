@@ -25,14 +25,19 @@
 #include <vector>
 
 #include "common/Parameters.hh"
+#include "common/PerformanceMetrics.hh"
+#include "output/AlignmentWriter.hh"
+#include "region_analysis/RegionIndexCache.hh"
 #include "region_analysis/VariantFindings.hh"
 #include "region_spec/LocusSpecification.hh"
 
 namespace ehunter
 {
 
-SampleFindings htslibStreamingSampleAnalyzer(
+void htslibStreamingSampleAnalyzer(
     const InputPaths& inputPaths, const SampleParameters& sampleParams, const HeuristicParameters& heuristicParams,
-    const RegionCatalog& regionCatalog, std::ostream& alignmentStream);
+    const RegionCatalog& regionCatalog, AlignmentWriter& alignmentWriter,
+    const LocusFindingsHandler& locusFindingsHandler, RegionIndexCache* indexCachePtr = nullptr,
+    SampleMetrics* metricsPtr = nullptr);
 
 }
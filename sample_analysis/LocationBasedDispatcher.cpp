@@ -27,8 +27,11 @@ namespace ehunter
 {
 
 LocationBasedDispatcher::LocationBasedDispatcher(
-    std::vector<std::unique_ptr<RegionAnalyzer>>& locusAnalyzers, int searchRadius)
+    std::vector<std::unique_ptr<RegionAnalyzer>>& locusAnalyzers, int searchRadius,
+    const CatalogKmerFilter* kmerFilterPtr)
     : locationBasedAnalyzerFinder_(locusAnalyzers, searchRadius)
+    , locusAnalyzers_(locusAnalyzers)
+    , kmerFilterPtr_(kmerFilterPtr)
 {
 }
 
@@ -62,10 +65,34 @@ void LocationBasedDispatcher::dispatch(
         }
         unpairedReads_.erase(fragmentId);
     }
+    else if (kmerFilterPtr_)
+    {
+        string fragmentId = mate.fragmentId();
+        dispatchByKmers(std::move(read), std::move(mate));
+        unpairedReads_.erase(fragmentId);
+    }
     else
     {
         unpairedReads_.erase(mate.fragmentId());
     }
 }
 
+void LocationBasedDispatcher::dispatchByKmers(reads::Read read, reads::Read mate)
+{
+    const ReadPairAssignment assignment = kmerFilterPtr_->assignPair(read.sequence, mate.sequence);
+    if (assignment.targetLocusIndex != -1)
+    {
+        ++numPairsAssignedByKmers_;
+        locusAnalyzers_[assignment.targetLocusIndex]->processMates(std::move(read), std::move(mate));
+    }
+    else if (!assignment.offtargetLocusIndexes.empty())
+    {
+        ++numPairsAssignedByKmers_;
+        for (int locusIndex : assignment.offtargetLocusIndexes)
+        {
+            locusAnalyzers_[locusIndex]->processOfftargetMates(read, mate);
+        }
+    }
+}
+
 }
@@ -23,6 +23,7 @@
 #include <memory>
 #include <string>
 
+#include "filtering/CatalogKmerFilter.hh"
 #include "reads/Read.hh"
 #include "region_analysis/RegionAnalyzer.hh"
 #include "sample_analysis/LocationBasedAnalyzerFinder.hh"
@@ -30,16 +31,27 @@
 namespace ehunter
 {
 
+// Read pairs that are not aligned near any locus are assigned to loci by kmers if a kmer filter is given; the filter
+// must be built from the catalog of the analyzers
 class LocationBasedDispatcher
 {
 public:
-    LocationBasedDispatcher(std::vector<std::unique_ptr<RegionAnalyzer>>& locusAnalyzers, int searchRadius);
+    LocationBasedDispatcher(
+        std::vector<std::unique_ptr<RegionAnalyzer>>& locusAnalyzers, int searchRadius,
+        const CatalogKmerFilter* kmerFilterPtr = nullptr);
     void dispatch(
         const std::string& readChrom, int32_t readPosition, const std::string& mateChrom, int32_t matePosition,
         reads::Read read);
 
+    int numPairsAssignedByKmers() const { return numPairsAssignedByKmers_; }
+
 private:
+    void dispatchByKmers(reads::Read read, reads::Read mate);
+
     LocationBasedAnalyzerFinder locationBasedAnalyzerFinder_;
+    std::vector<std::unique_ptr<RegionAnalyzer>>& locusAnalyzers_;
+    const CatalogKmerFilter* kmerFilterPtr_;
+    int numPairsAssignedByKmers_ = 0;
 
     using ReadCatalog = std::unordered_map<std::string, reads::Read>;
     ReadCatalog unpairedReads_;
@@ -0,0 +1,125 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sample_analysis/OfftargetReadCache.hh"
+
+#include <stdexcept>
+
+#include "stats/WeightedPurityCalculator.hh"
+
+namespace ehunter
+{
+
+using boost::optional;
+using reads::ReadPair;
+using reads::ReadPairs;
+using std::string;
+
+// Same purity as required of off-target reads by the region analyzer
+static const double kMinInRepeatReadPurity = 0.90;
+
+static ReadPairs selectInRepeatReadPairs(const ReadPairs& readPairs, const string& repeatUnit)
+{
+    const WeightedPurityCalculator weightedPurityCalculator(repeatUnit);
+    ReadPairs inRepeatReadPairs;
+    for (const auto& fragmentIdAndReadPair : readPairs)
+    {
+        const ReadPair& readPair = fragmentIdAndReadPair.second;
+        if (readPair.first_mate.isSet() && readPair.second_mate.isSet()
+            && weightedPurityCalculator.checkIfReachesScore(readPair.first_mate.sequence, kMinInRepeatReadPurity)
+            && weightedPurityCalculator.checkIfReachesScore(readPair.second_mate.sequence, kMinInRepeatReadPurity))
+        {
+            inRepeatReadPairs.Add(readPair.first_mate);
+            inRepeatReadPairs.Add(readPair.second_mate);
+        }
+    }
+    return inRepeatReadPairs;
+}
+
+OfftargetReadCache::OfftargetReadCache(const RegionCatalog& regionCatalog, ReadPairsLoader readPairsLoader)
+    : readPairsLoader_(std::move(readPairsLoader))
+{
+    for (const auto& locusIdAndLocusSpec : regionCatalog)
+    {
+        for (const Region& region : locusIdAndLocusSpec.second.offtargetLoci())
+        {
+            ++regionReads_[region].numPendingLoci;
+        }
+    }
+}
+
+ReadPairs
+OfftargetReadCache::getReadPairs(const LocusSpecification& locusSpec, const optional<string>& optionalRepeatUnit)
+{
+    ReadPairs locusReadPairs;
+    for (const Region& region : locusSpec.offtargetLoci())
+    {
+        const auto regionReadsIterator = regionReads_.find(region);
+        if (regionReadsIterator == regionReads_.end())
+        {
+            throw std::logic_error("Reads from " + region.ToString() + " were already served to all loci");
+        }
+
+        RegionReads& regionReads = regionReadsIterator->second;
+        if (!regionReads.isLoaded)
+        {
+            regionReads.readPairs = readPairsLoader_(region);
+            regionReads.isLoaded = true;
+            ++numRegionsLoaded_;
+        }
+
+        const ReadPairs* readPairsPtr = &regionReads.readPairs;
+        if (optionalRepeatUnit)
+        {
+            const string& repeatUnit = *optionalRepeatUnit;
+            auto& inRepeatReadPairsByUnit = regionReads.inRepeatReadPairsByUnit;
+            auto unitIterator = inRepeatReadPairsByUnit.find(repeatUnit);
+            if (unitIterator == inRepeatReadPairsByUnit.end())
+            {
+                ReadPairs inRepeatReadPairs = selectInRepeatReadPairs(regionReads.readPairs, repeatUnit);
+                unitIterator = inRepeatReadPairsByUnit.emplace(repeatUnit, std::move(inRepeatReadPairs)).first;
+            }
+            readPairsPtr = &unitIterator->second;
+        }
+
+        // Pairs with mates in several off-target regions of the locus are only added once
+        for (const auto& fragmentIdAndReadPair : *readPairsPtr)
+        {
+            const ReadPair& readPair = fragmentIdAndReadPair.second;
+            if (readPair.first_mate.isSet())
+            {
+                locusReadPairs.Add(readPair.first_mate);
+            }
+            if (readPair.second_mate.isSet())
+            {
+                locusReadPairs.Add(readPair.second_mate);
+            }
+        }
+
+        if (--regionReads.numPendingLoci == 0)
+        {
+            regionReads_.erase(regionReadsIterator);
+        }
+    }
+
+    return locusReadPairs;
+}
+
+}
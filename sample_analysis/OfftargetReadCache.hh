@@ -0,0 +1,68 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "common/GenomicRegion.hh"
+#include "reads/ReadPairs.hh"
+#include "region_spec/LocusSpecification.hh"
+
+namespace ehunter
+{
+
+// Reads from the off-target regions of the loci of a catalog. Loci of rare repeats often list the same regions, so each
+// distinct region is read once and its pairs of in-repeat reads are found once for each repeat unit; the reads of a
+// region are released after they are served to the last locus that lists it
+class OfftargetReadCache
+{
+public:
+    using ReadPairsLoader = std::function<reads::ReadPairs(const Region&)>;
+
+    OfftargetReadCache(const RegionCatalog& regionCatalog, ReadPairsLoader readPairsLoader);
+
+    // Pairs from the off-target regions of the locus; if the unit of its rare repeat is given, only the pairs with
+    // both reads in a repeat of that unit are returned. Each locus of the catalog can be served once
+    reads::ReadPairs
+    getReadPairs(const LocusSpecification& locusSpec, const boost::optional<std::string>& optionalRepeatUnit);
+
+    int numRegionsLoaded() const { return numRegionsLoaded_; }
+
+private:
+    struct RegionReads
+    {
+        bool isLoaded = false;
+        reads::ReadPairs readPairs;
+        std::unordered_map<std::string, reads::ReadPairs> inRepeatReadPairsByUnit;
+        int numPendingLoci = 0;
+    };
+
+    std::map<Region, RegionReads> regionReads_;
+    ReadPairsLoader readPairsLoader_;
+    int numRegionsLoaded_ = 0;
+};
+
+}
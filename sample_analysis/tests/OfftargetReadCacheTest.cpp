@@ -0,0 +1,119 @@
+//
+// Expansion Hunter
+// Copyright (c) 2018 Illumina, Inc.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sample_analysis/OfftargetReadCache.hh"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "graphcore/GraphBuilders.hh"
+
+using namespace ehunter;
+
+using reads::Read;
+using reads::ReadPairs;
+using std::string;
+
+static void addPair(const string& fragmentId, const string& sequence, const string& mateSequence, ReadPairs& readPairs)
+{
+    Read read(fragmentId + "/1", sequence);
+    read.is_first_mate = true;
+    readPairs.Add(read);
+    readPairs.Add(Read(fragmentId + "/2", mateSequence));
+}
+
+class ServingOfftargetReads : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        addLocus("locus1", { Region("chr2:100-200"), Region("chr3:100-200") });
+        addLocus("locus2", { Region("chr2:100-200") });
+    }
+
+    void addLocus(const string& locusId, const std::vector<Region>& offtargetRegions)
+    {
+        LocusSpecification locusSpec(
+            locusId, { Region("chr1:1-2") }, AlleleCount::kTwo, graphtools::makeStrGraph("ATCG", "CGG", "ATCG"));
+        locusSpec.setOfftargetLoci(offtargetRegions);
+        catalog.emplace(locusId, locusSpec);
+    }
+
+    ReadPairs loadReadPairs(const Region& region)
+    {
+        ++numLoadsByRegion[region.ToString()];
+        const string irr = "CGGCGGCGGCGGCGGCGGCGGCGG";
+        ReadPairs readPairs;
+        if (region.chrom() == "chr2")
+        {
+            addPair("frag1", irr, irr, readPairs);
+            addPair("frag2", "ATGCATTACGATCAGGATCAGTAC", irr, readPairs);
+        }
+        else
+        {
+            addPair("frag1", irr, irr, readPairs);
+            addPair("frag3", irr, irr, readPairs);
+        }
+        return readPairs;
+    }
+
+    OfftargetReadCache makeCache()
+    {
+        return OfftargetReadCache(catalog, [this](const Region& region) { return loadReadPairs(region); });
+    }
+
+    RegionCatalog catalog;
+    std::map<string, int> numLoadsByRegion;
+};
+
+TEST_F(ServingOfftargetReads, RegionSharedByLoci_ReadOnce)
+{
+    OfftargetReadCache cache = makeCache();
+    cache.getReadPairs(catalog.at("locus1"), string("CGG"));
+    cache.getReadPairs(catalog.at("locus2"), string("CGG"));
+
+    EXPECT_EQ(2, cache.numRegionsLoaded());
+    EXPECT_EQ(1, numLoadsByRegion["chr2:100-200"]);
+    EXPECT_EQ(1, numLoadsByRegion["chr3:100-200"]);
+}
+
+TEST_F(ServingOfftargetReads, UnitOfRareRepeatGiven_OnlyInRepeatPairsServed)
+{
+    OfftargetReadCache cache = makeCache();
+    const ReadPairs inRepeatReadPairs = cache.getReadPairs(catalog.at("locus1"), string("CGG"));
+    const ReadPairs allReadPairs = cache.getReadPairs(catalog.at("locus2"), boost::none);
+
+    // The pair found in both off-target regions of the first locus is served once
+    EXPECT_EQ(2, inRepeatReadPairs.NumCompletePairs());
+    EXPECT_EQ(2, allReadPairs.NumCompletePairs());
+    EXPECT_NO_THROW(inRepeatReadPairs["frag3"]);
+    EXPECT_ANY_THROW(inRepeatReadPairs["frag2"]);
+    EXPECT_NO_THROW(allReadPairs["frag2"]);
+}
+
+TEST_F(ServingOfftargetReads, LocusServedTwice_ExceptionThrown)
+{
+    OfftargetReadCache cache = makeCache();
+    cache.getReadPairs(catalog.at("locus1"), string("CGG"));
+    EXPECT_ANY_THROW(cache.getReadPairs(catalog.at("locus1"), string("CGG")));
+}
@@ -20,11 +20,21 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -32,11 +42,23 @@
 #include "thirdparty/spdlog/spdlog.h"
 
 #include "common/Parameters.hh"
+#include "common/PerformanceMetrics.hh"
 #include "input/CatalogLoading.hh"
+#include "input/CatalogSharding.hh"
 #include "input/ParameterLoading.hh"
 #include "input/SampleStats.hh"
+#include "output/AlignmentWriter.hh"
+#include "output/BamAlignmentWriter.hh"
+#include "output/FindingsReorderBuffer.hh"
 #include "output/JsonWriter.hh"
+#include "output/MetricsWriter.hh"
+#include "output/OutputCheckpoint.hh"
+#include "output/OutputMerging.hh"
+#include "output/ReadCountSummary.hh"
 #include "output/VcfWriter.hh"
+#include "output/YamlAlignmentWriter.hh"
+#include "region_analysis/RegionAnalyzer.hh"
+#include "region_analysis/RegionIndexCache.hh"
 #include "region_analysis/VariantFindings.hh"
 #include "sample_analysis/HtsSeekingSampleAnalyzer.hh"
 #include "sample_analysis/HtsStreamingSampleAnalyzer.hh"
@@ -46,6 +68,352 @@ namespace spd = spdlog;
 
 using namespace ehunter;
 
+static void writeLocusOutputRecords(const LocusOutputRecords& records, JsonWriter& jsonWriter, VcfWriter& vcfWriter)
+{
+    for (const auto& jsonRecord : records.jsonRecords)
+    {
+        jsonWriter.writeRecord(jsonRecord);
+    }
+    for (const auto& idAndFieldDescription : records.vcfFieldDescriptions)
+    {
+        vcfWriter.addFieldDescription(idAndFieldDescription.second);
+    }
+    for (const auto& vcfRecord : records.vcfRecords)
+    {
+        vcfWriter.addRecord(vcfRecord);
+    }
+}
+
+// The catalog is the given shard of the catalog file
+static void analyzeSample(
+    const SampleTask& sampleTask, const OutputParameters& outputParams, const HeuristicParameters& heuristicParams,
+    const RegionCatalog& regionCatalog, const CatalogShard& catalogShard, RegionIndexCache* indexCachePtr)
+{
+    auto console = spdlog::get("console");
+    const auto startTime = std::chrono::steady_clock::now();
+
+    SampleParameters sampleParams = sampleTask.sample();
+    const InputPaths& inputPaths = sampleTask.inputPaths();
+    const OutputPaths& outputPaths = sampleTask.outputPaths();
+
+    console->info("Analyzing sample {}", sampleParams.id());
+    console->info("Read length is set to {}", sampleParams.readLength());
+
+    // Each sample opens its own reference because fasta index handles cannot be shared between threads
+    FastaReference reference(inputPaths.reference());
+    Outputs outputs(outputPaths.json());
+
+    CompositeAlignmentWriter alignmentWriter;
+    if (outputParams.writeAlignmentLog())
+    {
+        console->info("Writing alignments to {}", outputPaths.log());
+        alignmentWriter.add(std::unique_ptr<AlignmentWriter>(new YamlAlignmentWriter(outputPaths.log())));
+    }
+    if (outputParams.writeRealignedBam())
+    {
+        console->info("Writing realigned reads to {}", outputPaths.bam());
+        alignmentWriter.add(
+            std::unique_ptr<AlignmentWriter>(new BamAlignmentWriter(outputPaths.bam(), reference.contigs())));
+    }
+
+    // Records saved to a checkpoint are only reused by a run with the same catalog and parameters
+    const nlohmann::json checkpointSettings
+        = encodeCheckpointSettings(inputPaths, sampleParams, heuristicParams, catalogShard);
+    OutputCheckpoint checkpoint;
+    if (outputParams.resumeFromCheckpoint())
+    {
+        checkpoint = loadOutputCheckpoint(outputPaths.checkpoint(), sampleParams.id(), checkpointSettings);
+        console->info("Resuming with {} loci saved to {}", checkpoint.completedLoci.size(), outputPaths.checkpoint());
+    }
+
+    // Only loci missing from the checkpoint are analyzed. Indexes shared between samples must refer to the graphs of
+    // the shared catalog, so the sample builds its own indexes for its copy of the remaining loci
+    RegionCatalog remainingCatalog;
+    const RegionCatalog* analyzedCatalogPtr = &regionCatalog;
+    if (!checkpoint.completedLoci.empty())
+    {
+        for (const auto& locusIdAndRecords : checkpoint.completedLoci)
+        {
+            if (regionCatalog.find(locusIdAndRecords.first) == regionCatalog.end())
+            {
+                throw std::invalid_argument(
+                    "Checkpoint " + outputPaths.checkpoint() + " contains locus " + locusIdAndRecords.first
+                    + " that is missing from the catalog");
+            }
+        }
+        for (const auto& locusIdAndLocusSpec : regionCatalog)
+        {
+            if (checkpoint.completedLoci.find(locusIdAndLocusSpec.first) == checkpoint.completedLoci.end())
+            {
+                remainingCatalog.emplace(locusIdAndLocusSpec);
+            }
+        }
+        analyzedCatalogPtr = &remainingCatalog;
+        indexCachePtr = nullptr;
+    }
+
+    // Records are written as soon as each locus is analyzed so that findings are not accumulated in memory. Records
+    // of newly analyzed loci are also appended to the checkpoint
+    VcfWriter vcfWriter(sampleParams.id(), sampleParams.readLength(), reference, outputPaths.vcf(), outputParams);
+    JsonWriter jsonWriter(sampleParams.id(), sampleParams.readLength(), outputs.json());
+    CheckpointWriter checkpointWriter(
+        outputPaths.checkpoint(), sampleParams.id(), checkpointSettings, checkpoint.validSize);
+    std::unique_ptr<ReadCountSummaryWriter> readCountWriterPtr;
+    if (outputParams.writeReadCounts())
+    {
+        console->info("Saving read counts to {}", outputPaths.readCounts());
+        readCountWriterPtr.reset(new ReadCountSummaryWriter(outputPaths.readCounts()));
+    }
+    FindingsReorderBuffer findingsReorderBuffer(
+        regionCatalog, [&](const LocusSpecification& locusSpec, const RegionFindings& locusFindings) {
+            const auto savedRecordsIter = checkpoint.completedLoci.find(locusSpec.regionId());
+            if (savedRecordsIter != checkpoint.completedLoci.end())
+            {
+                writeLocusOutputRecords(savedRecordsIter->second, jsonWriter, vcfWriter);
+                return;
+            }
+
+            LocusOutputRecords records;
+            records.jsonRecords = jsonWriter.formatRecords(locusSpec, locusFindings);
+            vcfWriter.formatRecords(locusSpec, locusFindings, records.vcfRecords, records.vcfFieldDescriptions);
+            checkpointWriter.write(locusSpec.regionId(), records);
+            writeLocusOutputRecords(records, jsonWriter, vcfWriter);
+            if (readCountWriterPtr)
+            {
+                readCountWriterPtr->write(locusSpec.regionId(), locusFindings);
+            }
+        });
+    for (const auto& locusIdAndRecords : checkpoint.completedLoci)
+    {
+        findingsReorderBuffer.add(locusIdAndRecords.first, RegionFindings());
+    }
+    auto locusFindingsHandler = [&](const std::string& locusId, RegionFindings locusFindings) {
+        findingsReorderBuffer.add(locusId, std::move(locusFindings));
+    };
+
+    SampleMetrics sampleMetrics;
+    SampleMetrics* metricsPtr = outputParams.writeMetrics() ? &sampleMetrics : nullptr;
+    if (isBamFile(inputPaths.htsFile()))
+    {
+        htsSeekingSampleAnalysis(
+            inputPaths, sampleParams, heuristicParams, *analyzedCatalogPtr, alignmentWriter, locusFindingsHandler,
+            indexCachePtr, metricsPtr);
+    }
+    else
+    {
+        htslibStreamingSampleAnalyzer(
+            inputPaths, sampleParams, heuristicParams, *analyzedCatalogPtr, alignmentWriter, locusFindingsHandler,
+            indexCachePtr, metricsPtr);
+    }
+
+    console->info("Finalizing output files of sample {}", sampleParams.id());
+    checkpointWriter.close();
+    if (readCountWriterPtr)
+    {
+        readCountWriterPtr->close(sampleParams);
+    }
+    vcfWriter.close();
+    jsonWriter.close();
+    alignmentWriter.close();
+
+    // The checkpoint is only needed to resume an interrupted run
+    std::remove(outputPaths.checkpoint().c_str());
+
+    if (metricsPtr)
+    {
+        // Time spent finalizing the output files is only included in the total wall time
+        const std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+        console->info("Writing performance metrics to {}", outputPaths.metrics());
+        std::ofstream metricsFile(outputPaths.metrics());
+        if (!metricsFile.is_open())
+        {
+            throw std::runtime_error("Failed to open " + outputPaths.metrics() + " for writing");
+        }
+        writeSampleMetrics(sampleParams.id(), elapsedTime.count(), sampleMetrics, metricsFile);
+    }
+}
+
+// Genotypes the loci of the catalog from read counts saved by an earlier run; loci missing from the saved read counts,
+// for example loci of other catalog shards, are skipped
+static void regenotypeSample(const RegenotypeParameters& regenotypeParams)
+{
+    auto console = spdlog::get("console");
+
+    console->info("Loading read counts from {}", regenotypeParams.readCountsPath());
+    const ReadCountSummary readCountSummary = loadReadCountSummary(regenotypeParams.readCountsPath());
+    const Sex sex = regenotypeParams.optionalSex() ? *regenotypeParams.optionalSex() : readCountSummary.sex;
+    const double haplotypeDepth = regenotypeParams.optionalHaplotypeDepth()
+        ? *regenotypeParams.optionalHaplotypeDepth()
+        : readCountSummary.haplotypeDepth;
+    const SampleParameters sampleParams(readCountSummary.sampleId, sex, readCountSummary.readLength, haplotypeDepth);
+    console->info("Genotyping sample {} at haplotype depth {}", sampleParams.id(), haplotypeDepth);
+
+    console->info("Initializing reference {}", regenotypeParams.reference());
+    FastaReference reference(regenotypeParams.reference());
+    console->info("Loading variant catalog from disk {}", regenotypeParams.catalog());
+    const RegionCatalog regionCatalog = loadRegionCatalogFromDisk(regenotypeParams.catalog(), reference, sex);
+    for (const auto& locusIdAndReadCounts : readCountSummary.loci)
+    {
+        if (regionCatalog.find(locusIdAndReadCounts.first) == regionCatalog.end())
+        {
+            throw std::invalid_argument(
+                "Read counts " + regenotypeParams.readCountsPath() + " contain locus " + locusIdAndReadCounts.first
+                + " that is missing from the catalog");
+        }
+    }
+
+    const OutputParameters& outputParams = regenotypeParams.outputParameters();
+    const std::string& outputPrefix = regenotypeParams.outputPrefix();
+    const std::string vcfPath = outputPrefix + (outputParams.compressVcf() ? ".vcf.gz" : ".vcf");
+    Outputs outputs(outputPrefix + ".json");
+    VcfWriter vcfWriter(sampleParams.id(), sampleParams.readLength(), reference, vcfPath, outputParams);
+    JsonWriter jsonWriter(sampleParams.id(), sampleParams.readLength(), outputs.json());
+
+    for (const auto& locusIdAndLocusSpec : regionCatalog)
+    {
+        const auto readCountsIter = readCountSummary.loci.find(locusIdAndLocusSpec.first);
+        if (readCountsIter == readCountSummary.loci.end())
+        {
+            continue;
+        }
+        const RegionFindings locusFindings
+            = genotypeLocusFromReadCounts(locusIdAndLocusSpec.second, readCountsIter->second, sampleParams);
+        jsonWriter.write(locusIdAndLocusSpec.second, locusFindings);
+        vcfWriter.write(locusIdAndLocusSpec.second, locusFindings);
+    }
+    console->info("Genotyped {} of {} loci of the catalog", readCountSummary.loci.size(), regionCatalog.size());
+
+    vcfWriter.close();
+    jsonWriter.close();
+}
+
+// Lines submitted to a running service waiting to be analyzed
+class ServiceJobQueue
+{
+public:
+    void push(std::string jobEncoding)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobEncodings_.push_back(std::move(jobEncoding));
+        }
+        jobAdded_.notify_one();
+    }
+
+    // Called once no more jobs will be submitted
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            isClosed_ = true;
+        }
+        jobAdded_.notify_all();
+    }
+
+    // Waits for the next job; returns false once the queue is closed and all jobs were taken
+    bool tryPopping(std::string& jobEncoding)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        jobAdded_.wait(lock, [this]() { return isClosed_ || !jobEncodings_.empty(); });
+        if (jobEncodings_.empty())
+        {
+            return false;
+        }
+        jobEncoding = std::move(jobEncodings_.front());
+        jobEncodings_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable jobAdded_;
+    std::deque<std::string> jobEncodings_;
+    bool isClosed_ = false;
+};
+
+// Analyzes jobs read from standard input until it is closed. Each job is reported on standard output as a line with
+// tab-separated output prefix, status (done or failed), wall time in seconds, and an error message for failed jobs
+static void serveJobs(
+    const ProgramParameters& params, const std::map<Sex, RegionCatalog>& regionCatalogs,
+    const std::map<Sex, std::unique_ptr<RegionIndexCache>>& indexCaches)
+{
+    auto console = spdlog::get("console");
+    const ServiceParameters& serviceParams = params.serviceParameters();
+
+    // Indexes are built before the first job is accepted so that jobs only pay for read analysis
+    for (const auto& sexAndRegionCatalog : regionCatalogs)
+    {
+        RegionIndexCache& indexCache = *indexCaches.at(sexAndRegionCatalog.first);
+        for (const auto& locusIdAndLocusSpec : sexAndRegionCatalog.second)
+        {
+            indexCache.getAlignmentIndex(locusIdAndLocusSpec.second);
+        }
+    }
+
+    ServiceJobQueue jobQueue;
+    std::mutex reportMutex;
+    auto report = [&](const std::string& jobEncoding, const std::string& status, double elapsedSeconds,
+                      const std::string& message) {
+        const std::string outputPrefix = jobEncoding.substr(0, jobEncoding.find('\t'));
+        std::lock_guard<std::mutex> lock(reportMutex);
+        std::cout << outputPrefix << "\t" << status << "\t" << elapsedSeconds;
+        if (!message.empty())
+        {
+            std::cout << "\t" << message;
+        }
+        std::cout << std::endl;
+    };
+
+    auto analyzeJobs = [&]() {
+        std::string jobEncoding;
+        while (jobQueue.tryPopping(jobEncoding))
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            std::string status = "done";
+            std::string message;
+            try
+            {
+                const SampleTask sampleTask = serviceParams.decodeJob(jobEncoding);
+                const Sex sex = sampleTask.sample().sex();
+                analyzeSample(
+                    sampleTask, params.outputParameters(), params.heuristics(), regionCatalogs.at(sex),
+                    params.catalogShard(), indexCaches.at(sex).get());
+            }
+            catch (const std::exception& e)
+            {
+                console->error("Failed to analyze job {}: {}", jobEncoding, e.what());
+                status = "failed";
+                message = e.what();
+            }
+            const std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+            report(jobEncoding, status, elapsedTime.count(), message);
+        }
+    };
+
+    console->info("Accepting jobs on standard input with {} threads", params.numThreads());
+    std::vector<std::thread> threads;
+    for (int threadIndex = 0; threadIndex != params.numThreads(); ++threadIndex)
+    {
+        threads.emplace_back(analyzeJobs);
+    }
+
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (!line.empty() && line.front() != '#')
+        {
+            jobQueue.push(line);
+        }
+    }
+    jobQueue.close();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    console->info("Standard input is closed; shutting down");
+}
+
 int main(int argc, char** argv)
 {
     auto console = spd::stderr_color_mt("console");
@@ -55,6 +423,27 @@ int main(int argc, char** argv)
     {
         console->info("Starting {}", kProgramVersion);
 
+        if (argc > 1 && std::string(argv[1]) == "merge")
+        {
+            auto optionalMergeParameters = tryLoadingMergeParameters(argc - 1, argv + 1);
+            if (optionalMergeParameters)
+            {
+                console->info("Merging outputs of {} shards", optionalMergeParameters->shardOutputPrefixes().size());
+                mergeShardOutputs(*optionalMergeParameters);
+            }
+            return 0;
+        }
+
+        if (argc > 1 && std::string(argv[1]) == "regenotype")
+        {
+            auto optionalRegenotypeParameters = tryLoadingRegenotypeParameters(argc - 1, argv + 1);
+            if (optionalRegenotypeParameters)
+            {
+                regenotypeSample(*optionalRegenotypeParameters);
+            }
+            return 0;
+        }
+
         auto optionalProgramParameters = tryLoadingProgramParameters(argc, argv);
         if (!optionalProgramParameters)
         {
@@ -69,43 +458,112 @@ int main(int argc, char** argv)
             console->info("Verbose logging enabled");
         }
 
-        SampleParameters& sampleParams = params.sample();
+        const std::vector<SampleTask>& sampleTasks = params.sampleTasks();
+        const HeuristicParameters& heuristicParams = params.heuristics();
+        const OutputParameters& outputParams = params.outputParameters();
+        const std::string& referencePath = params.isServiceMode() ? params.serviceParameters().reference()
+                                                                  : sampleTasks.front().inputPaths().reference();
+        const std::string& catalogPath = params.isServiceMode() ? params.serviceParameters().catalog()
+                                                                : sampleTasks.front().inputPaths().catalog();
 
-        console->info("Analyzing sample {}", sampleParams.id());
-        console->info("Read length is set to {}", sampleParams.readLength());
+        console->info("Initializing reference {}", referencePath);
+        FastaReference reference(referencePath);
 
-        const InputPaths& inputPaths = params.inputPaths();
+        // Expected allele counts depend on sex, so the catalog is loaded once for each sex present in the batch. In
+        // batch and service modes the kmer indexes of the locus graphs are shared by all samples of the same sex
+        const bool isBatchMode = sampleTasks.size() > 1;
+        std::vector<Sex> sexes;
+        if (params.isServiceMode())
+        {
+            sexes = { Sex::kFemale, Sex::kMale };
+        }
+        for (const auto& sampleTask : sampleTasks)
+        {
+            sexes.push_back(sampleTask.sample().sex());
+        }
 
-        console->info("Initializing reference {}", inputPaths.reference());
-        FastaReference reference(inputPaths.reference());
+        std::map<Sex, RegionCatalog> regionCatalogs;
+        std::map<Sex, std::unique_ptr<RegionIndexCache>> indexCaches;
+        for (const Sex sex : sexes)
+        {
+            if (regionCatalogs.find(sex) == regionCatalogs.end())
+            {
+                console->info("Loading variant catalog from disk {}", catalogPath);
+                RegionCatalog regionCatalog = loadRegionCatalogFromDisk(catalogPath, reference, sex);
+                const CatalogShard& shard = params.catalogShard();
+                if (!shard.isWholeCatalog())
+                {
+                    const size_t numLoci = regionCatalog.size();
+                    regionCatalog = selectCatalogShard(regionCatalog, shard.index(), shard.numShards());
+                    console->info(
+                        "Shard {} of {} contains {} of {} loci", shard.index() + 1, shard.numShards(),
+                        regionCatalog.size(), numLoci);
+                }
+                regionCatalogs.emplace(sex, std::move(regionCatalog));
+                if (isBatchMode || params.isServiceMode())
+                {
+                    indexCaches.emplace(
+                        sex, std::unique_ptr<RegionIndexCache>(
+                                 new RegionIndexCache(heuristicParams.kmerLenForAlignment())));
+                }
+            }
+        }
 
-        console->info("Loading variant catalog from disk {}", inputPaths.catalog());
-        const RegionCatalog regionCatalog
-            = loadRegionCatalogFromDisk(inputPaths.catalog(), reference, sampleParams.sex());
+        if (params.isServiceMode())
+        {
+            serveJobs(params, regionCatalogs, indexCaches);
+            return 0;
+        }
 
-        console->info("Running sample analysis");
-        const HeuristicParameters& heuristicParams = params.heuristics();
-        const OutputPaths& outputPaths = params.outputPaths();
-        Outputs outputs(outputPaths.vcf(), outputPaths.json(), outputPaths.log());
+        if (!isBatchMode)
+        {
+            console->info("Running sample analysis");
+            const SampleTask& sampleTask = sampleTasks.front();
+            const RegionCatalog& regionCatalog = regionCatalogs.at(sampleTask.sample().sex());
+            analyzeSample(sampleTask, outputParams, heuristicParams, regionCatalog, params.catalogShard(), nullptr);
+            return 0;
+        }
+
+        const int numThreads = std::min(params.numThreads(), static_cast<int>(sampleTasks.size()));
+        console->info("Analyzing {} samples with {} threads", sampleTasks.size(), numThreads);
 
-        SampleFindings sampleFindings;
-        if (isBamFile(inputPaths.htsFile()))
+        // A failed sample is reported and does not stop the analysis of the rest of the batch
+        std::atomic<size_t> nextTaskIndex(0);
+        std::atomic<int> numFailedSamples(0);
+        auto analyzeSamples = [&]() {
+            for (size_t taskIndex = nextTaskIndex++; taskIndex < sampleTasks.size(); taskIndex = nextTaskIndex++)
+            {
+                const SampleTask& sampleTask = sampleTasks[taskIndex];
+                const Sex sex = sampleTask.sample().sex();
+                try
+                {
+                    analyzeSample(
+                        sampleTask, outputParams, heuristicParams, regionCatalogs.at(sex), params.catalogShard(),
+                        indexCaches.at(sex).get());
+                }
+                catch (const std::exception& e)
+                {
+                    console->error("Failed to analyze sample {}: {}", sampleTask.sample().id(), e.what());
+                    ++numFailedSamples;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int threadIndex = 0; threadIndex != numThreads; ++threadIndex)
         {
-            sampleFindings
-                = htsSeekingSampleAnalysis(inputPaths, sampleParams, heuristicParams, regionCatalog, outputs.log());
+            threads.emplace_back(analyzeSamples);
         }
-        else
+        for (auto& thread : threads)
         {
-            sampleFindings = htslibStreamingSampleAnalyzer(
-                inputPaths, sampleParams, heuristicParams, regionCatalog, outputs.log());
+            thread.join();
         }
 
-        console->info("Writing output to disk");
-        VcfWriter vcfWriter(sampleParams.id(), sampleParams.readLength(), regionCatalog, sampleFindings, reference);
-        outputs.vcf() << vcfWriter;
-
-        JsonWriter jsonWriter(sampleParams.id(), sampleParams.readLength(), regionCatalog, sampleFindings);
-        outputs.json() << jsonWriter;
+        if (numFailedSamples != 0)
+        {
+            console->error("Failed to analyze {} of {} samples", numFailedSamples.load(), sampleTasks.size());
+            return 1;
+        }
     }
     catch (const std::exception& e)
     {
@@ -118,9 +118,16 @@ namespace irrdetection
 
     static inline double scoreBases(char referenceBase, char queryBase)
     {
-        return kReferenceQueryCodeScoreLookupTable[kReferenceBaseEncodingTable[referenceBase]]
-                                                  [kQueryBaseEncodingTable[queryBase]];
+        const BaseCode referenceBaseCode = kReferenceBaseEncodingTable[static_cast<unsigned char>(referenceBase)];
+        const BaseCode queryBaseCode = kQueryBaseEncodingTable[static_cast<unsigned char>(queryBase)];
+        return kReferenceQueryCodeScoreLookupTable[referenceBaseCode][queryBaseCode];
     }
+
+    const int kNumQueryBaseCodes = kMaxQueryBaseCode + 1;
+    const double kMaxBaseScore = 1.0;
+
+    // Number of bases scored between the checks for early termination
+    const int kBasesPerTerminationCheck = 32;
 }
 
 WeightedPurityCalculator::WeightedPurityCalculator(const std::string& repeatUnit)
@@ -129,9 +136,83 @@ WeightedPurityCalculator::WeightedPurityCalculator(const std::string& repeatUnit
     const string repeatUnitRc = graphtools::reverseComplement(repeatUnit);
     auto permutationsRc = computeCircularPermutations(repeatUnitRc);
     repeatUnits_.insert(repeatUnits_.end(), permutationsRc.begin(), permutationsRc.end());
+
+    // Score vectors are laid out by offset, then query base code, then permutation
+    repeatUnitLength_ = repeatUnit.length();
+    const int numPermutations = repeatUnits_.size();
+    scoreVectors_.resize(repeatUnitLength_ * irrdetection::kNumQueryBaseCodes * numPermutations);
+    for (int offset = 0; offset != repeatUnitLength_; ++offset)
+    {
+        for (int asciiCode = 0; asciiCode <= irrdetection::maxBaseAscii; ++asciiCode)
+        {
+            const int queryBaseCode = irrdetection::kQueryBaseEncodingTable[asciiCode];
+            const int vectorIndex = offset * irrdetection::kNumQueryBaseCodes + queryBaseCode;
+            double* scores = &scoreVectors_[vectorIndex * numPermutations];
+            for (int permutationIndex = 0; permutationIndex != numPermutations; ++permutationIndex)
+            {
+                const char referenceBase = repeatUnits_[permutationIndex][offset];
+                scores[permutationIndex] = irrdetection::scoreBases(referenceBase, static_cast<char>(asciiCode));
+            }
+        }
+    }
+}
+
+const double* WeightedPurityCalculator::scoreVector(int offset, char queryBase) const
+{
+    const int queryBaseCode = irrdetection::kQueryBaseEncodingTable[static_cast<unsigned char>(queryBase)];
+    return &scoreVectors_[(offset * irrdetection::kNumQueryBaseCodes + queryBaseCode) * repeatUnits_.size()];
+}
+
+int WeightedPurityCalculator::addBaseScores(
+    string::const_iterator begin, string::const_iterator end, int offset, vector<double>& scores) const
+{
+    const int numPermutations = scores.size();
+    double* scoresData = scores.data();
+    for (auto baseIter = begin; baseIter != end; ++baseIter)
+    {
+        const double* baseScores = scoreVector(offset, *baseIter);
+        for (int permutationIndex = 0; permutationIndex != numPermutations; ++permutationIndex)
+        {
+            scoresData[permutationIndex] += baseScores[permutationIndex];
+        }
+
+        offset = offset + 1 == repeatUnitLength_ ? 0 : offset + 1;
+    }
+
+    return offset;
 }
 
 double WeightedPurityCalculator::score(const string& querySequence) const
+{
+    vector<double> scores(repeatUnits_.size(), 0);
+    addBaseScores(querySequence.begin(), querySequence.end(), 0, scores);
+
+    return *std::max_element(scores.begin(), scores.end()) / static_cast<double>(querySequence.length());
+}
+
+bool WeightedPurityCalculator::checkIfReachesScore(const string& querySequence, double minScore) const
+{
+    const int queryLength = querySequence.length();
+    const double minTotalScore = minScore * queryLength;
+    vector<double> scores(repeatUnits_.size(), 0);
+
+    int offset = 0;
+    for (int blockStart = 0; blockStart < queryLength; blockStart += irrdetection::kBasesPerTerminationCheck)
+    {
+        const int blockEnd = std::min(blockStart + irrdetection::kBasesPerTerminationCheck, queryLength);
+        offset = addBaseScores(querySequence.begin() + blockStart, querySequence.begin() + blockEnd, offset, scores);
+
+        const double maxRemainingScore = irrdetection::kMaxBaseScore * (queryLength - blockEnd);
+        if (*std::max_element(scores.begin(), scores.end()) + maxRemainingScore < minTotalScore)
+        {
+            return false;
+        }
+    }
+
+    return *std::max_element(scores.begin(), scores.end()) / static_cast<double>(queryLength) >= minScore;
+}
+
+double WeightedPurityCalculator::scoreEachPermutationSeparately(const string& querySequence) const
 {
     vector<double> scores;
     for (const auto& repeatUnit : repeatUnits_)
@@ -25,16 +25,36 @@
 namespace ehunter
 {
 
+/**
+ * Scores how well a sequence matches a repeat with the given unit in either orientation
+ *
+ * The score is the per-base average of the base match scores of the best circular permutation of the repeat unit or
+ * its reverse complement. All permutations are scored in a single pass over the sequence: for each offset in the repeat
+ * unit and each query base there is a precomputed vector with the scores of this base against every permutation, which
+ * is added to the vector of running scores.
+ */
 class WeightedPurityCalculator
 {
 public:
     WeightedPurityCalculator(const std::string& repeatUnit);
     double score(const std::string& querySequence) const;
 
+    // Same as score(querySequence) >= minScore but stops as soon as no permutation can reach the minimal score
+    bool checkIfReachesScore(const std::string& querySequence, double minScore) const;
+
+    // Scores each permutation with a separate pass over the sequence; used as a reference for testing and benchmarking
+    double scoreEachPermutationSeparately(const std::string& querySequence) const;
+
 private:
     double score(const std::string& repeatUnit, const std::string& querySequence) const;
     std::vector<std::string> computeCircularPermutations(std::string sequence) const;
+    const double* scoreVector(int offset, char queryBase) const;
+    int addBaseScores(
+        std::string::const_iterator begin, std::string::const_iterator end, int offset,
+        std::vector<double>& scores) const;
     std::vector<std::string> repeatUnits_;
+    int repeatUnitLength_;
+    std::vector<double> scoreVectors_;
 };
 
 }
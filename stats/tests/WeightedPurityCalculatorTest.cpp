@@ -43,3 +43,24 @@ TEST(CalculatingWeightedPurityScore, ImperfectRepeat_Calculated)
     EXPECT_THAT(wpCalculator.score("ACCCCAACCCCAACCCCAACCCCAACCCCAACCCCA"), DoubleNear(1.0, 0.005));
     EXPECT_THAT(wpCalculator.score("tCCCCttCCCCttCCCCttCCCCtTCCCCttCCCCT"), DoubleNear(0.75, 0.005));
 }
+
+TEST(CalculatingWeightedPurityScore, TypicalSequences_SameScoreAsScoringEachPermutationSeparately)
+{
+    WeightedPurityCalculator wpCalculator("AACCCC");
+    const vector<string> sequences = { "ACCCCAACCCCAACCCCAACCCCAACCCCAACCCCA", "tCCCCttCCCCttCCCCttCCCCtTCCCCttCCCCT",
+                                       "GGTTGGGGTTGGGGTTGGNNTTGG", "ATCGATCGATCGATCGATCGATCGATCGATCG", "A" };
+
+    for (const auto& sequence : sequences)
+    {
+        EXPECT_EQ(wpCalculator.scoreEachPermutationSeparately(sequence), wpCalculator.score(sequence));
+    }
+}
+
+TEST(CheckingWeightedPurityScore, TypicalSequences_ComparedToMinimalScore)
+{
+    WeightedPurityCalculator wpCalculator("AACCCC");
+    EXPECT_TRUE(wpCalculator.checkIfReachesScore("ACCCCAACCCCAACCCCAACCCCAACCCCAACCCCA", 0.90));
+    EXPECT_FALSE(wpCalculator.checkIfReachesScore("tCCCCttCCCCttCCCCttCCCCtTCCCCttCCCCT", 0.90));
+    EXPECT_TRUE(wpCalculator.checkIfReachesScore("tCCCCttCCCCttCCCCttCCCCtTCCCCttCCCCT", 0.75));
+    EXPECT_FALSE(wpCalculator.checkIfReachesScore("ATCGATCGATCGATCGATCGATCGATCGATCGATCGATCG", 0.90));
+}
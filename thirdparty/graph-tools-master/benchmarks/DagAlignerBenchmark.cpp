@@ -0,0 +1,327 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Roman Petrovski <RPetrovski@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "graphalign/PinnedDagAligner.hh"
+#include "graphalign/dagAligner/ScoreKernels.hh"
+#include "graphcore/Graph.hh"
+#include "graphcore/GraphBuilders.hh"
+#include "graphcore/Path.hh"
+
+using std::string;
+
+using namespace graphtools;
+using namespace graphalign::dagAligner;
+
+static string makeRandomSequence(size_t length, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    const string bases = "ACGT";
+    string sequence;
+    for (size_t index = 0; index != length; ++index)
+    {
+        sequence += bases[generator() % bases.size()];
+    }
+    return sequence;
+}
+
+// 150bp read that starts with the end of the left flank and continues into the repeat
+static string makeRead(const string& leftFlank, const string& repeatUnit)
+{
+    string read = leftFlank.substr(leftFlank.length() - 20);
+    while (read.length() < 150)
+    {
+        read += repeatUnit;
+    }
+    return read.substr(0, 150);
+}
+
+static void alignReadToRepeat(benchmark::State& state, const string& repeatUnit)
+{
+    const auto isa = static_cast<KernelIsa>(state.range(0));
+    if (!isSupported(isa))
+    {
+        state.SkipWithError("instruction set is not supported by this CPU");
+        return;
+    }
+    setActiveScoreKernels(isa);
+
+    const string leftFlank = makeRandomSequence(1000, 1);
+    const Graph graph = makeStrGraph(leftFlank, repeatUnit, makeRandomSequence(1000, 2));
+    const string read = makeRead(leftFlank, repeatUnit);
+    // seed on the first 20 bases of the read, the rest is aligned to the unrolled target
+    const Path seed(&graph, leftFlank.length() - 20, { 0 }, leftFlank.length());
+    const string queryPiece = read.substr(20);
+
+    PinnedDagAligner aligner(5, -4, -8, -2);
+    for (auto _ : state)
+    {
+        int score = 0;
+        auto alignments = aligner.prefixAlign(seed, queryPiece, queryPiece.length() + 10, score);
+        benchmark::DoNotOptimize(alignments);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(toString(isa));
+}
+
+// Target with the topology of a repeat unrolled by the dag aligner: copies of the repeat unit followed by a flank that
+// can be entered from the end of every copy
+static EdgeMap makeUnrolledRepeatTarget(const string& repeatUnit, string& target)
+{
+    const int unitLen = repeatUnit.length();
+    const int numCopies = 160 / unitLen;
+    std::vector<std::pair<int, int>> edges;
+    std::vector<int> nodeIds;
+    for (int copy = 0; copy != numCopies; ++copy)
+    {
+        if (copy)
+        {
+            edges.emplace_back(copy * unitLen - 1, copy * unitLen);
+        }
+        nodeIds.push_back(copy);
+        target += repeatUnit;
+    }
+    const int flankStart = target.length();
+    for (int copy = 0; copy != numCopies; ++copy)
+    {
+        edges.emplace_back(copy * unitLen + unitLen - 1, flankStart);
+    }
+    nodeIds.push_back(numCopies);
+    target += makeRandomSequence(160, 3);
+    edges.emplace_back(target.length(), target.length());
+    return EdgeMap(edges, nodeIds);
+}
+
+// 150bp reads made of the repeat unit with a few mismatches each
+static std::vector<string> makeRepeatReads(const string& repeatUnit, int numReads, std::size_t readLen = 150)
+{
+    std::vector<string> reads;
+    for (int readIndex = 0; readIndex != numReads; ++readIndex)
+    {
+        string read;
+        while (read.length() < readLen)
+        {
+            read += repeatUnit;
+        }
+        read = read.substr(0, readLen);
+        for (int error = 0; error != readIndex % 3; ++error)
+        {
+            read[(error * 37 + readIndex * 11) % read.length()] = "ACGT"[error % 4];
+        }
+        reads.push_back(read);
+    }
+    return reads;
+}
+
+static void fillUnrolledRepeatMatrix(benchmark::State& state, const string& repeatUnit)
+{
+    const auto isa = static_cast<KernelIsa>(state.range(0));
+    if (!isSupported(isa))
+    {
+        state.SkipWithError("instruction set is not supported by this CPU");
+        return;
+    }
+    setActiveScoreKernels(isa);
+
+    string target;
+    const EdgeMap edgeMap = makeUnrolledRepeatTarget(repeatUnit, target);
+    const string read = makeRepeatReads(repeatUnit, 1).front();
+
+    BaseMatchingDagAligner<true, false> aligner(5, -4, -8, -2);
+    for (auto _ : state)
+    {
+        aligner.align(read.begin(), read.end(), target.begin(), target.end(), edgeMap);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(toString(isa) + " target=" + std::to_string(target.length()) + "bp");
+}
+
+// Same as fillUnrolledRepeatMatrix, only the cells within 10 gaps of the target paths get filled
+static void fillUnrolledRepeatMatrixBand(benchmark::State& state, const string& repeatUnit)
+{
+    const auto isa = static_cast<KernelIsa>(state.range(0));
+    if (!isSupported(isa))
+    {
+        state.SkipWithError("instruction set is not supported by this CPU");
+        return;
+    }
+    setActiveScoreKernels(isa);
+
+    string target;
+    const EdgeMap edgeMap = makeUnrolledRepeatTarget(repeatUnit, target);
+    const string read = makeRepeatReads(repeatUnit, 1).front();
+
+    BaseMatchingDagBandedAligner<true, false> aligner(5, -4, -8, -2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            aligner.alignBanded<false>(read.begin(), read.end(), target.begin(), target.end(), edgeMap, 10));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(toString(isa) + " target=" + std::to_string(target.length()) + "bp");
+}
+
+// Reads aligned against the same target one after another or all at once, one read per vector lane
+static void fillUnrolledRepeatMatrices(benchmark::State& state, const string& repeatUnit, bool batch)
+{
+    const auto isa = static_cast<KernelIsa>(state.range(0));
+    if (!isSupported(isa))
+    {
+        state.SkipWithError("instruction set is not supported by this CPU");
+        return;
+    }
+    setActiveScoreKernels(isa);
+
+    string target;
+    const EdgeMap edgeMap = makeUnrolledRepeatTarget(repeatUnit, target);
+    BaseMatchingDagAligner<true, false> aligner(5, -4, -8, -2);
+    BaseMatchingDagBatchAligner<true, false> batchAligner(5, -4, -8, -2);
+    const std::vector<string> reads = makeRepeatReads(repeatUnit, batchAligner.LANES);
+    for (auto _ : state)
+    {
+        if (batch)
+        {
+            batchAligner.align(reads.begin(), reads.end(), target.begin(), target.end(), edgeMap);
+        }
+        else
+        {
+            for (const string& read : reads)
+            {
+                aligner.align(read.begin(), read.end(), target.begin(), target.end(), edgeMap);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * reads.size());
+    state.SetLabel(toString(isa) + (batch ? " batch" : " one by one"));
+}
+
+// Query pieces short enough for 8-bit scores aligned 16 at a time with 16-bit scores or 32 at a time with 8-bit scores
+static void fillUnrolledRepeatPieceMatrices(benchmark::State& state, const string& repeatUnit, bool narrow)
+{
+    const auto isa = static_cast<KernelIsa>(state.range(0));
+    if (!isSupported(isa))
+    {
+        state.SkipWithError("instruction set is not supported by this CPU");
+        return;
+    }
+    setActiveScoreKernels(isa);
+
+    string target;
+    const EdgeMap edgeMap = makeUnrolledRepeatTarget(repeatUnit, target);
+    BaseMatchingDagBatchAligner<true, false> batchAligner(5, -4, -8, -2);
+    BaseMatchingDagBatchAligner<true, false, 32, NarrowScore> narrowBatchAligner(5, -4, -8, -2);
+    const std::vector<string> pieces = makeRepeatReads(repeatUnit, narrowBatchAligner.LANES, 25);
+    for (auto _ : state)
+    {
+        if (narrow)
+        {
+            narrowBatchAligner.align(pieces.begin(), pieces.end(), target.begin(), target.end(), edgeMap);
+        }
+        else
+        {
+            for (std::size_t first = 0; pieces.size() != first; first += batchAligner.LANES)
+            {
+                batchAligner.align(
+                    pieces.begin() + first, pieces.begin() + first + batchAligner.LANES, target.begin(), target.end(),
+                    edgeMap);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * pieces.size());
+    state.SetLabel(toString(isa) + (narrow ? " 8-bit" : " 16-bit"));
+}
+
+static void BM_FillFmr1Matrix(benchmark::State& state) { fillUnrolledRepeatMatrix(state, "CGG"); }
+BENCHMARK(BM_FillFmr1Matrix)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_FillFmr1MatrixBand(benchmark::State& state) { fillUnrolledRepeatMatrixBand(state, "CGG"); }
+BENCHMARK(BM_FillFmr1MatrixBand)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_FillC9orf72Matrix(benchmark::State& state) { fillUnrolledRepeatMatrix(state, "GGGGCC"); }
+BENCHMARK(BM_FillC9orf72Matrix)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_AlignToFmr1Repeat(benchmark::State& state) { alignReadToRepeat(state, "CGG"); }
+BENCHMARK(BM_AlignToFmr1Repeat)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_AlignToC9orf72Repeat(benchmark::State& state) { alignReadToRepeat(state, "GGGGCC"); }
+BENCHMARK(BM_AlignToC9orf72Repeat)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_FillFmr1MatricesOneByOne(benchmark::State& state) { fillUnrolledRepeatMatrices(state, "CGG", false); }
+BENCHMARK(BM_FillFmr1MatricesOneByOne)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_FillFmr1MatricesInBatch(benchmark::State& state) { fillUnrolledRepeatMatrices(state, "CGG", true); }
+BENCHMARK(BM_FillFmr1MatricesInBatch)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_FillFmr1PieceMatrices16Bit(benchmark::State& state)
+{
+    fillUnrolledRepeatPieceMatrices(state, "CGG", false);
+}
+BENCHMARK(BM_FillFmr1PieceMatrices16Bit)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+static void BM_FillFmr1PieceMatrices8Bit(benchmark::State& state)
+{
+    fillUnrolledRepeatPieceMatrices(state, "CGG", true);
+}
+BENCHMARK(BM_FillFmr1PieceMatrices8Bit)
+    ->Arg(static_cast<int>(KernelIsa::kScalar))
+    ->Arg(static_cast<int>(KernelIsa::kAvx2))
+    ->Arg(static_cast<int>(KernelIsa::kAvx512bw));
+
+BENCHMARK_MAIN();
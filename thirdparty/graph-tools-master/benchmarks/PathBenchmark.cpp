@@ -0,0 +1,88 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <list>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "graphcore/Graph.hh"
+#include "graphcore/GraphBuilders.hh"
+#include "graphcore/Path.hh"
+#include "graphcore/PathOperations.hh"
+
+using std::list;
+using std::string;
+
+using namespace graphtools;
+
+// Typical repeat locus: two 150bp flanks around a CAG repeat
+static Graph makeBenchmarkGraph() { return makeStrGraph(string(150, 'A'), "CAG", string(150, 'T')); }
+
+static void BM_ExtendPathStart(benchmark::State& state)
+{
+    const Graph graph = makeBenchmarkGraph();
+    const Path seed(&graph, 1, { 1 }, 2);
+    const auto extension_len = static_cast<int32_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        list<Path> paths = extendPathStart(seed, extension_len);
+        benchmark::DoNotOptimize(paths);
+    }
+}
+BENCHMARK(BM_ExtendPathStart)->Arg(10)->Arg(20)->Arg(40);
+
+static void BM_ExtendPathEnd(benchmark::State& state)
+{
+    const Graph graph = makeBenchmarkGraph();
+    const Path seed(&graph, 1, { 1 }, 2);
+    const auto extension_len = static_cast<int32_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        list<Path> paths = extendPathEnd(seed, extension_len);
+        benchmark::DoNotOptimize(paths);
+    }
+}
+BENCHMARK(BM_ExtendPathEnd)->Arg(10)->Arg(20)->Arg(40);
+
+static void BM_CopyPath(benchmark::State& state)
+{
+    const Graph graph = makeBenchmarkGraph();
+    const Path path(&graph, 100, { 0, 1, 1, 1, 2 }, 50);
+
+    for (auto _ : state)
+    {
+        Path copy(path);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_CopyPath);
+
+BENCHMARK_MAIN();
@@ -60,6 +60,7 @@ struct BamAlignment
     Sequence sequence;
     std::vector<int> BaseQualities;
     std::string graphCigar; // Represents the graph alignment of the read (in a string BAM tag)
+    std::string graphName; // Identifies the graph that the graph CIGAR refers to (in a string BAM tag)
 };
 
 /**
@@ -122,5 +123,6 @@ private:
 
     static std::string const initHeader; // Dummy header line
     static std::string const graphCigarBamTag; // Custom tag to use for graphCIGAR string
+    static std::string const graphNameBamTag; // Custom tag to use for the name of the graph
 };
 }
\ No newline at end of file
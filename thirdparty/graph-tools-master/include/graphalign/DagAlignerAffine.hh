@@ -36,6 +36,8 @@
 #include <boost/assert.hpp>
 
 #include "dagAligner/AffineAlignMatrix.hh"
+#include "dagAligner/AffineAlignMatrixBanded.hh"
+#include "dagAligner/AffineAlignMatrixBatch.hh"
 #include "dagAligner/AffineAlignMatrixVectorized.hh"
 #include "dagAligner/PenaltyMatrix.hh"
 
@@ -45,32 +47,23 @@ namespace graphalign
 namespace dagAligner
 {
     /**
-     * Performs global alignment of query against DAG of target nodes.
+     * Recovers the best scoring paths from a filled alignment matrix.
      * \param clipFront true instructs to represent insertions at the start of CIGAR as soft clips
      */
-    template <typename AlignMatrix, bool clipFront = true> class Aligner
+    template <typename AlignMatrix, bool clipFront = true> class Backtracker
     {
-        AlignMatrix alignMatrix_;
+        const AlignMatrix& alignMatrix_;
 
         // max number of best paths to backtrack
         const std::size_t maxRepeats_;
 
     public:
-        Aligner(
-            const typename AlignMatrix::PenaltyMatrix& penaltyMatrix, Score gapOpen, Score gapExt,
-            std::size_t maxRepeats = 10)
-            : alignMatrix_(penaltyMatrix, gapOpen, gapExt)
+        Backtracker(const AlignMatrix& alignMatrix, std::size_t maxRepeats)
+            : alignMatrix_(alignMatrix)
             , maxRepeats_(maxRepeats)
         {
         }
 
-        template <typename QueryIt, typename TargetIt>
-        void __attribute((noinline))
-        align(QueryIt queryBegin, QueryIt queryEnd, TargetIt targetBegin, TargetIt targetEnd, const EdgeMap& edgeMap)
-        {
-            alignMatrix_.init(queryBegin, queryEnd, targetBegin, targetEnd, edgeMap);
-        }
-
         struct Step
         {
             Cigar::OpCode operation_;
@@ -321,6 +314,65 @@ namespace dagAligner
             cigars.push_back(ret);
             return true;
         }
+    };
+
+    /**
+     * Performs global alignment of query against DAG of target nodes.
+     * \param clipFront true instructs to represent insertions at the start of CIGAR as soft clips
+     */
+    template <typename AlignMatrix, bool clipFront = true> class Aligner
+    {
+        AlignMatrix alignMatrix_;
+
+        // max number of best paths to backtrack
+        const std::size_t maxRepeats_;
+
+    public:
+        Aligner(
+            const typename AlignMatrix::PenaltyMatrix& penaltyMatrix, Score gapOpen, Score gapExt,
+            std::size_t maxRepeats = 10)
+            : alignMatrix_(penaltyMatrix, gapOpen, gapExt)
+            , maxRepeats_(maxRepeats)
+        {
+        }
+
+        template <typename QueryIt, typename TargetIt>
+        void __attribute((noinline))
+        align(QueryIt queryBegin, QueryIt queryEnd, TargetIt targetBegin, TargetIt targetEnd, const EdgeMap& edgeMap)
+        {
+            alignMatrix_.init(queryBegin, queryEnd, targetBegin, targetEnd, edgeMap);
+        }
+
+        /**
+         * \brief Same as align for the matrices that fill only a band of cells, such as AffineAlignMatrixBanded
+         * \param bandWidth max number of gaps alignments can get ahead of or behind the target path they follow
+         * \return true if the band contains all the best alignments, otherwise the query has to be realigned
+         *         without a band
+         */
+        template <bool localAlign, typename QueryIt, typename TargetIt>
+        bool __attribute((noinline)) alignBanded(
+            QueryIt queryBegin, QueryIt queryEnd, TargetIt targetBegin, TargetIt targetEnd, const EdgeMap& edgeMap,
+            int bandWidth)
+        {
+            alignMatrix_.init(queryBegin, queryEnd, targetBegin, targetEnd, edgeMap, bandWidth);
+            Score bestScore = SCORE_MIN;
+            alignMatrix_.template nextBestAlign<localAlign>(alignMatrix_.alignBegin(), bestScore);
+            return alignMatrix_.outOfBandScoreBound() < bestScore;
+        }
+
+        template <bool localAlign>
+        Score backtrackAllPaths(const EdgeMap& edgeMap, std::vector<Cigar>& cigars, Score& secondBestScore) const
+        {
+            return Backtracker<AlignMatrix, clipFront>(alignMatrix_, maxRepeats_)
+                .template backtrackAllPaths<localAlign>(edgeMap, cigars, secondBestScore);
+        }
+
+        template <bool localAlign>
+        Cigar backtrackBestPath(const EdgeMap& edgeMap, Score& bestScore, Score& secondBestScore) const
+        {
+            return Backtracker<AlignMatrix, clipFront>(alignMatrix_, maxRepeats_)
+                .template backtrackBestPath<localAlign>(edgeMap, bestScore, secondBestScore);
+        }
 
         friend std::ostream& operator<<(std::ostream& os, const Aligner& aligner)
         {
@@ -328,6 +380,79 @@ namespace dagAligner
         }
     };
 
+    /**
+     * Performs global alignment of a batch of queries against the same DAG of target nodes at once. The matrices of
+     * all queries are filled together, one query per vector lane.
+     * \param clipFront true instructs to represent insertions at the start of CIGAR as soft clips
+     */
+    template <typename AlignMatrixBatch, bool clipFront = true> class BatchAligner
+    {
+        AlignMatrixBatch alignMatrix_;
+
+        // max number of best paths to backtrack
+        const std::size_t maxRepeats_;
+
+    public:
+        // max number of queries in a batch
+        static const int LANES = AlignMatrixBatch::LANES;
+
+        BatchAligner(
+            const typename AlignMatrixBatch::PenaltyMatrix& penaltyMatrix, Score gapOpen, Score gapExt,
+            std::size_t maxRepeats = 10)
+            : alignMatrix_(penaltyMatrix, gapOpen, gapExt)
+            , maxRepeats_(maxRepeats)
+        {
+        }
+
+        /**
+         * \param queriesBegin first of at most LANES query sequences, each providing begin() and end()
+         */
+        template <typename QueriesIt, typename TargetIt>
+        void __attribute((noinline)) align(
+            QueriesIt queriesBegin, QueriesIt queriesEnd, TargetIt targetBegin, TargetIt targetEnd,
+            const EdgeMap& edgeMap)
+        {
+            alignMatrix_.init(queriesBegin, queriesEnd, targetBegin, targetEnd, edgeMap);
+        }
+
+        int numQueries() const { return alignMatrix_.numQueries(); }
+
+        /**
+         * \param query index of the query in the last aligned batch
+         * \return score of the best alignment of the query without backtracking it
+         */
+        template <bool localAlign> Score bestScore(int query) const
+        {
+            const typename AlignMatrixBatch::Lane lane = alignMatrix_.lane(query);
+            Score ret = 0;
+            lane.template nextBestAlign<localAlign>(lane.alignBegin(), ret);
+            return ret;
+        }
+
+        /**
+         * \param query index of the query in the last aligned batch
+         * \return highest score of any cell of the query, see AffineAlignMatrixBatch::maxCellScore
+         */
+        Score maxCellScore(int query) const { return alignMatrix_.maxCellScore(query); }
+
+        /**
+         * \param query index of the query in the last aligned batch
+         */
+        template <bool localAlign>
+        Score backtrackAllPaths(
+            int query, const EdgeMap& edgeMap, std::vector<Cigar>& cigars, Score& secondBestScore) const
+        {
+            const typename AlignMatrixBatch::Lane lane = alignMatrix_.lane(query);
+            return Backtracker<typename AlignMatrixBatch::Lane, clipFront>(lane, maxRepeats_)
+                .template backtrackAllPaths<localAlign>(edgeMap, cigars, secondBestScore);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const BatchAligner& aligner)
+        {
+            return os << "BatchAligner(" << aligner.alignMatrix_ << ")";
+        }
+    };
+
 } // namespace dagAligner
 
 // template <bool penalizeMove>
@@ -370,6 +495,22 @@ public:
     }
 };
 
+template <bool penalizeMove, bool clipFront = true, bool matchQueryN = true, bool matchTargetN = true>
+class BandedDagAligner : public dagAligner::Aligner<
+                             dagAligner::AffineAlignMatrixBanded<
+                                 dagAligner::FixedPenaltyMatrix<matchQueryN, matchTargetN>, penalizeMove>,
+                             clipFront>
+{
+    typedef dagAligner::FixedPenaltyMatrix<matchQueryN, matchTargetN> PenaltyMatrix;
+
+public:
+    BandedDagAligner(const PenaltyMatrix& penaltyMatrix, dagAligner::Score gapOpen, dagAligner::Score gapExt)
+        : dagAligner::Aligner<dagAligner::AffineAlignMatrixBanded<PenaltyMatrix, penalizeMove>, clipFront>(
+              penaltyMatrix, gapOpen, gapExt)
+    {
+    }
+};
+
 // template <bool penalizeMove>
 // class DagAligner
 //     : public dagAligner::Aligner<dagAligner::AffineAlignMatrix<dagAligner::FreePenaltyMatrix, penalizeMove>>
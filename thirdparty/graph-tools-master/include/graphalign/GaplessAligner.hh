@@ -29,6 +29,7 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
 
 #include "graphalign/GraphAligner.hh"
@@ -48,14 +49,28 @@ class GaplessAligner : public GraphAligner
 public:
     GaplessAligner(const Graph* graph_ptr, int32_t kmer_len)
         : kmer_len_(kmer_len)
-        , kmer_index_(*graph_ptr, kmer_len)
+        , kmer_index_ptr_(std::make_shared<KmerIndex>(*graph_ptr, kmer_len))
+    {
+    }
+
+    // Uses a prebuilt kmer index of the graph that can be shared with other aligners
+    explicit GaplessAligner(std::shared_ptr<const KmerIndex> kmer_index_ptr)
+        : kmer_len_(kmer_index_ptr->kmerLength())
+        , kmer_index_ptr_(std::move(kmer_index_ptr))
     {
     }
     std::list<GraphAlignment> align(const std::string& query) const override;
 
+    /**
+     * Same as align but only returns alignments with at most the given number of mismatches; paths are extended only
+     * while they stay within this bound, so a read that matches the graph well is aligned without enumerating all
+     * paths through the repeats
+     */
+    std::list<GraphAlignment> align(const std::string& query, int32_t max_mismatches) const;
+
 private:
     int32_t kmer_len_;
-    KmerIndex kmer_index_;
+    std::shared_ptr<const KmerIndex> kmer_index_ptr_;
 };
 
 /**
@@ -89,6 +104,19 @@ private:
  */
 std::list<GraphAlignment> getBestAlignmentToShortPath(const Path& path, int32_t start_pos, const std::string& query);
 
+/**
+ * Computes top-scoring gapless alignments of a query sequence to the graph that go through the path starting at the
+ * given position on the sequence and have at most the given number of mismatches
+ *
+ * @param path: Any path shorter than the query
+ * @param start_pos: Position on the query corrsponding to the start of the path
+ * @param query: Any sequence
+ * @param max_mismatches: Maximum number of mismatches
+ * @return Best gapless alignments with the above properties or an empty list if there are none
+ */
+std::list<GraphAlignment> getBestAlignmentToShortPath(
+    const Path& path, int32_t start_pos, const std::string& query, int32_t max_mismatches);
+
 /**
  * Aligns a query sequence to a path of the same length
  *
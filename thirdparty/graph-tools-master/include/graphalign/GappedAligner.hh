@@ -31,8 +31,12 @@
 
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
 
 #include "graphalign/GaplessAligner.hh"
 #include "graphalign/GraphAligner.hh"
@@ -74,7 +78,23 @@ public:
         : kmer_len_(kmer_len)
         , padding_len_(padding_len)
         , seed_affix_trim_len_(seed_affix_trim_len)
-        , kmer_index_(*graph_ptr, kmer_len)
+        , kmer_index_ptr_(std::make_shared<KmerIndex>(*graph_ptr, kmer_len))
+        , aligner_(alignerName, alignerParameters)
+    {
+    }
+
+    /**
+     * Initializes the aligner with a prebuilt kmer index of the graph that can be shared with other aligners
+     *
+     * @param kmer_index_ptr: Kmer index of the graph; its kmer length is used for seeding
+     */
+    GappedGraphAligner(
+        std::shared_ptr<const KmerIndex> kmer_index_ptr, size_t padding_len, size_t seed_affix_trim_len,
+        const std::string& alignerName, LinearAlignmentParameters alignerParameters = LinearAlignmentParameters())
+        : kmer_len_(kmer_index_ptr->kmerLength())
+        , padding_len_(padding_len)
+        , seed_affix_trim_len_(seed_affix_trim_len)
+        , kmer_index_ptr_(std::move(kmer_index_ptr))
         , aligner_(alignerName, alignerParameters)
     {
     }
@@ -87,6 +107,30 @@ public:
      */
     std::list<GraphAlignment> align(const std::string& query) const override;
 
+    /**
+     * Aligns a batch of reads to the graph. Query pieces of the same length that extend seeds from the same position
+     * are aligned together by the dag aligner
+     *
+     * @param queries: Query sequences
+     * @return Lists of top-scoring graph alignments, same as align would return for each query
+     */
+    std::vector<std::list<GraphAlignment>> alignBatch(const std::vector<std::string>& queries) const;
+
+    /**
+     * Counts batches of query pieces aligned against the same target by alignBatch; all zeros for the path aligner
+     */
+    DagBatchStats batchStats() const { return aligner_.batchStats(); }
+
+    /**
+     * Counts query pieces aligned by alignBatch with 8-bit and 16-bit scores; all zeros for the path aligner
+     */
+    DagScorePrecisionStats scorePrecisionStats() const { return aligner_.scorePrecisionStats(); }
+
+    /**
+     * Counts query pieces aligned within a band and realigned without it; all zeros for the path aligner
+     */
+    DagBandStats bandStats() const { return aligner_.bandStats(); }
+
     /**
      * Extends a path matching a kmer in the query sequence to full-length alignments
      *
@@ -121,10 +165,47 @@ public:
     extendAlignmentSuffix(const Path& seed_path, const std::string& query_piece, size_t extension_len) const;
 
 private:
+    /**
+     * Seed kmer match of a query with the pieces of the query on either side of it and their alignments
+     */
+    struct SeedExtension
+    {
+        explicit SeedExtension(const Path& kmer_path)
+            : kmer_path(kmer_path)
+            , prefix_seed_path(kmer_path)
+            , suffix_seed_path(kmer_path)
+        {
+        }
+
+        Path kmer_path;
+        Path prefix_seed_path;
+        std::string query_prefix;
+        std::list<PathAndAlignment> prefix_extensions;
+        Path suffix_seed_path;
+        std::string query_suffix;
+        std::list<PathAndAlignment> suffix_extensions;
+    };
+
+    /**
+     * Finds the path and the query position of the first kmer in the query that is unique in the graph
+     */
+    boost::optional<std::pair<Path, size_t>> findSeed(const std::string& query) const;
+
+    /**
+     * Splits query into pieces to be aligned on either side of the kmer match. Empty pieces are replaced by artificial
+     * 1bp extensions
+     */
+    SeedExtension splitQueryAtKmerMatch(Path kmer_path, const std::string& query, size_t kmer_start_on_query) const;
+
+    /**
+     * Combines prefix and suffix extensions with the kmer match into full-length alignments
+     */
+    static std::list<GraphAlignment> mergeExtensions(SeedExtension& extension);
+
     const size_t kmer_len_;
     const size_t padding_len_;
     const int32_t seed_affix_trim_len_;
-    const KmerIndex kmer_index_;
+    const std::shared_ptr<const KmerIndex> kmer_index_ptr_;
 
     class AlignerSelector
     {
@@ -165,6 +246,57 @@ private:
                                    : ptrDagAligner_->prefixAlign(seed_path, query_piece, extension_len, score);
         }
 
+        std::vector<std::list<PathAndAlignment>> suffixAlignBatch(
+            const std::vector<Path>& seed_paths, const std::vector<std::string>& query_pieces,
+            size_t extension_len) const
+        {
+            std::vector<int> scores;
+            if (ptrDagAligner_)
+            {
+                return ptrDagAligner_->suffixAlignBatch(seed_paths, query_pieces, extension_len, scores);
+            }
+
+            // path aligner has no batch mode
+            std::vector<std::list<PathAndAlignment>> ret;
+            for (std::size_t piece = 0; piece != query_pieces.size(); ++piece)
+            {
+                int score = INT32_MIN;
+                ret.push_back(
+                    ptrPathAligner_->suffixAlign(seed_paths[piece], query_pieces[piece], extension_len, score));
+            }
+            return ret;
+        }
+
+        std::vector<std::list<PathAndAlignment>> prefixAlignBatch(
+            const std::vector<Path>& seed_paths, const std::vector<std::string>& query_pieces,
+            size_t extension_len) const
+        {
+            std::vector<int> scores;
+            if (ptrDagAligner_)
+            {
+                return ptrDagAligner_->prefixAlignBatch(seed_paths, query_pieces, extension_len, scores);
+            }
+
+            // path aligner has no batch mode
+            std::vector<std::list<PathAndAlignment>> ret;
+            for (std::size_t piece = 0; piece != query_pieces.size(); ++piece)
+            {
+                int score = INT32_MIN;
+                ret.push_back(
+                    ptrPathAligner_->prefixAlign(seed_paths[piece], query_pieces[piece], extension_len, score));
+            }
+            return ret;
+        }
+
+        DagBatchStats batchStats() const { return ptrDagAligner_ ? ptrDagAligner_->batchStats() : DagBatchStats(); }
+
+        DagScorePrecisionStats scorePrecisionStats() const
+        {
+            return ptrDagAligner_ ? ptrDagAligner_->scorePrecisionStats() : DagScorePrecisionStats();
+        }
+
+        DagBandStats bandStats() const { return ptrDagAligner_ ? ptrDagAligner_->bandStats() : DagBandStats(); }
+
     } aligner_;
 };
 }
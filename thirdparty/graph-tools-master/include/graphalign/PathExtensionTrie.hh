@@ -0,0 +1,82 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "graphcore/Path.hh"
+
+namespace graphtools
+{
+
+/**
+ * Prefix tree spelling the sequences of all paths that extend a seed path by a fixed length in one direction. The
+ * sequences are read starting from the pinned end of the seed, so paths sharing their first bases share the nodes
+ * spelling them and the alignment matrix columns computed for these nodes can be reused by all of them
+ */
+class PathExtensionTrie
+{
+public:
+    enum class Direction
+    {
+        kStart,
+        kEnd
+    };
+
+    struct Node
+    {
+        char base;
+        // Parent nodes precede their children; the root has no parent
+        int32_t parent;
+        int32_t depth;
+    };
+
+    // Enumerates the paths extending the start (or end) of the seed path by extension_len
+    PathExtensionTrie(const Path& seed_path, int32_t extension_len, Direction direction);
+
+    Direction direction() const { return direction_; }
+    // The root spells an empty sequence and is always the first node
+    const std::vector<Node>& nodes() const { return nodes_; }
+    // Extended paths and the nodes spelling their sequences in the order of extendPathStart / extendPathEnd
+    const std::vector<std::pair<int32_t, Path>>& leaves() const { return leaves_; }
+    // Rough estimate of the memory held by the trie
+    size_t numBytes() const;
+
+private:
+    int32_t addSequence(const std::string& sequence);
+
+    Direction direction_;
+    std::vector<Node> nodes_;
+    std::vector<std::vector<std::pair<char, int32_t>>> children_;
+    std::vector<std::pair<int32_t, Path>> leaves_;
+};
+}
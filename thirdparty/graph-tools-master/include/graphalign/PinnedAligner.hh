@@ -30,8 +30,10 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "graphalign/LinearAlignment.hh"
+#include "graphalign/PathExtensionTrie.hh"
 #include "graphalign/TracebackMatrix.hh"
 
 namespace graphtools
@@ -56,6 +58,10 @@ public:
     // Calculates a top-scoring local alignment of a query to the reference that starts at right-most position of both
     // sequences
     Alignment suffixAlign(std::string query, std::string reference);
+    // Fills one column of the prefix alignment matrix per trie node from the column of its parent; the query is
+    // expected to be reversed for tries spelling path starts. Each column holds query.length() + 1 cells
+    void populateTrieColumns(
+        const PathExtensionTrie& trie, const std::string& query, std::vector<TracebackMatrixCell>& columns);
 
 private:
     void fillTopLeft(TracebackMatrix& matrix);
@@ -28,9 +28,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/throw_exception.hpp>
 
@@ -40,6 +44,7 @@
 #include "graphalign/dagAligner/BaseMatchingPenaltyMatrix.hh"
 #include "graphcore/Graph.hh"
 #include "graphcore/Path.hh"
+#include "graphutils/PairHashing.hh"
 
 namespace graphtools
 {
@@ -71,6 +76,93 @@ public:
     }
 };
 
+template <bool penalizeMove, bool clipFront = true>
+class BaseMatchingDagBandedAligner
+    : public graphalign::dagAligner::Aligner<
+          graphalign::dagAligner::AffineAlignMatrixBanded<
+              graphalign::dagAligner::BaseMatchingPenaltyMatrix, penalizeMove>,
+          clipFront>
+{
+    typedef graphalign::dagAligner::BaseMatchingPenaltyMatrix PenaltyMatrix;
+    typedef graphalign::dagAligner::Score Score;
+
+public:
+    BaseMatchingDagBandedAligner(Score match, Score mismatch, Score gapOpen, Score gapExt)
+        : graphalign::dagAligner::Aligner<
+              graphalign::dagAligner::AffineAlignMatrixBanded<PenaltyMatrix, penalizeMove>, clipFront>(
+              PenaltyMatrix(match, mismatch), gapOpen, gapExt)
+    {
+    }
+};
+
+template <bool penalizeMove, bool clipFront = true, int lanes = 16, typename ScoreT = graphalign::dagAligner::Score>
+class BaseMatchingDagBatchAligner : public graphalign::dagAligner::BatchAligner<
+                                        graphalign::dagAligner::AffineAlignMatrixBatch<
+                                            graphalign::dagAligner::BaseMatchingPenaltyMatrix, penalizeMove, lanes,
+                                            ScoreT>,
+                                        clipFront>
+{
+    typedef graphalign::dagAligner::BaseMatchingPenaltyMatrix PenaltyMatrix;
+    typedef graphalign::dagAligner::Score Score;
+
+public:
+    BaseMatchingDagBatchAligner(Score match, Score mismatch, Score gapOpen, Score gapExt)
+        : graphalign::dagAligner::BatchAligner<
+              graphalign::dagAligner::AffineAlignMatrixBatch<PenaltyMatrix, penalizeMove, lanes, ScoreT>, clipFront>(
+              PenaltyMatrix(match, mismatch), gapOpen, gapExt)
+    {
+    }
+};
+
+/**
+ * Counters describing the use of the unrolled target cache of PinnedDagAligner
+ */
+struct DagTargetCacheStats
+{
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * Counters describing the banded alignment of single query pieces by PinnedDagAligner. Pieces whose best alignments
+ * might fall outside of the band get realigned without it
+ */
+struct DagBandStats
+{
+    std::size_t bandedPieces = 0;
+    std::size_t bandFallbacks = 0;
+};
+
+/**
+ * Counters describing the batches of query pieces aligned against the same target by the batch functions of
+ * PinnedDagAligner
+ */
+struct DagBatchStats
+{
+    std::size_t batches = 0;
+    std::size_t pieces = 0;
+
+    double meanBatchSize() const { return batches ? double(pieces) / batches : 0.0; }
+};
+
+/**
+ * Counters describing the score precision used by the batch functions of PinnedDagAligner. Query pieces are aligned
+ * with 8-bit scores first and get realigned with 16-bit scores if their scores saturated. Only the pieces too long to
+ * ever pass the saturation checks get 16-bit scores straight away
+ */
+struct DagScorePrecisionStats
+{
+    std::size_t narrowPieces = 0;
+    std::size_t narrowOverflows = 0;
+    std::size_t widePieces = 0;
+
+    // fraction of the pieces aligned with 8-bit scores that had to be realigned with 16-bit scores
+    double overflowRate() const { return narrowPieces ? double(narrowOverflows) / narrowPieces : 0.0; }
+};
+
 /**
  * Performs alignment of query pieces that start or end at the seed in the graph
  */
@@ -79,6 +171,10 @@ class PinnedDagAligner
     typedef std::pair<int, int> Edge;
     typedef std::vector<Edge> Edges;
     BaseMatchingDagAligner<true, false> aligner_;
+    BaseMatchingDagBandedAligner<true, false> bandedAligner_;
+    BaseMatchingDagBatchAligner<true, false> batchAligner_;
+    BaseMatchingDagBatchAligner<true, false, 32, graphalign::dagAligner::NarrowScore> narrowBatchAligner_;
+    const int32_t matchScore_;
 
     static void appendOperation(OperationType type, uint32_t length, std::list<Operation>& operations)
     {
@@ -196,9 +292,27 @@ class PinnedDagAligner
     }
 
 public:
+    // Default upper bound on the memory taken by cached unrolled targets
+    static constexpr std::size_t kDefaultTargetCacheBytes = 16 * 1024 * 1024;
+
+    // Number of query pieces aligned at once by the batch functions
+    static constexpr int kBatchSize = BaseMatchingDagBatchAligner<true, false>::LANES;
+    // Same for the first pass of the batch functions, which uses 8-bit scores
+    static constexpr int kNarrowBatchSize
+        = BaseMatchingDagBatchAligner<true, false, 32, graphalign::dagAligner::NarrowScore>::LANES;
+
+    /**
+     * \param targetCacheBytes approximate bound on the memory used to cache unrolled targets; 0 disables caching
+     */
     explicit PinnedDagAligner(
-        const int32_t matchScore, const int32_t mismatchScore, const int32_t gapOpenScore, const int32_t gapExtendScore)
+        const int32_t matchScore, const int32_t mismatchScore, const int32_t gapOpenScore, const int32_t gapExtendScore,
+        std::size_t targetCacheBytes = kDefaultTargetCacheBytes)
         : aligner_(matchScore, mismatchScore, gapOpenScore, gapExtendScore)
+        , bandedAligner_(matchScore, mismatchScore, gapOpenScore, gapExtendScore)
+        , batchAligner_(matchScore, mismatchScore, gapOpenScore, gapExtendScore)
+        , narrowBatchAligner_(matchScore, mismatchScore, gapOpenScore, gapExtendScore)
+        , matchScore_(matchScore)
+        , targetCacheBytes_(targetCacheBytes)
     {
     }
 
@@ -206,102 +320,442 @@ public:
     prefixAlign(const Path& seedPath, const std::string& queryPiece, size_t extensionLen, int& score)
     {
         using namespace graphalign::dagAligner;
-        std::vector<MappedId> nodeIds;
-        Edges edges;
-        std::string target;
+        const Graph& graph = *seedPath.graphRawPtr();
+        const std::shared_ptr<const DagTarget> dagTarget = getTarget(graph, prefixTargetKey(seedPath, extensionLen));
 
-        // when repeat expansions are unrolled each copy gets a unique id, so, all
-        // ids have to be remapped
-        std::map<MappedId, NodeId> originalIds;
+        std::list<PathAndAlignment> ret;
+        if (!dagTarget->target.empty())
+        {
+            std::vector<Cigar> cigars;
+            score = alignPiece(*dagTarget, queryPiece, extensionLen, cigars);
+            ret = prefixAlignments(seedPath, *dagTarget, cigars);
+        }
 
-        bfsDiscoverEdges(
-            *seedPath.graphRawPtr(), seedPath.nodeIds().back(), seedPath.endPosition(), extensionLen, nodeIds, edges,
-            target, originalIds);
-        edges.push_back(Edge(target.length(), target.length()));
+        return ret;
+    }
+
+    std::list<PathAndAlignment>
+    suffixAlign(const Path& seedPath, std::string queryPiece, size_t extensionLen, int& score)
+    {
+        using namespace graphalign::dagAligner;
+        ReverseGraph rg(*seedPath.graphRawPtr());
+        const std::shared_ptr<const DagTarget> dagTarget = getTarget(rg, suffixTargetKey(seedPath, extensionLen));
 
         std::list<PathAndAlignment> ret;
-        if (!target.empty())
+        if (!dagTarget->target.empty())
         {
-            const EdgeMap alignerEdges(edges, nodeIds);
+            std::reverse(queryPiece.begin(), queryPiece.end());
+            std::vector<Cigar> cigars;
+            score = alignPiece(*dagTarget, queryPiece, extensionLen, cigars);
+            ret = suffixAlignments(seedPath, *dagTarget, cigars);
+        }
 
-            aligner_.align(queryPiece.begin(), queryPiece.end(), target.begin(), target.end(), alignerEdges);
+        return ret;
+    }
 
-            std::vector<Cigar> cigars;
-            Score secondBestScore = 0;
-            Score bestScore = aligner_.backtrackAllPaths<false>(alignerEdges, cigars, secondBestScore);
+    /**
+     * \brief Same as prefixAlign for a number of query pieces that start at the same seed. Pieces are aligned
+     *        in batches, see alignBatch
+     * \param scores receives the score of each query piece
+     */
+    std::vector<std::list<PathAndAlignment>> prefixAlignBatch(
+        const Path& seedPath, const std::vector<std::string>& queryPieces, size_t extensionLen,
+        std::vector<int>& scores)
+    {
+        return prefixAlignBatch(std::vector<Path>(queryPieces.size(), seedPath), queryPieces, extensionLen, scores);
+    }
 
-            score = bestScore;
-            for (Cigar& cigar : cigars)
-            {
-                fixFirstNodeExpansion(nodeIds, originalIds, seedPath, cigar);
+    /**
+     * \brief Same as prefixAlignBatch for query pieces that extend different seed paths. All seed paths must end at
+     *        the same position, so that the pieces share the target
+     */
+    std::vector<std::list<PathAndAlignment>> prefixAlignBatch(
+        const std::vector<Path>& seedPaths, const std::vector<std::string>& queryPieces, size_t extensionLen,
+        std::vector<int>& scores)
+    {
+        if (seedPaths.empty())
+        {
+            return {};
+        }
+        const Graph& graph = *seedPaths.front().graphRawPtr();
+        const TargetKey key = prefixTargetKey(seedPaths.front(), extensionLen);
+        checkSameTarget(seedPaths, key, prefixTargetKey);
+        const std::shared_ptr<const DagTarget> dagTarget = getTarget(graph, key);
 
-                unmapNodeIds(originalIds, cigar);
+        std::vector<std::vector<graphalign::dagAligner::Cigar>> cigars;
+        alignBatch(*dagTarget, queryPieces, scores, cigars);
 
-                Path path = seedPath;
-                std::list<Operation> operations;
-                parseGraphCigar(*seedPath.graphRawPtr(), cigar, path, operations);
+        std::vector<std::list<PathAndAlignment>> ret;
+        for (std::size_t piece = 0; cigars.size() != piece; ++piece)
+        {
+            ret.push_back(prefixAlignments(seedPaths[piece], *dagTarget, cigars[piece]));
+        }
 
-                ret.push_back(PathAndAlignment(path, Alignment(seedPath.seq().length(), operations)));
-            }
+        return ret;
+    }
+
+    /**
+     * \brief Same as suffixAlign for a number of query pieces that end at the same seed. Pieces are aligned
+     *        in batches, see alignBatch
+     * \param scores receives the score of each query piece
+     */
+    std::vector<std::list<PathAndAlignment>> suffixAlignBatch(
+        const Path& seedPath, const std::vector<std::string>& queryPieces, size_t extensionLen,
+        std::vector<int>& scores)
+    {
+        return suffixAlignBatch(std::vector<Path>(queryPieces.size(), seedPath), queryPieces, extensionLen, scores);
+    }
+
+    /**
+     * \brief Same as suffixAlignBatch for query pieces that extend different seed paths. All seed paths must start at
+     *        the same position, so that the pieces share the target
+     */
+    std::vector<std::list<PathAndAlignment>> suffixAlignBatch(
+        const std::vector<Path>& seedPaths, std::vector<std::string> queryPieces, size_t extensionLen,
+        std::vector<int>& scores)
+    {
+        if (seedPaths.empty())
+        {
+            return {};
+        }
+        ReverseGraph rg(*seedPaths.front().graphRawPtr());
+        const TargetKey key = suffixTargetKey(seedPaths.front(), extensionLen);
+        checkSameTarget(seedPaths, key, suffixTargetKey);
+        const std::shared_ptr<const DagTarget> dagTarget = getTarget(rg, key);
+
+        for (std::string& queryPiece : queryPieces)
+        {
+            std::reverse(queryPiece.begin(), queryPiece.end());
+        }
+
+        std::vector<std::vector<graphalign::dagAligner::Cigar>> cigars;
+        alignBatch(*dagTarget, queryPieces, scores, cigars);
+
+        std::vector<std::list<PathAndAlignment>> ret;
+        for (std::size_t piece = 0; cigars.size() != piece; ++piece)
+        {
+            ret.push_back(suffixAlignments(seedPaths[piece], *dagTarget, cigars[piece]));
         }
 
         return ret;
     }
 
-    std::list<PathAndAlignment>
-    suffixAlign(const Path& seedPath, std::string queryPiece, size_t extensionLen, int& score)
+    const DagTargetCacheStats& targetCacheStats() const { return targetCacheStats_; }
+    const DagBatchStats& batchStats() const { return batchStats_; }
+    const DagScorePrecisionStats& scorePrecisionStats() const { return scorePrecisionStats_; }
+    const DagBandStats& bandStats() const { return bandStats_; }
+
+private:
+    /**
+     * \brief Linearized subgraph reachable from a seed position within the extension length
+     */
+    struct DagTarget
     {
-        using namespace graphalign::dagAligner;
         std::vector<MappedId> nodeIds;
-        Edges edges;
-        std::string target;
-
         // when repeat expansions are unrolled each copy gets a unique id, so, all
         // ids have to be remapped
         std::map<MappedId, NodeId> originalIds;
+        std::string target;
+        // only set for non-empty targets
+        std::unique_ptr<const graphalign::dagAligner::EdgeMap> edgeMap;
+        std::size_t bytes = 0;
+    };
 
-        ReverseGraph rg(*seedPath.graphRawPtr());
-        bfsDiscoverEdges(
-            rg, seedPath.nodeIds().front(),
-            // endPosition is on the base that belongs to the path...
-            ConstReversePath(seedPath).endPosition(), extensionLen, nodeIds, edges, target, originalIds);
-        edges.push_back(Edge(target.length(), target.length()));
+    // Unrolled targets depend only on the seed position, extension length and direction
+    struct TargetKey
+    {
+        const Graph* graph;
+        NodeId nodeId;
+        int32_t offset;
+        std::size_t extensionLen;
+        bool reverse;
 
+        bool operator==(const TargetKey& other) const
+        {
+            return graph == other.graph && nodeId == other.nodeId && offset == other.offset
+                && extensionLen == other.extensionLen && reverse == other.reverse;
+        }
+    };
+
+    struct TargetKeyHash
+    {
+        std::size_t operator()(const TargetKey& key) const
+        {
+            std::size_t seed = 0;
+            hash_combine(seed, key.graph, key.nodeId, key.offset, key.extensionLen, key.reverse);
+            return seed;
+        }
+    };
+
+    typedef std::pair<TargetKey, std::shared_ptr<const DagTarget>> TargetCacheEntry;
+
+    static TargetKey prefixTargetKey(const Path& seedPath, std::size_t extensionLen)
+    {
+        return TargetKey{ seedPath.graphRawPtr(), seedPath.nodeIds().back(), seedPath.endPosition(), extensionLen,
+                          false };
+    }
+
+    static TargetKey suffixTargetKey(const Path& seedPath, std::size_t extensionLen)
+    {
+        // endPosition is on the base that belongs to the path...
+        return TargetKey{ seedPath.graphRawPtr(), seedPath.nodeIds().front(),
+                          ConstReversePath(seedPath).endPosition(), extensionLen, true };
+    }
+
+    template <typename TargetKeyFunction>
+    static void checkSameTarget(const std::vector<Path>& seedPaths, const TargetKey& key, TargetKeyFunction targetKey)
+    {
+        for (const Path& seedPath : seedPaths)
+        {
+            if (!(targetKey(seedPath, key.extensionLen) == key))
+            {
+                throw std::logic_error("Seed paths of a batch must share the target, got " + seedPath.encode());
+            }
+        }
+    }
+
+    /**
+     * \brief Converts cigars of query pieces aligned against the target that starts at the end of the seed path
+     */
+    std::list<PathAndAlignment> prefixAlignments(
+        const Path& seedPath, const DagTarget& dagTarget, std::vector<graphalign::dagAligner::Cigar>& cigars)
+    {
         std::list<PathAndAlignment> ret;
-        if (!target.empty())
+        for (graphalign::dagAligner::Cigar& cigar : cigars)
         {
-            const EdgeMap alignerEdges(edges, nodeIds);
+            fixFirstNodeExpansion(dagTarget.nodeIds, dagTarget.originalIds, seedPath, cigar);
 
-            std::reverse(queryPiece.begin(), queryPiece.end());
-            aligner_.align(queryPiece.begin(), queryPiece.end(), target.begin(), target.end(), alignerEdges);
+            unmapNodeIds(dagTarget.originalIds, cigar);
 
-            std::vector<Cigar> cigars;
-            Score secondBestScore = 0;
-            Score bestScore = aligner_.backtrackAllPaths<false>(alignerEdges, cigars, secondBestScore);
+            Path path = seedPath;
+            std::list<Operation> operations;
+            parseGraphCigar(*seedPath.graphRawPtr(), cigar, path, operations);
+
+            ret.push_back(PathAndAlignment(path, Alignment(seedPath.seq().length(), operations)));
+        }
+        return ret;
+    }
+
+    /**
+     * \brief Converts cigars of reversed query pieces aligned against the reversed target that ends at the start of
+     *        the seed path
+     */
+    std::list<PathAndAlignment> suffixAlignments(
+        const Path& seedPath, const DagTarget& dagTarget, std::vector<graphalign::dagAligner::Cigar>& cigars)
+    {
+        ReverseGraph rg(*seedPath.graphRawPtr());
+        std::list<PathAndAlignment> ret;
+        for (graphalign::dagAligner::Cigar& cigar : cigars)
+        {
+            fixFirstNodeExpansion(dagTarget.nodeIds, dagTarget.originalIds, ConstReversePath(seedPath), cigar);
 
-            score = bestScore;
-            for (Cigar& cigar : cigars)
+            unmapNodeIds(dagTarget.originalIds, cigar);
+
+            Path path = seedPath;
+            ReversePath rp(path);
+            std::list<Operation> operations;
+            parseGraphCigar(rg, cigar, rp, operations);
+            operations.reverse();
+
+            // reversed alignments always start at the beginning of the path because
+            // the seed path gets start-extended to incorporate them
+            ret.push_back(PathAndAlignment(path, Alignment(0, operations)));
+        }
+        return ret;
+    }
+
+    /**
+     * \brief Aligns a query piece against the target and backtracks its best paths. The target extends beyond the
+     *        piece length by the padding the caller expects alignments to need, so the piece is aligned within a band
+     *        that wide first. If the band might miss the best alignments, the full matrix is filled instead.
+     * \return score of the best alignment
+     */
+    int alignPiece(
+        const DagTarget& dagTarget, const std::string& queryPiece, size_t extensionLen,
+        std::vector<graphalign::dagAligner::Cigar>& cigars)
+    {
+        using namespace graphalign::dagAligner;
+        const EdgeMap& alignerEdges = *dagTarget.edgeMap;
+        const std::string& target = dagTarget.target;
+        const int bandWidth = extensionLen > queryPiece.length() ? extensionLen - queryPiece.length() : 0;
+
+        ++bandStats_.bandedPieces;
+        Score secondBestScore = 0;
+        if (bandedAligner_.alignBanded<false>(
+                queryPiece.begin(), queryPiece.end(), target.begin(), target.end(), alignerEdges, bandWidth))
+        {
+            return bandedAligner_.backtrackAllPaths<false>(alignerEdges, cigars, secondBestScore);
+        }
+
+        ++bandStats_.bandFallbacks;
+        aligner_.align(queryPiece.begin(), queryPiece.end(), target.begin(), target.end(), alignerEdges);
+        return aligner_.backtrackAllPaths<false>(alignerEdges, cigars, secondBestScore);
+    }
+
+    /**
+     * \brief Aligns query pieces against the target and backtracks the best paths of each. Pieces are first aligned
+     *        kNarrowBatchSize at a time with saturating 8-bit scores. A piece gets the same paths as with 16-bit
+     *        scores if none of its cells reached NARROW_SCORE_MAX and, as a score grows by at most matchScore_ per
+     *        query base, its best score is above NARROW_SCORE_MIN + matchScore_ * length, so that it cannot derive
+     *        from a cell saturated at the bottom. The other pieces are realigned kBatchSize at a time with 16-bit
+     *        scores. Pieces too long to pass both checks skip the 8-bit pass.
+     */
+    void alignBatch(
+        const DagTarget& dagTarget, const std::vector<std::string>& queryPieces, std::vector<int>& scores,
+        std::vector<std::vector<graphalign::dagAligner::Cigar>>& cigars)
+    {
+        using namespace graphalign::dagAligner;
+        scores.assign(queryPieces.size(), INT32_MIN);
+        cigars.assign(queryPieces.size(), std::vector<Cigar>());
+        if (dagTarget.target.empty())
+        {
+            return;
+        }
+
+        std::vector<std::size_t> narrowPieces;
+        std::vector<std::size_t> widePieces;
+        for (std::size_t piece = 0; queryPieces.size() != piece; ++piece)
+        {
+            if (NARROW_SCORE_MIN + matchScore_ * int64_t(queryPieces[piece].size()) < NARROW_SCORE_MAX - 1)
+            {
+                narrowPieces.push_back(piece);
+            }
+            else
+            {
+                widePieces.push_back(piece);
+            }
+        }
+        ++batchStats_.batches;
+        batchStats_.pieces += queryPieces.size();
+        scorePrecisionStats_.narrowPieces += narrowPieces.size();
+        scorePrecisionStats_.widePieces += widePieces.size();
+
+        std::vector<std::size_t> overflows;
+        alignPieces(narrowBatchAligner_, dagTarget, queryPieces, narrowPieces, scores, cigars, &overflows);
+        scorePrecisionStats_.narrowOverflows += overflows.size();
+
+        widePieces.insert(widePieces.end(), overflows.begin(), overflows.end());
+        alignPieces(batchAligner_, dagTarget, queryPieces, widePieces, scores, cigars, nullptr);
+    }
+
+    /**
+     * \param pieces indexes of the query pieces to align
+     * \param overflows if not null, receives the indexes of the pieces whose scores may have saturated instead of
+     *        getting their scores and cigars
+     */
+    template <typename BatchAlignerT>
+    void alignPieces(
+        BatchAlignerT& batchAligner, const DagTarget& dagTarget, const std::vector<std::string>& queryPieces,
+        const std::vector<std::size_t>& pieces, std::vector<int>& scores,
+        std::vector<std::vector<graphalign::dagAligner::Cigar>>& cigars, std::vector<std::size_t>* overflows)
+    {
+        using namespace graphalign::dagAligner;
+        const EdgeMap& alignerEdges = *dagTarget.edgeMap;
+        const std::string& target = dagTarget.target;
+        std::vector<std::string> batch;
+        for (std::size_t first = 0; pieces.size() > first; first += BatchAlignerT::LANES)
+        {
+            const std::size_t last = std::min<std::size_t>(pieces.size(), first + BatchAlignerT::LANES);
+            batch.clear();
+            for (std::size_t i = first; last != i; ++i)
             {
-                fixFirstNodeExpansion(nodeIds, originalIds, ConstReversePath(seedPath), cigar);
+                batch.push_back(queryPieces[pieces[i]]);
+            }
+            batchAligner.align(batch.begin(), batch.end(), target.begin(), target.end(), alignerEdges);
+
+            for (std::size_t i = first; last != i; ++i)
+            {
+                const std::size_t piece = pieces[i];
+                if (overflows
+                    && (NARROW_SCORE_MAX <= batchAligner.maxCellScore(i - first)
+                        || batchAligner.template bestScore<false>(i - first)
+                            <= NARROW_SCORE_MIN + matchScore_ * int64_t(queryPieces[piece].size())))
+                {
+                    overflows->push_back(piece);
+                    continue;
+                }
 
-                unmapNodeIds(originalIds, cigar);
+                Score secondBestScore = 0;
+                scores[piece] = batchAligner.template backtrackAllPaths<false>(
+                    i - first, alignerEdges, cigars[piece], secondBestScore);
+            }
+        }
+    }
 
-                Path path = seedPath;
-                ReversePath rp(path);
-                std::list<Operation> operations;
-                parseGraphCigar(rg, cigar, rp, operations);
-                operations.reverse();
+    template <typename GraphT> std::shared_ptr<const DagTarget> getTarget(const GraphT& graph, const TargetKey& key)
+    {
+        const auto cached = targetCacheIndex_.find(key);
+        if (targetCacheIndex_.end() != cached)
+        {
+            ++targetCacheStats_.hits;
+            // most recently used entries are kept at the front
+            targetCache_.splice(targetCache_.begin(), targetCache_, cached->second);
+            return cached->second->second;
+        }
 
-                // reversed alignments always start at the beginning of the path because
-                // the seed path gets start-extended to incorporate them
-                ret.push_back(PathAndAlignment(path, Alignment(0, operations)));
+        ++targetCacheStats_.misses;
+        std::shared_ptr<const DagTarget> dagTarget = buildTarget(graph, key.nodeId, key.offset, key.extensionLen);
+        if (dagTarget->bytes <= targetCacheBytes_)
+        {
+            while (targetCacheStats_.bytes + dagTarget->bytes > targetCacheBytes_)
+            {
+                evictLeastRecentlyUsedTarget();
             }
+            targetCache_.emplace_front(key, dagTarget);
+            targetCacheIndex_.emplace(key, targetCache_.begin());
+            targetCacheStats_.bytes += dagTarget->bytes;
+            targetCacheStats_.entries = targetCache_.size();
         }
 
-        return ret;
+        return dagTarget;
     }
 
-private:
+    void evictLeastRecentlyUsedTarget()
+    {
+        const TargetCacheEntry& entry = targetCache_.back();
+        targetCacheStats_.bytes -= entry.second->bytes;
+        targetCacheIndex_.erase(entry.first);
+        targetCache_.pop_back();
+        targetCacheStats_.entries = targetCache_.size();
+        ++targetCacheStats_.evictions;
+    }
+
+    template <typename GraphT>
+    static std::shared_ptr<const DagTarget>
+    buildTarget(const GraphT& graph, NodeId startNodeId, std::size_t startNodeOffset, std::size_t extensionLen)
+    {
+        using namespace graphalign::dagAligner;
+        std::shared_ptr<DagTarget> dagTarget = std::make_shared<DagTarget>();
+
+        Edges edges;
+        bfsDiscoverEdges(
+            graph, startNodeId, startNodeOffset, extensionLen, dagTarget->nodeIds, edges, dagTarget->target,
+            dagTarget->originalIds);
+        edges.push_back(Edge(dagTarget->target.length(), dagTarget->target.length()));
+
+        if (!dagTarget->target.empty())
+        {
+            dagTarget->edgeMap.reset(new EdgeMap(edges, dagTarget->nodeIds));
+        }
+
+        // rough estimate of the heap memory held by the target and its edge map
+        const std::size_t kMapNodeOverhead = 4 * sizeof(void*);
+        dagTarget->bytes = sizeof(DagTarget) + dagTarget->nodeIds.size() * sizeof(MappedId)
+            + dagTarget->originalIds.size() * (sizeof(std::pair<MappedId, NodeId>) + kMapNodeOverhead)
+            + dagTarget->target.capacity() + dagTarget->target.length() * (sizeof(int) + sizeof(std::size_t))
+            + edges.size() * sizeof(int);
+
+        return dagTarget;
+    }
+
+    const std::size_t targetCacheBytes_;
+    std::list<TargetCacheEntry> targetCache_;
+    std::unordered_map<TargetKey, std::list<TargetCacheEntry>::iterator, TargetKeyHash> targetCacheIndex_;
+    DagTargetCacheStats targetCacheStats_;
+    DagBatchStats batchStats_;
+    DagScorePrecisionStats scorePrecisionStats_;
+    DagBandStats bandStats_;
+
     template <typename GraphT>
     static std::map<NodeId, int> extractSubgraph(
         const GraphT& graph, const NodeId startNodeId, const std::size_t startNodeOffset, const std::size_t seqLen)
@@ -28,12 +28,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <list>
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "graphalign/GraphAlignment.hh"
 #include "graphalign/LinearAlignmentOperations.hh"
+#include "graphalign/PathExtensionTrie.hh"
 #include "graphalign/PinnedAligner.hh"
+#include "graphalign/TracebackRunner.hh"
 #include "graphcore/PathOperations.hh"
 
 namespace graphtools
@@ -41,6 +49,22 @@ namespace graphtools
 
 using PathAndAlignment = std::pair<Path, Alignment>;
 
+/**
+ * Counters describing the use of the path extension cache of PinnedPathAligner
+ */
+struct PathTrieCacheStats
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * Aligns query pieces to all paths extending a seed path. The paths are enumerated once per seed and kept in a
+ * prefix tree, so the alignment matrix columns of the bases shared by several paths are computed only once
+ */
 class PinnedPathAligner
 {
     const int32_t matchScore_;
@@ -50,11 +74,17 @@ class PinnedPathAligner
     mutable PinnedAligner pinnedAligner_;
 
 public:
-    PinnedPathAligner(int32_t matchScore = 5, int32_t mismatchScore = -4, int32_t gapOpenScore = -8)
+    // Default upper bound on the memory taken by cached path extensions
+    static constexpr size_t kDefaultTrieCacheBytes = 16 * 1024 * 1024;
+
+    PinnedPathAligner(
+        int32_t matchScore = 5, int32_t mismatchScore = -4, int32_t gapOpenScore = -8,
+        size_t trieCacheBytes = kDefaultTrieCacheBytes)
         : matchScore_(matchScore)
         , mismatchScore_(mismatchScore)
         , gapOpenScore_(gapOpenScore)
         , pinnedAligner_(matchScore_, mismatchScore_, gapOpenScore_)
+        , trieCacheBytes_(trieCacheBytes)
     {
     }
     std::list<PathAndAlignment>
@@ -62,64 +92,189 @@ public:
     std::list<PathAndAlignment>
     prefixAlign(const Path& seed_path, const std::string& query_piece, size_t extension_len, int& score) const;
 
+    const PathTrieCacheStats& trieCacheStats() const { return trieCacheStats_; }
+
 private:
-    int32_t scoreAlignment(const Alignment& alignment) const
+    struct TrieKey
     {
-        return graphtools::scoreAlignment(alignment, matchScore_, mismatchScore_, gapOpenScore_);
-    }
+        const Graph* graph;
+        Path seed_path;
+        size_t extension_len;
+        PathExtensionTrie::Direction direction;
+
+        bool operator<(const TrieKey& other) const
+        {
+            if (graph != other.graph)
+            {
+                return std::less<const Graph*>()(graph, other.graph);
+            }
+            return std::tie(seed_path, extension_len, direction)
+                < std::tie(other.seed_path, other.extension_len, other.direction);
+        }
+    };
+
+    typedef std::pair<TrieKey, std::shared_ptr<const PathExtensionTrie>> TrieCacheEntry;
+
+    // Top scoring cell of the prefix alignment matrix of the path spelled by a trie node
+    struct TopCell
+    {
+        int32_t score;
+        size_t row_index;
+        // Trie node whose column contains the cell
+        int32_t node_index;
+    };
+
+    std::list<PathAndAlignment> alignToExtensions(
+        const Path& seed_path, std::string query_piece, size_t extension_len, PathExtensionTrie::Direction direction,
+        int& top_alignment_score) const;
+    std::shared_ptr<const PathExtensionTrie> getTrie(const TrieKey& key) const;
+    void evictLeastRecentlyUsedTrie() const;
+
+    const size_t trieCacheBytes_;
+    mutable std::list<TrieCacheEntry> trieCache_;
+    mutable std::map<TrieKey, std::list<TrieCacheEntry>::iterator> trieCacheIndex_;
+    mutable PathTrieCacheStats trieCacheStats_;
+
+    // Alignment matrix columns of all trie nodes and their top scoring cells, kept to reuse the allocations
+    mutable std::vector<TracebackMatrixCell> columns_;
+    mutable std::vector<TopCell> topCells_;
 };
 
 inline std::list<PathAndAlignment> PinnedPathAligner::suffixAlign(
     const Path& seed_path, const std::string& query_piece, size_t extension_len, int& top_alignment_score) const
+{
+    return alignToExtensions(
+        seed_path, query_piece, extension_len, PathExtensionTrie::Direction::kStart, top_alignment_score);
+}
+
+inline std::list<PathAndAlignment> PinnedPathAligner::prefixAlign(
+    const Path& seed_path, const std::string& query_piece, size_t extension_len, int& top_alignment_score) const
+{
+    return alignToExtensions(
+        seed_path, query_piece, extension_len, PathExtensionTrie::Direction::kEnd, top_alignment_score);
+}
+
+inline std::list<PathAndAlignment> PinnedPathAligner::alignToExtensions(
+    const Path& seed_path, std::string query_piece, size_t extension_len, PathExtensionTrie::Direction direction,
+    int& top_alignment_score) const
 {
     std::list<PathAndAlignment> top_paths_and_alignments;
     top_alignment_score = INT32_MIN;
 
-    const std::list<Path> path_extensions = extendPathStart(seed_path, extension_len);
-    for (const auto& path : path_extensions)
+    const std::shared_ptr<const PathExtensionTrie> trie
+        = getTrie(TrieKey{ seed_path.graphRawPtr(), seed_path, extension_len, direction });
+    const bool is_reversed = direction == PathExtensionTrie::Direction::kStart;
+    if (is_reversed)
+    {
+        std::reverse(query_piece.begin(), query_piece.end());
+    }
+
+    const size_t num_rows = query_piece.length() + 1;
+    pinnedAligner_.populateTrieColumns(*trie, query_piece, columns_);
+
+    // Matches the choice of TracebackMatrix::locateTopScoringCell: top score first, then the bottom row, then the
+    // rightmost column
+    const std::vector<PathExtensionTrie::Node>& nodes = trie->nodes();
+    topCells_.resize(nodes.size());
+    for (size_t node_index = 0; node_index != nodes.size(); ++node_index)
     {
-        Alignment alignment = pinnedAligner_.suffixAlign(path.seq(), query_piece);
-        const int32_t alignment_score = scoreAlignment(alignment);
+        const PathExtensionTrie::Node& node = nodes[node_index];
+        TopCell top_cell = node.parent < 0 ? TopCell{ INT32_MIN, 0, 0 } : topCells_[node.parent];
+        const TracebackMatrixCell* column = &columns_[node_index * num_rows];
+        for (size_t row_index = 0; row_index != num_rows; ++row_index)
+        {
+            if (top_cell.score < column[row_index].score
+                || (top_cell.score == column[row_index].score && top_cell.row_index <= row_index))
+            {
+                top_cell = TopCell{ column[row_index].score, row_index, static_cast<int32_t>(node_index) };
+            }
+        }
+        topCells_[node_index] = top_cell;
+    }
 
-        if (top_alignment_score < alignment_score)
+    // Paths whose top scoring cells lie in the column of the same node share the alignment
+    std::map<int32_t, Alignment> alignments_by_top_node;
+    for (const auto& leaf : trie->leaves())
+    {
+        const TopCell& top_cell = topCells_[leaf.first];
+        if (top_alignment_score < top_cell.score)
         {
             top_paths_and_alignments.clear();
-            top_alignment_score = alignment_score;
+            top_alignment_score = top_cell.score;
         }
 
-        if (top_alignment_score == alignment_score)
+        if (top_alignment_score == top_cell.score)
         {
-            top_paths_and_alignments.push_back(std::make_pair(path, alignment));
+            auto alignment_it = alignments_by_top_node.find(top_cell.node_index);
+            if (alignment_it == alignments_by_top_node.end())
+            {
+                // Traceback never moves right of the top scoring cell, so the columns up to it are sufficient
+                const size_t col_index = nodes[top_cell.node_index].depth;
+                TracebackMatrix matrix(num_rows, col_index + 1);
+                for (int32_t node_index = top_cell.node_index; node_index >= 0; node_index = nodes[node_index].parent)
+                {
+                    const TracebackMatrixCell* column = &columns_[node_index * num_rows];
+                    for (size_t row_index = 0; row_index != num_rows; ++row_index)
+                    {
+                        matrix.setScore(row_index, nodes[node_index].depth, column[row_index].score);
+                        matrix.setTracebackStep(row_index, nodes[node_index].depth, column[row_index].direction);
+                    }
+                }
+
+                TracebackRunner traceback_runner(matrix);
+                Alignment alignment = traceback_runner.runTraceback(top_cell.row_index, col_index);
+                alignment_it = alignments_by_top_node.emplace(top_cell.node_index, std::move(alignment)).first;
+            }
+
+            Alignment alignment = alignment_it->second;
+            if (is_reversed)
+            {
+                alignment.reverse(nodes[leaf.first].depth);
+            }
+            top_paths_and_alignments.push_back(std::make_pair(leaf.second, alignment));
         }
     }
 
     return top_paths_and_alignments;
 }
 
-inline std::list<PathAndAlignment> PinnedPathAligner::prefixAlign(
-    const Path& seed_path, const std::string& query_piece, size_t extension_len, int& top_alignment_score) const
+inline std::shared_ptr<const PathExtensionTrie> PinnedPathAligner::getTrie(const TrieKey& key) const
 {
-    std::list<PathAndAlignment> top_paths_and_alignments;
-    top_alignment_score = INT32_MIN;
-
-    const std::list<Path> path_extensions = extendPathEnd(seed_path, extension_len);
-    for (const auto& path : path_extensions)
+    const auto cached = trieCacheIndex_.find(key);
+    if (trieCacheIndex_.end() != cached)
     {
-        Alignment alignment = pinnedAligner_.prefixAlign(path.seq(), query_piece);
-        const int32_t alignment_score = scoreAlignment(alignment);
-
-        if (top_alignment_score < alignment_score)
-        {
-            top_paths_and_alignments.clear();
-            top_alignment_score = alignment_score;
-        }
+        ++trieCacheStats_.hits;
+        // most recently used entries are kept at the front
+        trieCache_.splice(trieCache_.begin(), trieCache_, cached->second);
+        return cached->second->second;
+    }
 
-        if (top_alignment_score == alignment_score)
+    ++trieCacheStats_.misses;
+    std::shared_ptr<const PathExtensionTrie> trie = std::make_shared<PathExtensionTrie>(
+        key.seed_path, static_cast<int32_t>(key.extension_len), key.direction);
+    const size_t trie_bytes = trie->numBytes();
+    if (trie_bytes <= trieCacheBytes_)
+    {
+        while (trieCacheStats_.bytes + trie_bytes > trieCacheBytes_)
         {
-            top_paths_and_alignments.push_back(std::make_pair(path, alignment));
+            evictLeastRecentlyUsedTrie();
         }
+        trieCache_.emplace_front(key, trie);
+        trieCacheIndex_.emplace(key, trieCache_.begin());
+        trieCacheStats_.bytes += trie_bytes;
+        trieCacheStats_.entries = trieCache_.size();
     }
 
-    return top_paths_and_alignments;
+    return trie;
+}
+
+inline void PinnedPathAligner::evictLeastRecentlyUsedTrie() const
+{
+    const TrieCacheEntry& entry = trieCache_.back();
+    trieCacheStats_.bytes -= entry.second->numBytes();
+    trieCacheIndex_.erase(entry.first);
+    trieCache_.pop_back();
+    trieCacheStats_.entries = trieCache_.size();
+    ++trieCacheStats_.evictions;
 }
 }
@@ -0,0 +1,347 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Roman Petrovski <RPetrovski@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "Details.hh"
+#include "ScoreKernels.hh"
+
+namespace graphalign
+{
+
+namespace dagAligner
+{
+
+    /**
+     * \brief Same as AffineAlignMatrixVectorized, but only fills the cells reachable by alignments that never get more
+     *        than bandWidth gaps ahead of or behind the target path they follow. The band of each target row is
+     *        derived from the shortest and the longest paths leading to it, so that it follows all branches and
+     *        unrolled repeat copies of the target graph.
+     *
+     *        Cells outside the band keep a low score that cannot wrap around when penalties are added to it. As any
+     *        alignment that leaves the band has more than bandWidth gap positions, none of them can score above
+     *        outOfBandScoreBound(). If the best alignment in the band scores higher, the banded matrix has the same
+     *        best alignments as the full one.
+     */
+    template <typename PenaltyMatrixT, bool penalizeMove, int step = 16> class AffineAlignMatrixBanded
+    {
+        // free moves make alignments start anywhere in the target, which leaves no band to follow
+        static_assert(penalizeMove, "Banded alignment requires penalized moves");
+
+    public:
+        typedef PenaltyMatrixT PenaltyMatrix;
+
+    private:
+        // low enough to never win, high enough for penalties not to wrap it around
+        static Score outOfBandScore() { return SCORE_MIN / 2; }
+
+        const PenaltyMatrix penaltyMatrix_;
+        const Score gapOpen_;
+        const Score gapExt_;
+
+        PaddedAlignMatrix<step> v_;
+        PaddedAlignMatrix<step> g_;
+        PaddedAlignMatrix<step> f_;
+        PaddedAlignMatrix<step> e_;
+
+        std::vector<typename PenaltyMatrix::QueryChar> query_;
+        std::vector<typename PenaltyMatrix::TargetChar> target_;
+        std::vector<Score> alignmentPenalties_[PenaltyMatrix::TARGET_CHAR_MAX_ + 1];
+
+        // [bandBegin_[t], bandEnd_[t]) query offsets filled in row t, rounded to whole steps
+        std::vector<int> bandBegin_;
+        std::vector<int> bandEnd_;
+        // [readBegin_[t], readEnd_[t]) query offsets of row t read while filling the band of row t and its successors
+        std::vector<int> readBegin_;
+        std::vector<int> readEnd_;
+        int outOfBandScoreBound_ = 0;
+
+    public:
+        AffineAlignMatrixBanded(const PenaltyMatrix& penaltyMatrix, Score gapOpen, Score gapExt)
+            : penaltyMatrix_(penaltyMatrix)
+            , gapOpen_(gapOpen)
+            , gapExt_(gapExt)
+        {
+        }
+
+        template <typename QueryIt, typename TargetIt>
+        void init(
+            QueryIt queryBegin, QueryIt queryEnd, TargetIt targetBegin, TargetIt targetEnd, const EdgeMap& edgeMap,
+            int bandWidth)
+        {
+            if (queryEnd == queryBegin)
+            {
+                throw std::logic_error("Empty query is not allowed.");
+            }
+
+            if (targetEnd == targetBegin)
+            {
+                throw std::logic_error("Empty target is not allowed.");
+            }
+
+            if (0 > bandWidth)
+            {
+                throw std::logic_error("Negative band width is not allowed: " + std::to_string(bandWidth));
+            }
+
+            // avoid "uninitialized read" complaints from valgrind
+            query_.resize((std::distance(queryBegin, queryEnd) + step - 1) / step * step);
+            query_.clear();
+            penaltyMatrix_.translateQuery(queryBegin, queryEnd, std::back_inserter(query_));
+            target_.clear();
+            penaltyMatrix_.translateTarget(targetBegin, targetEnd, std::back_inserter(target_));
+
+            reset(edgeMap);
+            computeBand(edgeMap, bandWidth);
+
+            fill(edgeMap);
+        }
+
+        /**
+         * \return score that no alignment leaving the band can exceed
+         */
+        int outOfBandScoreBound() const { return outOfBandScoreBound_; }
+
+        typedef AlignMatrix::const_iterator const_iterator;
+        template <bool localAlign> const_iterator nextBestAlign(const_iterator start, Score& bestScore) const
+        {
+            // only the last column is initialized outside of the band
+            static_assert(!localAlign, "Banded alignment cannot be local");
+            return v_.nextBestAlign(start, queryLen() - 1, bestScore);
+        }
+        const_iterator alignBegin() const { return v_.cellOneOne(); }
+        const_iterator alignEnd() const { return v_.end(); }
+        int targetOffset(const_iterator cell) const { return std::distance(v_.cellOneOne(), cell) / v_.paddedRowLen(); }
+        int queryOffset(const_iterator cell) const { return std::distance(v_.cellOneOne(), cell) % v_.paddedRowLen(); }
+        int queryLen() const { return query_.size(); }
+
+        bool isInsertion(int q, int t) const
+        {
+            const Score insExtScore = v_.at(q, t) - f_.at(q - 1, t);
+            const Score insOpenScore = v_.at(q, t) - v_.at(q - 1, t);
+            return gapExt_ == insExtScore || gapOpen_ + gapExt_ == insOpenScore;
+        }
+
+        bool isDeletion(int q, int t, int p) const
+        {
+            const Score delExtScore = v_.at(q, t) - e_.at(q, p);
+            const Score delOpenScore = v_.at(q, t) - v_.at(q, p);
+            return gapExt_ == delExtScore || gapOpen_ + gapExt_ == delOpenScore;
+        }
+
+        bool isMatch(int q, int t, int p) const
+        {
+            typename PenaltyMatrix::QueryChar queryChar = query_[q];
+            typename PenaltyMatrix::TargetChar targetChar = target_[t];
+            const Score alnScore = v_.at(q, t) - v_.at(q - 1, p);
+            return penaltyMatrix_.isMatch(queryChar, targetChar) && penaltyMatrix_(queryChar, targetChar) == alnScore;
+        }
+
+        bool isMismatch(int q, int t, int p) const
+        {
+            typename PenaltyMatrix::QueryChar queryChar = query_[q];
+            typename PenaltyMatrix::TargetChar targetChar = target_[t];
+            const Score alnScore = v_.at(q, t) - v_.at(q - 1, p);
+            return !penaltyMatrix_.isMatch(queryChar, targetChar) && penaltyMatrix_(queryChar, targetChar) == alnScore;
+        }
+
+    private:
+        void reset(const EdgeMap& edgeMap)
+        {
+            const int qLen = query_.size();
+            const int tLen = target_.size();
+
+            for (typename PenaltyMatrix::TargetChar tc = 0; tc <= PenaltyMatrix::TARGET_CHAR_MAX_; ++tc)
+            {
+                alignmentPenalties_[tc].resize((qLen + step - 1) / step * step, 0);
+                for (int q = 0; q < qLen; ++q)
+                {
+                    alignmentPenalties_[tc][q] = penaltyMatrix_(query_[q], tc);
+                }
+            }
+
+            // cells of the target rows are initialized just before the rows get filled, only as far as they are read
+            for (PaddedAlignMatrix<step>* matrix : { &v_, &g_, &f_, &e_ })
+            {
+                matrix->resize(qLen, tLen);
+                std::fill_n(matrix->row(0, -1), matrix->paddedRowLen() - 1, SCORE_MIN);
+                for (int t = 0; t < tLen; ++t)
+                {
+                    matrix->at(-1, t) = SCORE_MIN;
+                }
+            }
+
+            // first column penalises for deletion
+            for (int t = 0; t < tLen; ++t)
+            {
+                for (EdgeMap::OffsetEdges::const_iterator prevNodeIndexIt = edgeMap.prevNodesBegin(t);
+                     prevNodeIndexIt != edgeMap.prevNodesEnd(t); ++prevNodeIndexIt)
+                {
+                    const int p = *prevNodeIndexIt;
+                    v_.at(-1, t) = std::max(v_.at(-1, t), Score(v_.at(-1, p) + gapOpen_ + gapExt_));
+                    f_.at(-1, t) = std::max(v_.at(-1, t), Score(f_.at(-1, p) + gapOpen_ + gapExt_));
+                }
+            }
+
+            // first row penalizes for insertion
+            for (int q = 0; q < queryLen(); ++q)
+            {
+                v_.at(q, -1) = v_.at(q - 1, -1) + gapOpen_ + gapExt_;
+                e_.at(q, -1) = e_.at(q - 1, -1) + gapOpen_ + gapExt_;
+            }
+        }
+
+        void computeBand(const EdgeMap& edgeMap, int bandWidth)
+        {
+            const int qLen = query_.size();
+            const int tLen = target_.size();
+
+            // number of target characters on the shortest and the longest paths ending at t
+            std::vector<int> shortestPath(tLen);
+            std::vector<int> longestPath(tLen);
+            bandBegin_.resize(tLen);
+            bandEnd_.resize(tLen);
+            readBegin_.resize(tLen);
+            readEnd_.resize(tLen);
+            for (int t = 0; t < tLen; ++t)
+            {
+                shortestPath[t] = tLen;
+                longestPath[t] = 0;
+                for (EdgeMap::OffsetEdges::const_iterator prevNodeIndexIt = edgeMap.prevNodesBegin(t);
+                     prevNodeIndexIt != edgeMap.prevNodesEnd(t); ++prevNodeIndexIt)
+                {
+                    const int p = *prevNodeIndexIt;
+                    shortestPath[t] = std::min(shortestPath[t], -1 == p ? 1 : shortestPath[p] + 1);
+                    longestPath[t] = std::max(longestPath[t], -1 == p ? 1 : longestPath[p] + 1);
+                }
+
+                // cell (q, t) of a path of length d is q + 1 - d gaps ahead of it
+                const int first = std::max(0, shortestPath[t] - 1 - bandWidth);
+                const int last = std::min(qLen - 1, longestPath[t] - 1 + bandWidth);
+                bandBegin_[t] = first <= last ? first / step * step : 0;
+                bandEnd_[t] = first <= last ? (last + step) / step * step : 0;
+
+                // insertions read the cell preceding the band
+                readBegin_[t] = std::max(0, bandBegin_[t] - 1);
+                readEnd_[t] = bandEnd_[t];
+                for (EdgeMap::OffsetEdges::const_iterator prevNodeIndexIt = edgeMap.prevNodesBegin(t);
+                     prevNodeIndexIt != edgeMap.prevNodesEnd(t); ++prevNodeIndexIt)
+                {
+                    // successors read the diagonal cells preceding their band
+                    const int p = *prevNodeIndexIt;
+                    if (-1 != p && bandEnd_[t] != bandBegin_[t])
+                    {
+                        readBegin_[p] = std::min(readBegin_[p], std::max(0, bandBegin_[t] - 1));
+                        readEnd_[p] = std::max(readEnd_[p], bandEnd_[t]);
+                    }
+                }
+            }
+
+            // alignments leaving the band have at least bandWidth + 1 gap positions and can align all query bases
+            // at best
+            int bestPenalties = 0;
+            for (int q = 0; q < qLen; ++q)
+            {
+                Score best = 0;
+                for (typename PenaltyMatrix::TargetChar tc = 0; tc <= PenaltyMatrix::TARGET_CHAR_MAX_; ++tc)
+                {
+                    best = std::max(best, alignmentPenalties_[tc][q]);
+                }
+                bestPenalties += best;
+            }
+            outOfBandScoreBound_ = bestPenalties + gapOpen_ + (bandWidth + 1) * gapExt_;
+        }
+
+        void resetRow(int t)
+        {
+            const int qLen = query_.size();
+            const int readLen = readEnd_[t] - readBegin_[t];
+            if (readLen)
+            {
+                std::fill_n(v_.row(readBegin_[t], t), readLen, outOfBandScore());
+                std::fill_n(f_.row(readBegin_[t], t), readLen, outOfBandScore());
+                std::fill_n(e_.row(readBegin_[t], t), readLen, outOfBandScore());
+            }
+            std::fill_n(g_.row(bandBegin_[t], t), bandEnd_[t] - bandBegin_[t], SCORE_MIN);
+
+            // best alignments are searched for in the last column of all rows
+            if (readEnd_[t] < qLen)
+            {
+                v_.at(qLen - 1, t) = outOfBandScore();
+            }
+        }
+
+        void fill(const EdgeMap& edgeMap)
+        {
+            const int qLen = query_.size();
+            const int tLen = target_.size();
+            const ScoreKernels& kernels = activeScoreKernels();
+
+            for (int t = 0; t < tLen; ++t)
+            {
+                resetRow(t);
+
+                // rows are processed in whole steps, the padding is never used by backtracking
+                const int begin = bandBegin_[t];
+                const int len = bandEnd_[t] - begin;
+                if (!len)
+                {
+                    continue;
+                }
+
+                const typename PenaltyMatrix::TargetChar tc = target_[t];
+                const Score* const penalties = &alignmentPenalties_[tc].front() + begin;
+                for (EdgeMap::OffsetEdges::const_iterator prevNodeIndexIt = edgeMap.prevNodesBegin(t);
+                     edgeMap.prevNodesEnd(t) != prevNodeIndexIt; ++prevNodeIndexIt)
+                {
+                    const int p = *prevNodeIndexIt;
+                    kernels.deletionAndAlign(
+                        v_.row(begin, p), e_.row(begin, p), v_.row(begin - 1, p), penalties, e_.row(begin, t),
+                        g_.row(begin, t), len, gapOpen_, gapExt_);
+                }
+
+                kernels.consolidate(e_.row(begin, t), g_.row(begin, t), v_.row(begin, t), len);
+                kernels.insertion(
+                    f_.row(begin, t), v_.row(begin, t), std::min(qLen, bandEnd_[t]) - begin, gapOpen_, gapExt_);
+            }
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const AffineAlignMatrixBanded& matrix)
+        {
+            return os << "AffineAlignMatrixBanded(" << matrix.v_ << ")";
+        }
+    };
+
+} // namespace dagAligner
+
+} // namespace graphalign
@@ -0,0 +1,474 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Roman Petrovski <RPetrovski@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Details.hh"
+#include "ScoreKernels.hh"
+
+namespace graphalign
+{
+
+namespace dagAligner
+{
+
+    /**
+     * \brief Arithmetic and row kernels for the cell type of the batch matrices
+     */
+    template <typename ScoreT> struct BatchScoreTraits;
+
+    template <> struct BatchScoreTraits<Score>
+    {
+        // 16-bit cells do not saturate for the queries seen in practice, so their maximum is not tracked
+        static const bool tracksMaxScore = false;
+
+        // wraps around the same way as the single query matrices
+        static Score fromInt(int score) { return Score(score); }
+
+        static void deletionAndAlign(
+            const ScoreKernels& kernels, const Score* vp, const Score* ep, const Score* vDiag, const Score* penalties,
+            Score* e, Score* g, int len, Score gapOpen, Score gapExt)
+        {
+            kernels.deletionAndAlign(vp, ep, vDiag, penalties, e, g, len, gapOpen, gapExt);
+        }
+
+        static void consolidate(const ScoreKernels& kernels, const Score* e, const Score* g, Score* v, int len)
+        {
+            kernels.consolidate(e, g, v, len);
+        }
+
+        static void insertionAcrossLanes(
+            const ScoreKernels& kernels, Score* f, Score* v, int len, int lanes, Score gapOpen, Score gapExt)
+        {
+            kernels.insertionAcrossLanes(f, v, len, lanes, gapOpen, gapExt);
+        }
+    };
+
+    template <> struct BatchScoreTraits<NarrowScore>
+    {
+        // 8-bit cells saturate after a few dozen matches, so callers need the highest score to detect it
+        static const bool tracksMaxScore = true;
+
+        static NarrowScore fromInt(int score)
+        {
+            return NarrowScore(std::max<int>(NARROW_SCORE_MIN, std::min<int>(NARROW_SCORE_MAX, score)));
+        }
+
+        static void deletionAndAlign(
+            const ScoreKernels& kernels, const NarrowScore* vp, const NarrowScore* ep, const NarrowScore* vDiag,
+            const NarrowScore* penalties, NarrowScore* e, NarrowScore* g, int len, NarrowScore gapOpen,
+            NarrowScore gapExt)
+        {
+            kernels.narrowDeletionAndAlign(vp, ep, vDiag, penalties, e, g, len, gapOpen, gapExt);
+        }
+
+        static void
+        consolidate(const ScoreKernels& kernels, const NarrowScore* e, const NarrowScore* g, NarrowScore* v, int len)
+        {
+            kernels.narrowConsolidate(e, g, v, len);
+        }
+
+        static void insertionAcrossLanes(
+            const ScoreKernels& kernels, NarrowScore* f, NarrowScore* v, int len, int lanes, NarrowScore gapOpen,
+            NarrowScore gapExt)
+        {
+            kernels.narrowInsertionAcrossLanes(f, v, len, lanes, gapOpen, gapExt);
+        }
+    };
+
+    /**
+     * \brief The 2-d tables of scores filled during the simultaneous alignment of up to lanes queries against the same
+     *        target. Cells of all queries that have the same query and target offsets are stored next to each other,
+     *        so that each vector lane of the row kernels processes a different query.
+     * \param ScoreT Score or NarrowScore. NarrowScore cells saturate at NARROW_SCORE_MIN and NARROW_SCORE_MAX, so it is
+     *               up to the caller to check with maxCellScore that no cell reached NARROW_SCORE_MAX and that the
+     *               best scores stayed clear of NARROW_SCORE_MIN
+     */
+    template <typename PenaltyMatrixT, bool penalizeMove, int lanes = 16, typename ScoreT = Score>
+    class AffineAlignMatrixBatch
+    {
+    public:
+        typedef PenaltyMatrixT PenaltyMatrix;
+        static const int LANES = lanes;
+
+    private:
+        const PenaltyMatrix penaltyMatrix_;
+        const Score gapOpen_;
+        const Score gapExt_;
+
+        int numQueries_;
+        // shorter queries leave their remaining cells unused
+        int maxQueryLen_;
+
+        std::vector<ScoreT> v_;
+        std::vector<ScoreT> f_;
+        std::vector<ScoreT> e_;
+        // backtracking does not need alignment scores, so, only the row being filled is kept
+        std::vector<ScoreT> g_;
+        // highest v score of each query offset over all rows, when tracked for ScoreT
+        std::vector<ScoreT> maxScores_;
+
+        std::vector<typename PenaltyMatrix::QueryChar> queries_[lanes];
+        std::vector<typename PenaltyMatrix::TargetChar> target_;
+        std::vector<ScoreT> alignmentPenalties_[PenaltyMatrix::TARGET_CHAR_MAX_ + 1];
+
+        typedef BatchScoreTraits<ScoreT> Traits;
+        static ScoreT cellMin() { return std::numeric_limits<ScoreT>::min(); }
+
+        int cellIndex(int q, int t) const { return ((t + 1) * (maxQueryLen_ + 1) + q + 1) * lanes; }
+
+    public:
+        AffineAlignMatrixBatch(const PenaltyMatrix& penaltyMatrix, Score gapOpen, Score gapExt)
+            : penaltyMatrix_(penaltyMatrix)
+            , gapOpen_(gapOpen)
+            , gapExt_(gapExt)
+            , numQueries_(0)
+            , maxQueryLen_(0)
+        {
+        }
+
+        /**
+         * \param queriesBegin  first of the query sequences, each providing begin() and end()
+         */
+        template <typename QueriesIt, typename TargetIt>
+        void init(
+            QueriesIt queriesBegin, QueriesIt queriesEnd, TargetIt targetBegin, TargetIt targetEnd,
+            const EdgeMap& edgeMap)
+        {
+            const int numQueries = std::distance(queriesBegin, queriesEnd);
+            if (!numQueries || lanes < numQueries)
+            {
+                throw std::logic_error(
+                    "Batch must contain between 1 and " + std::to_string(lanes) + " queries, got "
+                    + std::to_string(numQueries));
+            }
+
+            if (targetEnd == targetBegin)
+            {
+                throw std::logic_error("Empty target is not allowed.");
+            }
+
+            numQueries_ = numQueries;
+            maxQueryLen_ = 0;
+            int lane = 0;
+            for (QueriesIt query = queriesBegin; queriesEnd != query; ++query, ++lane)
+            {
+                if (query->end() == query->begin())
+                {
+                    throw std::logic_error("Empty query is not allowed.");
+                }
+                queries_[lane].clear();
+                penaltyMatrix_.translateQuery(query->begin(), query->end(), std::back_inserter(queries_[lane]));
+                maxQueryLen_ = std::max<int>(maxQueryLen_, queries_[lane].size());
+            }
+            for (; lanes != lane; ++lane)
+            {
+                queries_[lane].clear();
+            }
+            target_.clear();
+            penaltyMatrix_.translateTarget(targetBegin, targetEnd, std::back_inserter(target_));
+
+            reset();
+
+            fill(edgeMap);
+        }
+
+        int numQueries() const { return numQueries_; }
+
+        /**
+         * \return highest score of the cells of the query; only available for cell types that track it
+         */
+        Score maxCellScore(int query) const
+        {
+            if (!Traits::tracksMaxScore || numQueries_ <= query)
+            {
+                throw std::logic_error("Max score of query " + std::to_string(query) + " is not tracked");
+            }
+            Score ret = cellMin();
+            for (std::size_t q = 0; q != queries_[query].size(); ++q)
+            {
+                ret = std::max<Score>(ret, maxScores_[q * lanes + query]);
+            }
+            return ret;
+        }
+
+        /**
+         * \brief View of the matrices of a single query that can be backtracked like a single query matrix
+         */
+        class Lane
+        {
+            const AffineAlignMatrixBatch& batch_;
+            const int lane_;
+            // + 1 for gap column
+            const int rowLen_;
+
+            Score at(const std::vector<ScoreT>& matrix, int q, int t) const
+            {
+                return matrix[batch_.cellIndex(q, t) + lane_];
+            }
+            Score cell(int c) const { return at(batch_.v_, c % rowLen_ - 1, c / rowLen_ - 1); }
+            int targetLen() const { return batch_.target_.size(); }
+
+        public:
+            typedef typename AffineAlignMatrixBatch::PenaltyMatrix PenaltyMatrix;
+
+            Lane(const AffineAlignMatrixBatch& batch, int lane)
+                : batch_(batch)
+                , lane_(lane)
+                , rowLen_(batch.queries_[lane].size() + 1)
+            {
+            }
+
+            // cells are numbered row by row, including the gap row and the gap column
+            typedef int const_iterator;
+            template <bool localAlign> const_iterator nextBestAlign(const_iterator start, Score& bestScore) const
+            {
+                if (!localAlign)
+                {
+                    // first row that has the last query cell at or after start
+                    const int q = queryLen() - 1;
+                    int t = std::max(0, start / rowLen_ - 1);
+                    if (targetLen() <= t)
+                    {
+                        return alignEnd();
+                    }
+                    bestScore = at(batch_.v_, q, t);
+                    int bestT = t;
+                    for (++t; targetLen() != t; ++t)
+                    {
+                        if (bestScore < at(batch_.v_, q, t))
+                        {
+                            bestScore = at(batch_.v_, q, t);
+                            bestT = t;
+                        }
+                    }
+                    return (bestT + 1) * rowLen_ + q + 1;
+                }
+
+                const_iterator it = start;
+                if (alignEnd() == it)
+                {
+                    return alignEnd();
+                }
+                if (!(it % rowLen_))
+                {
+                    ++it;
+                }
+                const_iterator ret = it;
+                bestScore = cell(it++);
+                while (alignEnd() != it)
+                {
+                    if (!(it % rowLen_))
+                    {
+                        ++it;
+                    }
+                    if (bestScore < cell(it))
+                    {
+                        bestScore = cell(it);
+                        ret = it;
+                    }
+                    ++it;
+                }
+                return ret;
+            }
+            const_iterator alignBegin() const { return rowLen_ + 1; }
+            const_iterator alignEnd() const { return (targetLen() + 1) * rowLen_; }
+            int targetOffset(const_iterator cell) const { return cell / rowLen_ - 1; }
+            int queryOffset(const_iterator cell) const { return cell % rowLen_ - 1; }
+            int queryLen() const { return rowLen_ - 1; }
+
+            bool isInsertion(int q, int t) const
+            {
+                const Score insExtScore = at(batch_.v_, q, t) - at(batch_.f_, q - 1, t);
+                const Score insOpenScore = at(batch_.v_, q, t) - at(batch_.v_, q - 1, t);
+                return batch_.gapExt_ == insExtScore || batch_.gapOpen_ + batch_.gapExt_ == insOpenScore;
+            }
+
+            bool isDeletion(int q, int t, int p) const
+            {
+                const Score delExtScore = at(batch_.v_, q, t) - at(batch_.e_, q, p);
+                const Score delOpenScore = at(batch_.v_, q, t) - at(batch_.v_, q, p);
+                return batch_.gapExt_ == delExtScore || batch_.gapOpen_ + batch_.gapExt_ == delOpenScore;
+            }
+
+            bool isMatch(int q, int t, int p) const
+            {
+                typename PenaltyMatrix::QueryChar queryChar = batch_.queries_[lane_][q];
+                typename PenaltyMatrix::TargetChar targetChar = batch_.target_[t];
+                const Score alnScore = at(batch_.v_, q, t) - at(batch_.v_, q - 1, p);
+                return batch_.penaltyMatrix_.isMatch(queryChar, targetChar)
+                    && batch_.penaltyMatrix_(queryChar, targetChar) == alnScore;
+            }
+
+            bool isMismatch(int q, int t, int p) const
+            {
+                typename PenaltyMatrix::QueryChar queryChar = batch_.queries_[lane_][q];
+                typename PenaltyMatrix::TargetChar targetChar = batch_.target_[t];
+                const Score alnScore = at(batch_.v_, q, t) - at(batch_.v_, q - 1, p);
+                return !batch_.penaltyMatrix_.isMatch(queryChar, targetChar)
+                    && batch_.penaltyMatrix_(queryChar, targetChar) == alnScore;
+            }
+        };
+
+        Lane lane(int query) const
+        {
+            if (numQueries_ <= query)
+            {
+                throw std::logic_error(
+                    "Query " + std::to_string(query) + " is not in the batch of " + std::to_string(numQueries_));
+            }
+            return Lane(*this, query);
+        }
+
+    private:
+        void reset()
+        {
+            const int tLen = target_.size();
+
+            for (typename PenaltyMatrix::TargetChar tc = 0; tc <= PenaltyMatrix::TARGET_CHAR_MAX_; ++tc)
+            {
+                std::vector<ScoreT>& penalties = alignmentPenalties_[tc];
+                penalties.assign(maxQueryLen_ * lanes, 0);
+                for (int lane = 0; lane != numQueries_; ++lane)
+                {
+                    for (std::size_t q = 0; q != queries_[lane].size(); ++q)
+                    {
+                        penalties[q * lanes + lane] = Traits::fromInt(penaltyMatrix_(queries_[lane][q], tc));
+                    }
+                }
+            }
+
+            // rows are initialized just before they get filled, while they are still in cache
+            const std::size_t cells = std::size_t(tLen + 1) * (maxQueryLen_ + 1) * lanes;
+            g_.resize(maxQueryLen_ * lanes);
+            if (Traits::tracksMaxScore)
+            {
+                maxScores_.assign(maxQueryLen_ * lanes, cellMin());
+            }
+            for (std::vector<ScoreT>* matrix : { &v_, &f_, &e_ })
+            {
+                matrix->resize(cells);
+                std::fill_n(matrix->begin(), (maxQueryLen_ + 1) * lanes, cellMin());
+                // top left must be 0 and never change
+                std::fill_n(matrix->begin(), lanes, 0);
+            }
+
+            // first row penalizes for insertion
+            for (int q = 0; q < maxQueryLen_; ++q)
+            {
+                const ScoreT vScore = Traits::fromInt(v_[cellIndex(q - 1, -1)] + gapOpen_ + gapExt_);
+                std::fill_n(v_.begin() + cellIndex(q, -1), lanes, vScore);
+                const ScoreT eScore = Traits::fromInt(e_[cellIndex(q - 1, -1)] + gapOpen_ + gapExt_);
+                std::fill_n(e_.begin() + cellIndex(q, -1), lanes, eScore);
+            }
+        }
+
+        void resetRow(int t, const EdgeMap& edgeMap)
+        {
+            for (std::vector<ScoreT>* matrix : { &v_, &f_, &e_ })
+            {
+                std::fill_n(matrix->begin() + cellIndex(-1, t), (maxQueryLen_ + 1) * lanes, cellMin());
+            }
+            std::fill(g_.begin(), g_.end(), cellMin());
+
+            // first column penalises for deletion. Same for all queries
+            ScoreT vFirst = cellMin();
+            ScoreT fFirst = cellMin();
+            if (penalizeMove)
+            {
+                for (EdgeMap::OffsetEdges::const_iterator prevNodeIndexIt = edgeMap.prevNodesBegin(t);
+                     prevNodeIndexIt != edgeMap.prevNodesEnd(t); ++prevNodeIndexIt)
+                {
+                    const int p = *prevNodeIndexIt;
+                    vFirst = std::max(vFirst, Traits::fromInt(v_[cellIndex(-1, p)] + gapOpen_ + gapExt_));
+                    fFirst = std::max(vFirst, Traits::fromInt(f_[cellIndex(-1, p)] + gapOpen_ + gapExt_));
+                }
+            }
+            else
+            {
+                vFirst = 0;
+                fFirst = 0;
+            }
+            std::fill_n(v_.begin() + cellIndex(-1, t), lanes, vFirst);
+            std::fill_n(f_.begin() + cellIndex(-1, t), lanes, fFirst);
+        }
+
+        void fill(const EdgeMap& edgeMap)
+        {
+            const int tLen = target_.size();
+            const int rowLen = maxQueryLen_ * lanes;
+            const ScoreKernels& kernels = activeScoreKernels();
+            const ScoreT gapOpen = Traits::fromInt(gapOpen_);
+            const ScoreT gapExt = Traits::fromInt(gapExt_);
+
+            for (int t = 0; t < tLen; ++t)
+            {
+                resetRow(t, edgeMap);
+
+                const ScoreT* const penalties = &alignmentPenalties_[target_[t]].front();
+                for (EdgeMap::OffsetEdges::const_iterator prevNodeIndexIt = edgeMap.prevNodesBegin(t);
+                     edgeMap.prevNodesEnd(t) != prevNodeIndexIt; ++prevNodeIndexIt)
+                {
+                    const int p = *prevNodeIndexIt;
+                    Traits::deletionAndAlign(
+                        kernels, &v_[cellIndex(0, p)], &e_[cellIndex(0, p)], &v_[cellIndex(-1, p)], penalties,
+                        &e_[cellIndex(0, t)], &g_.front(), rowLen, gapOpen, gapExt);
+                }
+
+                Traits::consolidate(kernels, &e_[cellIndex(0, t)], &g_.front(), &v_[cellIndex(0, t)], rowLen);
+                Traits::insertionAcrossLanes(
+                    kernels, &f_[cellIndex(0, t)], &v_[cellIndex(0, t)], maxQueryLen_, lanes, gapOpen, gapExt);
+
+                if (Traits::tracksMaxScore)
+                {
+                    // v is the maximum of e, f and g, so its cells cover all three matrices
+                    const ScoreT* const v = &v_[cellIndex(0, t)];
+                    for (int i = 0; i != rowLen; ++i)
+                    {
+                        maxScores_[i] = std::max(maxScores_[i], v[i]);
+                    }
+                }
+            }
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const AffineAlignMatrixBatch& matrix)
+        {
+            return os << "AffineAlignMatrixBatch(queries:" << matrix.numQueries_ << ",rows:" << matrix.target_.size()
+                      << ",columns:" << matrix.maxQueryLen_ << ")";
+        }
+    };
+
+} // namespace dagAligner
+
+} // namespace graphalign
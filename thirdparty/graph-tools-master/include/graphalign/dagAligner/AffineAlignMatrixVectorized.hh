@@ -32,6 +32,7 @@
 #include <iostream>
 
 #include "Details.hh"
+#include "ScoreKernels.hh"
 
 namespace graphalign
 {
@@ -207,6 +208,9 @@ namespace dagAligner
         {
             const int qLen = query_.size();
             const int tLen = target_.size();
+            // rows are processed in whole steps, the padding is never used by backtracking
+            const int paddedQLen = (qLen + step - 1) / step * step;
+            const ScoreKernels& kernels = activeScoreKernels();
 
             for (int t = 0; t < tLen; ++t)
             {
@@ -216,18 +220,13 @@ namespace dagAligner
                      edgeMap.prevNodesEnd(t) != prevNodeIndexIt; ++prevNodeIndexIt)
                 {
                     const int p = *prevNodeIndexIt;
-                    for (int q = 0; q < qLen; q += step)
-                    {
-                        recomputeForDeletion(q, t, p);
-                        recomputeForAlign(q, t, p, penalties + q);
-                    }
+                    kernels.deletionAndAlign(
+                        v_.row(0, p), e_.row(0, p), v_.row(-1, p), penalties, e_.row(0, t), g_.row(0, t), paddedQLen,
+                        gapOpen_, gapExt_);
                 }
 
-                for (int q = 0; q < qLen; q += step)
-                {
-                    consolidate(q, t);
-                }
-                recomputeForInsertion(qLen, t);
+                kernels.consolidate(e_.row(0, t), g_.row(0, t), v_.row(0, t), paddedQLen);
+                kernels.insertion(f_.row(0, t), v_.row(0, t), qLen, gapOpen_, gapExt_);
             }
         }
 
@@ -241,87 +240,6 @@ namespace dagAligner
             }
         }
 
-        // __attribute((noinline))
-        void recomputeForAlign(int q, int t, int p, const Score penalties[step])
-        {
-            Score tmp[step];
-            Score* v = v_.row(q - 1, p);
-            for (int i = 0; i < step; ++i)
-            {
-                tmp[i] = v[i] + penalties[i];
-            }
-
-            Score* g = g_.row(q, t);
-            for (int i = 0; i < step; ++i)
-            {
-                g[i] = g[i] > tmp[i] ? g[i] : tmp[i];
-            }
-        }
-
-        // __attribute((noinline))
-        void recomputeForDeletion(int q, int t, int p)
-        {
-            Score* ep = e_.row(q, p);
-            Score tmpEp[step];
-            for (int i = 0; i < step; ++i)
-            {
-                tmpEp[i] = ep[i] + gapExt_;
-            }
-
-            Score* vp = v_.row(q, p);
-            Score tmpVp[step];
-            for (int i = 0; i < step; ++i)
-            {
-                tmpVp[i] = vp[i] + gapOpen_ + gapExt_;
-            }
-
-            Score tmp[step];
-            for (int i = 0; i < step; ++i)
-            {
-                tmp[i] = tmpEp[i] > tmpVp[i] ? tmpEp[i] : tmpVp[i];
-            }
-
-            Score* e = e_.row(q, t);
-            for (int i = 0; i < step; ++i)
-            {
-                e[i] = e[i] > tmp[i] ? e[i] : tmp[i];
-            }
-        }
-
-        // __attribute((noinline))
-        void recomputeForInsertion(int qLen, int t)
-        {
-            Score* v = v_.row(0, t);
-            Score* f = f_.row(0, t);
-            Score* fp = f_.row(-1, t);
-            Score* vp = v_.row(-1, t);
-
-            // cannot be vectorized since insertion is computed horisontally
-            for (int i = 0; i < qLen; ++i)
-            {
-                f[i] = std::max<Score>(f[i], std::max<Score>((fp[i] + gapExt_), (vp[i] + gapOpen_ + gapExt_)));
-                v[i] = std::max(v[i], f[i]);
-            }
-        }
-
-        // __attribute((noinline))
-        void consolidate(int q, int t)
-        {
-            Score tmp[step];
-            Score* e = e_.row(q, t);
-            Score* g = g_.row(q, t);
-            for (int i = 0; i < step; ++i)
-            {
-                tmp[i] = g[i] > e[i] ? g[i] : e[i];
-            }
-
-            Score* v = v_.row(q, t);
-            for (int i = 0; i < step; ++i)
-            {
-                v[i] = v[i] > tmp[i] ? v[i] : tmp[i];
-            }
-        }
-
         friend std::ostream& operator<<(std::ostream& os, const AffineAlignMatrixVectorized& matrix)
         {
             return os << "AffineAlignMatrix(" << matrix.v_ << ")";
@@ -53,6 +53,11 @@ namespace dagAligner
     typedef signed short Score;
     static const Score SCORE_MIN = std::numeric_limits<Score>::min();
 
+    // saturating scores for alignments whose scores are known to fit in 8 bits
+    typedef signed char NarrowScore;
+    static const NarrowScore NARROW_SCORE_MIN = std::numeric_limits<NarrowScore>::min();
+    static const NarrowScore NARROW_SCORE_MAX = std::numeric_limits<NarrowScore>::max();
+
     /**
      * \brief Contains information about graph edges between the target sequence characters
      */
@@ -212,11 +217,17 @@ namespace dagAligner
         }
 
         void reset(std::size_t qLen, std::size_t tLen)
+        {
+            resize(qLen, tLen);
+            std::fill(matrix_.begin() + 1, matrix_.end(), SCORE_MIN);
+        }
+
+        // same as reset, except that all cells but the top left one are left for the caller to initialize
+        void resize(std::size_t qLen, std::size_t tLen)
         {
             // + 1 for gap row and gap column
             rowLen_ = qLen + 1;
             matrix_.resize(paddedRowLen() * (tLen + 1));
-            std::fill(matrix_.begin() + 1, matrix_.end(), SCORE_MIN);
         }
 
         int paddedRowLen() const { return 1 + (rowLen_ - 1 + pad - 1) / pad * pad; }
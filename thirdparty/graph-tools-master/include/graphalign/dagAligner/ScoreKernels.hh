@@ -0,0 +1,102 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Roman Petrovski <RPetrovski@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <string>
+
+#include "graphalign/dagAligner/Details.hh"
+
+namespace graphalign
+{
+
+namespace dagAligner
+{
+
+    /**
+     * \brief Instruction sets for which the score row kernels are available
+     */
+    enum class KernelIsa
+    {
+        kScalar,
+        kAvx2,
+        kAvx512bw
+    };
+
+    std::string toString(KernelIsa isa);
+
+    /**
+     * \brief Row-wise updates of the affine alignment matrices. All rows have len elements and may overlap only if
+     *        they are the same row. Additions saturate at the limits of the score type instead of wrapping around.
+     */
+    struct ScoreKernels
+    {
+        KernelIsa isa;
+
+        // e = max(e, max(ep + gapExt, vp + gapOpen + gapExt)); g = max(g, vDiag + penalties)
+        void (*deletionAndAlign)(
+            const Score* vp, const Score* ep, const Score* vDiag, const Score* penalties, Score* e, Score* g, int len,
+            Score gapOpen, Score gapExt);
+
+        // v = max(v, max(g, e))
+        void (*consolidate)(const Score* e, const Score* g, Score* v, int len);
+
+        // f[i] = max(f[i], max(f[i - 1] + gapExt, v[i - 1] + gapOpen + gapExt)); v[i] = max(v[i], f[i])
+        // f[-1] and v[-1] must be valid. Vectorized versions require gapOpen <= 0.
+        void (*insertion)(Score* f, Score* v, int len, Score gapOpen, Score gapExt);
+
+        // same as insertion for rows that interleave the cells of several queries, so that element i * lanes + lane
+        // belongs to query lane. Insertions propagate between the elements of the same lane only. f[-lanes..-1] and
+        // v[-lanes..-1] must be valid.
+        void (*insertionAcrossLanes)(Score* f, Score* v, int len, int lanes, Score gapOpen, Score gapExt);
+
+        // 8-bit versions of deletionAndAlign, consolidate and insertionAcrossLanes
+        void (*narrowDeletionAndAlign)(
+            const NarrowScore* vp, const NarrowScore* ep, const NarrowScore* vDiag, const NarrowScore* penalties,
+            NarrowScore* e, NarrowScore* g, int len, NarrowScore gapOpen, NarrowScore gapExt);
+        void (*narrowConsolidate)(const NarrowScore* e, const NarrowScore* g, NarrowScore* v, int len);
+        void (*narrowInsertionAcrossLanes)(
+            NarrowScore* f, NarrowScore* v, int len, int lanes, NarrowScore gapOpen, NarrowScore gapExt);
+    };
+
+    bool isSupported(KernelIsa isa);
+
+    /**
+     * \brief Kernels currently used by the aligners. Initially these are the best ones supported by the CPU.
+     */
+    const ScoreKernels& activeScoreKernels();
+
+    /**
+     * \brief Switches all aligners to the kernels of the given instruction set; intended for testing and benchmarking
+     * \throws std::invalid_argument if the CPU does not support the instruction set
+     */
+    void setActiveScoreKernels(KernelIsa isa);
+
+} // namespace dagAligner
+
+} // namespace graphalign
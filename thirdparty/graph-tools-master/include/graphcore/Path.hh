@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "graphcore/Graph.hh"
+#include "graphutils/SmallVector.hh"
 
 namespace graphtools
 {
@@ -47,14 +48,11 @@ namespace graphtools
 class Path
 {
 public:
-    typedef std::vector<NodeId>::const_iterator const_iterator;
+    // Most paths span only a handful of nodes, so their ids are stored in place without a heap allocation
+    typedef SmallVector<NodeId, 8> NodeIdList;
+    typedef NodeIdList::const_iterator const_iterator;
     // The constructor checks if the inputs define a well-formed path.
     Path(const Graph* graph_raw_ptr, int32_t start_position, const std::vector<NodeId>& nodes, int32_t end_position);
-    ~Path();
-    Path(const Path& other);
-    Path(Path&& other) noexcept;
-    Path& operator=(const Path& other);
-    Path& operator=(Path&& other) noexcept;
     bool operator==(const Path& other) const;
     bool operator<(const Path& path) const;
 
@@ -62,7 +60,7 @@ public:
     const_iterator end() const;
 
     // Ids of nodes overlapped by the path
-    std::vector<NodeId> const& nodeIds() const;
+    NodeIdList const& nodeIds() const;
     size_t numNodes() const;
     // Sequence of the entire path
     std::string seq() const;
@@ -118,8 +116,19 @@ public:
     NodeId lastNodeId() const { return nodeIds().back(); }
 
 private:
-    struct Impl;
-    std::unique_ptr<Impl> pimpl_;
+    bool isValid() const;
+    bool isNodePositionValid(NodeId node_id, int32_t position) const;
+    bool arePositionsOrdered() const;
+    bool isPathEmpty() const;
+    bool isFirstNodePosValid() const;
+    bool isLastNodePosValid() const;
+    bool isPathConnected() const;
+    void assertThatIndexIsValid(int32_t node_index) const;
+
+    const Graph* graph_raw_ptr_;
+    int32_t start_position_;
+    int32_t end_position_;
+    NodeIdList nodes_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Path& path);
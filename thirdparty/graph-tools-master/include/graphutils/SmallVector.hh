@@ -0,0 +1,204 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace graphtools
+{
+
+/**
+ * Vector of trivially copyable elements that keeps up to N elements in place and only allocates once it grows past
+ * that. Intended for short sequences (e.g. node ids of a path) that are copied and extended at a high rate.
+ */
+template <typename T, size_t N> class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector only supports trivially copyable types");
+    static_assert(N > 0, "SmallVector needs room for at least one element in place");
+
+public:
+    typedef T value_type;
+    typedef const T* const_iterator;
+    typedef T* iterator;
+
+    SmallVector() = default;
+    SmallVector(std::initializer_list<T> elements) { assign(elements.begin(), elements.end()); }
+    explicit SmallVector(const std::vector<T>& elements) { assign(elements.data(), elements.data() + elements.size()); }
+
+    SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+    SmallVector(SmallVector&& other) noexcept { moveFrom(other); }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            size_ = 0;
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            heap_.reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    const T* data() const { return heap_ ? heap_.get() : inline_; }
+    T* data() { return heap_ ? heap_.get() : inline_; }
+
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+    // True if the elements are stored in place (no heap allocation was made)
+    bool isInline() const { return !heap_; }
+
+    const T& operator[](size_t index) const { return data()[index]; }
+    T& operator[](size_t index) { return data()[index]; }
+    const T& front() const { return data()[0]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    void clear() { size_ = 0; }
+
+    void reserve(size_t new_capacity)
+    {
+        if (new_capacity <= capacity_)
+        {
+            return;
+        }
+        std::unique_ptr<T[]> new_heap(new T[new_capacity]);
+        std::memcpy(new_heap.get(), data(), size_ * sizeof(T));
+        heap_ = std::move(new_heap);
+        capacity_ = new_capacity;
+    }
+
+    void push_back(const T& element)
+    {
+        if (size_ == capacity_)
+        {
+            reserve(2 * capacity_);
+        }
+        data()[size_++] = element;
+    }
+
+    void pop_back() { --size_; }
+
+    iterator insert(const_iterator position, const T& element)
+    {
+        const size_t index = position - begin();
+        if (size_ == capacity_)
+        {
+            reserve(2 * capacity_);
+        }
+        T* elements = data();
+        std::memmove(elements + index + 1, elements + index, (size_ - index) * sizeof(T));
+        elements[index] = element;
+        ++size_;
+        return elements + index;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        const size_t index = position - begin();
+        T* elements = data();
+        std::memmove(elements + index, elements + index + 1, (size_ - index - 1) * sizeof(T));
+        --size_;
+        return elements + index;
+    }
+
+    operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+    bool operator==(const SmallVector& other) const
+    {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(const SmallVector& other) const { return !(*this == other); }
+    bool operator<(const SmallVector& other) const
+    {
+        return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+    }
+
+    friend bool operator==(const SmallVector& small_vector, const std::vector<T>& vector)
+    {
+        return small_vector.size() == vector.size()
+            && std::equal(small_vector.begin(), small_vector.end(), vector.begin());
+    }
+    friend bool operator==(const std::vector<T>& vector, const SmallVector& small_vector)
+    {
+        return small_vector == vector;
+    }
+
+private:
+    template <typename Iterator> void assign(Iterator first, Iterator last)
+    {
+        const size_t new_size = std::distance(first, last);
+        reserve(new_size);
+        std::copy(first, last, data());
+        size_ = new_size;
+    }
+
+    void moveFrom(SmallVector& other)
+    {
+        if (other.heap_)
+        {
+            heap_ = std::move(other.heap_);
+            capacity_ = other.capacity_;
+        }
+        else
+        {
+            std::memcpy(inline_, other.inline_, other.size_ * sizeof(T));
+            capacity_ = N;
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+        other.capacity_ = N;
+    }
+
+    T inline_[N];
+    std::unique_ptr<T[]> heap_;
+    size_t size_ = 0;
+    size_t capacity_ = N;
+};
+}
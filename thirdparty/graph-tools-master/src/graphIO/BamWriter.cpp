@@ -50,6 +50,7 @@ namespace graphIO
 
 string const BamWriter::initHeader = "@HD\tVN:1.4\tSO:unknown\n";
 string const BamWriter::graphCigarBamTag = "XG";
+string const BamWriter::graphNameBamTag = "XL";
 
 BamWriter::BamWriter(string const& bamPath, ReferenceContigs& contigs)
     : filePtr_(hts_open(bamPath.c_str(), "wb"), hts_close)
@@ -136,6 +137,13 @@ void BamWriter::writeAlignment(BamAlignment& align)
             q, BamWriter::graphCigarBamTag.c_str(), 'Z', align.graphCigar.length() + 1,
             reinterpret_cast<uint8_t*>(&data[0]));
     }
+    if (!align.graphName.empty())
+    {
+        string data(align.graphName);
+        bam_aux_append(
+            q, BamWriter::graphNameBamTag.c_str(), 'Z', align.graphName.length() + 1,
+            reinterpret_cast<uint8_t*>(&data[0]));
+    }
     if (bam_write1(filePtr_->fp.bgzf, q) == 0)
     {
         throw std::logic_error("Cannot write alignment");
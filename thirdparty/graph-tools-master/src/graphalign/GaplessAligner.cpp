@@ -28,6 +28,7 @@
 
 #include "graphalign/GaplessAligner.hh"
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -37,11 +38,99 @@
 #include "graphutils/SequenceOperations.hh"
 
 using std::list;
+using std::pair;
 using std::string;
 using std::vector;
 
 namespace graphtools
 {
+
+namespace
+{
+using PathAndMismatches = pair<Path, int32_t>;
+
+// Extends the start of a path that begins at the given query position to the start of the query, keeping the
+// extensions that have at most max_mismatches mismatches in total
+void extendStartWithinMismatches(
+    const Path& path, int32_t query_pos, const string& query, int32_t num_mismatches, int32_t max_mismatches,
+    list<PathAndMismatches>& extensions)
+{
+    const Graph& graph = *path.graphRawPtr();
+    const NodeId node_id = path.firstNodeId();
+    const string& node_seq = graph.nodeSeq(node_id);
+    const int32_t shift_len = std::min(path.startPosition(), query_pos);
+
+    for (int32_t offset = 1; offset <= shift_len; ++offset)
+    {
+        const char ref_base = node_seq[path.startPosition() - offset];
+        if (!checkIfReferenceBaseMatchesQueryBase(ref_base, query[query_pos - offset]))
+        {
+            if (++num_mismatches > max_mismatches)
+            {
+                return;
+            }
+        }
+    }
+
+    Path extended_path(path);
+    extended_path.shiftStartAlongNode(shift_len);
+    if (query_pos == shift_len)
+    {
+        extensions.emplace_back(extended_path, num_mismatches);
+        return;
+    }
+
+    for (NodeId pred_node_id : graph.predecessors(node_id))
+    {
+        Path next_path(extended_path);
+        next_path.extendStartToNode(pred_node_id);
+        extendStartWithinMismatches(
+            next_path, query_pos - shift_len, query, num_mismatches, max_mismatches, extensions);
+    }
+}
+
+// Extends the end of a path that ends just before the given query position to the end of the query, keeping the
+// extensions that have at most max_mismatches mismatches in total
+void extendEndWithinMismatches(
+    const Path& path, int32_t query_pos, const string& query, int32_t num_mismatches, int32_t max_mismatches,
+    list<PathAndMismatches>& extensions)
+{
+    const Graph& graph = *path.graphRawPtr();
+    const NodeId node_id = path.lastNodeId();
+    const string& node_seq = graph.nodeSeq(node_id);
+    const auto query_len = static_cast<int32_t>(query.length());
+    const int32_t shift_len
+        = std::min(static_cast<int32_t>(node_seq.length()) - path.endPosition(), query_len - query_pos);
+
+    for (int32_t offset = 0; offset != shift_len; ++offset)
+    {
+        const char ref_base = node_seq[path.endPosition() + offset];
+        if (!checkIfReferenceBaseMatchesQueryBase(ref_base, query[query_pos + offset]))
+        {
+            if (++num_mismatches > max_mismatches)
+            {
+                return;
+            }
+        }
+    }
+
+    Path extended_path(path);
+    extended_path.shiftEndAlongNode(shift_len);
+    if (query_pos + shift_len == query_len)
+    {
+        extensions.emplace_back(extended_path, num_mismatches);
+        return;
+    }
+
+    for (NodeId succ_node_id : graph.successors(node_id))
+    {
+        Path next_path(extended_path);
+        next_path.extendEndToNode(succ_node_id);
+        extendEndWithinMismatches(next_path, query_pos + shift_len, query, num_mismatches, max_mismatches, extensions);
+    }
+}
+}
+
 list<GraphAlignment> GaplessAligner::align(const string& query) const
 {
     const list<string> kmers = extractKmersFromAllPositions(query, kmer_len_);
@@ -50,9 +139,9 @@ list<GraphAlignment> GaplessAligner::align(const string& query) const
     for (const string& kmer : kmers)
     {
         // Initiate alignment from a unique kmer.
-        if (kmer_index_.numPaths(kmer) == 1)
+        if (kmer_index_ptr_->numPaths(kmer) == 1)
         {
-            const Path kmer_path = kmer_index_.getPaths(kmer).front();
+            const Path kmer_path = kmer_index_ptr_->getPaths(kmer).front();
             return getBestAlignmentToShortPath(kmer_path, pos, query);
         }
         ++pos;
@@ -60,6 +149,22 @@ list<GraphAlignment> GaplessAligner::align(const string& query) const
     return {};
 }
 
+list<GraphAlignment> GaplessAligner::align(const string& query, int32_t max_mismatches) const
+{
+    const auto query_len = static_cast<int32_t>(query.length());
+    for (int32_t pos = 0; pos + kmer_len_ <= query_len; ++pos)
+    {
+        // Initiate alignment from a unique kmer.
+        const string kmer = query.substr(pos, kmer_len_);
+        if (kmer_index_ptr_->numPaths(kmer) == 1)
+        {
+            const Path kmer_path = kmer_index_ptr_->getPaths(kmer).front();
+            return getBestAlignmentToShortPath(kmer_path, pos, query, max_mismatches);
+        }
+    }
+    return {};
+}
+
 list<GraphAlignment> getBestAlignmentToShortPath(const Path& path, int32_t start_pos, const string& query)
 {
     const int32_t start_extension = start_pos;
@@ -86,6 +191,54 @@ list<GraphAlignment> getBestAlignmentToShortPath(const Path& path, int32_t start
     return best_alignments;
 }
 
+list<GraphAlignment>
+getBestAlignmentToShortPath(const Path& path, int32_t start_pos, const string& query, int32_t max_mismatches)
+{
+    int32_t path_mismatches = 0;
+    const string path_seq = path.seq();
+    for (int32_t index = 0; index != static_cast<int32_t>(path_seq.length()); ++index)
+    {
+        if (!checkIfReferenceBaseMatchesQueryBase(path_seq[index], query[start_pos + index]))
+        {
+            ++path_mismatches;
+        }
+    }
+
+    if (path_mismatches > max_mismatches)
+    {
+        return {};
+    }
+
+    list<PathAndMismatches> start_extensions;
+    extendStartWithinMismatches(path, start_pos, query, path_mismatches, max_mismatches, start_extensions);
+
+    list<GraphAlignment> best_alignments;
+    int32_t min_mismatches = max_mismatches + 1;
+    const auto end_pos = static_cast<int32_t>(start_pos + path.length());
+    for (const auto& start_extension : start_extensions)
+    {
+        list<PathAndMismatches> full_paths;
+        extendEndWithinMismatches(
+            start_extension.first, end_pos, query, start_extension.second, std::min(min_mismatches, max_mismatches),
+            full_paths);
+
+        for (const auto& full_path : full_paths)
+        {
+            if (full_path.second < min_mismatches)
+            {
+                min_mismatches = full_path.second;
+                best_alignments.clear();
+            }
+            if (full_path.second == min_mismatches)
+            {
+                best_alignments.push_back(alignWithoutGaps(full_path.first, query));
+            }
+        }
+    }
+
+    return best_alignments;
+}
+
 GraphAlignment alignWithoutGaps(const Path& path, const string& query)
 {
     vector<string> query_pieces = splitSequenceByPath(path, query);
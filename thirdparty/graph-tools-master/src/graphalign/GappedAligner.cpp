@@ -29,6 +29,9 @@
 
 #include "graphalign/GappedAligner.hh"
 
+#include <map>
+#include <tuple>
+
 #include "graphalign/GraphAlignmentOperations.hh"
 #include "graphalign/LinearAlignmentOperations.hh"
 #include "graphcore/PathOperations.hh"
@@ -37,6 +40,7 @@ using std::list;
 using std::make_pair;
 using std::string;
 using std::to_string;
+using std::vector;
 
 namespace graphtools
 {
@@ -97,7 +101,147 @@ static int32_t removeSuffixThatOverlapsMultipleNodes(int32_t suffixLength, Path&
     return 0;
 }
 
+/**
+ * Trims the paths of aligned query prefixes to the aligned part of the reference and checks the alignments
+ *
+ * @param query_piece: Aligned query prefix
+ * @param[in|out] paths_and_alignments: Alignments of the query prefix and their paths
+ */
+static void finishPrefixExtensions(const string& query_piece, list<PathAndAlignment>& paths_and_alignments)
+{
+    for (PathAndAlignment& path_and_alignment : paths_and_alignments)
+    {
+        Path& path = path_and_alignment.first;
+        Alignment& alignment = path_and_alignment.second;
+        alignment.setReferenceStart(0);
+
+        const int32_t overhang = path.length() - alignment.referenceLength();
+        path.shrinkStartBy(overhang);
+
+        if (!checkConsistency(path_and_alignment.second, path.seq(), query_piece))
+        {
+            throw std::logic_error("Inconsistent prefix");
+        }
+    }
+}
+
+/**
+ * Checks alignments of query suffixes and trims their paths to the aligned part of the reference
+ *
+ * @param query_piece: Aligned query suffix
+ * @param[in|out] paths_and_alignments: Alignments of the query suffix and their paths
+ */
+static void finishSuffixExtensions(const string& query_piece, list<PathAndAlignment>& paths_and_alignments)
+{
+    for (PathAndAlignment& path_and_alignment : paths_and_alignments)
+    {
+        if (!checkConsistency(path_and_alignment.second, path_and_alignment.first.seq(), query_piece))
+        {
+            throw std::logic_error("Inconsistent suffix");
+        }
+
+        Path& path = path_and_alignment.first;
+        Alignment& alignment = path_and_alignment.second;
+
+        const int32_t overhang = path.length() - alignment.referenceLength();
+        path.shrinkEndBy(overhang);
+    }
+}
+
 list<GraphAlignment> GappedGraphAligner::align(const string& query) const
+{
+    const boost::optional<std::pair<Path, size_t>> seed = findSeed(query);
+    if (!seed)
+    {
+        return {};
+    }
+
+    return extendKmerMatchToFullAlignments(seed->first, query, seed->second);
+}
+
+vector<list<GraphAlignment>> GappedGraphAligner::alignBatch(const vector<string>& queries) const
+{
+    vector<boost::optional<SeedExtension>> extensions;
+    // the target of a piece only depends on the position the piece extends from and on the extension length, so
+    // pieces of equal length share it if they extend seeds that end at the same position
+    typedef std::tuple<NodeId, int32_t, size_t> SeedEndAndExtensionLen;
+    std::map<SeedEndAndExtensionLen, vector<size_t>> prefix_groups;
+    std::map<SeedEndAndExtensionLen, vector<size_t>> suffix_groups;
+    for (size_t query_index = 0; query_index != queries.size(); ++query_index)
+    {
+        const boost::optional<std::pair<Path, size_t>> seed = findSeed(queries[query_index]);
+        if (!seed)
+        {
+            extensions.push_back(boost::none);
+            continue;
+        }
+
+        extensions.push_back(splitQueryAtKmerMatch(seed->first, queries[query_index], seed->second));
+        const SeedExtension& extension = *extensions.back();
+        if (!extension.query_prefix.empty())
+        {
+            const Path& seed_path = extension.prefix_seed_path;
+            const size_t extension_len = extension.query_prefix.length() + padding_len_;
+            prefix_groups[std::make_tuple(seed_path.nodeIds().front(), seed_path.startPosition(), extension_len)]
+                .push_back(query_index);
+        }
+        if (!extension.query_suffix.empty())
+        {
+            const Path& seed_path = extension.suffix_seed_path;
+            const size_t extension_len = extension.query_suffix.length() + padding_len_;
+            suffix_groups[std::make_tuple(seed_path.nodeIds().back(), seed_path.endPosition(), extension_len)]
+                .push_back(query_index);
+        }
+    }
+
+    for (const auto& group : prefix_groups)
+    {
+        vector<Path> seed_paths;
+        vector<string> query_pieces;
+        for (size_t query_index : group.second)
+        {
+            seed_paths.push_back(extensions[query_index]->prefix_seed_path);
+            query_pieces.push_back(extensions[query_index]->query_prefix);
+        }
+
+        vector<list<PathAndAlignment>> prefix_extensions
+            = aligner_.suffixAlignBatch(seed_paths, query_pieces, std::get<2>(group.first));
+        for (size_t piece_index = 0; piece_index != query_pieces.size(); ++piece_index)
+        {
+            finishPrefixExtensions(query_pieces[piece_index], prefix_extensions[piece_index]);
+            extensions[group.second[piece_index]]->prefix_extensions = std::move(prefix_extensions[piece_index]);
+        }
+    }
+
+    for (const auto& group : suffix_groups)
+    {
+        vector<Path> seed_paths;
+        vector<string> query_pieces;
+        for (size_t query_index : group.second)
+        {
+            seed_paths.push_back(extensions[query_index]->suffix_seed_path);
+            query_pieces.push_back(extensions[query_index]->query_suffix);
+        }
+
+        vector<list<PathAndAlignment>> suffix_extensions
+            = aligner_.prefixAlignBatch(seed_paths, query_pieces, std::get<2>(group.first));
+        for (size_t piece_index = 0; piece_index != query_pieces.size(); ++piece_index)
+        {
+            finishSuffixExtensions(query_pieces[piece_index], suffix_extensions[piece_index]);
+            extensions[group.second[piece_index]]->suffix_extensions = std::move(suffix_extensions[piece_index]);
+        }
+    }
+
+    vector<list<GraphAlignment>> top_graph_alignments;
+    for (boost::optional<SeedExtension>& extension : extensions)
+    {
+        top_graph_alignments.push_back(extension ? mergeExtensions(*extension) : list<GraphAlignment>());
+    }
+
+    return top_graph_alignments;
+}
+
+boost::optional<std::pair<Path, size_t>> GappedGraphAligner::findSeed(const string& query) const
 {
     const list<string> kmers = extractKmersFromAllPositions(query, kmer_len_);
 
@@ -105,34 +249,53 @@ list<GraphAlignment> GappedGraphAligner::align(const string& query) const
     for (const string& kmer : kmers)
     {
         // Initiate alignment from a unique kmer.
-        if (kmer_index_.numPaths(kmer) == 1)
+        if (kmer_index_ptr_->numPaths(kmer) == 1)
         {
-            Path kmer_path = kmer_index_.getPaths(kmer).front();
+            Path kmer_path = kmer_index_ptr_->getPaths(kmer).front();
             removeSuffixThatOverlapsMultipleNodes(seed_affix_trim_len_, kmer_path);
             const int32_t num_prefix_bases_trimmed
                 = removePrefixThatOverlapsMultipleNodes(seed_affix_trim_len_, kmer_path);
-            return extendKmerMatchToFullAlignments(kmer_path, query, kmer_start_on_query + num_prefix_bases_trimmed);
+            return make_pair(kmer_path, kmer_start_on_query + num_prefix_bases_trimmed);
         }
         ++kmer_start_on_query;
     }
 
-    return {};
+    return boost::none;
 }
 
 list<GraphAlignment> GappedGraphAligner::extendKmerMatchToFullAlignments(
     Path kmer_path, const string& query, size_t kmer_start_on_query) const
+{
+    SeedExtension extension = splitQueryAtKmerMatch(kmer_path, query, kmer_start_on_query);
+
+    if (!extension.query_prefix.empty())
+    {
+        extension.prefix_extensions = extendAlignmentPrefix(
+            extension.prefix_seed_path, extension.query_prefix, extension.query_prefix.length() + padding_len_);
+    }
+
+    if (!extension.query_suffix.empty())
+    {
+        extension.suffix_extensions = extendAlignmentSuffix(
+            extension.suffix_seed_path, extension.query_suffix, extension.query_suffix.length() + padding_len_);
+    }
+
+    return mergeExtensions(extension);
+}
+
+GappedGraphAligner::SeedExtension
+GappedGraphAligner::splitQueryAtKmerMatch(Path kmer_path, const string& query, size_t kmer_start_on_query) const
 {
     assert(kmer_path.length() > 1);
 
+    SeedExtension extension(kmer_path);
+
     // Generate prefix extensions
-    list<PathAndAlignment> prefix_extensions;
     size_t query_prefix_len = kmer_start_on_query;
     if (query_prefix_len != 0)
     {
-        const string query_prefix = query.substr(0, query_prefix_len);
-        Path prefix_seed_path = kmer_path;
-        prefix_seed_path.shrinkEndBy(kmer_path.length());
-        prefix_extensions = extendAlignmentPrefix(prefix_seed_path, query_prefix, query_prefix_len + padding_len_);
+        extension.query_prefix = query.substr(0, query_prefix_len);
+        extension.prefix_seed_path.shrinkEndBy(kmer_path.length());
     }
     else
     {
@@ -141,19 +304,17 @@ list<GraphAlignment> GappedGraphAligner::extendKmerMatchToFullAlignments(
         query_prefix_len = 1;
         Path prefix_path = kmer_path;
         prefix_path.shrinkEndBy(prefix_path.length() - 1);
-        prefix_extensions = { make_pair(prefix_path, Alignment(0, "1M")) };
+        extension.prefix_extensions = { make_pair(prefix_path, Alignment(0, "1M")) };
         kmer_path.shrinkStartBy(1);
     }
 
     // Generate suffix extensions
-    list<PathAndAlignment> suffix_extensions;
     size_t query_suffix_len = query.length() - kmer_path.length() - query_prefix_len;
     if (query_suffix_len != 0)
     {
-        const string query_suffix = query.substr(query_prefix_len + kmer_path.length(), query_suffix_len);
-        Path suffix_seed_path = kmer_path;
-        suffix_seed_path.shrinkStartBy(kmer_path.length());
-        suffix_extensions = extendAlignmentSuffix(suffix_seed_path, query_suffix, query_suffix_len + padding_len_);
+        extension.query_suffix = query.substr(query_prefix_len + kmer_path.length(), query_suffix_len);
+        extension.suffix_seed_path = kmer_path;
+        extension.suffix_seed_path.shrinkStartBy(kmer_path.length());
     }
     else
     {
@@ -161,13 +322,21 @@ list<GraphAlignment> GappedGraphAligner::extendKmerMatchToFullAlignments(
         // suffix_extensions we create a 1bp suffix artificially.
         Path suffix_path = kmer_path;
         suffix_path.shrinkStartBy(suffix_path.length() - 1);
-        suffix_extensions = { make_pair(suffix_path, Alignment(0, "1M")) };
+        extension.suffix_extensions = { make_pair(suffix_path, Alignment(0, "1M")) };
         kmer_path.shrinkEndBy(1);
     }
 
+    extension.kmer_path = kmer_path;
+    return extension;
+}
+
+list<GraphAlignment> GappedGraphAligner::mergeExtensions(SeedExtension& extension)
+{
+    const Path& kmer_path = extension.kmer_path;
+
     // Merge alignments together
     list<PathAndAlignment> top_paths_and_alignments;
-    for (PathAndAlignment& prefix_path_and_alignment : prefix_extensions)
+    for (PathAndAlignment& prefix_path_and_alignment : extension.prefix_extensions)
     {
         Path& prefix_path = prefix_path_and_alignment.first;
         Path prefix_plus_kmer_path = concatenatePaths(prefix_path, kmer_path);
@@ -176,7 +345,7 @@ list<GraphAlignment> GappedGraphAligner::extendKmerMatchToFullAlignments(
         Alignment kmer_alignment(prefix_alignment.referenceLength(), to_string(kmer_path.length()) + "M");
         Alignment prefix_plus_kmer_alignment = mergeAlignments(prefix_alignment, kmer_alignment);
 
-        for (PathAndAlignment& suffix_path_and_alignment : suffix_extensions)
+        for (PathAndAlignment& suffix_path_and_alignment : extension.suffix_extensions)
         {
             Path& suffix_path = suffix_path_and_alignment.first;
             Alignment& suffix_alignment = suffix_path_and_alignment.second;
@@ -209,21 +378,7 @@ GappedGraphAligner::extendAlignmentPrefix(const Path& seed_path, const string& q
     int32_t top_alignment_score = INT32_MIN;
     list<PathAndAlignment> top_paths_and_alignments
         = aligner_.suffixAlign(seed_path, query_piece, extension_len, top_alignment_score);
-
-    for (PathAndAlignment& path_and_alignment : top_paths_and_alignments)
-    {
-        Path& path = path_and_alignment.first;
-        Alignment& alignment = path_and_alignment.second;
-        alignment.setReferenceStart(0);
-
-        const int32_t overhang = path.length() - alignment.referenceLength();
-        path.shrinkStartBy(overhang);
-
-        if (!checkConsistency(path_and_alignment.second, path.seq(), query_piece))
-        {
-            throw std::logic_error("Inconsistent prefix");
-        }
-    }
+    finishPrefixExtensions(query_piece, top_paths_and_alignments);
 
     return top_paths_and_alignments;
 }
@@ -236,20 +391,7 @@ GappedGraphAligner::extendAlignmentSuffix(const Path& seed_path, const string& q
     int32_t top_alignment_score = INT32_MIN;
     list<PathAndAlignment> top_paths_and_alignments
         = aligner_.prefixAlign(seed_path, query_piece, extension_len, top_alignment_score);
-
-    for (PathAndAlignment& path_and_alignment : top_paths_and_alignments)
-    {
-        if (!checkConsistency(path_and_alignment.second, path_and_alignment.first.seq(), query_piece))
-        {
-            throw std::logic_error("Inconsistent suffix");
-        }
-
-        Path& path = path_and_alignment.first;
-        Alignment& alignment = path_and_alignment.second;
-
-        const int32_t overhang = path.length() - alignment.referenceLength();
-        path.shrinkEndBy(overhang);
-    }
+    finishSuffixExtensions(query_piece, top_paths_and_alignments);
 
     return top_paths_and_alignments;
 }
@@ -0,0 +1,97 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graphalign/PathExtensionTrie.hh"
+
+#include <algorithm>
+#include <list>
+
+#include "graphcore/PathOperations.hh"
+
+using std::list;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace graphtools
+{
+
+PathExtensionTrie::PathExtensionTrie(const Path& seed_path, int32_t extension_len, Direction direction)
+    : direction_(direction)
+    , nodes_{ Node{ 0, -1, 0 } }
+    , children_(1)
+{
+    const list<Path> extended_paths = direction == Direction::kStart ? extendPathStart(seed_path, extension_len)
+                                                                     : extendPathEnd(seed_path, extension_len);
+    leaves_.reserve(extended_paths.size());
+    for (const Path& path : extended_paths)
+    {
+        string sequence = path.seq();
+        if (direction == Direction::kStart)
+        {
+            std::reverse(sequence.begin(), sequence.end());
+        }
+        leaves_.emplace_back(addSequence(sequence), path);
+    }
+}
+
+int32_t PathExtensionTrie::addSequence(const string& sequence)
+{
+    int32_t node_index = 0;
+    for (char base : sequence)
+    {
+        vector<pair<char, int32_t>>& children = children_[node_index];
+        auto child_it = std::find_if(
+            children.begin(), children.end(), [base](const pair<char, int32_t>& child) { return child.first == base; });
+        if (child_it != children.end())
+        {
+            node_index = child_it->second;
+            continue;
+        }
+
+        const auto child_index = static_cast<int32_t>(nodes_.size());
+        nodes_.push_back(Node{ base, node_index, nodes_[node_index].depth + 1 });
+        children.emplace_back(base, child_index);
+        children_.emplace_back();
+        node_index = child_index;
+    }
+
+    return node_index;
+}
+
+size_t PathExtensionTrie::numBytes() const
+{
+    size_t num_bytes = sizeof(PathExtensionTrie) + nodes_.size() * (sizeof(Node) + sizeof(children_.front()));
+    num_bytes += (nodes_.size() - 1) * sizeof(pair<char, int32_t>);
+    for (const auto& leaf : leaves_)
+    {
+        num_bytes += sizeof(leaf) + leaf.second.numNodes() * sizeof(NodeId);
+    }
+    return num_bytes;
+}
+}
@@ -113,6 +113,52 @@ void PinnedAligner::fillBodyCell(TracebackMatrix& matrix, size_t row_index, size
     }
 }
 
+void PinnedAligner::populateTrieColumns(
+    const PathExtensionTrie& trie, const string& query, std::vector<TracebackMatrixCell>& columns)
+{
+    const size_t num_rows = query.length() + 1;
+    const std::vector<PathExtensionTrie::Node>& nodes = trie.nodes();
+    columns.resize(nodes.size() * num_rows);
+
+    // The root column is the left column of all matrices
+    columns[0] = TracebackMatrixCell(TracebackStep::kStop, 0);
+    for (size_t row_index = 1; row_index != num_rows; ++row_index)
+    {
+        columns[row_index] = TracebackMatrixCell(TracebackStep::kTop, row_index * gap_score_);
+    }
+
+    for (size_t node_index = 1; node_index != nodes.size(); ++node_index)
+    {
+        const PathExtensionTrie::Node& node = nodes[node_index];
+        const TracebackMatrixCell* left = &columns[node.parent * num_rows];
+        TracebackMatrixCell* column = &columns[node_index * num_rows];
+        column[0] = TracebackMatrixCell(TracebackStep::kLeft, node.depth * gap_score_);
+
+        // Same choice of the traceback step as in fillBodyCell
+        for (size_t row_index = 1; row_index != num_rows; ++row_index)
+        {
+            const bool do_bases_match = checkIfReferenceBaseMatchesQueryBase(node.base, query[row_index - 1]);
+            TracebackMatrixCell& cell = column[row_index];
+            cell.score = left[row_index - 1].score + (do_bases_match ? match_score_ : mismatch_score_);
+            cell.direction = do_bases_match ? TracebackStep::kDiagonalMatch : TracebackStep::kDiagonalMismatch;
+
+            const int32_t query_gap_score = left[row_index].score + gap_score_;
+            if (query_gap_score > cell.score)
+            {
+                cell.score = query_gap_score;
+                cell.direction = TracebackStep::kLeft;
+            }
+
+            const int32_t reference_gap_score = column[row_index - 1].score + gap_score_;
+            if (reference_gap_score > cell.score)
+            {
+                cell.score = reference_gap_score;
+                cell.direction = TracebackStep::kTop;
+            }
+        }
+    }
+}
+
 Alignment PinnedAligner::prefixAlign(const string& reference, const string& query)
 {
     TracebackMatrix matrix = populateTracebackMatrix(reference, query);
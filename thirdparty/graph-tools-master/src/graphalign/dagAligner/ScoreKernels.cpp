@@ -0,0 +1,573 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Roman Petrovski <RPetrovski@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graphalign/dagAligner/ScoreKernels.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define GRAPHTOOLS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace graphalign
+{
+
+namespace dagAligner
+{
+
+    namespace
+    {
+        // Score arithmetic saturates at the limits of the score type in all kernels so that they produce identical
+        // matrices; cells initialized to SCORE_MIN then stay at SCORE_MIN instead of wrapping around to large scores
+
+        Score saturateScore(int score)
+        {
+            return Score(std::max<int>(SCORE_MIN, std::min<int>(std::numeric_limits<Score>::max(), score)));
+        }
+
+        void deletionAndAlignScalar(
+            const Score* vp, const Score* ep, const Score* vDiag, const Score* penalties, Score* e, Score* g, int len,
+            Score gapOpen, Score gapExt)
+        {
+            const Score gapOpenExt = saturateScore(gapOpen + gapExt);
+            for (int i = 0; i < len; ++i)
+            {
+                const Score extended = saturateScore(ep[i] + gapExt);
+                const Score opened = saturateScore(vp[i] + gapOpenExt);
+                const Score deletion = extended > opened ? extended : opened;
+                e[i] = e[i] > deletion ? e[i] : deletion;
+
+                const Score aligned = saturateScore(vDiag[i] + penalties[i]);
+                g[i] = g[i] > aligned ? g[i] : aligned;
+            }
+        }
+
+        void consolidateScalar(const Score* e, const Score* g, Score* v, int len)
+        {
+            for (int i = 0; i < len; ++i)
+            {
+                const Score best = g[i] > e[i] ? g[i] : e[i];
+                v[i] = v[i] > best ? v[i] : best;
+            }
+        }
+
+        void insertionScalar(Score* f, Score* v, int len, Score gapOpen, Score gapExt)
+        {
+            const Score gapOpenExt = saturateScore(gapOpen + gapExt);
+            for (int i = 0; i < len; ++i)
+            {
+                f[i] = std::max(f[i], std::max(saturateScore(f[i - 1] + gapExt), saturateScore(v[i - 1] + gapOpenExt)));
+                v[i] = std::max(v[i], f[i]);
+            }
+        }
+
+        void insertionAcrossLanesScalar(Score* f, Score* v, int len, int lanes, Score gapOpen, Score gapExt)
+        {
+            const Score gapOpenExt = saturateScore(gapOpen + gapExt);
+            for (int i = 0; i < len * lanes; ++i)
+            {
+                f[i] = std::max(
+                    f[i], std::max(saturateScore(f[i - lanes] + gapExt), saturateScore(v[i - lanes] + gapOpenExt)));
+                v[i] = std::max(v[i], f[i]);
+            }
+        }
+
+        NarrowScore saturate(int score)
+        {
+            return NarrowScore(std::max<int>(NARROW_SCORE_MIN, std::min<int>(NARROW_SCORE_MAX, score)));
+        }
+
+        void narrowDeletionAndAlignScalar(
+            const NarrowScore* vp, const NarrowScore* ep, const NarrowScore* vDiag, const NarrowScore* penalties,
+            NarrowScore* e, NarrowScore* g, int len, NarrowScore gapOpen, NarrowScore gapExt)
+        {
+            const NarrowScore gapOpenExt = saturate(gapOpen + gapExt);
+            for (int i = 0; i < len; ++i)
+            {
+                const NarrowScore deletion = std::max(saturate(ep[i] + gapExt), saturate(vp[i] + gapOpenExt));
+                e[i] = std::max(e[i], deletion);
+                g[i] = std::max(g[i], saturate(vDiag[i] + penalties[i]));
+            }
+        }
+
+        void narrowConsolidateScalar(const NarrowScore* e, const NarrowScore* g, NarrowScore* v, int len)
+        {
+            for (int i = 0; i < len; ++i)
+            {
+                v[i] = std::max(v[i], std::max(g[i], e[i]));
+            }
+        }
+
+        void narrowInsertionAcrossLanesScalar(
+            NarrowScore* f, NarrowScore* v, int len, int lanes, NarrowScore gapOpen, NarrowScore gapExt)
+        {
+            const NarrowScore gapOpenExt = saturate(gapOpen + gapExt);
+            for (int i = 0; i < len * lanes; ++i)
+            {
+                f[i] = std::max(f[i], std::max(saturate(f[i - lanes] + gapExt), saturate(v[i - lanes] + gapOpenExt)));
+                v[i] = std::max(v[i], f[i]);
+            }
+        }
+
+#ifdef GRAPHTOOLS_X86_KERNELS
+
+        // Insertions propagate along the row, so the vectorized kernels solve the recurrence with a prefix maximum.
+        // With gapOpen <= 0 the values of f within a block can be written as
+        // f[i] = max(f[-1] + (i + 1) * gapExt, max_{j <= i}(a[j] + (i - j) * gapExt)), where
+        // a[j] = max(f[j], v[j - 1] + gapOpen + gapExt). Subtracting i * gapExt turns this into a plain prefix maximum.
+        // Saturating at SCORE_MIN commutes with the prefix maximum as long as gapExt <= 0 and the shifted scores stay
+        // below the maximum of the score type, which holds for scores far below it.
+
+        // shifts 16-bit elements towards higher lanes by count, filling the vacated lanes with fill
+        template <int count>
+        __attribute__((target("avx2"))) inline __m256i shiftLanesUpAvx2(__m256i x, __m256i fill)
+        {
+            const __m256i lowerHalf = _mm256_permute2x128_si256(fill, x, 0x20);
+            return count == 8 ? lowerHalf : _mm256_alignr_epi8(x, lowerHalf, (16 - 2 * count) & 15);
+        }
+
+        __attribute__((target("avx2"))) void insertionAvx2(Score* f, Score* v, int len, Score gapOpen, Score gapExt)
+        {
+            const __m256i minV = _mm256_set1_epi16(SCORE_MIN);
+            const __m256i gapOpenExtV = _mm256_set1_epi16(saturateScore(gapOpen + gapExt));
+            Score laneOffsets[16];
+            for (int lane = 0; lane != 16; ++lane)
+            {
+                laneOffsets[lane] = lane * gapExt;
+            }
+            const __m256i laneOffsetsV = _mm256_loadu_si256((const __m256i*)laneOffsets);
+
+            int i = 0;
+            for (; i + 16 <= len; i += 16)
+            {
+                // carries the best f from the preceding cells
+                const __m256i carry = _mm256_set1_epi16(saturateScore(f[i - 1] + gapExt));
+                const __m256i fromV = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(v + i - 1)), gapOpenExtV);
+                __m256i scan = _mm256_subs_epi16(
+                    _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(f + i)), fromV), laneOffsetsV);
+                scan = _mm256_max_epi16(scan, shiftLanesUpAvx2<1>(scan, minV));
+                scan = _mm256_max_epi16(scan, shiftLanesUpAvx2<2>(scan, minV));
+                scan = _mm256_max_epi16(scan, shiftLanesUpAvx2<4>(scan, minV));
+                scan = _mm256_max_epi16(scan, shiftLanesUpAvx2<8>(scan, minV));
+                scan = _mm256_max_epi16(scan, carry);
+
+                const __m256i fV = _mm256_adds_epi16(scan, laneOffsetsV);
+                _mm256_storeu_si256((__m256i*)(f + i), fV);
+                _mm256_storeu_si256(
+                    (__m256i*)(v + i), _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(v + i)), fV));
+            }
+            insertionScalar(f + i, v + i, len - i, gapOpen, gapExt);
+        }
+
+        // with one query per lane there is no dependency between the elements of a vector
+        __attribute__((target("avx2"))) void
+        insertionAcrossLanesAvx2(Score* f, Score* v, int len, int lanes, Score gapOpen, Score gapExt)
+        {
+            if (lanes % 16)
+            {
+                insertionAcrossLanesScalar(f, v, len, lanes, gapOpen, gapExt);
+                return;
+            }
+
+            const __m256i gapExtV = _mm256_set1_epi16(gapExt);
+            const __m256i gapOpenExtV = _mm256_set1_epi16(saturateScore(gapOpen + gapExt));
+            for (int i = 0; i < len * lanes; i += 16)
+            {
+                const __m256i extended
+                    = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(f + i - lanes)), gapExtV);
+                const __m256i opened
+                    = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(v + i - lanes)), gapOpenExtV);
+                const __m256i fV = _mm256_max_epi16(
+                    _mm256_loadu_si256((const __m256i*)(f + i)), _mm256_max_epi16(extended, opened));
+                _mm256_storeu_si256((__m256i*)(f + i), fV);
+                _mm256_storeu_si256(
+                    (__m256i*)(v + i), _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(v + i)), fV));
+            }
+        }
+
+        __attribute__((target("avx2"))) void deletionAndAlignAvx2(
+            const Score* vp, const Score* ep, const Score* vDiag, const Score* penalties, Score* e, Score* g, int len,
+            Score gapOpen, Score gapExt)
+        {
+            const __m256i gapExtV = _mm256_set1_epi16(gapExt);
+            const __m256i gapOpenExtV = _mm256_set1_epi16(saturateScore(gapOpen + gapExt));
+            int i = 0;
+            for (; i + 16 <= len; i += 16)
+            {
+                const __m256i extended = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(ep + i)), gapExtV);
+                const __m256i opened = _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(vp + i)), gapOpenExtV);
+                const __m256i deletion = _mm256_max_epi16(extended, opened);
+                _mm256_storeu_si256(
+                    (__m256i*)(e + i), _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(e + i)), deletion));
+
+                const __m256i aligned = _mm256_adds_epi16(
+                    _mm256_loadu_si256((const __m256i*)(vDiag + i)),
+                    _mm256_loadu_si256((const __m256i*)(penalties + i)));
+                _mm256_storeu_si256(
+                    (__m256i*)(g + i), _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(g + i)), aligned));
+            }
+            deletionAndAlignScalar(vp + i, ep + i, vDiag + i, penalties + i, e + i, g + i, len - i, gapOpen, gapExt);
+        }
+
+        __attribute__((target("avx2"))) void consolidateAvx2(const Score* e, const Score* g, Score* v, int len)
+        {
+            int i = 0;
+            for (; i + 16 <= len; i += 16)
+            {
+                const __m256i best = _mm256_max_epi16(
+                    _mm256_loadu_si256((const __m256i*)(g + i)), _mm256_loadu_si256((const __m256i*)(e + i)));
+                _mm256_storeu_si256(
+                    (__m256i*)(v + i), _mm256_max_epi16(_mm256_loadu_si256((const __m256i*)(v + i)), best));
+            }
+            consolidateScalar(e + i, g + i, v + i, len - i);
+        }
+
+        __attribute__((target("avx2"))) void narrowDeletionAndAlignAvx2(
+            const NarrowScore* vp, const NarrowScore* ep, const NarrowScore* vDiag, const NarrowScore* penalties,
+            NarrowScore* e, NarrowScore* g, int len, NarrowScore gapOpen, NarrowScore gapExt)
+        {
+            const __m256i gapExtV = _mm256_set1_epi8(gapExt);
+            const __m256i gapOpenExtV = _mm256_set1_epi8(saturate(gapOpen + gapExt));
+            int i = 0;
+            for (; i + 32 <= len; i += 32)
+            {
+                const __m256i extended = _mm256_adds_epi8(_mm256_loadu_si256((const __m256i*)(ep + i)), gapExtV);
+                const __m256i opened = _mm256_adds_epi8(_mm256_loadu_si256((const __m256i*)(vp + i)), gapOpenExtV);
+                const __m256i deletion = _mm256_max_epi8(extended, opened);
+                _mm256_storeu_si256(
+                    (__m256i*)(e + i), _mm256_max_epi8(_mm256_loadu_si256((const __m256i*)(e + i)), deletion));
+
+                const __m256i aligned = _mm256_adds_epi8(
+                    _mm256_loadu_si256((const __m256i*)(vDiag + i)),
+                    _mm256_loadu_si256((const __m256i*)(penalties + i)));
+                _mm256_storeu_si256(
+                    (__m256i*)(g + i), _mm256_max_epi8(_mm256_loadu_si256((const __m256i*)(g + i)), aligned));
+            }
+            narrowDeletionAndAlignScalar(
+                vp + i, ep + i, vDiag + i, penalties + i, e + i, g + i, len - i, gapOpen, gapExt);
+        }
+
+        __attribute__((target("avx2"))) void
+        narrowConsolidateAvx2(const NarrowScore* e, const NarrowScore* g, NarrowScore* v, int len)
+        {
+            int i = 0;
+            for (; i + 32 <= len; i += 32)
+            {
+                const __m256i best = _mm256_max_epi8(
+                    _mm256_loadu_si256((const __m256i*)(g + i)), _mm256_loadu_si256((const __m256i*)(e + i)));
+                _mm256_storeu_si256(
+                    (__m256i*)(v + i), _mm256_max_epi8(_mm256_loadu_si256((const __m256i*)(v + i)), best));
+            }
+            narrowConsolidateScalar(e + i, g + i, v + i, len - i);
+        }
+
+        __attribute__((target("avx2"))) void narrowInsertionAcrossLanesAvx2(
+            NarrowScore* f, NarrowScore* v, int len, int lanes, NarrowScore gapOpen, NarrowScore gapExt)
+        {
+            if (lanes % 32)
+            {
+                narrowInsertionAcrossLanesScalar(f, v, len, lanes, gapOpen, gapExt);
+                return;
+            }
+
+            const __m256i gapExtV = _mm256_set1_epi8(gapExt);
+            const __m256i gapOpenExtV = _mm256_set1_epi8(saturate(gapOpen + gapExt));
+            for (int i = 0; i < len * lanes; i += 32)
+            {
+                const __m256i extended = _mm256_adds_epi8(_mm256_loadu_si256((const __m256i*)(f + i - lanes)), gapExtV);
+                const __m256i opened
+                    = _mm256_adds_epi8(_mm256_loadu_si256((const __m256i*)(v + i - lanes)), gapOpenExtV);
+                const __m256i fV = _mm256_max_epi8(
+                    _mm256_loadu_si256((const __m256i*)(f + i)), _mm256_max_epi8(extended, opened));
+                _mm256_storeu_si256((__m256i*)(f + i), fV);
+                _mm256_storeu_si256(
+                    (__m256i*)(v + i), _mm256_max_epi8(_mm256_loadu_si256((const __m256i*)(v + i)), fV));
+            }
+        }
+
+        __attribute__((target("avx512bw"))) void deletionAndAlignAvx512bw(
+            const Score* vp, const Score* ep, const Score* vDiag, const Score* penalties, Score* e, Score* g, int len,
+            Score gapOpen, Score gapExt)
+        {
+            const __m512i gapExtV = _mm512_set1_epi16(gapExt);
+            const __m512i gapOpenExtV = _mm512_set1_epi16(saturateScore(gapOpen + gapExt));
+            for (int i = 0; i < len; i += 32)
+            {
+                // rows are padded to 16 elements only, so the last block may need to be masked
+                const __mmask32 mask = len - i >= 32 ? __mmask32(~0u) : __mmask32((1u << (len - i)) - 1);
+
+                const __m512i extended = _mm512_adds_epi16(_mm512_maskz_loadu_epi16(mask, ep + i), gapExtV);
+                const __m512i opened = _mm512_adds_epi16(_mm512_maskz_loadu_epi16(mask, vp + i), gapOpenExtV);
+                const __m512i deletion = _mm512_max_epi16(extended, opened);
+                _mm512_mask_storeu_epi16(
+                    e + i, mask, _mm512_max_epi16(_mm512_maskz_loadu_epi16(mask, e + i), deletion));
+
+                const __m512i aligned = _mm512_adds_epi16(
+                    _mm512_maskz_loadu_epi16(mask, vDiag + i), _mm512_maskz_loadu_epi16(mask, penalties + i));
+                _mm512_mask_storeu_epi16(
+                    g + i, mask, _mm512_max_epi16(_mm512_maskz_loadu_epi16(mask, g + i), aligned));
+            }
+        }
+
+        __attribute__((target("avx512bw"))) void consolidateAvx512bw(const Score* e, const Score* g, Score* v, int len)
+        {
+            for (int i = 0; i < len; i += 32)
+            {
+                const __mmask32 mask = len - i >= 32 ? __mmask32(~0u) : __mmask32((1u << (len - i)) - 1);
+                const __m512i best
+                    = _mm512_max_epi16(_mm512_maskz_loadu_epi16(mask, g + i), _mm512_maskz_loadu_epi16(mask, e + i));
+                _mm512_mask_storeu_epi16(v + i, mask, _mm512_max_epi16(_mm512_maskz_loadu_epi16(mask, v + i), best));
+            }
+        }
+
+        __attribute__((target("avx512bw"))) void insertionAvx512bw(
+            Score* f, Score* v, int len, Score gapOpen, Score gapExt)
+        {
+            const __m512i minV = _mm512_set1_epi16(SCORE_MIN);
+            const __m512i gapOpenExtV = _mm512_set1_epi16(saturateScore(gapOpen + gapExt));
+            Score laneOffsets[32];
+            Score shiftIndexes[32];
+            for (int lane = 0; lane != 32; ++lane)
+            {
+                laneOffsets[lane] = lane * gapExt;
+                shiftIndexes[lane] = lane;
+            }
+            const __m512i laneOffsetsV = _mm512_loadu_si512(laneOffsets);
+            const __m512i lanesV = _mm512_loadu_si512(shiftIndexes);
+
+            int i = 0;
+            for (; i + 32 <= len; i += 32)
+            {
+                const __m512i carry = _mm512_set1_epi16(saturateScore(f[i - 1] + gapExt));
+                const __m512i fromV = _mm512_adds_epi16(_mm512_loadu_si512(v + i - 1), gapOpenExtV);
+                __m512i scan = _mm512_subs_epi16(_mm512_max_epi16(_mm512_loadu_si512(f + i), fromV), laneOffsetsV);
+                for (int count = 1; count != 32; count *= 2)
+                {
+                    // lanes below count receive SCORE_MIN, the rest the element count lanes below
+                    const __mmask32 shiftedLanes = __mmask32(~0u) << count;
+                    const __m512i shifted = _mm512_mask_permutexvar_epi16(
+                        minV, shiftedLanes, _mm512_sub_epi16(lanesV, _mm512_set1_epi16(Score(count))), scan);
+                    scan = _mm512_max_epi16(scan, shifted);
+                }
+                scan = _mm512_max_epi16(scan, carry);
+
+                const __m512i fV = _mm512_adds_epi16(scan, laneOffsetsV);
+                _mm512_storeu_si512(f + i, fV);
+                _mm512_storeu_si512(v + i, _mm512_max_epi16(_mm512_loadu_si512(v + i), fV));
+            }
+            insertionAvx2(f + i, v + i, len - i, gapOpen, gapExt);
+        }
+
+        __attribute__((target("avx512bw"))) void
+        insertionAcrossLanesAvx512bw(Score* f, Score* v, int len, int lanes, Score gapOpen, Score gapExt)
+        {
+            if (lanes % 32)
+            {
+                insertionAcrossLanesAvx2(f, v, len, lanes, gapOpen, gapExt);
+                return;
+            }
+
+            const __m512i gapExtV = _mm512_set1_epi16(gapExt);
+            const __m512i gapOpenExtV = _mm512_set1_epi16(saturateScore(gapOpen + gapExt));
+            for (int i = 0; i < len * lanes; i += 32)
+            {
+                const __m512i extended = _mm512_adds_epi16(_mm512_loadu_si512(f + i - lanes), gapExtV);
+                const __m512i opened = _mm512_adds_epi16(_mm512_loadu_si512(v + i - lanes), gapOpenExtV);
+                const __m512i fV = _mm512_max_epi16(_mm512_loadu_si512(f + i), _mm512_max_epi16(extended, opened));
+                _mm512_storeu_si512(f + i, fV);
+                _mm512_storeu_si512(v + i, _mm512_max_epi16(_mm512_loadu_si512(v + i), fV));
+            }
+        }
+
+        __attribute__((target("avx512bw"))) void narrowDeletionAndAlignAvx512bw(
+            const NarrowScore* vp, const NarrowScore* ep, const NarrowScore* vDiag, const NarrowScore* penalties,
+            NarrowScore* e, NarrowScore* g, int len, NarrowScore gapOpen, NarrowScore gapExt)
+        {
+            const __m512i gapExtV = _mm512_set1_epi8(gapExt);
+            const __m512i gapOpenExtV = _mm512_set1_epi8(saturate(gapOpen + gapExt));
+            for (int i = 0; i < len; i += 64)
+            {
+                const __mmask64 mask = len - i >= 64 ? __mmask64(~0ull) : __mmask64((1ull << (len - i)) - 1);
+
+                const __m512i extended = _mm512_adds_epi8(_mm512_maskz_loadu_epi8(mask, ep + i), gapExtV);
+                const __m512i opened = _mm512_adds_epi8(_mm512_maskz_loadu_epi8(mask, vp + i), gapOpenExtV);
+                const __m512i deletion = _mm512_max_epi8(extended, opened);
+                _mm512_mask_storeu_epi8(e + i, mask, _mm512_max_epi8(_mm512_maskz_loadu_epi8(mask, e + i), deletion));
+
+                const __m512i aligned = _mm512_adds_epi8(
+                    _mm512_maskz_loadu_epi8(mask, vDiag + i), _mm512_maskz_loadu_epi8(mask, penalties + i));
+                _mm512_mask_storeu_epi8(g + i, mask, _mm512_max_epi8(_mm512_maskz_loadu_epi8(mask, g + i), aligned));
+            }
+        }
+
+        __attribute__((target("avx512bw"))) void
+        narrowConsolidateAvx512bw(const NarrowScore* e, const NarrowScore* g, NarrowScore* v, int len)
+        {
+            for (int i = 0; i < len; i += 64)
+            {
+                const __mmask64 mask = len - i >= 64 ? __mmask64(~0ull) : __mmask64((1ull << (len - i)) - 1);
+                const __m512i best
+                    = _mm512_max_epi8(_mm512_maskz_loadu_epi8(mask, g + i), _mm512_maskz_loadu_epi8(mask, e + i));
+                _mm512_mask_storeu_epi8(v + i, mask, _mm512_max_epi8(_mm512_maskz_loadu_epi8(mask, v + i), best));
+            }
+        }
+
+        __attribute__((target("avx512bw"))) void narrowInsertionAcrossLanesAvx512bw(
+            NarrowScore* f, NarrowScore* v, int len, int lanes, NarrowScore gapOpen, NarrowScore gapExt)
+        {
+            if (lanes % 64)
+            {
+                narrowInsertionAcrossLanesAvx2(f, v, len, lanes, gapOpen, gapExt);
+                return;
+            }
+
+            const __m512i gapExtV = _mm512_set1_epi8(gapExt);
+            const __m512i gapOpenExtV = _mm512_set1_epi8(saturate(gapOpen + gapExt));
+            for (int i = 0; i < len * lanes; i += 64)
+            {
+                const __m512i extended = _mm512_adds_epi8(_mm512_loadu_si512(f + i - lanes), gapExtV);
+                const __m512i opened = _mm512_adds_epi8(_mm512_loadu_si512(v + i - lanes), gapOpenExtV);
+                const __m512i fV = _mm512_max_epi8(_mm512_loadu_si512(f + i), _mm512_max_epi8(extended, opened));
+                _mm512_storeu_si512(f + i, fV);
+                _mm512_storeu_si512(v + i, _mm512_max_epi8(_mm512_loadu_si512(v + i), fV));
+            }
+        }
+
+#endif // GRAPHTOOLS_X86_KERNELS
+
+        const ScoreKernels kScalarKernels = { KernelIsa::kScalar,
+                                              deletionAndAlignScalar,
+                                              consolidateScalar,
+                                              insertionScalar,
+                                              insertionAcrossLanesScalar,
+                                              narrowDeletionAndAlignScalar,
+                                              narrowConsolidateScalar,
+                                              narrowInsertionAcrossLanesScalar };
+#ifdef GRAPHTOOLS_X86_KERNELS
+        const ScoreKernels kAvx2Kernels = { KernelIsa::kAvx2,
+                                            deletionAndAlignAvx2,
+                                            consolidateAvx2,
+                                            insertionAvx2,
+                                            insertionAcrossLanesAvx2,
+                                            narrowDeletionAndAlignAvx2,
+                                            narrowConsolidateAvx2,
+                                            narrowInsertionAcrossLanesAvx2 };
+        const ScoreKernels kAvx512bwKernels = { KernelIsa::kAvx512bw,
+                                                deletionAndAlignAvx512bw,
+                                                consolidateAvx512bw,
+                                                insertionAvx512bw,
+                                                insertionAcrossLanesAvx512bw,
+                                                narrowDeletionAndAlignAvx512bw,
+                                                narrowConsolidateAvx512bw,
+                                                narrowInsertionAcrossLanesAvx512bw };
+#endif
+
+        const ScoreKernels& kernelsFor(KernelIsa isa)
+        {
+            switch (isa)
+            {
+#ifdef GRAPHTOOLS_X86_KERNELS
+            case KernelIsa::kAvx2:
+                return kAvx2Kernels;
+            case KernelIsa::kAvx512bw:
+                return kAvx512bwKernels;
+#endif
+            default:
+                return kScalarKernels;
+            }
+        }
+
+        const ScoreKernels* detectBestKernels()
+        {
+            for (KernelIsa isa : { KernelIsa::kAvx512bw, KernelIsa::kAvx2 })
+            {
+                if (isSupported(isa))
+                {
+                    return &kernelsFor(isa);
+                }
+            }
+            return &kScalarKernels;
+        }
+
+        std::atomic<const ScoreKernels*>& activeKernels()
+        {
+            static std::atomic<const ScoreKernels*> kernels(detectBestKernels());
+            return kernels;
+        }
+    }
+
+    std::string toString(KernelIsa isa)
+    {
+        switch (isa)
+        {
+        case KernelIsa::kAvx2:
+            return "avx2";
+        case KernelIsa::kAvx512bw:
+            return "avx512bw";
+        default:
+            return "scalar";
+        }
+    }
+
+    bool isSupported(KernelIsa isa)
+    {
+        switch (isa)
+        {
+#ifdef GRAPHTOOLS_X86_KERNELS
+        case KernelIsa::kAvx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case KernelIsa::kAvx512bw:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512bw");
+#endif
+        case KernelIsa::kScalar:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    const ScoreKernels& activeScoreKernels() { return *activeKernels().load(std::memory_order_relaxed); }
+
+    void setActiveScoreKernels(KernelIsa isa)
+    {
+        if (!isSupported(isa))
+        {
+            throw std::invalid_argument("Instruction set " + toString(isa) + " is not supported by this CPU");
+        }
+        activeKernels().store(&kernelsFor(isa), std::memory_order_relaxed);
+    }
+
+} // namespace dagAligner
+
+} // namespace graphalign
@@ -44,86 +44,55 @@ using std::vector;
 
 namespace graphtools
 {
-struct Path::Impl
-{
-    Impl(
-        const Graph* new_graph_raw_ptr, int32_t new_start_position, const vector<NodeId>& new_nodes,
-        int32_t new_end_position)
-        : graph_raw_ptr(new_graph_raw_ptr)
-        , start_position(new_start_position)
-        , end_position(new_end_position)
-        , nodes(new_nodes)
-    {
-    }
-    bool isValid() const;
-    bool isNodePositionValid(NodeId node_id, int32_t position) const;
-    bool arePositionsOrdered() const;
-    bool isPathEmpty() const;
-    bool isFirstNodePosValid() const;
-    bool isLastNodePosValid() const;
-    bool isPathConnected() const;
-    string encode() const;
-    void assertThatIndexIsValid(int32_t node_index) const
-    {
-        if (node_index < 0 || node_index >= (signed)nodes.size())
-        {
-            const string msg = "Node index " + to_string(node_index) + "is out of bounds for path " + encode();
-            throw std::logic_error(msg);
-        }
-    }
-
-    bool operator==(const Impl& other) const
+void Path::assertThatIndexIsValid(int32_t node_index) const
+{
+    if (node_index < 0 || node_index >= (signed)nodes_.size())
     {
-        return (graph_raw_ptr == other.graph_raw_ptr) && (start_position == other.start_position)
-            && (end_position == other.end_position) && (nodes == other.nodes);
+        const string msg = "Node index " + to_string(node_index) + "is out of bounds for path " + encode();
+        throw std::logic_error(msg);
     }
+}
 
-    const Graph* const graph_raw_ptr;
-    int32_t start_position;
-    int32_t end_position;
-    vector<NodeId> nodes;
-};
-
-bool Path::Impl::isValid() const
+bool Path::isValid() const
 {
     return !isPathEmpty() && isFirstNodePosValid() && isLastNodePosValid() && arePositionsOrdered()
         && isPathConnected();
 }
 
-bool Path::Impl::arePositionsOrdered() const { return nodes.size() != 1 || start_position <= end_position; }
+bool Path::arePositionsOrdered() const { return nodes_.size() != 1 || start_position_ <= end_position_; }
 
-bool Path::Impl::isNodePositionValid(NodeId node_id, int32_t position) const
+bool Path::isNodePositionValid(NodeId node_id, int32_t position) const
 {
     if (position < 0)
     {
         return false;
     }
-    const string& node_seq = graph_raw_ptr->nodeSeq(node_id);
+    const string& node_seq = graph_raw_ptr_->nodeSeq(node_id);
     return (unsigned)position <= node_seq.length();
 }
 
-bool Path::Impl::isPathEmpty() const { return nodes.empty(); }
+bool Path::isPathEmpty() const { return nodes_.empty(); }
 
-bool Path::Impl::isFirstNodePosValid() const
+bool Path::isFirstNodePosValid() const
 {
-    const NodeId first_node_id = nodes.front();
-    return isNodePositionValid(first_node_id, start_position);
+    const NodeId first_node_id = nodes_.front();
+    return isNodePositionValid(first_node_id, start_position_);
 }
 
-bool Path::Impl::isLastNodePosValid() const
+bool Path::isLastNodePosValid() const
 {
-    const NodeId last_node_id = nodes.back();
-    return isNodePositionValid(last_node_id, end_position);
+    const NodeId last_node_id = nodes_.back();
+    return isNodePositionValid(last_node_id, end_position_);
 }
 
-bool Path::Impl::isPathConnected() const
+bool Path::isPathConnected() const
 {
-    vector<NodeId>::const_iterator start_iter;
-    vector<NodeId>::const_iterator end_iter;
-    for (start_iter = nodes.begin(); start_iter != std::prev(nodes.end()); ++start_iter)
+    const_iterator start_iter;
+    const_iterator end_iter;
+    for (start_iter = nodes_.begin(); start_iter != std::prev(nodes_.end()); ++start_iter)
     {
         end_iter = std::next(start_iter);
-        if (!graph_raw_ptr->hasEdge(*start_iter, *end_iter))
+        if (!graph_raw_ptr_->hasEdge(*start_iter, *end_iter))
         {
             return false;
         }
@@ -131,23 +100,23 @@ bool Path::Impl::isPathConnected() const
     return true;
 }
 
-string Path::Impl::encode() const
+string Path::encode() const
 {
     string path_encoding;
 
     size_t node_index = 0;
-    const size_t last_index = nodes.size() - 1;
-    for (NodeId node_id : nodes)
+    const size_t last_index = nodes_.size() - 1;
+    for (NodeId node_id : nodes_)
     {
         const string node_name = to_string(node_id);
         string node_encoding;
         if (node_index == 0) // Encoding first node.
         {
-            node_encoding = "(" + node_name + "@" + to_string(start_position) + ")";
+            node_encoding = "(" + node_name + "@" + to_string(start_position_) + ")";
         }
         if (node_index == last_index) // Encoding last node.
         {
-            node_encoding += "-(" + node_name + "@" + to_string(end_position) + ")";
+            node_encoding += "-(" + node_name + "@" + to_string(end_position_) + ")";
         }
         if (node_index != 0 && node_index != last_index) // Encoding intermediate node.
         {
@@ -160,66 +129,39 @@ string Path::Impl::encode() const
     return path_encoding;
 }
 
-string Path::encode() const { return pimpl_->encode(); }
-
 Path::Path(const Graph* graph_raw_ptr, int32_t start_position, const vector<NodeId>& nodes, int32_t end_position)
-    : pimpl_(new Impl(graph_raw_ptr, start_position, nodes, end_position))
+    : graph_raw_ptr_(graph_raw_ptr)
+    , start_position_(start_position)
+    , end_position_(end_position)
+    , nodes_(nodes)
 {
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot create invalid path");
     }
 }
 
-Path::~Path() = default;
+Path::const_iterator Path::begin() const { return nodes_.begin(); }
+Path::const_iterator Path::end() const { return nodes_.end(); }
 
-Path::Path(const Path& other)
-    : pimpl_(new Impl(*other.pimpl_))
-{
-}
+int32_t Path::startPosition() const { return start_position_; }
+int32_t Path::endPosition() const { return end_position_; }
+const Graph* Path::graphRawPtr() const { return graph_raw_ptr_; }
 
-Path::Path(Path&& other) noexcept
-    : pimpl_(std::move(other.pimpl_))
-{
-}
+Path::NodeIdList const& Path::nodeIds() const { return nodes_; }
 
-Path& Path::operator=(const Path& other)
-{
-    if (this != &other)
-    {
-        pimpl_.reset(new Impl(*other.pimpl_));
-    }
-    return *this;
-}
-
-Path::const_iterator Path::begin() const { return pimpl_->nodes.begin(); }
-Path::const_iterator Path::end() const { return pimpl_->nodes.end(); }
-
-Path& Path::operator=(Path&& other) noexcept
-{
-    pimpl_ = std::move(other.pimpl_);
-    return *this;
-}
-
-int32_t Path::startPosition() const { return pimpl_->start_position; }
-int32_t Path::endPosition() const { return pimpl_->end_position; }
-const Graph* Path::graphRawPtr() const { return pimpl_->graph_raw_ptr; }
-
-vector<NodeId> const& Path::nodeIds() const { return pimpl_->nodes; }
+size_t Path::numNodes() const { return nodes_.size(); }
 
-size_t Path::numNodes() const { return pimpl_->nodes.size(); }
-
-NodeId Path::getNodeIdByIndex(size_t node_index) const { return pimpl_->nodes[node_index]; }
+NodeId Path::getNodeIdByIndex(size_t node_index) const { return nodes_[node_index]; }
 
 bool Path::checkOverlapWithNode(NodeId node_id) const
 {
-    const vector<NodeId>& nodes = pimpl_->nodes;
-    return std::find(nodes.begin(), nodes.end(), node_id) != nodes.end();
+    return std::find(nodes_.begin(), nodes_.end(), node_id) != nodes_.end();
 }
 
 int32_t Path::getStartPositionOnNodeByIndex(size_t node_index) const
 {
-    pimpl_->assertThatIndexIsValid(static_cast<int32_t>(node_index));
+    assertThatIndexIsValid(static_cast<int32_t>(node_index));
 
     if (node_index == 0)
     {
@@ -231,14 +173,14 @@ int32_t Path::getStartPositionOnNodeByIndex(size_t node_index) const
 
 int32_t Path::getEndPositionOnNodeByIndex(size_t node_index) const
 {
-    pimpl_->assertThatIndexIsValid(static_cast<int32_t>(node_index));
+    assertThatIndexIsValid(static_cast<int32_t>(node_index));
 
     if (node_index == numNodes() - 1)
     {
         return endPosition();
     }
 
-    const int32_t node_id = pimpl_->nodes[node_index];
+    const int32_t node_id = nodes_[node_index];
     const size_t node_length = graphRawPtr()->nodeSeq(static_cast<NodeId>(node_id)).length();
 
     return node_length;
@@ -246,8 +188,8 @@ int32_t Path::getEndPositionOnNodeByIndex(size_t node_index) const
 
 size_t Path::getNodeOverlapLengthByIndex(size_t node_index) const
 {
-    pimpl_->assertThatIndexIsValid(static_cast<int32_t>(node_index));
-    const int32_t node_id = pimpl_->nodes[node_index];
+    assertThatIndexIsValid(static_cast<int32_t>(node_index));
+    const int32_t node_id = nodes_[node_index];
     const size_t node_length = graphRawPtr()->nodeSeq(static_cast<NodeId>(node_id)).length();
     auto length_on_node = (int32_t)node_length; // This is the length of all intermediate nodes.
 
@@ -256,15 +198,15 @@ size_t Path::getNodeOverlapLengthByIndex(size_t node_index) const
 
     if (is_first_node && is_last_node)
     {
-        length_on_node = pimpl_->end_position - pimpl_->start_position;
+        length_on_node = end_position_ - start_position_;
     }
     else if (is_first_node)
     {
-        length_on_node = static_cast<int32_t>(node_length - pimpl_->start_position);
+        length_on_node = static_cast<int32_t>(node_length - start_position_);
     }
     else if (is_last_node)
     {
-        length_on_node = pimpl_->end_position;
+        length_on_node = end_position_;
     }
 
     return static_cast<size_t>(length_on_node);
@@ -277,10 +219,10 @@ int32_t Path::getDistanceFromPathStart(NodeId node, int32_t offset) const
     bool found = false;
     while (n < numNodes())
     {
-        const auto node_id = pimpl_->nodes[n];
-        const int32_t node_start = n == 0 ? pimpl_->start_position : 0;
+        const auto node_id = nodes_[n];
+        const int32_t node_start = n == 0 ? start_position_ : 0;
         const int32_t node_end
-            = n == numNodes() - 1 ? pimpl_->end_position : (int32_t)pimpl_->graph_raw_ptr->nodeSeq(node_id).size() - 1;
+            = n == numNodes() - 1 ? end_position_ : (int32_t)graph_raw_ptr_->nodeSeq(node_id).size() - 1;
 
         if (node_id == node && offset >= node_start && offset <= node_end)
         {
@@ -302,7 +244,7 @@ int32_t Path::getDistanceFromPathStart(NodeId node, int32_t offset) const
 size_t Path::length() const
 {
     size_t path_length = 0;
-    for (int32_t node_index = 0; node_index != (signed)pimpl_->nodes.size(); ++node_index)
+    for (int32_t node_index = 0; node_index != (signed)nodes_.size(); ++node_index)
     {
         path_length += getNodeOverlapLengthByIndex(static_cast<size_t>(node_index));
     }
@@ -312,15 +254,15 @@ size_t Path::length() const
 
 string Path::getNodeSeq(size_t node_index) const
 {
-    auto node_id = static_cast<int32_t>(pimpl_->nodes[node_index]);
-    const string& sequence = pimpl_->graph_raw_ptr->nodeSeq(static_cast<NodeId>(node_id));
+    auto node_id = static_cast<int32_t>(nodes_[node_index]);
+    const string& sequence = graph_raw_ptr_->nodeSeq(static_cast<NodeId>(node_id));
 
     if (node_index == 0)
     {
         const size_t node_overlap_len = getNodeOverlapLengthByIndex(node_index);
-        return sequence.substr(static_cast<unsigned long>(pimpl_->start_position), node_overlap_len);
+        return sequence.substr(static_cast<unsigned long>(start_position_), node_overlap_len);
     }
-    else if ((size_t)node_index == pimpl_->nodes.size() - 1)
+    else if ((size_t)node_index == nodes_.size() - 1)
     {
         const size_t node_overlap_len = getNodeOverlapLengthByIndex(node_index);
         return sequence.substr(0, node_overlap_len);
@@ -335,18 +277,18 @@ string Path::seq() const
 {
     string path_seq;
     size_t node_index = 0;
-    for (NodeId node_id : pimpl_->nodes)
+    for (NodeId node_id : nodes_)
     {
-        string node_seq = pimpl_->graph_raw_ptr->nodeSeq(node_id);
+        string node_seq = graph_raw_ptr_->nodeSeq(node_id);
         if (node_index == 0)
         {
-            node_seq = node_seq.substr(static_cast<unsigned long>(pimpl_->start_position));
+            node_seq = node_seq.substr(static_cast<unsigned long>(start_position_));
         }
 
-        if (node_index == pimpl_->nodes.size() - 1)
+        if (node_index == nodes_.size() - 1)
         {
-            const int32_t end_node_start = pimpl_->nodes.size() == 1 ? pimpl_->start_position : 0;
-            const int32_t segment_len = pimpl_->end_position - end_node_start;
+            const int32_t end_node_start = nodes_.size() == 1 ? start_position_ : 0;
+            const int32_t segment_len = end_position_ - end_node_start;
             node_seq = node_seq.substr(0, (unsigned long)segment_len);
         }
 
@@ -356,14 +298,18 @@ string Path::seq() const
     return path_seq;
 }
 
-bool Path::operator==(const Path& other) const { return *pimpl_ == *other.pimpl_; }
+bool Path::operator==(const Path& other) const
+{
+    return (graph_raw_ptr_ == other.graph_raw_ptr_) && (start_position_ == other.start_position_)
+        && (end_position_ == other.end_position_) && (nodes_ == other.nodes_);
+}
 
 ostream& operator<<(ostream& os, const Path& path) { return os << path.encode(); }
 
 void Path::shiftStartAlongNode(int32_t shift_len)
 {
-    pimpl_->start_position -= shift_len;
-    if (!pimpl_->isValid())
+    start_position_ -= shift_len;
+    if (!isValid())
     {
         throw std::logic_error("Cannot move start by " + to_string(shift_len));
     }
@@ -371,9 +317,9 @@ void Path::shiftStartAlongNode(int32_t shift_len)
 
 void Path::shiftEndAlongNode(int32_t shift_len)
 {
-    pimpl_->end_position += shift_len;
+    end_position_ += shift_len;
 
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot move end by " + to_string(shift_len));
     }
@@ -381,11 +327,11 @@ void Path::shiftEndAlongNode(int32_t shift_len)
 
 void Path::extendStartToNode(NodeId node_id)
 {
-    pimpl_->nodes.insert(pimpl_->nodes.begin(), node_id);
-    const auto new_node_seq_len = static_cast<int32_t>(pimpl_->graph_raw_ptr->nodeSeq(node_id).length());
-    pimpl_->start_position = new_node_seq_len;
+    nodes_.insert(nodes_.begin(), node_id);
+    const auto new_node_seq_len = static_cast<int32_t>(graph_raw_ptr_->nodeSeq(node_id).length());
+    start_position_ = new_node_seq_len;
 
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot extend to node " + to_string(node_id));
     }
@@ -393,10 +339,10 @@ void Path::extendStartToNode(NodeId node_id)
 
 void Path::extendStartToIncludeNode(NodeId node_id)
 {
-    pimpl_->nodes.insert(pimpl_->nodes.begin(), node_id);
-    pimpl_->start_position = 0;
+    nodes_.insert(nodes_.begin(), node_id);
+    start_position_ = 0;
 
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot extend to node " + to_string(node_id));
     }
@@ -404,10 +350,10 @@ void Path::extendStartToIncludeNode(NodeId node_id)
 
 void Path::removeStartNode()
 {
-    pimpl_->nodes.erase(pimpl_->nodes.begin());
-    pimpl_->start_position = 0;
+    nodes_.erase(nodes_.begin());
+    start_position_ = 0;
 
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot remove start node of " + encode());
     }
@@ -432,10 +378,10 @@ void Path::removeZeroLengthEnd()
 
 void Path::extendEndToNode(NodeId node_id)
 {
-    pimpl_->nodes.push_back(node_id);
-    pimpl_->end_position = 0;
+    nodes_.push_back(node_id);
+    end_position_ = 0;
 
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot extend right to node " + to_string(node_id));
     }
@@ -443,11 +389,11 @@ void Path::extendEndToNode(NodeId node_id)
 
 void Path::extendEndToIncludeNode(NodeId node_id)
 {
-    pimpl_->nodes.push_back(node_id);
-    const auto new_node_seq_len = static_cast<int32_t>(pimpl_->graph_raw_ptr->nodeSeq(node_id).length());
-    pimpl_->end_position = new_node_seq_len;
+    nodes_.push_back(node_id);
+    const auto new_node_seq_len = static_cast<int32_t>(graph_raw_ptr_->nodeSeq(node_id).length());
+    end_position_ = new_node_seq_len;
 
-    if (!pimpl_->isValid())
+    if (!isValid())
     {
         throw std::logic_error("Cannot extend right to node " + to_string(node_id));
     }
@@ -455,11 +401,11 @@ void Path::extendEndToIncludeNode(NodeId node_id)
 
 void Path::removeEndNode()
 {
-    pimpl_->nodes.erase(pimpl_->nodes.end() - 1);
-    NodeId new_last_node_id = pimpl_->nodes.back();
-    auto new_last_node_len = static_cast<int32_t>(pimpl_->graph_raw_ptr->nodeSeq(new_last_node_id).length());
-    pimpl_->end_position = new_last_node_len;
-    if (!pimpl_->isValid())
+    nodes_.erase(nodes_.end() - 1);
+    NodeId new_last_node_id = nodes_.back();
+    auto new_last_node_len = static_cast<int32_t>(graph_raw_ptr_->nodeSeq(new_last_node_id).length());
+    end_position_ = new_last_node_len;
+    if (!isValid())
     {
         throw std::logic_error("Cannot remove end node of  " + encode());
     }
@@ -485,7 +431,7 @@ void Path::shrinkStartBy(int32_t shrink_len)
 
 void Path::shrinkEndBy(int32_t shrink_len)
 {
-    const int32_t node_len_left = pimpl_->end_position;
+    const int32_t node_len_left = end_position_;
 
     if (shrink_len <= node_len_left)
     {
@@ -509,16 +455,16 @@ void Path::shrinkBy(int32_t start_shrink_len, int32_t end_shrink_len)
 
 bool Path::operator<(const Path& other) const
 {
-    if (pimpl_->start_position != other.pimpl_->start_position)
+    if (start_position_ != other.start_position_)
     {
-        return pimpl_->start_position < other.pimpl_->start_position;
+        return start_position_ < other.start_position_;
     }
 
-    if (pimpl_->nodes != other.pimpl_->nodes)
+    if (nodes_ != other.nodes_)
     {
-        return pimpl_->nodes < other.pimpl_->nodes;
+        return nodes_ < other.nodes_;
     }
 
-    return pimpl_->end_position < other.pimpl_->end_position;
+    return end_position_ < other.end_position_;
 }
 }
@@ -28,6 +28,8 @@
 
 #include "graphalign/DagAlignerAffine.hh"
 
+#include <random>
+
 #include "gtest/gtest.h"
 
 using std::string;
@@ -781,3 +783,92 @@ TEST(RepeatExpansion, two_repeats)
     EXPECT_EQ(32, bestScore);
     EXPECT_EQ("6[1=]7[3=]8[3=]5[1D1=]", toString(cigars.at(0)));
 }
+
+/*
+ *     _
+ *    / \
+ *  G-TCC-AAAAA
+ */
+TEST(BandedAlignment, RepeatQueriesWithErrors_SameAlignmentsAsFullMatrixWhenBandHoldsThem)
+{
+    DagAligner<true> aligner({ 5, -4 }, -8, -2);
+    BandedDagAligner<true> bandedAligner({ 5, -4 }, -8, -2);
+
+    const string reference = "GTCCTCCTCCTCCTCCAAAAA";
+    EdgeMap edges(
+        std::vector<std::pair<int, int>>({ { 0, 1 },
+                                           { 3, 4 },
+                                           { 6, 7 },
+                                           { 9, 10 },
+                                           { 12, 13 },
+                                           { 3, 16 },
+                                           { 6, 16 },
+                                           { 9, 16 },
+                                           { 12, 16 },
+                                           { 15, 16 },
+                                           { reference.length(), reference.length() } }),
+        std::vector<int>({ 0, 1, 2, 3, 4, 5, 6 }));
+
+    std::mt19937 generator(42);
+    int bandedQueries = 0;
+    for (int iteration = 0; iteration != 200; ++iteration)
+    {
+        string query = "G" + string("TCCTCCTCCTCC").substr(0, 3 * (generator() % 5)) + "AAAAA";
+        for (int error = generator() % 4; error; --error)
+        {
+            const std::size_t pos = generator() % query.length();
+            switch (generator() % 3)
+            {
+            case 0:
+                query[pos] = "ACGT"[generator() % 4];
+                break;
+            case 1:
+                query.insert(pos, 1, "ACGT"[generator() % 4]);
+                break;
+            default:
+                query.erase(pos, 1 < query.length());
+            }
+        }
+
+        aligner.align(query.begin(), query.end(), reference.begin(), reference.end(), edges);
+        std::vector<Cigar> cigars;
+        Score secondBestScore = 0;
+        const Score bestScore = aligner.backtrackAllPaths<false>(edges, cigars, secondBestScore);
+
+        for (const int bandWidth : { 0, 1, 3 })
+        {
+            if (bandedAligner.alignBanded<false>(
+                    query.begin(), query.end(), reference.begin(), reference.end(), edges, bandWidth))
+            {
+                ++bandedQueries;
+                std::vector<Cigar> bandedCigars;
+                EXPECT_EQ(bestScore, bandedAligner.backtrackAllPaths<false>(edges, bandedCigars, secondBestScore))
+                    << query;
+                EXPECT_EQ(cigars, bandedCigars) << query << " band " << bandWidth;
+            }
+        }
+    }
+    EXPECT_LT(200, bandedQueries);
+}
+
+TEST(BandedAlignment, LongInsertion_BandTooNarrow)
+{
+    BandedDagAligner<true> bandedAligner({ 5, -4 }, -8, -2);
+
+    const string reference = "GTCCAAAAA";
+    EdgeMap edges(
+        std::vector<std::pair<int, int>>({ { reference.length(), reference.length() } }), std::vector<int>({ 0 }));
+
+    const string query = "GTCCTTTTTTAAAAA";
+    EXPECT_FALSE(
+        bandedAligner.alignBanded<false>(query.begin(), query.end(), reference.begin(), reference.end(), edges, 2));
+    // band covers the whole matrix
+    const int bandWidth = query.length() + reference.length();
+    EXPECT_TRUE(bandedAligner.alignBanded<false>(
+        query.begin(), query.end(), reference.begin(), reference.end(), edges, bandWidth));
+
+    std::vector<Cigar> cigars;
+    Score secondBestScore = 0;
+    EXPECT_EQ(45 - 8 - 12, bandedAligner.backtrackAllPaths<false>(edges, cigars, secondBestScore));
+    EXPECT_EQ("0[4=6I5=]", toString(cigars.at(0)));
+}
@@ -188,3 +188,24 @@ TEST(GraphAlignment, PolyalanineGraph_BestAlignmentObtained)
         EXPECT_EQ(expected_alignments, alignments);
     }
 }
+
+TEST(GraphAlignmentWithinMismatches, TypicalStrGraph_BestAlignmentsWithinBoundObtained)
+{
+    Graph graph = makeStrGraph("AAAACG", "CCG", "ATTT");
+    const int32_t kmer_len = 3;
+    GaplessAligner aligner(&graph, kmer_len);
+
+    {
+        const string repeat_read = "CGCCGCCGCCG";
+        list<GraphAlignment> expected_alignments = { decodeGraphAlignment(4, "0[2M]1[3M]1[3M]1[3M]", &graph),
+                                                     decodeGraphAlignment(1, "1[2M]1[3M]1[3M]1[3M]", &graph) };
+        EXPECT_EQ(expected_alignments, aligner.align(repeat_read, 0));
+    }
+
+    {
+        const string repeat_read = "CCGACGCCTCCG";
+        list<GraphAlignment> expected_alignments = { decodeGraphAlignment(0, "1[3M]1[1X2M]1[2M1X]1[3M]", &graph) };
+        EXPECT_EQ(expected_alignments, aligner.align(repeat_read, 2));
+        EXPECT_TRUE(aligner.align(repeat_read, 1).empty());
+    }
+}
@@ -255,5 +255,100 @@ TEST_P(AlignerTests, PerformingGappedAlignment_IncorrectSeedKmer_ReadAligned)
     }
 }
 
+TEST_P(AlignerTests, AligningBatch_ReadsSharingSeeds_SameAlignmentsAsSingleReads)
+{
+    Graph graph = makeStrGraph("TTGACCTAGCATTCAGGCT", "CAG", "GTCCAATGCGATTACAGGA");
+    GappedGraphAligner aligner(&graph, 6, 4, 0, GetParam());
+
+    // reads start at a few positions only, so that many of them extend the same seeds by the same length
+    const string left_flank = graph.nodeSeq(0);
+    const string right_flank = graph.nodeSeq(2);
+    std::vector<string> queries;
+    for (int read = 0; read != 40; ++read)
+    {
+        string repeat;
+        for (int unit = 0; unit != 3 + read % 5; ++unit)
+        {
+            repeat += "CAG";
+        }
+        string query = left_flank.substr(4 + read % 3 * 3) + repeat + right_flank.substr(0, 10);
+        // sprinkle mismatches and an insertion
+        query[read % query.length()] = 'A';
+        if (!(read % 4))
+        {
+            query.insert(query.length() / 2, "T");
+        }
+        queries.push_back(query);
+    }
+    queries.push_back("NNNNNNNNNNNN");
+
+    const std::vector<list<GraphAlignment>> batch_alignments = aligner.alignBatch(queries);
+
+    ASSERT_EQ(queries.size(), batch_alignments.size());
+    for (std::size_t query = 0; query != queries.size(); ++query)
+    {
+        EXPECT_EQ(aligner.align(queries[query]), batch_alignments[query]) << queries[query];
+    }
+}
+
+TEST_P(AlignerTests, AligningBatch_ReadsWithIndelsFromAllStartPositions_SameAlignmentsAsSingleReads)
+{
+    const string left_flank = "GCCTCTGAGCGGGCGGGCCGGCCATTTCAGGCTGCGGGATAGGTCC";
+    const string right_flank = "CCGCCGCCGCCTCCTCAGCTTCCTCAGCGCGCTTGATGCACATCTGGTCAGTTCCAGGAACATGGCATGC";
+    Graph graph = makeStrGraph(left_flank, "CGG", right_flank);
+    GappedGraphAligner aligner(&graph, 14, 10, 5, GetParam());
+
+    string haplotype = left_flank;
+    for (int unit = 0; unit != 15; ++unit)
+    {
+        haplotype += "CGG";
+    }
+    haplotype += right_flank;
+
+    // 60bp reads starting at every position of the haplotype with sequencing errors and indels, so that pieces
+    // extending the same seed have different lengths
+    const int read_len = 60;
+    std::vector<string> queries;
+    for (std::size_t start = 0; start + read_len <= haplotype.length(); ++start)
+    {
+        string query = haplotype.substr(start, read_len);
+        if (!(start % 3))
+        {
+            query[(start * 7) % read_len] = query[(start * 7) % read_len] == 'A' ? 'T' : 'A';
+        }
+        if (start % 5 == 1)
+        {
+            query.erase(20 + start % 20, 4);
+        }
+        if (start % 7 == 2)
+        {
+            query.insert(25 + start % 15, "TTT");
+        }
+        // deletion from the right flank longer than the padding
+        const std::size_t deletion_start = left_flank.length() + 45 + 20;
+        if (start % 4 == 1 && start < deletion_start && deletion_start + 12 + 15 <= start + read_len)
+        {
+            query.erase(deletion_start - start, 12);
+        }
+        queries.push_back(query);
+    }
+
+    const std::vector<list<GraphAlignment>> batch_alignments = aligner.alignBatch(queries);
+
+    ASSERT_EQ(queries.size(), batch_alignments.size());
+    for (std::size_t query = 0; query != queries.size(); ++query)
+    {
+        EXPECT_EQ(aligner.align(queries[query]), batch_alignments[query]) << queries[query];
+    }
+
+    // reads starting within the repeat are seeded where it meets the right flank, so their pieces of equal lengths
+    // share targets
+    if ("dag-aligner" == GetParam())
+    {
+        EXPECT_EQ(161ul, aligner.batchStats().pieces);
+        EXPECT_EQ(89ul, aligner.batchStats().batches);
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(
     AlignerTestsInst, AlignerTests, ::testing::Values(std::string("path-aligner"), std::string("dag-aligner")), );
@@ -81,3 +81,144 @@ TEST(SimpleGraph, AlignPrefix)
     EXPECT_EQ("(0@2)-(2)-(3@2)", toString(res.front().first));
     EXPECT_EQ("2M", res.front().second.generateCigar());
 }
+
+TEST(CachingUnrolledTargets, RepeatedSeedPosition_TargetReused)
+{
+    Graph graph = makeSwapGraph("AAAA", "C", "T", "GGGG");
+    graph.addEdge(1, 1);
+    Path seed(&graph, 1, { 0 }, 3);
+    PinnedDagAligner dag_pinned_aligner(1, -1, 0, -2);
+
+    int32_t first_score = INT32_MIN;
+    const auto first_res = dag_pinned_aligner.prefixAlign(seed, "ACGG", 8, first_score);
+    int32_t second_score = INT32_MIN;
+    const auto second_res = dag_pinned_aligner.prefixAlign(seed, "ACGG", 8, second_score);
+    int32_t suffix_score = INT32_MIN;
+    dag_pinned_aligner.suffixAlign(seed, "A", 8, suffix_score);
+
+    EXPECT_EQ(first_score, second_score);
+    EXPECT_EQ(first_res, second_res);
+    EXPECT_EQ(1ul, dag_pinned_aligner.targetCacheStats().hits);
+    EXPECT_EQ(2ul, dag_pinned_aligner.targetCacheStats().misses);
+    EXPECT_EQ(2ul, dag_pinned_aligner.targetCacheStats().entries);
+}
+
+TEST(CachingUnrolledTargets, TargetsExceedingMemoryBound_NotCached)
+{
+    Graph graph = makeSwapGraph("AAAA", "C", "T", "GGGG");
+    graph.addEdge(1, 1);
+    Path seed(&graph, 1, { 0 }, 3);
+    PinnedDagAligner dag_pinned_aligner(1, -1, 0, -2, 0);
+
+    int32_t score = INT32_MIN;
+    const auto res = dag_pinned_aligner.prefixAlign(seed, "ACGG", 8, score);
+    dag_pinned_aligner.prefixAlign(seed, "ACGG", 8, score);
+
+    EXPECT_EQ(4, score);
+    EXPECT_EQ("(0@1)-(1)-(3@2)", toString(res.front().first));
+    EXPECT_EQ(0ul, dag_pinned_aligner.targetCacheStats().hits);
+    EXPECT_EQ(0ul, dag_pinned_aligner.targetCacheStats().entries);
+    EXPECT_EQ(0ul, dag_pinned_aligner.targetCacheStats().bytes);
+}
+
+TEST(AligningBatches, QueryPiecesFromSameSeed_SameAlignmentsAsSinglePieces)
+{
+    Graph graph = makeSwapGraph("AAAA", "C", "T", "GGGG");
+    graph.addEdge(1, 1);
+    Path seed(&graph, 1, { 0 }, 3);
+    PinnedDagAligner dag_pinned_aligner(1, -1, 0, -2);
+
+    // more pieces than fit in one batch
+    std::vector<string> pieces;
+    for (int piece = 0; piece != PinnedDagAligner::kBatchSize + 3; ++piece)
+    {
+        pieces.push_back(string("ACCCCGGGG").substr(0, 2 + piece % 7) + (piece % 2 ? "G" : "T"));
+    }
+
+    std::vector<int32_t> prefix_scores;
+    const auto prefix_res = dag_pinned_aligner.prefixAlignBatch(seed, pieces, 12, prefix_scores);
+    std::vector<int32_t> suffix_scores;
+    const auto suffix_res = dag_pinned_aligner.suffixAlignBatch(seed, pieces, 12, suffix_scores);
+
+    ASSERT_EQ(pieces.size(), prefix_res.size());
+    ASSERT_EQ(pieces.size(), suffix_res.size());
+    for (std::size_t piece = 0; piece != pieces.size(); ++piece)
+    {
+        int32_t score = INT32_MIN;
+        EXPECT_EQ(dag_pinned_aligner.prefixAlign(seed, pieces[piece], 12, score), prefix_res[piece]) << pieces[piece];
+        EXPECT_EQ(score, prefix_scores[piece]);
+        EXPECT_EQ(dag_pinned_aligner.suffixAlign(seed, pieces[piece], 12, score), suffix_res[piece]) << pieces[piece];
+        EXPECT_EQ(score, suffix_scores[piece]);
+    }
+}
+
+TEST(AligningBatches, PiecesOfAllScorePrecisions_SameAlignmentsAsSinglePieces)
+{
+    Graph graph = makeStrGraph("TTTTACGT", "CAG", "ATTGGCAT");
+    Path seed(&graph, 1, { 1 }, 3);
+    PinnedDagAligner dag_pinned_aligner(5, -4, -8, -2);
+
+    std::vector<string> pieces;
+    // short pieces that align well get exact 8-bit scores
+    for (int len = 1; len != 25; ++len)
+    {
+        pieces.push_back(string("CAGCAGCAGCAGCAGCAGCAGCAGC").substr(0, len));
+    }
+    // short pieces that align poorly saturate 8-bit scores at the bottom
+    for (int len = 20; len != 25; ++len)
+    {
+        pieces.push_back(string(len, 'T'));
+    }
+    // longer pieces that align well saturate 8-bit scores at the top
+    for (int len = 26; len < 40; len += 4)
+    {
+        pieces.push_back(string("CAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAG").substr(0, len));
+    }
+    // saturates at the top, then mismatches bring the best score back into the 8-bit range
+    pieces.push_back(string("CAGCAGCAGCAGCAGCAGCAGCAGCAG") + "TTTTTT");
+    // pieces too long to pass the saturation checks get 16-bit scores straight away
+    for (int len = 52; len < 60; len += 4)
+    {
+        pieces.push_back(string("CAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAGCAG").substr(0, len));
+    }
+
+    std::vector<int32_t> prefix_scores;
+    const auto prefix_res = dag_pinned_aligner.prefixAlignBatch(seed, pieces, 70, prefix_scores);
+
+    EXPECT_EQ(34ul, dag_pinned_aligner.scorePrecisionStats().narrowPieces);
+    EXPECT_EQ(10ul, dag_pinned_aligner.scorePrecisionStats().narrowOverflows);
+    EXPECT_EQ(2ul, dag_pinned_aligner.scorePrecisionStats().widePieces);
+
+    std::vector<int32_t> suffix_scores;
+    const auto suffix_res = dag_pinned_aligner.suffixAlignBatch(seed, pieces, 70, suffix_scores);
+
+    ASSERT_EQ(pieces.size(), prefix_res.size());
+    ASSERT_EQ(pieces.size(), suffix_res.size());
+    for (std::size_t piece = 0; piece != pieces.size(); ++piece)
+    {
+        int32_t score = INT32_MIN;
+        EXPECT_EQ(dag_pinned_aligner.prefixAlign(seed, pieces[piece], 70, score), prefix_res[piece]) << pieces[piece];
+        EXPECT_EQ(score, prefix_scores[piece]);
+        EXPECT_EQ(dag_pinned_aligner.suffixAlign(seed, pieces[piece], 70, score), suffix_res[piece]) << pieces[piece];
+        EXPECT_EQ(score, suffix_scores[piece]);
+    }
+}
+
+TEST(AligningWithinBand, PiecesWithFewAndManyGaps_BandUsedForFewOnly)
+{
+    Graph graph = makeStrGraph("TTTTACGT", "CAG", "ATTGGCAT");
+    Path seed(&graph, 0, { 0 }, 8);
+    PinnedDagAligner dag_pinned_aligner(5, -4, -8, -2);
+
+    int32_t score = INT32_MIN;
+    const auto few_gaps = dag_pinned_aligner.prefixAlign(seed, "CAGCAGCAGATTGG", 24, score);
+    EXPECT_EQ(70, score);
+    EXPECT_EQ(1ul, dag_pinned_aligner.bandStats().bandedPieces);
+    EXPECT_EQ(0ul, dag_pinned_aligner.bandStats().bandFallbacks);
+
+    // insertion longer than the 2 bases of padding
+    const auto many_gaps = dag_pinned_aligner.prefixAlign(seed, "CAGCAGTTTTTTTTCAGATTGG", 24, score);
+    EXPECT_EQ(70 - 8 - 16, score);
+    EXPECT_EQ(2ul, dag_pinned_aligner.bandStats().bandedPieces);
+    EXPECT_EQ(1ul, dag_pinned_aligner.bandStats().bandFallbacks);
+}
@@ -0,0 +1,144 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graphalign/PinnedPathAligner.hh"
+
+#include <random>
+
+#include "graphalign/LinearAlignmentOperations.hh"
+#include "graphcore/Graph.hh"
+#include "graphcore/GraphBuilders.hh"
+
+#include "gtest/gtest.h"
+
+using std::list;
+using std::string;
+
+using namespace graphtools;
+
+// Flanks around two adjacent repeats separated by an optional interruption
+static Graph makeTwoRepeatGraph()
+{
+    Graph graph(5);
+    graph.setNodeSeq(0, "ATTCGA");
+    graph.setNodeSeq(1, "CAG");
+    graph.setNodeSeq(2, "CAA");
+    graph.setNodeSeq(3, "CCG");
+    graph.setNodeSeq(4, "TGGCAT");
+    graph.addEdge(0, 1);
+    graph.addEdge(1, 1);
+    graph.addEdge(1, 2);
+    graph.addEdge(1, 3);
+    graph.addEdge(2, 3);
+    graph.addEdge(3, 3);
+    graph.addEdge(3, 4);
+    return graph;
+}
+
+// Aligns the query piece to each extension separately
+static list<PathAndAlignment> alignToEachPath(
+    const Path& seed_path, const string& query_piece, int32_t extension_len, bool extend_start, int32_t& top_score)
+{
+    const int32_t match_score = 5, mismatch_score = -4, gap_score = -8;
+    PinnedAligner aligner(match_score, mismatch_score, gap_score);
+    list<PathAndAlignment> top_paths_and_alignments;
+    top_score = INT32_MIN;
+    const list<Path> paths
+        = extend_start ? extendPathStart(seed_path, extension_len) : extendPathEnd(seed_path, extension_len);
+    for (const Path& path : paths)
+    {
+        const Alignment alignment = extend_start ? aligner.suffixAlign(path.seq(), query_piece)
+                                                 : aligner.prefixAlign(path.seq(), query_piece);
+        const int32_t score = scoreAlignment(alignment, match_score, mismatch_score, gap_score);
+        if (top_score < score)
+        {
+            top_paths_and_alignments.clear();
+            top_score = score;
+        }
+        if (top_score == score)
+        {
+            top_paths_and_alignments.emplace_back(path, alignment);
+        }
+    }
+    return top_paths_and_alignments;
+}
+
+TEST(AligningToPathExtensions, RandomQueriesAroundTwoRepeats_SameAlignmentsAsEachPathSeparately)
+{
+    Graph graph = makeTwoRepeatGraph();
+    const Path suffix_seed(&graph, 4, { 0 }, 4);
+    const Path prefix_seed(&graph, 2, { 4 }, 2);
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> base_distribution(0, 3);
+    std::uniform_int_distribution<int> length_distribution(1, 20);
+    const string bases = "ACGT";
+
+    PinnedPathAligner aligner;
+    for (int trial = 0; trial != 200; ++trial)
+    {
+        string query_piece;
+        for (int i = length_distribution(generator); i; --i)
+        {
+            query_piece += bases[base_distribution(generator)];
+        }
+        const int32_t extension_len = static_cast<int32_t>(query_piece.length()) + 4;
+
+        int32_t expected_score = 0, score = 0;
+        const list<PathAndAlignment> expected_suffix_alignments
+            = alignToEachPath(suffix_seed, query_piece, extension_len, false, expected_score);
+        EXPECT_EQ(expected_suffix_alignments, aligner.prefixAlign(suffix_seed, query_piece, extension_len, score));
+        EXPECT_EQ(expected_score, score);
+
+        const list<PathAndAlignment> expected_prefix_alignments
+            = alignToEachPath(prefix_seed, query_piece, extension_len, true, expected_score);
+        EXPECT_EQ(expected_prefix_alignments, aligner.suffixAlign(prefix_seed, query_piece, extension_len, score));
+        EXPECT_EQ(expected_score, score);
+    }
+
+    // One trie per seed and extension length
+    EXPECT_EQ(40ul, aligner.trieCacheStats().misses);
+    EXPECT_EQ(360ul, aligner.trieCacheStats().hits);
+}
+
+TEST(AligningToPathExtensions, RepeatQuery_AllTopScoringPathsReported)
+{
+    Graph graph = makeStrGraph("ATTC", "CAG", "GGTA");
+    const Path seed(&graph, 4, { 0 }, 4);
+
+    PinnedPathAligner aligner;
+    int32_t score = 0;
+    const list<PathAndAlignment> alignments = aligner.prefixAlign(seed, "CAGCAG", 10, score);
+
+    EXPECT_EQ(30, score);
+    ASSERT_EQ(3ul, alignments.size());
+    EXPECT_EQ("(0@4)-(1)-(1)-(1)-(1@1)", alignments.front().first.encode());
+    EXPECT_EQ("(0@4)-(1)-(1)-(2@4)", alignments.back().first.encode());
+    EXPECT_EQ("6M", alignments.front().second.generateCigar());
+    EXPECT_EQ("6M", alignments.back().second.generateCigar());
+}
@@ -0,0 +1,321 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Roman Petrovski <RPetrovski@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graphalign/dagAligner/ScoreKernels.hh"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using std::vector;
+using namespace graphalign::dagAligner;
+
+class ScoreKernelsTest : public ::testing::TestWithParam<KernelIsa>
+{
+};
+
+TEST_P(ScoreKernelsTest, RandomRows_SameScoresAsScalarKernels)
+{
+    if (!isSupported(GetParam()))
+    {
+        return;
+    }
+
+    const KernelIsa originalIsa = activeScoreKernels().isa;
+    setActiveScoreKernels(KernelIsa::kScalar);
+    const ScoreKernels scalar = activeScoreKernels();
+    setActiveScoreKernels(GetParam());
+    const ScoreKernels tested = activeScoreKernels();
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> scores(-200, 200);
+    for (const int len : { 16, 48, 150, 160 })
+    {
+        auto randomRow = [&]() {
+            vector<Score> row(len);
+            for (Score& score : row)
+            {
+                score = scores(generator);
+            }
+            return row;
+        };
+
+        const vector<Score> vp = randomRow(), ep = randomRow(), vDiag = randomRow(), penalties = randomRow();
+        vector<Score> expectedE = randomRow(), expectedG = randomRow(), expectedV = randomRow();
+        vector<Score> e = expectedE, g = expectedG, v = expectedV;
+
+        scalar.deletionAndAlign(&vp[0], &ep[0], &vDiag[0], &penalties[0], &expectedE[0], &expectedG[0], len, -8, -2);
+        scalar.consolidate(&expectedE[0], &expectedG[0], &expectedV[0], len);
+        tested.deletionAndAlign(&vp[0], &ep[0], &vDiag[0], &penalties[0], &e[0], &g[0], len, -8, -2);
+        tested.consolidate(&e[0], &g[0], &v[0], len);
+
+        EXPECT_EQ(expectedE, e);
+        EXPECT_EQ(expectedG, g);
+        EXPECT_EQ(expectedV, v);
+
+        // insertion kernels read the cell preceding the row
+        vector<Score> expectedF = randomRow(), expectedVWithGap = randomRow();
+        expectedF.insert(expectedF.begin(), 15);
+        expectedVWithGap.insert(expectedVWithGap.begin(), 30);
+        vector<Score> f = expectedF, vWithGap = expectedVWithGap;
+
+        scalar.insertion(&expectedF[1], &expectedVWithGap[1], len, -8, -2);
+        tested.insertion(&f[1], &vWithGap[1], len, -8, -2);
+
+        EXPECT_EQ(expectedF, f);
+        EXPECT_EQ(expectedVWithGap, vWithGap);
+    }
+
+    setActiveScoreKernels(originalIsa);
+}
+
+TEST_P(ScoreKernelsTest, RandomInterleavedRows_SameInsertionsAsScalarKernels)
+{
+    if (!isSupported(GetParam()))
+    {
+        return;
+    }
+
+    const KernelIsa originalIsa = activeScoreKernels().isa;
+    setActiveScoreKernels(KernelIsa::kScalar);
+    const ScoreKernels scalar = activeScoreKernels();
+    setActiveScoreKernels(GetParam());
+    const ScoreKernels tested = activeScoreKernels();
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> scores(-200, 200);
+    for (const int lanes : { 8, 16, 32 })
+    {
+        const int len = 50;
+        // includes the gap row preceding the first query position
+        vector<Score> expectedF((len + 1) * lanes), expectedV((len + 1) * lanes);
+        for (std::size_t i = 0; i != expectedF.size(); ++i)
+        {
+            expectedF[i] = scores(generator);
+            expectedV[i] = scores(generator);
+        }
+        vector<Score> f = expectedF, v = expectedV;
+
+        scalar.insertionAcrossLanes(&expectedF[lanes], &expectedV[lanes], len, lanes, -8, -2);
+        tested.insertionAcrossLanes(&f[lanes], &v[lanes], len, lanes, -8, -2);
+
+        EXPECT_EQ(expectedF, f);
+        EXPECT_EQ(expectedV, v);
+    }
+
+    setActiveScoreKernels(originalIsa);
+}
+
+// Matrices are initialized with SCORE_MIN, so sums of gap penalties and cells that were never reached must saturate
+TEST_P(ScoreKernelsTest, RowsNearScoreMin_SameSaturatedScoresAsScalarKernels)
+{
+    if (!isSupported(GetParam()))
+    {
+        return;
+    }
+
+    const KernelIsa originalIsa = activeScoreKernels().isa;
+    setActiveScoreKernels(KernelIsa::kScalar);
+    const ScoreKernels scalar = activeScoreKernels();
+    setActiveScoreKernels(GetParam());
+    const ScoreKernels tested = activeScoreKernels();
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> offsetsFromMin(0, 40);
+    std::uniform_int_distribution<int> scores(-200, 200);
+    std::bernoulli_distribution isNearMin(0.8);
+    for (const int len : { 16, 48, 150, 160 })
+    {
+        // the first row of each kind holds SCORE_MIN only and the rest mostly hold values within 40 of it
+        auto rowNearMin = [&](bool isAllMin) {
+            vector<Score> row(len, SCORE_MIN);
+            for (Score& score : row)
+            {
+                if (!isAllMin)
+                {
+                    score = isNearMin(generator) ? SCORE_MIN + offsetsFromMin(generator) : scores(generator);
+                }
+            }
+            return row;
+        };
+
+        for (const bool isAllMin : { true, false })
+        {
+            const vector<Score> vp = rowNearMin(isAllMin), ep = rowNearMin(isAllMin);
+            const vector<Score> vDiag = rowNearMin(isAllMin), penalties(len, -4);
+            vector<Score> expectedE = rowNearMin(isAllMin), expectedG = rowNearMin(isAllMin);
+            vector<Score> expectedV = rowNearMin(isAllMin);
+            vector<Score> e = expectedE, g = expectedG, v = expectedV;
+
+            scalar.deletionAndAlign(
+                &vp[0], &ep[0], &vDiag[0], &penalties[0], &expectedE[0], &expectedG[0], len, -8, -2);
+            scalar.consolidate(&expectedE[0], &expectedG[0], &expectedV[0], len);
+            tested.deletionAndAlign(&vp[0], &ep[0], &vDiag[0], &penalties[0], &e[0], &g[0], len, -8, -2);
+            tested.consolidate(&e[0], &g[0], &v[0], len);
+
+            EXPECT_EQ(expectedE, e);
+            EXPECT_EQ(expectedG, g);
+            EXPECT_EQ(expectedV, v);
+
+            vector<Score> expectedF = rowNearMin(isAllMin), expectedVWithGap = rowNearMin(isAllMin);
+            expectedF.insert(expectedF.begin(), SCORE_MIN);
+            expectedVWithGap.insert(expectedVWithGap.begin(), SCORE_MIN + 1);
+            vector<Score> f = expectedF, vWithGap = expectedVWithGap;
+
+            scalar.insertion(&expectedF[1], &expectedVWithGap[1], len, -8, -2);
+            tested.insertion(&f[1], &vWithGap[1], len, -8, -2);
+
+            EXPECT_EQ(expectedF, f);
+            EXPECT_EQ(expectedVWithGap, vWithGap);
+            if (isAllMin)
+            {
+                EXPECT_EQ(vector<Score>(len + 1, SCORE_MIN), f);
+            }
+        }
+    }
+
+    for (const int lanes : { 8, 16, 32 })
+    {
+        const int len = 50;
+        vector<Score> expectedF((len + 1) * lanes), expectedV((len + 1) * lanes);
+        for (std::size_t i = 0; i != expectedF.size(); ++i)
+        {
+            expectedF[i] = isNearMin(generator) ? SCORE_MIN + offsetsFromMin(generator) : scores(generator);
+            expectedV[i] = isNearMin(generator) ? SCORE_MIN + offsetsFromMin(generator) : scores(generator);
+        }
+        vector<Score> f = expectedF, v = expectedV;
+
+        scalar.insertionAcrossLanes(&expectedF[lanes], &expectedV[lanes], len, lanes, -8, -2);
+        tested.insertionAcrossLanes(&f[lanes], &v[lanes], len, lanes, -8, -2);
+
+        EXPECT_EQ(expectedF, f);
+        EXPECT_EQ(expectedV, v);
+    }
+
+    setActiveScoreKernels(originalIsa);
+}
+
+TEST_P(ScoreKernelsTest, RandomNarrowRows_SameSaturatedScoresAsScalarKernels)
+{
+    if (!isSupported(GetParam()))
+    {
+        return;
+    }
+
+    const KernelIsa originalIsa = activeScoreKernels().isa;
+    setActiveScoreKernels(KernelIsa::kScalar);
+    const ScoreKernels scalar = activeScoreKernels();
+    setActiveScoreKernels(GetParam());
+    const ScoreKernels tested = activeScoreKernels();
+
+    std::mt19937 generator(42);
+    // wide enough for the sums to saturate
+    std::uniform_int_distribution<int> scores(NARROW_SCORE_MIN, NARROW_SCORE_MAX);
+    auto randomRow = [&](int len) {
+        vector<NarrowScore> row(len);
+        for (NarrowScore& score : row)
+        {
+            score = scores(generator);
+        }
+        return row;
+    };
+
+    for (const int len : { 32, 48, 150, 160 })
+    {
+        const vector<NarrowScore> vp = randomRow(len), ep = randomRow(len), vDiag = randomRow(len);
+        const vector<NarrowScore> penalties = randomRow(len);
+        vector<NarrowScore> expectedE = randomRow(len), expectedG = randomRow(len), expectedV = randomRow(len);
+        vector<NarrowScore> e = expectedE, g = expectedG, v = expectedV;
+
+        scalar.narrowDeletionAndAlign(
+            &vp[0], &ep[0], &vDiag[0], &penalties[0], &expectedE[0], &expectedG[0], len, -8, -2);
+        scalar.narrowConsolidate(&expectedE[0], &expectedG[0], &expectedV[0], len);
+        tested.narrowDeletionAndAlign(&vp[0], &ep[0], &vDiag[0], &penalties[0], &e[0], &g[0], len, -8, -2);
+        tested.narrowConsolidate(&e[0], &g[0], &v[0], len);
+
+        EXPECT_EQ(expectedE, e);
+        EXPECT_EQ(expectedG, g);
+        EXPECT_EQ(expectedV, v);
+    }
+
+    for (const int lanes : { 16, 32, 64 })
+    {
+        const int len = 50;
+        // includes the gap row preceding the first query position
+        vector<NarrowScore> expectedF = randomRow((len + 1) * lanes), expectedV = randomRow((len + 1) * lanes);
+        vector<NarrowScore> f = expectedF, v = expectedV;
+
+        scalar.narrowInsertionAcrossLanes(&expectedF[lanes], &expectedV[lanes], len, lanes, -8, -2);
+        tested.narrowInsertionAcrossLanes(&f[lanes], &v[lanes], len, lanes, -8, -2);
+
+        EXPECT_EQ(expectedF, f);
+        EXPECT_EQ(expectedV, v);
+    }
+
+    setActiveScoreKernels(originalIsa);
+}
+
+TEST(NarrowScoreKernels, ScoresWithinRange_SameScoresAsWideKernels)
+{
+    const KernelIsa originalIsa = activeScoreKernels().isa;
+    setActiveScoreKernels(KernelIsa::kScalar);
+    const ScoreKernels scalar = activeScoreKernels();
+
+    std::mt19937 generator(42);
+    // small enough for no sum to saturate
+    std::uniform_int_distribution<int> scores(-50, 50);
+    const int len = 64;
+    vector<Score> vp(len), ep(len), vDiag(len), penalties(len), e(len), g(len), v(len);
+    for (vector<Score>* row : { &vp, &ep, &vDiag, &penalties, &e, &g, &v })
+    {
+        for (Score& score : *row)
+        {
+            score = scores(generator);
+        }
+    }
+    auto narrow = [](const vector<Score>& row) { return vector<NarrowScore>(row.begin(), row.end()); };
+    const vector<NarrowScore> narrowVp = narrow(vp), narrowEp = narrow(ep), narrowVDiag = narrow(vDiag);
+    const vector<NarrowScore> narrowPenalties = narrow(penalties);
+    vector<NarrowScore> narrowE = narrow(e), narrowG = narrow(g), narrowV = narrow(v);
+
+    scalar.deletionAndAlign(&vp[0], &ep[0], &vDiag[0], &penalties[0], &e[0], &g[0], len, -8, -2);
+    scalar.consolidate(&e[0], &g[0], &v[0], len);
+    scalar.narrowDeletionAndAlign(
+        &narrowVp[0], &narrowEp[0], &narrowVDiag[0], &narrowPenalties[0], &narrowE[0], &narrowG[0], len, -8, -2);
+    scalar.narrowConsolidate(&narrowE[0], &narrowG[0], &narrowV[0], len);
+
+    EXPECT_EQ(narrow(e), narrowE);
+    EXPECT_EQ(narrow(g), narrowG);
+    EXPECT_EQ(narrow(v), narrowV);
+
+    setActiveScoreKernels(originalIsa);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    ScoreKernelsTestInst, ScoreKernelsTest, ::testing::Values(KernelIsa::kAvx2, KernelIsa::kAvx512bw));
@@ -0,0 +1,87 @@
+//
+// GraphTools library
+// Copyright (c) 2018 Illumina, Inc.
+// All rights reserved.
+//
+// Author: Egor Dolzhenko <edolzhenko@illumina.com>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graphutils/SmallVector.hh"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using std::vector;
+
+using namespace graphtools;
+
+TEST(SmallVector, ElementsThatFitInPlace_StoredWithoutAllocation)
+{
+    SmallVector<int, 4> elements = { 1, 2, 3 };
+    elements.push_back(4);
+
+    EXPECT_TRUE(elements.isInline());
+    EXPECT_EQ((vector<int>{ 1, 2, 3, 4 }), elements);
+}
+
+TEST(SmallVector, GrowingPastInlineCapacity_ElementsPreserved)
+{
+    SmallVector<int, 2> elements = { 2, 3 };
+    elements.insert(elements.begin(), 1);
+    elements.push_back(4);
+
+    EXPECT_FALSE(elements.isInline());
+    EXPECT_EQ((vector<int>{ 1, 2, 3, 4 }), elements);
+}
+
+TEST(SmallVector, ErasingElements_RemainingElementsShifted)
+{
+    SmallVector<int, 4> elements = { 1, 2, 3 };
+    elements.erase(elements.begin());
+    EXPECT_EQ((vector<int>{ 2, 3 }), elements);
+
+    elements.erase(elements.end() - 1);
+    EXPECT_EQ((vector<int>{ 2 }), elements);
+}
+
+TEST(SmallVector, CopyingAndMoving_ValueSemanticsPreserved)
+{
+    SmallVector<int, 2> heap_elements = { 1, 2, 3 };
+    SmallVector<int, 2> inline_elements = { 4 };
+
+    SmallVector<int, 2> copy(heap_elements);
+    copy.push_back(5);
+    EXPECT_EQ((vector<int>{ 1, 2, 3 }), heap_elements);
+    EXPECT_EQ((vector<int>{ 1, 2, 3, 5 }), copy);
+
+    copy = inline_elements;
+    EXPECT_EQ((vector<int>{ 4 }), copy);
+
+    SmallVector<int, 2> moved(std::move(heap_elements));
+    EXPECT_EQ((vector<int>{ 1, 2, 3 }), moved);
+    EXPECT_TRUE(heap_elements.empty());
+
+    moved = std::move(inline_elements);
+    EXPECT_EQ((vector<int>{ 4 }), moved);
+    EXPECT_TRUE(moved.isInline());
+}